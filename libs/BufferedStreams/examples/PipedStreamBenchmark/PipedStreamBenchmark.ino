@@ -0,0 +1,105 @@
+/**
+ * @file PipedStreamBenchmark.ino
+ * @brief Throughput of a PipedStreamPair with per-byte and bulk transfers
+ *
+ * Moves 64-byte packets from one end of a PipedStreamPair to the other, first
+ * one byte at a time through the Stream interface, then with the bulk
+ * write(buffer, length) and readBytes() paths. Both a power-of-two capacity
+ * (mask arithmetic) and a non-power-of-two capacity are measured.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include <PipedStream.h>
+
+// Packet size used for every transfer
+const uint8_t PACKET_SIZE = 64;
+
+// Number of packets moved per measurement
+const uint16_t PACKET_COUNT = 1000;
+
+uint8_t packet[PACKET_SIZE];
+uint8_t received[PACKET_SIZE];
+
+// Prints one result line
+void printResult(const __FlashStringHelper *name, const uint16_t capacity, const unsigned long elapsed)
+{
+  const uint32_t totalBytes = (uint32_t)PACKET_SIZE * PACKET_COUNT;
+  Serial.print(name);
+  Serial.print(F(" (capacity "));
+  Serial.print(capacity);
+  Serial.print(F("): "));
+  Serial.print(elapsed);
+  Serial.print(F(" us, "));
+  Serial.print(elapsed ? (uint32_t)((uint64_t)totalBytes * 1000000UL / elapsed) : 0UL);
+  Serial.println(F(" bytes/sec"));
+}
+
+// Moves the packets one byte at a time through the Stream interface
+unsigned long runPerByte(PipedStreamPair &pipes)
+{
+  Stream &writer = pipes.first;
+  Stream &reader = pipes.second;
+
+  const unsigned long start = micros();
+  for (uint16_t p = 0; p < PACKET_COUNT; p++)
+  {
+    for (uint8_t i = 0; i < PACKET_SIZE; i++)
+    {
+      writer.write(packet[i]);
+    }
+    for (uint8_t i = 0; i < PACKET_SIZE; i++)
+    {
+      received[i] = reader.read();
+    }
+  }
+  return micros() - start;
+}
+
+// Moves the packets with the bulk write/readBytes paths
+unsigned long runBulk(PipedStreamPair &pipes)
+{
+  const unsigned long start = micros();
+  for (uint16_t p = 0; p < PACKET_COUNT; p++)
+  {
+    pipes.first.write(packet, PACKET_SIZE);
+    pipes.second.readBytes(received, PACKET_SIZE);
+  }
+  return micros() - start;
+}
+
+// Runs both measurements for one capacity
+void benchmark(const uint16_t capacity)
+{
+  PipedStreamPair pipes(capacity);
+
+  // Offset the positions so transfers wrap around the end of the buffer
+  pipes.first.write(packet, 23);
+  pipes.second.readBytes(received, 23);
+
+  printResult(F("per-byte"), capacity, runPerByte(pipes));
+  printResult(F("bulk"), capacity, runBulk(pipes));
+}
+
+void setup()
+{
+  Serial.begin(9600);
+  delay(1000);
+
+  Serial.println(F("PipedStream Benchmark"));
+  Serial.println(F("====================="));
+
+  for (uint8_t i = 0; i < PACKET_SIZE; i++)
+  {
+    packet[i] = i;
+  }
+
+  benchmark(128); // Power of two: mask arithmetic
+  benchmark(96);  // Other sizes: conditional wrap
+}
+
+void loop()
+{
+  // Empty loop
+}
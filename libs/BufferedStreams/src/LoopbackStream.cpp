@@ -10,6 +10,45 @@
  */
 #include "LoopbackStream.h"
 
+/**
+ * @brief Constructor for a single delimiter.
+ *
+ * @param delimiter The delimiter byte.
+ */
+LoopbackDelimiterIndex::LoopbackDelimiterIndex(const uint8_t delimiter)
+{
+  delimiters[0] = delimiter;
+  delimiters[1] = delimiter;
+  delimiter_count = 1;
+  reset();
+}
+
+/**
+ * @brief Constructor for two delimiters.
+ *
+ * @param first The first delimiter byte.
+ * @param second The second delimiter byte.
+ */
+LoopbackDelimiterIndex::LoopbackDelimiterIndex(const uint8_t first, const uint8_t second)
+{
+  delimiters[0] = first;
+  delimiters[1] = second;
+  delimiter_count = 2;
+  reset();
+}
+
+/**
+ * @brief Clears all counts and recorded positions.
+ */
+void LoopbackDelimiterIndex::reset()
+{
+  counts[0] = 0;
+  counts[1] = 0;
+  total = 0;
+  head = 0;
+  recorded = 0;
+}
+
 /**
  * @brief Constructor that allocates memory for the internal buffer.
  *
@@ -19,8 +58,28 @@ LoopbackStream::LoopbackStream(uint16_t buffer_size)
 {
   this->buffer = static_cast<uint8_t *>(malloc(buffer_size));
   this->buffer_size = buffer_size;
+  this->mask = ((buffer_size & (buffer_size - 1)) == 0) ? buffer_size - 1 : 0;
   this->pos = 0;
   this->size = 0;
+  this->owns_buffer = true;
+  this->delimiter_index = nullptr;
+}
+
+/**
+ * @brief Constructor that uses caller-provided storage without allocating.
+ *
+ * @param buffer Storage of at least buffer_size bytes, or nullptr to allocate it.
+ * @param buffer_size Size of the storage.
+ */
+LoopbackStream::LoopbackStream(uint8_t *buffer, uint16_t buffer_size)
+{
+  this->owns_buffer = buffer == nullptr;
+  this->buffer = owns_buffer ? static_cast<uint8_t *>(malloc(buffer_size)) : buffer;
+  this->buffer_size = buffer_size;
+  this->mask = ((buffer_size & (buffer_size - 1)) == 0) ? buffer_size - 1 : 0;
+  this->pos = 0;
+  this->size = 0;
+  this->delimiter_index = nullptr;
 }
 
 /**
@@ -28,7 +87,10 @@ LoopbackStream::LoopbackStream(uint16_t buffer_size)
  */
 LoopbackStream::~LoopbackStream()
 {
-  free(buffer);
+  if (owns_buffer)
+  {
+    free(buffer);
+  }
 }
 
 /**
@@ -37,12 +99,16 @@ LoopbackStream::~LoopbackStream()
  * @param other The LoopbackStream to move from.
  */
 LoopbackStream::LoopbackStream(LoopbackStream &&other) noexcept
-    : buffer(other.buffer), buffer_size(other.buffer_size), pos(other.pos), size(other.size)
+    : buffer(other.buffer), buffer_size(other.buffer_size), mask(other.mask), pos(other.pos), size(other.size),
+      owns_buffer(other.owns_buffer), delimiter_index(other.delimiter_index)
 {
   other.buffer = nullptr;
   other.buffer_size = 0;
+  other.mask = 0;
   other.pos = 0;
   other.size = 0;
+  other.owns_buffer = false;
+  other.delimiter_index = nullptr;
 }
 
 /**
@@ -55,17 +121,26 @@ LoopbackStream &LoopbackStream::operator=(LoopbackStream &&other) noexcept
 {
   if (this != &other)
   {
-    free(buffer);
+    if (owns_buffer)
+    {
+      free(buffer);
+    }
 
     buffer = other.buffer;
     buffer_size = other.buffer_size;
+    mask = other.mask;
     pos = other.pos;
     size = other.size;
+    owns_buffer = other.owns_buffer;
+    delimiter_index = other.delimiter_index;
 
     other.buffer = nullptr;
     other.buffer_size = 0;
+    other.mask = 0;
     other.pos = 0;
     other.size = 0;
+    other.owns_buffer = false;
+    other.delimiter_index = nullptr;
   }
   return *this;
 }
@@ -77,6 +152,10 @@ void LoopbackStream::clear()
 {
   this->pos = 0;
   this->size = 0;
+  if (delimiter_index)
+  {
+    delimiter_index->reset();
+  }
 }
 
 /**
@@ -93,12 +172,12 @@ int LoopbackStream::read()
   else
   {
     int ret = buffer[pos];
-    pos++;
-    size--;
-    if (pos == buffer_size)
+    if (delimiter_index)
     {
-      pos = 0;
+      indexRemoved(pos, 1);
     }
+    pos = wrap(pos + 1);
+    size--;
     return ret;
   }
 }
@@ -116,12 +195,162 @@ size_t LoopbackStream::write(uint8_t v)
     return 0;
   }
 
-  uint16_t write_pos = (pos + size) % buffer_size;
+  const uint16_t write_pos = wrap(pos + size);
   buffer[write_pos] = v;
+  if (delimiter_index)
+  {
+    indexAdded(write_pos, 1);
+  }
   size++;
   return 1;
 }
 
+/**
+ * @brief Writes a block of bytes to the buffer.
+ *
+ * The free space is at most two contiguous regions: from the write position to
+ * the end of the buffer, and from the start of the buffer up to the read position.
+ *
+ * @param data The bytes to write.
+ * @param length The number of bytes to write.
+ * @return The number of bytes written.
+ */
+size_t LoopbackStream::write(const uint8_t *data, size_t length)
+{
+  const uint16_t space = buffer_size - size;
+  const uint16_t count = (length < space) ? static_cast<uint16_t>(length) : space;
+  if (count == 0)
+  {
+    return 0;
+  }
+
+  const uint16_t write_pos = wrap(pos + size);
+  const uint16_t first = (count < buffer_size - write_pos) ? count : buffer_size - write_pos;
+  memcpy(buffer + write_pos, data, first);
+  memcpy(buffer, data + first, count - first);
+  if (delimiter_index)
+  {
+    indexAdded(write_pos, count);
+  }
+  size += count;
+  return count;
+}
+
+/**
+ * @brief Reads a block of bytes from the buffer.
+ *
+ * The buffered data is at most two contiguous regions: from the read position to
+ * the end of the buffer, and from the start of the buffer onwards.
+ *
+ * @param data The destination buffer.
+ * @param length The maximum number of bytes to read.
+ * @return The number of bytes read.
+ */
+size_t LoopbackStream::readBytes(char *data, size_t length)
+{
+  const uint16_t count = (length < size) ? static_cast<uint16_t>(length) : size;
+  if (count == 0)
+  {
+    return 0;
+  }
+
+  const uint16_t first = (count < buffer_size - pos) ? count : buffer_size - pos;
+  memcpy(data, buffer + pos, first);
+  memcpy(data + first, buffer, count - first);
+  if (delimiter_index)
+  {
+    indexRemoved(pos, count);
+  }
+  pos = wrap(pos + count);
+  size -= count;
+  return count;
+}
+
+/**
+ * @brief Borrows the contiguous run of buffered bytes starting at the read position.
+ *
+ * @param data Set to the first buffered byte.
+ * @param length Set to the number of contiguous bytes at data.
+ * @return true if data is available.
+ */
+bool LoopbackStream::peekContiguous(const uint8_t *&data, uint16_t &length) const
+{
+  if (size == 0)
+  {
+    data = nullptr;
+    length = 0;
+    return false;
+  }
+
+  data = buffer + pos;
+  length = (size < buffer_size - pos) ? size : buffer_size - pos;
+  return true;
+}
+
+/**
+ * @brief Drops bytes from the front of the buffer.
+ *
+ * @param count Number of bytes to drop.
+ */
+void LoopbackStream::consume(uint16_t count)
+{
+  if (count >= size)
+  {
+    clear();
+    return;
+  }
+
+  if (delimiter_index)
+  {
+    indexRemoved(pos, count);
+  }
+  pos = wrap(pos + count);
+  size -= count;
+}
+
+/**
+ * @brief Hands out contiguous free space behind the write position.
+ *
+ * @param length Number of contiguous bytes required.
+ * @return Pointer to the region, or nullptr if it is not available.
+ */
+uint8_t *LoopbackStream::reserve(const uint16_t length)
+{
+  if (size == 0)
+  {
+    pos = 0;
+  }
+
+  const uint16_t write_pos = wrap(pos + size);
+  // Free space runs to the end of the buffer, or up to the read position once wrapped
+  const uint16_t contiguous = (write_pos >= pos && size != buffer_size) ? buffer_size - write_pos
+                                                                         : buffer_size - size;
+  if (length == 0 || length > contiguous)
+  {
+    return nullptr;
+  }
+  return buffer + write_pos;
+}
+
+/**
+ * @brief Appends bytes previously written through reserve().
+ *
+ * @param count Number of bytes to append.
+ */
+void LoopbackStream::commit(uint16_t count)
+{
+  const uint16_t space = buffer_size - size;
+  if (count > space)
+  {
+    count = space;
+  }
+  if (delimiter_index)
+  {
+    indexAdded(wrap(pos + size), count);
+  }
+  size += count;
+}
+
 /**
  * @brief Returns the number of bytes available for reading.
  *
@@ -150,12 +379,22 @@ int LoopbackStream::availableForWrite()
  */
 bool LoopbackStream::contains(char ch)
 {
+  const uint8_t target = static_cast<uint8_t>(ch);
+  if (delimiter_index)
+  {
+    const int8_t slot = delimiter_index->find(target);
+    if (slot >= 0)
+    {
+      return delimiter_index->counts[slot] > 0;
+    }
+  }
+
   uint16_t current = pos;
   uint16_t remaining = size;
 
   while (remaining > 0)
   {
-    if (buffer[current] == ch)
+    if (buffer[current] == target)
     {
       return true;
     }
@@ -169,6 +408,124 @@ bool LoopbackStream::contains(char ch)
   return false;
 }
 
+/**
+ * @brief Attaches a delimiter index and builds it from the buffered bytes.
+ *
+ * @param index The index to attach, or nullptr to detach.
+ */
+void LoopbackStream::setDelimiterIndex(LoopbackDelimiterIndex *index)
+{
+  delimiter_index = index;
+  if (delimiter_index)
+  {
+    delimiter_index->reset();
+    indexAdded(pos, size);
+  }
+}
+
+/**
+ * @brief Reads one delimiter-terminated record.
+ *
+ * The end of the record comes from the recorded delimiter positions; only when
+ * more delimiters were written than could be recorded is the buffer scanned.
+ *
+ * @param data The destination buffer.
+ * @param length Size of the destination buffer, including the terminator.
+ * @return Number of bytes copied, or -1 if no complete record is buffered.
+ */
+int LoopbackStream::readLine(char *data, size_t length)
+{
+  if (!delimiter_index || delimiter_index->total == 0)
+  {
+    return -1;
+  }
+
+  uint16_t end;
+  if (delimiter_index->recorded)
+  {
+    end = delimiter_index->positions[delimiter_index->head];
+  }
+  else
+  {
+    end = pos;
+    while (delimiter_index->find(buffer[end]) < 0)
+    {
+      end = wrap(end + 1);
+    }
+  }
+
+  const uint16_t record = (end >= pos) ? end - pos : end + buffer_size - pos;
+  uint16_t copied = 0;
+  if (length > 0)
+  {
+    copied = (record < length - 1) ? record : static_cast<uint16_t>(length - 1);
+    readBytes(data, copied);
+    data[copied] = '\0';
+  }
+
+  // Drop any truncated remainder together with the delimiter
+  consume(record - copied + 1);
+  return copied;
+}
+
+/**
+ * @brief Records delimiters among bytes that entered the buffer.
+ *
+ * A position is recorded only while every delimiter before it is recorded too,
+ * so the recorded positions always describe the oldest delimiters in order.
+ *
+ * @param start Buffer position of the first new byte.
+ * @param count Number of new bytes.
+ */
+void LoopbackStream::indexAdded(uint16_t start, uint16_t count)
+{
+  LoopbackDelimiterIndex &idx = *delimiter_index;
+  while (count--)
+  {
+    const int8_t slot = idx.find(buffer[start]);
+    if (slot >= 0)
+    {
+      if (idx.recorded == idx.total && idx.recorded < LoopbackDelimiterIndex::MAX_POSITIONS)
+      {
+        idx.positions[(idx.head + idx.recorded) & (LoopbackDelimiterIndex::MAX_POSITIONS - 1)] = start;
+        idx.recorded++;
+      }
+      idx.counts[slot]++;
+      idx.total++;
+    }
+    start = wrap(start + 1);
+  }
+}
+
+/**
+ * @brief Forgets delimiters among bytes that leave the buffer.
+ *
+ * Bytes leave from the front, so a leaving delimiter is always the oldest one
+ * and, if any positions are recorded, the first recorded position.
+ *
+ * @param start Buffer position of the first leaving byte.
+ * @param count Number of leaving bytes.
+ */
+void LoopbackStream::indexRemoved(uint16_t start, uint16_t count)
+{
+  LoopbackDelimiterIndex &idx = *delimiter_index;
+  while (count-- && idx.total)
+  {
+    const int8_t slot = idx.find(buffer[start]);
+    if (slot >= 0)
+    {
+      if (idx.recorded)
+      {
+        idx.head = (idx.head + 1) & (LoopbackDelimiterIndex::MAX_POSITIONS - 1);
+        idx.recorded--;
+      }
+      idx.counts[slot]--;
+      idx.total--;
+    }
+    start = wrap(start + 1);
+  }
+}
+
 /**
  * @brief Peeks at the next byte in the buffer without removing it.
  *
@@ -12,6 +12,74 @@
 
 #include <Stream.h>
 
+/**
+ * @brief Index of delimiter bytes held by a LoopbackStream.
+ *
+ * Attached with LoopbackStream::setDelimiterIndex(), it is updated as bytes are
+ * written and read so that contains() on a registered delimiter is O(1) and
+ * readLine() finds the end of the first record without rescanning. The index
+ * lives outside the stream so streams that do not use it pay only for a pointer.
+ *
+ * The first MAX_POSITIONS delimiters in the buffer have their positions recorded;
+ * beyond that only counts are kept and readLine() scans once the recorded
+ * positions have been consumed.
+ */
+class LoopbackDelimiterIndex
+{
+  friend class LoopbackStream;
+
+public:
+  static const uint8_t MAX_DELIMITERS = 2; ///< Maximum number of registered delimiter bytes.
+  static const uint8_t MAX_POSITIONS = 8;  ///< Number of delimiter positions recorded (power of two).
+
+  /**
+   * @brief Constructor for a single delimiter.
+   *
+   * @param delimiter The delimiter byte, e.g. '\n'.
+   */
+  explicit LoopbackDelimiterIndex(const uint8_t delimiter);
+
+  /**
+   * @brief Constructor for two delimiters.
+   *
+   * @param first The first delimiter byte, e.g. '\n'.
+   * @param second The second delimiter byte, e.g. '\r'.
+   */
+  LoopbackDelimiterIndex(const uint8_t first, const uint8_t second);
+
+private:
+  /**
+   * @brief Forget all counts and positions.
+   */
+  void reset();
+
+  /**
+   * @brief Look up a registered delimiter.
+   *
+   * @param ch The byte to look up.
+   * @return Index of the delimiter, or -1 if ch is not registered.
+   */
+  inline int8_t find(const uint8_t ch) const
+  {
+    for (uint8_t i = 0; i < delimiter_count; i++)
+    {
+      if (delimiters[i] == ch)
+      {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  uint8_t delimiters[MAX_DELIMITERS]; ///< Registered delimiter bytes.
+  uint8_t delimiter_count;            ///< Number of registered delimiters.
+  uint16_t counts[MAX_DELIMITERS];    ///< Occurrences of each delimiter in the buffer.
+  uint16_t total;                     ///< Occurrences of all delimiters in the buffer.
+  uint16_t positions[MAX_POSITIONS];  ///< Buffer positions of the oldest delimiters.
+  uint8_t head;                       ///< First recorded position.
+  uint8_t recorded;                   ///< Number of recorded positions.
+};
+
 /**
  * @brief A stream that stores written data and returns it when read.
  *
@@ -21,10 +89,47 @@
  */
 class LoopbackStream : public Stream
 {
-  uint8_t *buffer;      ///< Pointer to the internal buffer.
-  uint16_t buffer_size; ///< Size of the internal buffer.
-  uint16_t pos;         ///< Current read position in the buffer.
-  uint16_t size;        ///< Number of bytes currently in the buffer.
+  uint8_t *buffer;                         ///< Pointer to the internal buffer.
+  uint16_t buffer_size;                    ///< Size of the internal buffer.
+  uint16_t mask;                           ///< buffer_size - 1 if buffer_size is a power of two, 0 otherwise.
+  uint16_t pos;                            ///< Current read position in the buffer.
+  uint16_t size;                           ///< Number of bytes currently in the buffer.
+  bool owns_buffer;                        ///< true if the buffer was allocated by this stream and must be freed.
+  LoopbackDelimiterIndex *delimiter_index; ///< Optional delimiter index, nullptr if disabled.
+
+  /**
+   * @brief Wrap a position that may have run past the end of the buffer.
+   *
+   * Uses mask arithmetic for power-of-two buffer sizes and a single conditional
+   * subtraction otherwise, so no division is ever needed.
+   *
+   * @param index Position in the range [0, 2 * buffer_size).
+   * @return The equivalent position in the range [0, buffer_size).
+   */
+  inline uint16_t wrap(const uint16_t index) const
+  {
+    if (mask)
+    {
+      return index & mask;
+    }
+    return (index >= buffer_size) ? static_cast<uint16_t>(index - buffer_size) : index;
+  }
+
+  /**
+   * @brief Update the delimiter index for bytes that entered the buffer.
+   *
+   * @param start Buffer position of the first new byte.
+   * @param count Number of new bytes.
+   */
+  void indexAdded(uint16_t start, uint16_t count);
+
+  /**
+   * @brief Update the delimiter index for bytes about to leave the buffer.
+   *
+   * @param start Buffer position of the first leaving byte.
+   * @param count Number of leaving bytes.
+   */
+  void indexRemoved(uint16_t start, uint16_t count);
 
 public:
   /**
@@ -40,7 +145,20 @@ public:
   explicit LoopbackStream(const uint16_t buffer_size = LoopbackStream::DEFAULT_SIZE);
 
   /**
-   * @brief Destructor that frees the internal buffer.
+   * @brief Constructor over caller-provided storage.
+   *
+   * No memory is allocated; the storage must outlive the stream and is never freed
+   * by it. Use this (or StaticLoopbackStream) to keep buffers off the heap. A null
+   * buffer is allocated as by the sized constructor, so wrappers can take optional
+   * storage.
+   *
+   * @param buffer Storage of at least buffer_size bytes, or nullptr to allocate it.
+   * @param buffer_size Size of the storage in bytes.
+   */
+  LoopbackStream(uint8_t *buffer, const uint16_t buffer_size);
+
+  /**
+   * @brief Destructor that frees the internal buffer if this stream allocated it.
    */
   ~LoopbackStream();
 
@@ -86,6 +204,88 @@ public:
    */
   virtual size_t write(uint8_t data) override;
 
+  /**
+   * @brief Write a block of bytes to the buffer.
+   *
+   * Copies as many bytes as fit using at most two memcpy segments.
+   *
+   * @param data The bytes to write.
+   * @param length The number of bytes to write.
+   * @return Number of bytes written (less than length if the buffer filled up).
+   */
+  virtual size_t write(const uint8_t *data, size_t length) override;
+
+  using Print::write;
+
+  /**
+   * @brief Read a block of bytes from the buffer.
+   *
+   * Copies up to length buffered bytes using at most two memcpy segments and
+   * returns immediately. Stream::readBytes() is not virtual on every core, so
+   * this hides it: calls made through a LoopbackStream skip the per-byte timed
+   * read, calls made through a Stream reference keep the base behaviour.
+   *
+   * @param data The destination buffer.
+   * @param length The maximum number of bytes to read.
+   * @return Number of bytes read (0 if the buffer is empty).
+   */
+  size_t readBytes(char *data, size_t length);
+
+  /**
+   * @brief Read a block of bytes from the buffer.
+   *
+   * @param data The destination buffer.
+   * @param length The maximum number of bytes to read.
+   * @return Number of bytes read (0 if the buffer is empty).
+   */
+  inline size_t readBytes(uint8_t *data, size_t length)
+  {
+    return readBytes(reinterpret_cast<char *>(data), length);
+  }
+
+  /**
+   * @brief Borrow the longest contiguous run of buffered bytes.
+   *
+   * The returned pointer aims directly into the internal buffer, so a caller can
+   * parse data in place and then release it with consume(). The pointer stays
+   * valid until the next read, consume(), clear() or move. Buffered data that
+   * wraps around the end of the buffer is exposed over two calls.
+   *
+   * @param data Set to the first buffered byte (nullptr if the buffer is empty).
+   * @param length Set to the number of contiguous bytes at data.
+   * @return true if at least one byte is available, false otherwise.
+   */
+  bool peekContiguous(const uint8_t *&data, uint16_t &length) const;
+
+  /**
+   * @brief Release bytes borrowed with peekContiguous().
+   *
+   * @param count Number of bytes to drop from the front of the buffer. Values
+   *              larger than available() empty the buffer.
+   */
+  void consume(uint16_t count);
+
+  /**
+   * @brief Borrow contiguous free space to be filled in place.
+   *
+   * An empty buffer is rewound first, so a reservation up to bufferSize() always
+   * succeeds while nothing is buffered. The bytes become readable only after
+   * commit(); reserving again without committing hands out the same region.
+   *
+   * @param length Number of contiguous bytes required.
+   * @return Pointer to the reserved region, or nullptr if length bytes are not
+   *         free in one piece.
+   */
+  uint8_t *reserve(const uint16_t length);
+
+  /**
+   * @brief Publish bytes written into a region obtained with reserve().
+   *
+   * @param count Number of bytes to append. Values larger than the free space
+   *              are clamped.
+   */
+  void commit(uint16_t count);
+
   /**
    * @brief Get the number of bytes available for writing.
    *
@@ -103,11 +303,37 @@ public:
   /**
    * @brief Check if the buffer contains a specific character.
    *
+   * O(1) for a delimiter registered in the attached index, a scan otherwise.
+   *
    * @param ch The character to search for.
    * @return true if the character is found, false otherwise.
    */
   virtual bool contains(char ch);
 
+  /**
+   * @brief Attach a delimiter index to the stream.
+   *
+   * The index is rebuilt from the bytes currently buffered and kept up to date
+   * from then on. It must outlive the stream or be detached first.
+   *
+   * @param index The index to attach, or nullptr to detach.
+   */
+  void setDelimiterIndex(LoopbackDelimiterIndex *index);
+
+  /**
+   * @brief Read one delimiter-terminated record.
+   *
+   * Copies the bytes before the first registered delimiter, NUL-terminates them
+   * and drops the record together with its delimiter. A record that does not fit
+   * is truncated and the rest of it is dropped.
+   *
+   * @param data The destination buffer.
+   * @param length Size of the destination buffer, including the terminator.
+   * @return Number of bytes copied, or -1 if no complete record is buffered or no
+   *         delimiter index is attached.
+   */
+  int readLine(char *data, size_t length);
+
   /**
    * @brief Read a byte from the buffer.
    *
@@ -129,3 +355,45 @@ public:
    */
   virtual void flush() override;
 };
+
+/**
+ * @brief Inline storage for StaticLoopbackStream.
+ *
+ * Kept in a separate base so that it is laid out before the LoopbackStream base
+ * that points into it.
+ *
+ * @tparam BUFFER_SIZE Size of the storage in bytes.
+ */
+template <uint16_t BUFFER_SIZE>
+struct StaticLoopbackStorage
+{
+  uint8_t m_storage[BUFFER_SIZE]; ///< Ring storage.
+};
+
+/**
+ * @brief A LoopbackStream whose buffer is part of the object.
+ *
+ * Nothing is allocated at runtime, so global instances do not touch the heap
+ * before setup(). The capacity must be a power of two so positions wrap with a
+ * mask. The stream cannot be moved, because its buffer cannot move with it.
+ *
+ * @tparam BUFFER_SIZE Capacity in bytes (power of two).
+ */
+template <uint16_t BUFFER_SIZE = LoopbackStream::DEFAULT_SIZE>
+class StaticLoopbackStream : private StaticLoopbackStorage<BUFFER_SIZE>, public LoopbackStream
+{
+  static_assert(BUFFER_SIZE > 0 && (BUFFER_SIZE & (BUFFER_SIZE - 1)) == 0,
+                "StaticLoopbackStream size must be a power of two");
+
+public:
+  /**
+   * @brief Constructor that attaches the stream to its inline storage.
+   */
+  StaticLoopbackStream()
+      : LoopbackStream(this->m_storage, BUFFER_SIZE)
+  {
+  }
+
+  StaticLoopbackStream(StaticLoopbackStream &&) = delete;
+  StaticLoopbackStream &operator=(StaticLoopbackStream &&) = delete;
+};
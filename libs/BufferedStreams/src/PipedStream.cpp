@@ -60,12 +60,84 @@ size_t PipedStream::write(uint8_t v)
  */
 size_t PipedStream::write(const uint8_t *buffer, size_t size)
 {
-  size_t bytes_written = 0;
-  for (size_t i = 0; i < size; ++i)
-  {
-    bytes_written += out->write(buffer[i]);
-  }
-  return bytes_written;
+  return out->write(buffer, size);
+}
+
+/**
+ * @brief Reads multiple bytes from the input buffer.
+ *
+ * @param buffer The destination buffer.
+ * @param length The maximum number of bytes to read.
+ * @return The number of bytes read.
+ */
+size_t PipedStream::readBytes(char *buffer, size_t length)
+{
+  return in->readBytes(buffer, length);
+}
+
+/**
+ * @brief Borrows contiguous bytes from the input buffer.
+ *
+ * @param data Set to the first buffered byte.
+ * @param length Set to the number of contiguous bytes.
+ * @return true if data is available.
+ */
+bool PipedStream::peekContiguous(const uint8_t *&data, uint16_t &length) const
+{
+  return in->peekContiguous(data, length);
+}
+
+/**
+ * @brief Drops bytes from the input buffer.
+ *
+ * @param count Number of bytes to drop.
+ */
+void PipedStream::consume(const uint16_t count)
+{
+  in->consume(count);
+}
+
+/**
+ * @brief Borrows contiguous free space in the output buffer.
+ *
+ * @param length Number of contiguous bytes required.
+ * @return Pointer to the region, or nullptr if it is not available.
+ */
+uint8_t *PipedStream::reserve(const uint16_t length)
+{
+  return out->reserve(length);
+}
+
+/**
+ * @brief Appends bytes written through reserve() to the output buffer.
+ *
+ * @param count Number of bytes to append.
+ */
+void PipedStream::commit(const uint16_t count)
+{
+  out->commit(count);
+}
+
+/**
+ * @brief Attaches a delimiter index to the input buffer.
+ *
+ * @param index The index to attach, or nullptr to detach.
+ */
+void PipedStream::setDelimiterIndex(LoopbackDelimiterIndex *index)
+{
+  in->setDelimiterIndex(index);
+}
+
+/**
+ * @brief Reads one delimiter-terminated record from the input buffer.
+ *
+ * @param buffer The destination buffer.
+ * @param length Size of the destination buffer.
+ * @return Number of bytes copied, or -1 if no complete record is buffered.
+ */
+int PipedStream::readLine(char *buffer, size_t length)
+{
+  return in->readLine(buffer, length);
 }
 
 /**
@@ -118,3 +190,18 @@ PipedStreamPair::PipedStreamPair(const uint16_t buffer_size)
       second(buffer2, buffer1)
 {
 }
+
+/**
+ * @brief Constructor that creates a pair of connected streams over caller-provided storage.
+ *
+ * @param storage1 Storage for first→second communication.
+ * @param storage2 Storage for second→first communication.
+ * @param buffer_size Size of each storage.
+ */
+PipedStreamPair::PipedStreamPair(uint8_t *storage1, uint8_t *storage2, const uint16_t buffer_size)
+    : buffer1(storage1, buffer_size),
+      buffer2(storage2, buffer_size),
+      first(buffer1, buffer2),
+      second(buffer2, buffer1)
+{
+}
@@ -62,6 +62,83 @@ public:
    */
   virtual size_t write(const uint8_t *buffer, size_t size) override;
 
+  using Print::write;
+
+  /**
+   * @brief Reads a block of bytes from the input stream.
+   *
+   * Copies up to length buffered bytes in bulk and returns immediately. This hides
+   * the non-virtual Stream::readBytes(); see LoopbackStream::readBytes().
+   *
+   * @param buffer The destination buffer.
+   * @param length The maximum number of bytes to read.
+   * @return Number of bytes read (0 if the input buffer is empty).
+   */
+  size_t readBytes(char *buffer, size_t length);
+
+  /**
+   * @brief Reads a block of bytes from the input stream.
+   *
+   * @param buffer The destination buffer.
+   * @param length The maximum number of bytes to read.
+   * @return Number of bytes read (0 if the input buffer is empty).
+   */
+  inline size_t readBytes(uint8_t *buffer, size_t length)
+  {
+    return readBytes(reinterpret_cast<char *>(buffer), length);
+  }
+
+  /**
+   * @brief Borrows the longest contiguous run of bytes in the input buffer.
+   *
+   * @param data Set to the first buffered byte (nullptr if the buffer is empty).
+   * @param length Set to the number of contiguous bytes at data.
+   * @return true if at least one byte is available, false otherwise.
+   * @see LoopbackStream::peekContiguous()
+   */
+  bool peekContiguous(const uint8_t *&data, uint16_t &length) const;
+
+  /**
+   * @brief Releases bytes borrowed from the input buffer.
+   *
+   * @param count Number of bytes to drop.
+   */
+  void consume(const uint16_t count);
+
+  /**
+   * @brief Borrows contiguous free space in the output buffer.
+   *
+   * @param length Number of contiguous bytes required.
+   * @return Pointer to the reserved region, or nullptr if it is not available.
+   * @see LoopbackStream::reserve()
+   */
+  uint8_t *reserve(const uint16_t length);
+
+  /**
+   * @brief Publishes bytes written into a region obtained with reserve().
+   *
+   * @param count Number of bytes to append to the output buffer.
+   */
+  void commit(const uint16_t count);
+
+  /**
+   * @brief Attaches a delimiter index to the input buffer.
+   *
+   * @param index The index to attach, or nullptr to detach.
+   * @see LoopbackStream::setDelimiterIndex()
+   */
+  void setDelimiterIndex(LoopbackDelimiterIndex *index);
+
+  /**
+   * @brief Reads one delimiter-terminated record from the input buffer.
+   *
+   * @param buffer The destination buffer.
+   * @param length Size of the destination buffer, including the terminator.
+   * @return Number of bytes copied, or -1 if no complete record is buffered.
+   * @see LoopbackStream::readLine()
+   */
+  int readLine(char *buffer, size_t length);
+
   /**
    * @brief Gets the number of bytes available for writing.
    *
@@ -126,6 +203,71 @@ public:
    */
   explicit PipedStreamPair(const uint16_t buffer_size = LoopbackStream::DEFAULT_SIZE);
 
+  /**
+   * @brief Constructor over caller-provided storage.
+   *
+   * No memory is allocated; both storages must outlive the pair. A null storage is
+   * allocated, see LoopbackStream(uint8_t *, uint16_t).
+   *
+   * @param storage1 Storage for first→second communication, or nullptr.
+   * @param storage2 Storage for second→first communication, or nullptr.
+   * @param buffer_size Size of each storage in bytes.
+   */
+  PipedStreamPair(uint8_t *storage1, uint8_t *storage2, const uint16_t buffer_size);
+
+  /**
+   * @brief Discards the data buffered in both directions.
+   */
+  void clear()
+  {
+    buffer1.clear();
+    buffer2.clear();
+  }
+
   PipedStream first;  ///< First end of the pipe.
   PipedStream second; ///< Second end of the pipe.
 };
+
+/**
+ * @brief Inline storage for StaticPipedStreamPair.
+ *
+ * Kept in a separate base so that it is laid out before the PipedStreamPair base
+ * that points into it.
+ *
+ * @tparam BUFFER_SIZE Size of each direction's storage in bytes.
+ */
+template <uint16_t BUFFER_SIZE>
+struct StaticPipedStreamStorage
+{
+  uint8_t m_storage1[BUFFER_SIZE]; ///< Storage for first→second communication.
+  uint8_t m_storage2[BUFFER_SIZE]; ///< Storage for second→first communication.
+};
+
+/**
+ * @brief A PipedStreamPair whose buffers are part of the object.
+ *
+ * Nothing is allocated at runtime, so global instances do not touch the heap
+ * before setup(). It can be passed anywhere a PipedStreamPair is expected, e.g.
+ * to a PackageInterface. The capacity must be a power of two so positions wrap
+ * with a mask.
+ *
+ * @tparam BUFFER_SIZE Capacity of each direction in bytes (power of two).
+ */
+template <uint16_t BUFFER_SIZE = LoopbackStream::DEFAULT_SIZE>
+class StaticPipedStreamPair : private StaticPipedStreamStorage<BUFFER_SIZE>, public PipedStreamPair
+{
+  static_assert(BUFFER_SIZE > 0 && (BUFFER_SIZE & (BUFFER_SIZE - 1)) == 0,
+                "StaticPipedStreamPair size must be a power of two");
+
+public:
+  /**
+   * @brief Constructor that attaches both directions to the inline storage.
+   */
+  StaticPipedStreamPair()
+      : PipedStreamPair(this->m_storage1, this->m_storage2, BUFFER_SIZE)
+  {
+  }
+
+  StaticPipedStreamPair(const StaticPipedStreamPair &) = delete;
+  StaticPipedStreamPair &operator=(const StaticPipedStreamPair &) = delete;
+};
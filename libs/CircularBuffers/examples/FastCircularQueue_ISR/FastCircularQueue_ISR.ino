@@ -0,0 +1,104 @@
+/**
+ * @file FastCircularQueue_ISR.ino
+ * @brief Lock-free ISR-to-loop data hand-off with SPSCQueuePolicy
+ *
+ * A Timer1 compare interrupt produces an incrementing sequence into a
+ * FastCircularQueue configured with SPSCQueuePolicy, while loop() consumes it
+ * without ever disabling interrupts. Every second the sketch reports the number
+ * of bytes received, the resulting throughput, sequence errors (which must stay
+ * at zero) and the number of times the ISR found the queue full.
+ *
+ * Target: AVR boards with Timer1 (e.g. Arduino Uno).
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include <FastCircularQueue.h>
+
+// Single producer (ISR), single consumer (loop)
+FastCircularQueue<uint8_t, 64, SPSCQueuePolicy> queue;
+
+// Timer1 compare value: 16 MHz / 8 prescaler / (49 + 1) = 40 kHz producer rate
+const uint16_t TIMER_COMPARE = 49;
+
+volatile uint8_t producerValue = 0;
+volatile uint32_t producerDrops = 0;
+
+uint8_t expectedValue = 0;
+uint32_t receivedBytes = 0;
+uint32_t sequenceErrors = 0;
+unsigned long lastReport = 0;
+
+ISR(TIMER1_COMPA_vect)
+{
+  if (queue.push(producerValue))
+  {
+    producerValue++;
+  }
+  else
+  {
+    producerDrops++;
+  }
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(1000);
+
+  Serial.println(F("FastCircularQueue ISR Example"));
+  Serial.println(F("============================="));
+
+  noInterrupts();
+  TCCR1A = 0;
+  TCCR1B = (1 << WGM12) | (1 << CS11); // CTC mode, prescaler 8
+  OCR1A = TIMER_COMPARE;
+  TCNT1 = 0;
+  TIMSK1 = (1 << OCIE1A);
+  interrupts();
+
+  lastReport = millis();
+}
+
+void loop()
+{
+  // Drain in place; interrupts stay enabled the whole time
+  const uint8_t *data;
+  uint8_t length;
+  while ((length = queue.readSpan(data)) > 0)
+  {
+    for (uint8_t i = 0; i < length; i++)
+    {
+      if (data[i] != expectedValue)
+      {
+        sequenceErrors++;
+        expectedValue = data[i];
+      }
+      expectedValue++;
+    }
+    queue.commitRead(length);
+    receivedBytes += length;
+  }
+
+  const unsigned long now = millis();
+  if (now - lastReport >= 1000)
+  {
+    uint32_t drops;
+    noInterrupts(); // Only for reading the 32-bit statistic consistently
+    drops = producerDrops;
+    interrupts();
+
+    Serial.print(F("Received: "));
+    Serial.print(receivedBytes);
+    Serial.print(F(" bytes, "));
+    Serial.print(receivedBytes * 1000UL / (now - lastReport));
+    Serial.print(F(" bytes/sec, sequence errors: "));
+    Serial.print(sequenceErrors);
+    Serial.print(F(", producer drops: "));
+    Serial.println(drops);
+
+    receivedBytes = 0;
+    lastReport = now;
+  }
+}
@@ -0,0 +1,75 @@
+/**
+ * @file StringMatcher_Basic.ino
+ * @brief Basic example demonstrating StringMatcher usage
+ *
+ * This example feeds a simulated AT command response into a StringBuffer and a
+ * StringMatcher side by side. The matcher reports the "OK\r\n" and "ERROR:"
+ * terminators as soon as their last character arrives, without searching the
+ * buffer again.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include <StringBuffer.h>
+#include <StringMatcher.h>
+
+// Patterns live in flash
+const char OK_PATTERN[] PROGMEM = "OK\r\n";
+const char ERROR_PATTERN[] PROGMEM = "ERROR:";
+
+// Response buffer and matcher for up to 2 patterns of up to 6 characters
+StringBuffer<64> response;
+StringMatcher<2, 6> matcher;
+
+int8_t okId;
+int8_t errorId;
+
+// Simulated module output
+const char MODULE_OUTPUT[] PROGMEM = "+NAME:HC-05\r\nOK\r\nAT+PSWD?\r\nERROR:(1D)\r\n";
+
+void setup()
+{
+  Serial.begin(9600);
+  delay(1000);
+
+  Serial.println(F("StringMatcher Basic Example"));
+  Serial.println(F("==========================="));
+
+  okId = matcher.addPattern(reinterpret_cast<const __FlashStringHelper *>(OK_PATTERN));
+  errorId = matcher.addPattern(reinterpret_cast<const __FlashStringHelper *>(ERROR_PATTERN));
+
+  for (uint8_t i = 0; i < strlen_P(MODULE_OUTPUT); i++)
+  {
+    const char c = pgm_read_byte(MODULE_OUTPUT + i);
+    response.append(c);
+
+    const uint8_t completed = matcher.feed(c);
+    if (completed & (1 << okId))
+    {
+      Serial.print(F("OK detected after "));
+      Serial.print(i + 1);
+      Serial.println(F(" characters"));
+    }
+    if (completed & (1 << errorId))
+    {
+      Serial.print(F("ERROR detected after "));
+      Serial.print(i + 1);
+      Serial.println(F(" characters"));
+    }
+  }
+
+  Serial.print(F("OK seen: "));
+  Serial.println(matcher.matched(okId) ? F("Yes") : F("No"));
+  Serial.print(F("ERROR seen: "));
+  Serial.println(matcher.matched(errorId) ? F("Yes") : F("No"));
+
+  // Start over for the next command, patterns stay registered
+  response.clear();
+  matcher.reset();
+}
+
+void loop()
+{
+  // Empty loop
+}
@@ -15,6 +15,145 @@
 
 #include <Arduino.h>
 
+#if defined(__AVR__)
+#include <util/atomic.h>
+#else
+#include <atomic>
+#endif
+
+/**
+ * @brief Index synchronization policy for single-context use
+ *
+ * Indices are plain volatile variables without any ordering guarantees. This is
+ * the historical behaviour: sufficient when producer and consumer run in the
+ * same context, or when the caller disables interrupts around queue accesses.
+ */
+struct DefaultQueuePolicy
+{
+  static constexpr bool ALLOWS_OVERWRITE = true; ///< pushOverwrite() may move the tail
+
+  /**
+   * @brief Queue index storage
+   *
+   * @tparam IndexType The integer type of the index
+   */
+  template <typename IndexType>
+  class Index
+  {
+  public:
+    explicit Index(const IndexType initial = 0) : value(initial) {}
+
+    inline IndexType load() const { return value; }
+    inline IndexType loadAcquire() const { return value; }
+    inline void store(const IndexType newValue) { value = newValue; }
+    inline void storeRelease(const IndexType newValue) { value = newValue; }
+
+  private:
+    volatile IndexType value; ///< Current index value
+  };
+};
+
+/**
+ * @brief Index synchronization policy for lock-free single-producer/single-consumer use
+ *
+ * The producer publishes the head with release semantics after the element is
+ * written, and the consumer publishes the tail with release semantics after the
+ * element is read. Each side reads the other side's index with acquire semantics.
+ * On AVR this is a volatile access fenced by compiler barriers (the core does not
+ * reorder memory operations); indices wider than one byte are additionally read and
+ * written inside a few-cycle atomic block so the other side never sees a torn value.
+ * On other targets it maps to std::atomic acquire/release.
+ *
+ * Exactly one context may push and exactly one context may pop, e.g. an ISR and
+ * the main loop. pushOverwrite() is not available since it would let the producer
+ * modify the tail, and clear() must only be called while both sides are idle.
+ */
+struct SPSCQueuePolicy
+{
+  static constexpr bool ALLOWS_OVERWRITE = false; ///< The tail belongs to the consumer only
+
+  /**
+   * @brief Queue index storage
+   *
+   * @tparam IndexType The integer type of the index
+   */
+  template <typename IndexType>
+  class Index
+  {
+  public:
+    explicit Index(const IndexType initial = 0) : value(initial) {}
+
+#if defined(__AVR__)
+    inline IndexType load() const { return value; }
+    inline IndexType loadAcquire() const
+    {
+      IndexType current;
+      if (sizeof(IndexType) == 1)
+      {
+        current = value;
+      }
+      else
+      {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { current = value; }
+      }
+      asm volatile("" ::: "memory"); // Later buffer accesses must not move above this load
+      return current;
+    }
+    inline void store(const IndexType newValue) { value = newValue; }
+    inline void storeRelease(const IndexType newValue)
+    {
+      asm volatile("" ::: "memory"); // Earlier buffer accesses must complete before publishing
+      if (sizeof(IndexType) == 1)
+      {
+        value = newValue;
+      }
+      else
+      {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { value = newValue; }
+      }
+    }
+
+  private:
+    volatile IndexType value; ///< Current index value
+#else
+    inline IndexType load() const { return value.load(std::memory_order_relaxed); }
+    inline IndexType loadAcquire() const { return value.load(std::memory_order_acquire); }
+    inline void store(const IndexType newValue) { value.store(newValue, std::memory_order_relaxed); }
+    inline void storeRelease(const IndexType newValue) { value.store(newValue, std::memory_order_release); }
+
+  private:
+    std::atomic<IndexType> value; ///< Current index value
+#endif
+  };
+};
+
+/**
+ * @brief Selects the smallest index type that can address a buffer
+ *
+ * Buffers of up to 256 elements keep the single-byte uint8_t indices, larger
+ * buffers use uint16_t (and uint32_t on targets where size_t allows it).
+ *
+ * @tparam BUFFER_SIZE The size of the buffer
+ */
+template <size_t BUFFER_SIZE, bool FITS_IN_BYTE = (BUFFER_SIZE <= 0x100UL),
+          bool FITS_IN_WORD = (BUFFER_SIZE <= 0x10000UL)>
+struct FastCircularQueueIndex
+{
+  typedef uint32_t Type; ///< Index type for very large host-side buffers
+};
+
+template <size_t BUFFER_SIZE, bool FITS_IN_WORD>
+struct FastCircularQueueIndex<BUFFER_SIZE, true, FITS_IN_WORD>
+{
+  typedef uint8_t Type; ///< Index type for buffers of up to 256 elements
+};
+
+template <size_t BUFFER_SIZE>
+struct FastCircularQueueIndex<BUFFER_SIZE, false, true>
+{
+  typedef uint16_t Type; ///< Index type for buffers of up to 65536 elements
+};
+
 /**
  * @brief High-performance circular queue implementation with fixed size
  *
@@ -24,12 +163,17 @@
  *
  * @tparam T The type of elements stored in the queue
  * @tparam BUFFER_SIZE The size of the buffer (must be a power of 2)
+ * @tparam Policy Index synchronization policy (DefaultQueuePolicy or SPSCQueuePolicy)
+ * @tparam IndexType Index and count type, chosen from BUFFER_SIZE by default
  */
-template <typename T, uint8_t BUFFER_SIZE>
+template <typename T, size_t BUFFER_SIZE, typename Policy = DefaultQueuePolicy,
+          typename IndexType = typename FastCircularQueueIndex<BUFFER_SIZE>::Type>
 class FastCircularQueue
 {
+  static_assert(BUFFER_SIZE >= 2, "BUFFER_SIZE must be at least 2!");
   static_assert((BUFFER_SIZE & (BUFFER_SIZE - 1)) == 0, "BUFFER_SIZE must be a power of 2!");
-  static_assert(BUFFER_SIZE <= 256, "BUFFER_SIZE must be <= 256 due to uint8_t index type!");
+  static_assert(BUFFER_SIZE - 1 <= static_cast<IndexType>(~static_cast<IndexType>(0)),
+                "IndexType is too small for BUFFER_SIZE!");
 
 public:
   /**
@@ -38,10 +182,7 @@ public:
   FastCircularQueue()
       : head(0), tail(0)
   {
-    for (uint8_t i = 0; i < BUFFER_SIZE; ++i)
-    {
-      buffer[i] = T();
-    }
+    // Slots are written before they are read, so no per-slot initialization is needed
   }
 
   /**
@@ -52,12 +193,12 @@ public:
    */
   inline bool push(const T &value)
   {
-    const uint8_t currentHead = head; // Take a snapshot of head
-    const uint8_t next = (currentHead + 1) & (BUFFER_SIZE - 1);
-    if (next == tail)
+    const IndexType currentHead = head.load(); // Take a snapshot of head
+    const IndexType next = (currentHead + 1) & (BUFFER_SIZE - 1);
+    if (next == tail.loadAcquire())
       return false;
     buffer[currentHead] = value;
-    head = next; // Memory barrier might be needed here for thread safety
+    head.storeRelease(next); // Publish only after the element is written
     return true;
   }
 
@@ -68,15 +209,16 @@ public:
    */
   inline void pushOverwrite(const T &value)
   {
-    const uint8_t currentHead = head;
-    const uint8_t next = (currentHead + 1) & (BUFFER_SIZE - 1);
-    if (next == tail)
+    static_assert(Policy::ALLOWS_OVERWRITE, "pushOverwrite is not available with this queue policy!");
+    const IndexType currentHead = head.load();
+    const IndexType next = (currentHead + 1) & (BUFFER_SIZE - 1);
+    if (next == tail.load())
     {
       // Overwrite mode: move tail to discard oldest data
-      tail = (tail + 1) & (BUFFER_SIZE - 1);
+      tail.store((tail.load() + 1) & (BUFFER_SIZE - 1));
     }
     buffer[currentHead] = value;
-    head = next; // Memory barrier might be needed here for thread safety
+    head.storeRelease(next);
   }
 
   /**
@@ -87,10 +229,11 @@ public:
    */
   inline bool pop(T &value)
   {
-    if (head == tail)
+    const IndexType currentTail = tail.load();
+    if (head.loadAcquire() == currentTail)
       return false;
-    value = buffer[tail];
-    tail = (tail + 1) & (BUFFER_SIZE - 1);
+    value = buffer[currentTail];
+    tail.storeRelease((currentTail + 1) & (BUFFER_SIZE - 1)); // Release the slot after reading
     return true;
   }
 
@@ -102,12 +245,131 @@ public:
    */
   inline bool peek(T &value) const
   {
-    if (head == tail)
+    const IndexType currentTail = tail.load();
+    if (head.loadAcquire() == currentTail)
       return false;
-    value = buffer[tail];
+    value = buffer[currentTail];
     return true;
   }
 
+  /**
+   * @brief Pushes multiple values to the queue
+   *
+   * Copies as many values as fit into the free space using at most two
+   * contiguous memcpy segments. T must be trivially copyable. count may
+   * exceed the queue size; the copy stops when the queue is full.
+   *
+   * @param values Pointer to the values to push
+   * @param count Number of values to push
+   * @return The number of values actually pushed
+   */
+  inline size_t pushN(const T *values, size_t count)
+  {
+    static_assert(__is_trivially_copyable(T), "pushN requires a trivially copyable T!");
+    size_t pushed = 0;
+    while (pushed < count)
+    {
+      T *span;
+      size_t length = writeSpan(span);
+      if (length == 0)
+        break;
+      if (length > count - pushed)
+        length = count - pushed;
+      memcpy(span, values + pushed, length * sizeof(T));
+      commitWrite(static_cast<IndexType>(length));
+      pushed += length;
+    }
+    return pushed;
+  }
+
+  /**
+   * @brief Pops multiple values from the queue
+   *
+   * Copies as many values as are available using at most two contiguous
+   * memcpy segments. T must be trivially copyable. count may exceed the
+   * queue size; the copy stops when the queue is empty.
+   *
+   * @param values Pointer to the destination buffer
+   * @param count Maximum number of values to pop
+   * @return The number of values actually popped
+   */
+  inline size_t popN(T *values, size_t count)
+  {
+    static_assert(__is_trivially_copyable(T), "popN requires a trivially copyable T!");
+    size_t popped = 0;
+    while (popped < count)
+    {
+      const T *span;
+      size_t length = readSpan(span);
+      if (length == 0)
+        break;
+      if (length > count - popped)
+        length = count - popped;
+      memcpy(values + popped, span, length * sizeof(T));
+      commitRead(static_cast<IndexType>(length));
+      popped += length;
+    }
+    return popped;
+  }
+
+  /**
+   * @brief Exposes the contiguous readable region starting at the tail
+   *
+   * The region ends at the head or at the end of the storage, whichever comes
+   * first; a second call after commitRead() returns the wrapped remainder.
+   *
+   * @param data Reference to store the pointer to the first readable element
+   * @return The number of contiguous elements that can be read in place
+   */
+  inline IndexType readSpan(const T *&data) const
+  {
+    const IndexType currentTail = tail.load();
+    const IndexType currentHead = head.loadAcquire();
+    data = &buffer[currentTail];
+    if (currentHead >= currentTail)
+      return currentHead - currentTail;
+    return BUFFER_SIZE - currentTail;
+  }
+
+  /**
+   * @brief Releases elements consumed in place through readSpan()
+   *
+   * @param count Number of elements to release (must not exceed the span length)
+   */
+  inline void commitRead(IndexType count)
+  {
+    tail.storeRelease((tail.load() + count) & (BUFFER_SIZE - 1));
+  }
+
+  /**
+   * @brief Exposes the contiguous writable region starting at the head
+   *
+   * One slot is always kept free to distinguish a full queue from an empty one,
+   * so the region never reaches the slot just before the tail.
+   *
+   * @param data Reference to store the pointer to the first writable element
+   * @return The number of contiguous elements that can be written in place
+   */
+  inline IndexType writeSpan(T *&data)
+  {
+    const IndexType currentHead = head.load();
+    const IndexType currentTail = tail.loadAcquire();
+    data = &buffer[currentHead];
+    if (currentHead < currentTail)
+      return currentTail - currentHead - 1;
+    return BUFFER_SIZE - currentHead - (currentTail == 0 ? 1 : 0);
+  }
+
+  /**
+   * @brief Publishes elements written in place through writeSpan()
+   *
+   * @param count Number of elements to publish (must not exceed the span length)
+   */
+  inline void commitWrite(IndexType count)
+  {
+    head.storeRelease((head.load() + count) & (BUFFER_SIZE - 1));
+  }
+
   /**
    * @brief Checks if the queue is empty
    *
@@ -115,7 +377,7 @@ public:
    */
   inline bool isEmpty() const
   {
-    return head == tail;
+    return head.loadAcquire() == tail.loadAcquire();
   }
 
   /**
@@ -125,7 +387,7 @@ public:
    */
   inline bool isFull() const
   {
-    return ((head + 1) & (BUFFER_SIZE - 1)) == tail;
+    return ((head.loadAcquire() + 1) & (BUFFER_SIZE - 1)) == tail.loadAcquire();
   }
 
   /**
@@ -133,17 +395,20 @@ public:
    *
    * @return The number of elements in the queue
    */
-  inline uint8_t available() const
+  inline IndexType available() const
   {
-    return (head - tail) & (BUFFER_SIZE - 1);
+    return (head.loadAcquire() - tail.loadAcquire()) & (BUFFER_SIZE - 1);
   }
 
   /**
    * @brief Clears the queue
+   *
+   * With SPSCQueuePolicy this must only be called while neither side is active.
    */
   inline void clear()
   {
-    head = tail = 0;
+    head.store(0);
+    tail.store(0);
   }
 
 protected:
@@ -152,9 +417,9 @@ protected:
    *
    * @return The current tail index
    */
-  inline uint8_t getTail() const
+  inline IndexType getTail() const
   {
-    return tail;
+    return tail.load();
   } // Allow derived classes to access tail safely
 
   /**
@@ -164,18 +429,19 @@ protected:
    * @param value Reference to store the peeked value
    * @return true if a value was successfully peeked, false if the index is out of bounds
    */
-  inline bool peekAt(uint8_t index, T &value) const
+  inline bool peekAt(IndexType index, T &value) const
   { // Provide safe indexed access
     if (index >= available())
       return false;
-    uint8_t pos = (tail + index) & (BUFFER_SIZE - 1);
+    IndexType pos = (tail.load() + index) & (BUFFER_SIZE - 1);
     value = buffer[pos];
     return true;
   }
 
 private:
-  T buffer[BUFFER_SIZE];       ///< The circular buffer
-  volatile uint8_t head, tail; ///< Head and tail indices
+  T buffer[BUFFER_SIZE];                          ///< The circular buffer
+  typename Policy::template Index<IndexType> head; ///< Write index, owned by the producer
+  typename Policy::template Index<IndexType> tail; ///< Read index, owned by the consumer
 };
 
 #endif
@@ -0,0 +1,106 @@
+/**
+ * @file StringMatcher.h
+ * @brief Incremental multi-pattern matcher for character streams.
+ *
+ * This file defines the StringMatcher class, which detects a fixed set of
+ * PROGMEM patterns in a character stream one character at a time. It is meant to
+ * be fed alongside a StringBuffer so that response terminators can be detected
+ * without rescanning the buffer on every received byte.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#ifndef STRINGMATCHER_H
+#define STRINGMATCHER_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Incremental multi-pattern matcher based on per-pattern KMP automata
+ *
+ * Patterns are kept in flash; only a KMP failure table and the current match
+ * progress of each pattern live in RAM. Each fed character advances every
+ * pattern in amortized constant time, independent of how many characters have
+ * been fed before, so detection cost does not grow with the buffer length.
+ *
+ * @tparam MAX_PATTERNS Maximum number of patterns (1-8)
+ * @tparam MAX_PATTERN_LENGTH Maximum length of a single pattern
+ */
+template <uint8_t MAX_PATTERNS, uint8_t MAX_PATTERN_LENGTH>
+class StringMatcher
+{
+  static_assert(MAX_PATTERNS > 0 && MAX_PATTERNS <= 8, "MAX_PATTERNS must be between 1 and 8!");
+  static_assert(MAX_PATTERN_LENGTH > 0, "MAX_PATTERN_LENGTH must be greater than 0!");
+
+public:
+  /**
+   * @brief Constructs a matcher without patterns
+   */
+  StringMatcher();
+
+  /**
+   * @brief Registers a flash string pattern
+   *
+   * @param pattern The pattern to detect (stored in PROGMEM)
+   * @return The pattern id, or -1 if the pattern is empty, too long or no slot is left
+   */
+  int8_t addPattern(const __FlashStringHelper *pattern);
+
+  /**
+   * @brief Feeds the next character of the stream
+   *
+   * @param c The character to process
+   * @return Bit mask of the pattern ids completed by this character (0 if none)
+   */
+  uint8_t feed(const char c);
+
+  /**
+   * @brief Checks if a pattern has been seen since the last reset
+   *
+   * @param id The pattern id returned by addPattern()
+   * @return true if the pattern occurred at least once
+   */
+  bool matched(const uint8_t id) const;
+
+  /**
+   * @brief Checks if the last fed character completed a pattern
+   *
+   * Equivalent to StringBuffer::endsWith() for the fed stream.
+   *
+   * @param id The pattern id returned by addPattern()
+   * @return true if the stream currently ends with the pattern
+   */
+  bool endsWith(const uint8_t id) const;
+
+  /**
+   * @brief Gets the bit mask of all patterns seen since the last reset
+   *
+   * @return Bit mask of matched pattern ids
+   */
+  uint8_t matchedMask() const;
+
+  /**
+   * @brief Gets the number of registered patterns
+   *
+   * @return The number of patterns
+   */
+  uint8_t patternCount() const;
+
+  /**
+   * @brief Clears match progress and match flags, keeping the patterns
+   */
+  void reset();
+
+private:
+  PGM_P m_patterns[MAX_PATTERNS];                      ///< Pattern strings in PROGMEM
+  uint8_t m_lengths[MAX_PATTERNS];                     ///< Pattern lengths
+  uint8_t m_progress[MAX_PATTERNS];                    ///< Matched prefix length per pattern
+  uint8_t m_failure[MAX_PATTERNS][MAX_PATTERN_LENGTH]; ///< KMP failure tables
+  uint8_t m_patternCount;                              ///< Number of registered patterns
+  uint8_t m_matchedMask;                               ///< Patterns seen since reset
+  uint8_t m_lastMask;                                  ///< Patterns completed by the last character
+};
+
+#include "StringMatcher.hpp" // Include template implementation
+#endif                       // STRINGMATCHER_H
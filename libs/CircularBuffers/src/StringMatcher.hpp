@@ -0,0 +1,132 @@
+/**
+ * @file StringMatcher.hpp
+ * @brief Implementation of the StringMatcher class.
+ *
+ * This file contains the implementation of the StringMatcher class methods for
+ * incremental multi-pattern detection over PROGMEM patterns.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#ifndef STRINGMATCHER_HPP
+#define STRINGMATCHER_HPP
+
+// Constructor
+template <uint8_t MAX_PATTERNS, uint8_t MAX_PATTERN_LENGTH>
+StringMatcher<MAX_PATTERNS, MAX_PATTERN_LENGTH>::StringMatcher()
+    : m_patternCount(0), m_matchedMask(0), m_lastMask(0)
+{
+}
+
+// Register a pattern and build its failure table
+template <uint8_t MAX_PATTERNS, uint8_t MAX_PATTERN_LENGTH>
+int8_t StringMatcher<MAX_PATTERNS, MAX_PATTERN_LENGTH>::addPattern(const __FlashStringHelper *pattern)
+{
+  if (!pattern || m_patternCount >= MAX_PATTERNS)
+    return -1;
+
+  PGM_P p = reinterpret_cast<PGM_P>(pattern);
+  const size_t len = strnlen_P(p, MAX_PATTERN_LENGTH + 1);
+  if (len == 0 || len > MAX_PATTERN_LENGTH)
+    return -1;
+
+  const uint8_t id = m_patternCount;
+  uint8_t *const failure = m_failure[id];
+
+  // failure[i] is the length of the longest proper border of pattern[0..i]
+  failure[0] = 0;
+  uint8_t border = 0;
+  for (uint8_t i = 1; i < len; i++)
+  {
+    const char c = pgm_read_byte(p + i);
+    while (border > 0 && c != static_cast<char>(pgm_read_byte(p + border)))
+    {
+      border = failure[border - 1];
+    }
+    if (c == static_cast<char>(pgm_read_byte(p + border)))
+    {
+      border++;
+    }
+    failure[i] = border;
+  }
+
+  m_patterns[id] = p;
+  m_lengths[id] = len;
+  m_progress[id] = 0;
+  m_patternCount++;
+  return id;
+}
+
+// Advance every pattern by one character
+template <uint8_t MAX_PATTERNS, uint8_t MAX_PATTERN_LENGTH>
+uint8_t StringMatcher<MAX_PATTERNS, MAX_PATTERN_LENGTH>::feed(const char c)
+{
+  uint8_t completed = 0;
+  for (uint8_t id = 0; id < m_patternCount; id++)
+  {
+    PGM_P p = m_patterns[id];
+    uint8_t progress = m_progress[id];
+
+    while (progress > 0 && c != static_cast<char>(pgm_read_byte(p + progress)))
+    {
+      progress = m_failure[id][progress - 1];
+    }
+    if (c == static_cast<char>(pgm_read_byte(p + progress)))
+    {
+      progress++;
+    }
+    if (progress == m_lengths[id])
+    {
+      completed |= (1 << id);
+      progress = m_failure[id][progress - 1]; // Allow overlapping occurrences
+    }
+    m_progress[id] = progress;
+  }
+
+  m_lastMask = completed;
+  m_matchedMask |= completed;
+  return completed;
+}
+
+// Check if a pattern occurred since the last reset
+template <uint8_t MAX_PATTERNS, uint8_t MAX_PATTERN_LENGTH>
+bool StringMatcher<MAX_PATTERNS, MAX_PATTERN_LENGTH>::matched(const uint8_t id) const
+{
+  return id < m_patternCount && (m_matchedMask & (1 << id));
+}
+
+// Check if the last character completed a pattern
+template <uint8_t MAX_PATTERNS, uint8_t MAX_PATTERN_LENGTH>
+bool StringMatcher<MAX_PATTERNS, MAX_PATTERN_LENGTH>::endsWith(const uint8_t id) const
+{
+  return id < m_patternCount && (m_lastMask & (1 << id));
+}
+
+// Get all patterns seen since the last reset
+template <uint8_t MAX_PATTERNS, uint8_t MAX_PATTERN_LENGTH>
+uint8_t StringMatcher<MAX_PATTERNS, MAX_PATTERN_LENGTH>::matchedMask() const
+{
+  return m_matchedMask;
+}
+
+// Get the number of registered patterns
+template <uint8_t MAX_PATTERNS, uint8_t MAX_PATTERN_LENGTH>
+uint8_t StringMatcher<MAX_PATTERNS, MAX_PATTERN_LENGTH>::patternCount() const
+{
+  return m_patternCount;
+}
+
+// Reset match state
+template <uint8_t MAX_PATTERNS, uint8_t MAX_PATTERN_LENGTH>
+void StringMatcher<MAX_PATTERNS, MAX_PATTERN_LENGTH>::reset()
+{
+  for (uint8_t id = 0; id < m_patternCount; id++)
+  {
+    m_progress[id] = 0;
+  }
+  m_matchedMask = 0;
+  m_lastMask = 0;
+}
+
+#endif // STRINGMATCHER_HPP
@@ -0,0 +1,18 @@
+/**
+ * @file Arduino.h
+ * @brief Minimal Arduino core for building the queues on a host.
+ *
+ * FastCircularQueue only needs the standard integer types and memcpy.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#endif
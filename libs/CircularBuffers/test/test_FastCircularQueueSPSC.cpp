@@ -0,0 +1,167 @@
+/**
+ * @file test_FastCircularQueueSPSC.cpp
+ * @brief FastCircularQueue with SPSCQueuePolicy between two threads.
+ *
+ * A producer thread pushes a counting sequence while a consumer thread
+ * pops it; any lost, repeated or reordered element breaks the sequence.
+ * Each queue size selects a different index type, and the bulk calls
+ * are run as well as the single-element ones. A side that finds the
+ * queue full or empty yields, so the test also finishes on one core.
+ * Bulk calls longer than a uint8_t index are checked on one thread.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include <FastCircularQueue.h>
+
+#include <stdio.h>
+#include <thread>
+
+static const uint32_t ITEMS = 1000000;
+
+static int failures = 0;
+
+static void report(const char *name, const uint32_t received, const uint32_t errors)
+{
+  if (received != ITEMS || errors != 0)
+  {
+    printf("%s: %u of %u items received, %u out of sequence\n", name,
+           (unsigned)received, (unsigned)ITEMS, (unsigned)errors);
+    failures++;
+  }
+}
+
+template <size_t SIZE>
+static void testSingle(const char *name)
+{
+  static FastCircularQueue<uint32_t, SIZE, SPSCQueuePolicy> queue;
+  queue.clear();
+
+  std::thread producer([] {
+    for (uint32_t i = 0; i < ITEMS;)
+    {
+      if (queue.push(i))
+      {
+        i++;
+      }
+      else
+      {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  uint32_t received = 0;
+  uint32_t errors = 0;
+  while (received < ITEMS)
+  {
+    uint32_t value;
+    if (queue.pop(value))
+    {
+      errors += value != received;
+      received++;
+    }
+    else
+    {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+
+  errors += !queue.isEmpty();
+  report(name, received, errors);
+}
+
+template <size_t SIZE>
+static void testBulk(const char *name)
+{
+  static FastCircularQueue<uint32_t, SIZE, SPSCQueuePolicy> queue;
+  queue.clear();
+
+  // Odd chunk lengths make the copies straddle the end of the storage
+  std::thread producer([] {
+    uint32_t chunk[13];
+    uint32_t next = 0;
+    while (next < ITEMS)
+    {
+      const size_t length = ITEMS - next < 13 ? ITEMS - next : 13;
+      for (size_t i = 0; i < length; i++)
+      {
+        chunk[i] = next + i;
+      }
+      size_t pushed = 0;
+      while (pushed < length)
+      {
+        const size_t count = queue.pushN(chunk + pushed, length - pushed);
+        if (count == 0)
+        {
+          std::this_thread::yield();
+        }
+        pushed += count;
+      }
+      next += length;
+    }
+  });
+
+  uint32_t received = 0;
+  uint32_t errors = 0;
+  uint32_t chunk[7];
+  while (received < ITEMS)
+  {
+    const size_t count = queue.popN(chunk, 7);
+    if (count == 0)
+    {
+      std::this_thread::yield();
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+      errors += chunk[i] != received;
+      received++;
+    }
+  }
+  producer.join();
+
+  errors += !queue.isEmpty();
+  report(name, received, errors);
+}
+
+// A count beyond the index type stops at full or empty instead of wrapping
+static void testLongBulk()
+{
+  static FastCircularQueue<uint32_t, 256, SPSCQueuePolicy> queue;
+  static uint32_t values[300];
+  for (uint32_t i = 0; i < 300; i++)
+  {
+    values[i] = i;
+  }
+
+  const size_t pushed = queue.pushN(values, 300);
+  memset(values, 0, sizeof(values));
+  const size_t popped = queue.popN(values, 300);
+  uint32_t errors = 0;
+  for (uint32_t i = 0; i < popped; i++)
+  {
+    errors += values[i] != i;
+  }
+  if (pushed != 255 || popped != 255 || errors != 0)
+  {
+    printf("pushN/popN of 300 into 256 slots: %u pushed, %u popped, %u out of sequence\n",
+           (unsigned)pushed, (unsigned)popped, (unsigned)errors);
+    failures++;
+  }
+}
+
+int main()
+{
+  testSingle<2>("push/pop, 2 slots");
+  testSingle<64>("push/pop, 64 slots");
+  testSingle<1024>("push/pop, 1024 slots");
+  testBulk<16>("pushN/popN, 16 slots");
+  testBulk<256>("pushN/popN, 256 slots");
+  testBulk<4096>("pushN/popN, 4096 slots");
+  testLongBulk();
+
+  printf("test_FastCircularQueueSPSC: %s\n", failures ? "FAILED" : "passed");
+  return failures ? 1 : 0;
+}
@@ -27,6 +27,7 @@ const char HC05::DISC_STR[] PROGMEM = "Disconnected";
 const char HC05::CMD_STR[] PROGMEM = "Command: ";
 const char HC05::ERROR_STR[] PROGMEM = "ERROR:";
 const char HC05::FAIL_STR[] PROGMEM = "FAIL";
+const char HC05::NEWLINE_STR[] PROGMEM = "\n";
 
 // Define a PROGMEM variable for the OK response string
 const char HC05::OK_RESPONSE[] PROGMEM = "OK\r\n";
@@ -52,6 +53,11 @@ HC05::HC05(Stream &stream,
       m_stateManager(INITIALIZING),
       m_dataReceivedCallback(nullptr)
 {
+  // Registration order must match the ResponsePattern ids
+  m_responseMatcher.addPattern(PGMT(OK_RESPONSE));
+  m_responseMatcher.addPattern(PGMT(ERROR_STR));
+  m_responseMatcher.addPattern(PGMT(FAIL_STR));
+  m_responseMatcher.addPattern(PGMT(NEWLINE_STR));
 }
 
 /**
@@ -181,6 +187,7 @@ void HC05::appendStreamData()
   {
     char c = p_stream->read();
     m_responseBuffer.append(c);
+    m_responseMatcher.feed(c);
   }
 }
 
@@ -194,6 +201,7 @@ void HC05::clearResponseBuffer()
     p_stream->read();
   }
   m_responseBuffer.clear();
+  m_responseMatcher.reset();
 }
 
 /**
@@ -206,12 +214,12 @@ bool HC05::processResponseBufferForCommand()
   bool success = false;
   bool errorDetected = false;
 
-  if (m_responseBuffer.endsWith(PGMT(OK_RESPONSE)))
+  if (m_responseMatcher.matched(PATTERN_OK))
   {
     success = true;
   }
-  else if (m_responseBuffer.indexOf(PGMT(ERROR_STR)) != -1 ||
-           m_responseBuffer.indexOf(PGMT(FAIL_STR)) != -1)
+  else if (m_responseMatcher.matched(PATTERN_ERROR) ||
+           m_responseMatcher.matched(PATTERN_FAIL))
   {
     errorDetected = true;
   }
@@ -319,7 +327,7 @@ void HC05::handleCheckingATMode()
 void HC05::handleWaitingForATResponse()
 {
   appendStreamData();
-  if (m_responseBuffer.endsWith(PGMT(OK_RESPONSE)))
+  if (m_responseMatcher.matched(PATTERN_OK))
   {
     m_commandDelayTimer.setInterval(DEFAULT_COMMAND_DELAY_MS);
     m_stateManager.setState(WAITING_FOR_COMMAND_DELAY);
@@ -377,7 +385,7 @@ void HC05::handleWaitingForDataMode()
 void HC05::handleWaitingForResponse()
 {
   appendStreamData();
-  if (m_responseBuffer.indexOf('\n') != -1)
+  if (m_responseMatcher.matched(PATTERN_NEWLINE))
   {
     if (processResponseBufferForCommand())
       return;
@@ -14,6 +14,7 @@
 #define HC05_H
 
 #include <StringBuffer.h>
+#include <StringMatcher.h>
 #include <ArduinoQueue.h>
 #include <Stream.h>
 #include <SimpleTimer.h>
@@ -185,6 +186,7 @@ private:
   static const char CMD_STR[] PROGMEM;              ///< Command message
   static const char ERROR_STR[] PROGMEM;            ///< Error message
   static const char FAIL_STR[] PROGMEM;             ///< Fail message
+  static const char NEWLINE_STR[] PROGMEM;          ///< Line terminator pattern
 
   // Add timing constants
   /// Reset delay in milliseconds
@@ -204,6 +206,21 @@ private:
   // Add buffer size constants
   /// Response buffer size
   static constexpr uint8_t RESPONSE_BUFFER_SIZE = 64;
+  /// Number of response patterns tracked by the matcher
+  static constexpr uint8_t RESPONSE_PATTERN_COUNT = 4;
+  /// Longest response pattern ("ERROR:")
+  static constexpr uint8_t RESPONSE_PATTERN_LENGTH = 6;
+
+  /**
+   * @brief Response pattern ids, in registration order
+   */
+  enum ResponsePattern : uint8_t
+  {
+    PATTERN_OK = 0, ///< "OK\r\n"
+    PATTERN_ERROR,  ///< "ERROR:"
+    PATTERN_FAIL,   ///< "FAIL"
+    PATTERN_NEWLINE ///< "\n"
+  };
 
   /**
    * @brief Status flags struct
@@ -311,6 +328,7 @@ private:
 
   ArduinoQueue<const Command *> m_commandQueue;        ///< Queue of commands to send
   StringBuffer<RESPONSE_BUFFER_SIZE> m_responseBuffer; ///< Buffer for responses
+  StringMatcher<RESPONSE_PATTERN_COUNT, RESPONSE_PATTERN_LENGTH> m_responseMatcher; ///< Incremental response pattern detection
   Status m_status;                                     ///< Current status flags
   Utilities::StateManager<State> m_stateManager{INITIALIZING};    ///< State manager
   DataCallback m_dataReceivedCallback;                 ///< Callback for received data
@@ -0,0 +1,130 @@
+/**
+ * @file AsyncHMC5883L.ino
+ * @brief Reads an HMC5883L magnetometer without blocking the scheduler
+ *
+ * The sensor task submits a 6-byte register read every 100 ms and gets the
+ * result as an FsmOS message. While the TWI interrupt moves the bytes, the
+ * counter task keeps running; its count per second shows how much CPU time
+ * is left. Compare with the HMC5883L example, which waits for every byte.
+ *
+ * Hardware Connections:
+ * - HMC5883L SDA → Arduino A4
+ * - HMC5883L SCL → Arduino A5
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include <FsmOS.h>
+#include <I2CEngine.h>
+
+#define HMC5883L 0x1E
+
+I2CEngine i2cEngine;
+
+class MagnetometerTask : public Task
+{
+public:
+  enum Message : uint8_t
+  {
+    MSG_CONFIGURED = 1,
+    MSG_SAMPLE = 2
+  };
+
+  MagnetometerTask() : Task(F("Magnetometer"))
+  {
+    setPeriod(100);
+  }
+
+  void on_start() override
+  {
+    // Continuous measurement mode
+    m_config.setWrite(HMC5883L, 0x02, &CONTINUOUS_MODE, 1);
+    m_config.notify(getId(), MSG_CONFIGURED);
+    i2cEngine.submit(m_config);
+  }
+
+  void step() override
+  {
+    // Skipped while the previous read is still pending
+    m_read.setRead(HMC5883L, 0x03, m_sample, sizeof(m_sample));
+    m_read.notify(getId(), MSG_SAMPLE);
+    i2cEngine.submit(m_read);
+  }
+
+  void on_msg(const MsgData &msg) override
+  {
+    if (msg.arg != I2CTransaction::OK)
+    {
+      Serial.print(F("I2C error 0x"));
+      Serial.println(msg.arg, HEX);
+      return;
+    }
+    if (msg.type == MSG_SAMPLE)
+    {
+      // The registers are X, Z, Y, most significant byte first
+      Serial.print(F("x="));
+      Serial.print((int16_t)(m_sample[0] << 8 | m_sample[1]));
+      Serial.print(F(" y="));
+      Serial.print((int16_t)(m_sample[4] << 8 | m_sample[5]));
+      Serial.print(F(" z="));
+      Serial.println((int16_t)(m_sample[2] << 8 | m_sample[3]));
+    }
+  }
+
+private:
+  static const uint8_t CONTINUOUS_MODE;
+
+  I2CTransaction m_config;
+  I2CTransaction m_read;
+  uint8_t m_sample[6];
+};
+
+const uint8_t MagnetometerTask::CONTINUOUS_MODE = 0x00;
+
+class CounterTask : public Task
+{
+public:
+  CounterTask() : Task(F("Counter")), m_count(0), m_lastReport(0)
+  {
+    setPeriod(1);
+  }
+
+  void step() override
+  {
+    m_count++;
+    if (millis() - m_lastReport >= 1000)
+    {
+      m_lastReport = millis();
+      Serial.print(F("counter steps/s: "));
+      Serial.println(m_count);
+      m_count = 0;
+    }
+  }
+
+private:
+  uint32_t m_count;
+  uint32_t m_lastReport;
+};
+
+MagnetometerTask magnetometer;
+CounterTask counter;
+
+void setup()
+{
+  Serial.begin(115200);
+
+  OS.begin();
+  OS.add(&i2cEngine);
+  OS.add(&magnetometer);
+  OS.add(&counter);
+  i2cEngine.setPeriod(2); // Completions are delivered at this period
+  i2cEngine.start();
+  magnetometer.start();
+  counter.start();
+}
+
+void loop()
+{
+  OS.loopOnce();
+}
@@ -0,0 +1,157 @@
+/**
+ * @file BusScheduling.ino
+ * @brief Several tasks sharing one I2C bus through the engine
+ *
+ * Three tasks read the accelerometer, temperature and gyroscope registers
+ * of an MPU-6050, which sit next to each other, and a fourth reads an
+ * HMC5883L magnetometer. Each task submits its own read; the engine runs
+ * the higher priority ones first, merges the MPU-6050 reads that are
+ * queued together into one burst, and chains transactions with repeated
+ * starts. Every two seconds the sketch prints the bus utilization and
+ * the per-device counters.
+ *
+ * Hardware Connections:
+ * - MPU-6050 and HMC5883L SDA → Arduino A4
+ * - MPU-6050 and HMC5883L SCL → Arduino A5
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include <FsmOS.h>
+#include <I2CEngine.h>
+
+#define MPU6050 0x68
+#define HMC5883L 0x1E
+
+I2CEngine i2cEngine;
+
+// Auto-incrementing registers, no STOP needed between transactions
+I2CDevice mpu6050(MPU6050, I2CDevice::BURST | I2CDevice::RESTART);
+I2CDevice hmc5883l(HMC5883L, I2CDevice::BURST | I2CDevice::RESTART);
+
+class RegisterReader : public Task
+{
+public:
+  RegisterReader(const __FlashStringHelper *name, uint8_t address, uint8_t firstRegister,
+                 uint8_t length, uint16_t period)
+      : Task(name), m_address(address), m_register(firstRegister), m_length(length), m_errors(0)
+  {
+    setPeriod(period);
+  }
+
+  void step() override
+  {
+    // Skipped while the previous read is still pending
+    m_read.setRead(m_address, m_register, m_data, m_length);
+    m_read.priority = getPriority();
+    m_read.notify(getId(), 0);
+    i2cEngine.submit(m_read);
+  }
+
+  void on_msg(const MsgData &msg) override
+  {
+    if (msg.arg != I2CTransaction::OK)
+    {
+      m_errors++;
+    }
+  }
+
+  int16_t getWord(uint8_t index) const { return (int16_t)(m_data[2 * index] << 8 | m_data[2 * index + 1]); }
+
+private:
+  I2CTransaction m_read;
+  uint8_t m_address;
+  uint8_t m_register;
+  uint8_t m_length;
+  uint8_t m_data[6];
+  uint16_t m_errors;
+};
+
+RegisterReader accelerometer(F("Accel"), MPU6050, 0x3B, 6, 10);
+RegisterReader temperature(F("Temp"), MPU6050, 0x41, 2, 10);
+RegisterReader gyroscope(F("Gyro"), MPU6050, 0x43, 6, 10);
+RegisterReader magnetometer(F("Mag"), HMC5883L, 0x03, 6, 20);
+
+void printDevice(const __FlashStringHelper *name, const I2CDevice &device)
+{
+  const I2CDevice::Statistics &statistics = device.statistics;
+  Serial.print(name);
+  Serial.print(F(": transactions="));
+  Serial.print(statistics.transactions);
+  Serial.print(F(" merged="));
+  Serial.print(statistics.merged);
+  Serial.print(F(" errors="));
+  Serial.print(statistics.errors);
+  Serial.print(F(" latency avg/max="));
+  Serial.print(device.getAverageLatency());
+  Serial.print('/');
+  Serial.print(statistics.maxLatency);
+  Serial.println(F(" us"));
+}
+
+class ReportTask : public Task
+{
+public:
+  ReportTask() : Task(F("Report"))
+  {
+    setPeriod(2000);
+  }
+
+  void step() override
+  {
+    Serial.print(F("bus utilization: "));
+    Serial.print(i2cEngine.getUtilization());
+    Serial.println('%');
+    printDevice(F("MPU-6050"), mpu6050);
+    printDevice(F("HMC5883L"), hmc5883l);
+    Serial.print(F("accel x="));
+    Serial.print(accelerometer.getWord(0));
+    Serial.print(F(" gyro x="));
+    Serial.println(gyroscope.getWord(0));
+    i2cEngine.resetStatistics();
+  }
+};
+
+ReportTask report;
+
+void setup()
+{
+  Serial.begin(115200);
+
+  i2cEngine.addDevice(mpu6050);
+  i2cEngine.addDevice(hmc5883l);
+
+  // The motion sensor goes first when the bus is contended
+  accelerometer.setPriority(Task::PRIORITY_HIGH);
+  temperature.setPriority(Task::PRIORITY_LOW);
+  gyroscope.setPriority(Task::PRIORITY_HIGH);
+  magnetometer.setPriority(Task::PRIORITY_NORMAL);
+
+  OS.begin();
+  OS.add(&i2cEngine);
+  OS.add(&accelerometer);
+  OS.add(&temperature);
+  OS.add(&gyroscope);
+  OS.add(&magnetometer);
+  OS.add(&report);
+  i2cEngine.setPeriod(2); // Completions are delivered at this period
+  i2cEngine.start();
+  I2c.setSpeed(1); // 400 kHz, once the engine has set up the hardware
+  accelerometer.start();
+  temperature.start();
+  gyroscope.start();
+  magnetometer.start();
+  report.start();
+
+  // Wake the MPU-6050 up from sleep
+  static const uint8_t wake = 0x00;
+  static I2CTransaction wakeUp;
+  wakeUp.setWrite(MPU6050, 0x6B, &wake, 1);
+  i2cEngine.submit(wakeUp);
+}
+
+void loop()
+{
+  OS.loopOnce();
+}
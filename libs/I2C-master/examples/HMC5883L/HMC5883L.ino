@@ -13,6 +13,7 @@
 int x = 0;
 int y = 0;
 int z = 0;
+uint8_t sample[6];
 
 void setup()
 {
@@ -22,13 +23,10 @@ void setup()
 
 void loop()
 {
-  I2c.read(HMC5883L, 0x03, 6); // read 6 bytes (x,y,z) from the device
-  x = I2c.receive() << 8;
-  x |= I2c.receive();
-  y = I2c.receive() << 8;
-  y |= I2c.receive();
-  z = I2c.receive() << 8;
-  z |= I2c.receive();
+  I2c.read(HMC5883L, 0x03, 6, sample); // read 6 bytes (x,y,z) straight into sample
+  x = sample[0] << 8 | sample[1];
+  y = sample[2] << 8 | sample[3];
+  z = sample[4] << 8 | sample[5];
 }
 
 /* Wire library equivalent would be this
@@ -0,0 +1,86 @@
+/**
+ * @file RegisterCache.ino
+ * @brief Auto-ranging an HMC5883L through a register cache
+ *
+ * The sketch reads the magnetometer continuously and changes its gain
+ * when a reading gets close to the end of the range or very small. The
+ * gain and mode changes are read-modify-write updates of the
+ * configuration registers; the cache serves their reads from RAM and
+ * leaves out writes that would not change anything, so only the samples
+ * and the real changes use the bus. Every two seconds the sketch prints
+ * the cache counters.
+ *
+ * Hardware Connections:
+ * - HMC5883L SDA → Arduino A4
+ * - HMC5883L SCL → Arduino A5
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include <I2C.h>
+#include <I2CRegisterCache.h>
+
+#define HMC5883L 0x1E
+
+#define CONFIG_A 0x00
+#define CONFIG_B 0x01
+#define MODE 0x02
+#define DATA_X_MSB 0x03
+
+// Registers 0x00-0x0C; the data and status registers change on their own
+I2CShadowRegisters<13> compass(HMC5883L);
+uint8_t gain = 1;
+uint32_t lastReport = 0;
+
+void setup()
+{
+  Serial.begin(9600);
+  I2c.begin();
+  I2c.timeOut(10);
+  compass.setVolatile(DATA_X_MSB, 7);
+}
+
+void loop()
+{
+  // The same configuration on every pass costs no bus traffic once cached
+  compass.update(CONFIG_A, 0x1C, 0x18);      // 75 Hz output rate
+  compass.update(CONFIG_B, 0xE0, gain << 5);
+  compass.update(MODE, 0x03, 0x00);          // continuous mode
+
+  uint8_t sample[6];
+  if (compass.read(DATA_X_MSB, sample, sizeof(sample)) == 0)
+  {
+    int16_t largest = 0;
+    for (uint8_t i = 0; i < sizeof(sample); i += 2)
+    {
+      int16_t value = abs((int16_t)(sample[i] << 8 | sample[i + 1]));
+      largest = max(largest, value);
+    }
+    if (largest > 1900 && gain < 7)
+    {
+      gain++;
+    }
+    else if (largest < 400 && gain > 0)
+    {
+      gain--;
+    }
+  }
+
+  if (millis() - lastReport >= 2000)
+  {
+    lastReport = millis();
+    Serial.print(F("gain "));
+    Serial.print(gain);
+    Serial.print(F(", register bytes from RAM "));
+    Serial.print(compass.statistics.hits);
+    Serial.print(F(", read "));
+    Serial.print(compass.statistics.reads);
+    Serial.print(F(", written "));
+    Serial.print(compass.statistics.writes);
+    Serial.print(F(", skipped "));
+    Serial.println(compass.statistics.skipped);
+    compass.resetStatistics();
+  }
+  delay(14);
+}
@@ -65,11 +65,12 @@
 #include <FsmOS.h>
 
 uint8_t I2C::returnStatus = 0;
-uint8_t I2C::nack = 0;
+#if I2C_STAGING_BUFFER
 uint8_t I2C::data[MAX_BUFFER_SIZE];
 uint8_t I2C::bytesAvailable = 0;
 uint8_t I2C::bufferIndex = 0;
 uint8_t I2C::totalBytes = 0;
+#endif
 SimpleTimer<uint8_t> I2C::timeoutTimer(0);
 
 I2C::I2C()
@@ -265,6 +266,7 @@ void I2C::scan()
     timeoutTimer.setInterval(tempInterval);
 }
 
+#if I2C_STAGING_BUFFER
 /*
  *  Description:
  *      Returns the number of unread bytes stored in the internal 32 byte buffer
@@ -299,6 +301,7 @@ uint8_t I2C::receive()
   bytesAvailable--;
   return (data[bufferIndex]);
 }
+#endif
 
 uint8_t I2C::write(uint8_t address)
 {
@@ -621,72 +624,14 @@ uint8_t I2C::write(uint8_t address, uint8_t registerAddress, const uint8_t *data
  *          number of bytes read, instead it will return the error code which
  *          can be used for debugging.
  */
+#if I2C_STAGING_BUFFER
 uint8_t I2C::read(uint8_t address, uint8_t numberBytes)
 {
   bytesAvailable = 0;
   bufferIndex = 0;
+  totalBytes = 0;
   numberBytes = min(numberBytes, MAX_BUFFER_SIZE);
-  if (numberBytes == 0)
-  {
-    numberBytes++;
-  }
-  nack = numberBytes - 1;
-  returnStatus = 0;
-  returnStatus = _start();
-  if (returnStatus)
-  {
-    return (returnStatus);
-  }
-  returnStatus = _sendAddress(SLA_R(address));
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (5);
-    }
-    return (returnStatus);
-  }
-  for (uint8_t i = 0; i < numberBytes; i++)
-  {
-    if (i == nack)
-    {
-      returnStatus = _receiveByte(0);
-      if (returnStatus == 1)
-      {
-        return (6);
-      }
-
-      if (returnStatus != MR_DATA_NACK)
-      {
-        return (returnStatus);
-      }
-    }
-    else
-    {
-      returnStatus = _receiveByte(1);
-      if (returnStatus == 1)
-      {
-        return (6);
-      }
-      if (returnStatus != MR_DATA_ACK)
-      {
-        return (returnStatus);
-      }
-    }
-    data[i] = TWDR;
-    bytesAvailable = i + 1;
-    totalBytes = i + 1;
-  }
-  returnStatus = _stop();
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (7);
-    }
-    return (returnStatus);
-  }
-  return (returnStatus);
+  return readBytes(address, 0, 0, numberBytes, nullptr, stage);
 }
 
 uint8_t I2C::read(int address, int numberBytes)
@@ -722,100 +667,16 @@ uint8_t I2C::read(uint8_t address, uint8_t registerAddress, uint8_t numberBytes)
 {
   bytesAvailable = 0;
   bufferIndex = 0;
+  totalBytes = 0;
   numberBytes = min(numberBytes, MAX_BUFFER_SIZE);
-  if (numberBytes == 0)
-  {
-    numberBytes++;
-  }
-  nack = numberBytes - 1;
-  returnStatus = 0;
-  returnStatus = _start();
-  if (returnStatus)
-  {
-    return (returnStatus);
-  }
-  returnStatus = _sendAddress(SLA_W(address));
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (2);
-    }
-    return (returnStatus);
-  }
-  returnStatus = _sendByte(registerAddress);
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (3);
-    }
-    return (returnStatus);
-  }
-  returnStatus = _start();
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (4);
-    }
-    return (returnStatus);
-  }
-  returnStatus = _sendAddress(SLA_R(address));
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (5);
-    }
-    return (returnStatus);
-  }
-  for (uint8_t i = 0; i < numberBytes; i++)
-  {
-    if (i == nack)
-    {
-      returnStatus = _receiveByte(0);
-      if (returnStatus == 1)
-      {
-        return (6);
-      }
-      if (returnStatus != MR_DATA_NACK)
-      {
-        return (returnStatus);
-      }
-    }
-    else
-    {
-      returnStatus = _receiveByte(1);
-      if (returnStatus == 1)
-      {
-        return (6);
-      }
-      if (returnStatus != MR_DATA_ACK)
-      {
-        return (returnStatus);
-      }
-    }
-    data[i] = TWDR;
-    bytesAvailable = i + 1;
-    totalBytes = i + 1;
-  }
-  returnStatus = _stop();
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (7);
-    }
-    return (returnStatus);
-  }
-  return (returnStatus);
+  return readBytes(address, registerAddress, 1, numberBytes, nullptr, stage);
 }
 
 uint8_t I2C::read(int address, int registerAddress, int numberBytes)
 {
   return (read((uint8_t)address, (uint8_t)registerAddress, (uint8_t)numberBytes));
 }
+#endif
 
 /*
  *  Description:
@@ -843,19 +704,144 @@ uint8_t I2C::read(int address, int registerAddress, int numberBytes)
  */
 uint8_t I2C::read(uint8_t address, uint8_t numberBytes, uint8_t *dataBuffer)
 {
-  bytesAvailable = 0;
-  bufferIndex = 0;
+  return readBytes(address, 0, 0, numberBytes, dataBuffer);
+}
+
+/*
+ *  Same as I2c.read(address, numberBytes, *dataBuffer), but can read more
+ *  bytes (up to 65535)
+ */
+uint8_t I2C::readex(uint8_t address, uint16_t numberBytes, uint8_t *dataBuffer)
+{
+  return readBytes(address, 0, 0, numberBytes, dataBuffer);
+}
+
+/*
+ *  Description:
+ *      Initiate a write operation to set the pointer to the registerAddress,
+ *      then sending a repeated start (not a stop then start) and store the
+ *      number of bytes in the dataBuffer. As a side note there is a maximum of
+ *      255 bytes that may be received unlike the Wire library which has a 32
+ *      byte restriction.
+ *
+ *      NOTE: For devices with 16-bit register addresses use
+ *      I2c.read16(address, registerAddress, numberBytes, *dataBuffer). It is
+ *      identical except registerAddress is a uint16_t
+ *
+ *      NOTE: For reading more bytes (up to 65535) use
+ *      I2c.readex(address, registerAddress, numberBytes, *dataBuffer). It is
+ *      identical except numberBytes is a uint16_t
+ *  Parameters:
+ *      address - uint8_t
+ *          The 7 bit I2C slave address
+ *      registerAddress - uint8_t
+ *          Starting register address to read data from
+ *      numberBytes - uint8_t
+ *          The number of bytes to be read
+ *      dataBuffer - uint8_t*
+ *          An array to store the read data
+ *  Returns:
+ *      uint8_t
+ *          See "TRANSMISSION TIMEOUT RETURN VALUES" for return value meaning
+ *          NOTE: Unlike the Wire library the read operation will not return the
+ *          number of bytes read, instead it will return the error code which
+ *          can be used for debugging.
+ */
+uint8_t I2C::read(uint8_t address, uint8_t registerAddress, uint8_t numberBytes, uint8_t *dataBuffer)
+{
+  return readBytes(address, registerAddress, 1, numberBytes, dataBuffer);
+}
+
+/*
+ *  Same as I2c.read(address, registerAddress, numberBytes, *dataBuffer), but
+ *  can read more bytes (up to 65535)
+ */
+uint8_t I2C::readex(uint8_t address, uint8_t registerAddress, uint16_t numberBytes, uint8_t *dataBuffer)
+{
+  return readBytes(address, registerAddress, 1, numberBytes, dataBuffer);
+}
+
+/*
+ *  Description:
+ *      Common body of all read functions. Optionally sets the slave register
+ *      pointer, then sends a repeated start and receives numberBytes bytes.
+ *      Each byte goes straight from TWDR to its destination: dataBuffer when
+ *      given, otherwise the sink function.
+ *  Parameters:
+ *      address - uint8_t
+ *          The 7 bit I2C slave address
+ *      registerAddress - uint16_t
+ *          Starting register address to read data from
+ *      registerBytes - uint8_t
+ *          0: read from the current register pointer
+ *          1: 8-bit register address
+ *          2: 16-bit register address, MSB first
+ *      numberBytes - uint16_t
+ *          The number of bytes to be read, 0 reads one byte
+ *      dataBuffer - uint8_t*
+ *          Array to store the read data, or nullptr to use the sink
+ *      sink - ByteSink
+ *          Called with target and each byte when dataBuffer is nullptr
+ *  Returns:
+ *      uint8_t
+ *          See "TRANSMISSION TIMEOUT RETURN VALUES" for return value meaning
+ */
+uint8_t I2C::readBytes(uint8_t address, uint16_t registerAddress, uint8_t registerBytes,
+                       uint16_t numberBytes, uint8_t *dataBuffer, ByteSink sink, void *target)
+{
   if (numberBytes == 0)
   {
     numberBytes++;
   }
-  nack = numberBytes - 1;
   returnStatus = 0;
   returnStatus = _start();
   if (returnStatus)
   {
     return (returnStatus);
   }
+  if (registerBytes)
+  {
+    returnStatus = _sendAddress(SLA_W(address));
+    if (returnStatus)
+    {
+      if (returnStatus == 1)
+      {
+        return (2);
+      }
+      return (returnStatus);
+    }
+    if (registerBytes == 2)
+    {
+      // Send MSB of register address
+      returnStatus = _sendByte(registerAddress >> 8);
+      if (returnStatus)
+      {
+        if (returnStatus == 1)
+        {
+          return (3);
+        }
+        return (returnStatus);
+      }
+    }
+    returnStatus = _sendByte(registerAddress & 0xFF);
+    if (returnStatus)
+    {
+      if (returnStatus == 1)
+      {
+        return (3);
+      }
+      return (returnStatus);
+    }
+    returnStatus = _start();
+    if (returnStatus)
+    {
+      if (returnStatus == 1)
+      {
+        return (4);
+      }
+      return (returnStatus);
+    }
+  }
   returnStatus = _sendAddress(SLA_R(address));
   if (returnStatus)
   {
@@ -865,7 +851,8 @@ uint8_t I2C::read(uint8_t address, uint8_t numberBytes, uint8_t *dataBuffer)
     }
     return (returnStatus);
   }
-  for (uint8_t i = 0; i < numberBytes; i++)
+  uint16_t nack = numberBytes - 1;
+  for (uint16_t i = 0; i < numberBytes; i++)
   {
     if (i == nack)
     {
@@ -891,9 +878,14 @@ uint8_t I2C::read(uint8_t address, uint8_t numberBytes, uint8_t *dataBuffer)
         return (returnStatus);
       }
     }
-    dataBuffer[i] = TWDR;
-    bytesAvailable = i + 1;
-    totalBytes = i + 1;
+    if (dataBuffer)
+    {
+      *dataBuffer++ = TWDR;
+    }
+    else
+    {
+      sink(target, TWDR);
+    }
   }
   returnStatus = _stop();
   if (returnStatus)
@@ -907,305 +899,13 @@ uint8_t I2C::read(uint8_t address, uint8_t numberBytes, uint8_t *dataBuffer)
   return (returnStatus);
 }
 
-/*
- *  Same as I2c.read(address, numberBytes, *dataBuffer), but can read more
- *  bytes (up to 65535)
- */
-uint8_t I2C::readex(uint8_t address, uint16_t numberBytes, uint8_t *dataBuffer)
+#if I2C_STAGING_BUFFER
+void I2C::stage(void *, uint8_t value)
 {
-  bytesAvailable = 0;
-  bufferIndex = 0;
-  if (numberBytes == 0)
-  {
-    numberBytes++;
-  }
-  uint16_t nack = numberBytes - 1;
-  returnStatus = 0;
-  returnStatus = _start();
-  if (returnStatus)
-  {
-    return (returnStatus);
-  }
-  returnStatus = _sendAddress(SLA_R(address));
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (5);
-    }
-    return (returnStatus);
-  }
-  for (uint16_t i = 0; i < numberBytes; i++)
-  {
-    if (i == nack)
-    {
-      returnStatus = _receiveByte(0);
-      if (returnStatus == 1)
-      {
-        return (6);
-      }
-      if (returnStatus != MR_DATA_NACK)
-      {
-        return (returnStatus);
-      }
-    }
-    else
-    {
-      returnStatus = _receiveByte(1);
-      if (returnStatus == 1)
-      {
-        return (6);
-      }
-      if (returnStatus != MR_DATA_ACK)
-      {
-        return (returnStatus);
-      }
-    }
-    dataBuffer[i] = TWDR;
-    bytesAvailable = i + 1;
-    totalBytes = i + 1;
-  }
-  returnStatus = _stop();
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (7);
-    }
-    return (returnStatus);
-  }
-  return (returnStatus);
-}
-
-/*
- *  Description:
- *      Initiate a write operation to set the pointer to the registerAddress,
- *      then sending a repeated start (not a stop then start) and store the
- *      number of bytes in the dataBuffer. As a side note there is a maximum of
- *      255 bytes that may be received unlike the Wire library which has a 32
- *      byte restriction.
- *
- *      NOTE: For devices with 16-bit register addresses use
- *      I2c.read16(address, registerAddress, numberBytes, *dataBuffer). It is
- *      identical except registerAddress is a uint16_t
- *
- *      NOTE: For reading more bytes (up to 65535) use
- *      I2c.readex(address, registerAddress, numberBytes, *dataBuffer). It is
- *      identical except numberBytes is a uint16_t
- *  Parameters:
- *      address - uint8_t
- *          The 7 bit I2C slave address
- *      registerAddress - uint8_t
- *          Starting register address to read data from
- *      numberBytes - uint8_t
- *          The number of bytes to be read
- *      dataBuffer - uint8_t*
- *          An array to store the read data
- *  Returns:
- *      uint8_t
- *          See "TRANSMISSION TIMEOUT RETURN VALUES" for return value meaning
- *          NOTE: Unlike the Wire library the read operation will not return the
- *          number of bytes read, instead it will return the error code which
- *          can be used for debugging.
- */
-uint8_t I2C::read(uint8_t address, uint8_t registerAddress, uint8_t numberBytes, uint8_t *dataBuffer)
-{
-  bytesAvailable = 0;
-  bufferIndex = 0;
-  if (numberBytes == 0)
-  {
-    numberBytes++;
-  }
-  nack = numberBytes - 1;
-  returnStatus = 0;
-  returnStatus = _start();
-  if (returnStatus)
-  {
-    return (returnStatus);
-  }
-  returnStatus = _sendAddress(SLA_W(address));
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (2);
-    }
-    return (returnStatus);
-  }
-  returnStatus = _sendByte(registerAddress);
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (3);
-    }
-    return (returnStatus);
-  }
-  returnStatus = _start();
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (4);
-    }
-    return (returnStatus);
-  }
-  returnStatus = _sendAddress(SLA_R(address));
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (5);
-    }
-    return (returnStatus);
-  }
-  for (uint8_t i = 0; i < numberBytes; i++)
-  {
-    if (i == nack)
-    {
-      returnStatus = _receiveByte(0);
-      if (returnStatus == 1)
-      {
-        return (6);
-      }
-      if (returnStatus != MR_DATA_NACK)
-      {
-        return (returnStatus);
-      }
-    }
-    else
-    {
-      returnStatus = _receiveByte(1);
-      if (returnStatus == 1)
-      {
-        return (6);
-      }
-      if (returnStatus != MR_DATA_ACK)
-      {
-        return (returnStatus);
-      }
-    }
-    dataBuffer[i] = TWDR;
-    bytesAvailable = i + 1;
-    totalBytes = i + 1;
-  }
-  returnStatus = _stop();
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (7);
-    }
-    return (returnStatus);
-  }
-  return (returnStatus);
-}
-
-/*
- *  Same as I2c.read(address, numberBytes, *dataBuffer), but can read more
- *  bytes (up to 65535)
- */
-uint8_t I2C::readex(uint8_t address, uint8_t registerAddress, uint16_t numberBytes, uint8_t *dataBuffer)
-{
-  bytesAvailable = 0;
-  bufferIndex = 0;
-  if (numberBytes == 0)
-  {
-    numberBytes++;
-  }
-  uint16_t nack = numberBytes - 1;
-  returnStatus = 0;
-  returnStatus = _start();
-  if (returnStatus)
-  {
-    return (returnStatus);
-  }
-  returnStatus = _sendAddress(SLA_W(address));
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (2);
-    }
-    return (returnStatus);
-  }
-  returnStatus = _sendByte(registerAddress >> 8);
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (3);
-    }
-    return (returnStatus);
-  }
-  returnStatus = _sendByte(registerAddress & 0xFF);
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (3);
-    }
-    return (returnStatus);
-  }
-  returnStatus = _start();
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (4);
-    }
-    return (returnStatus);
-  }
-  returnStatus = _sendAddress(SLA_R(address));
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (5);
-    }
-    return (returnStatus);
-  }
-  for (uint16_t i = 0; i < numberBytes; i++)
-  {
-    if (i == nack)
-    {
-      returnStatus = _receiveByte(0);
-      if (returnStatus == 1)
-      {
-        return (6);
-      }
-      if (returnStatus != MR_DATA_NACK)
-      {
-        return (returnStatus);
-      }
-    }
-    else
-    {
-      returnStatus = _receiveByte(1);
-      if (returnStatus == 1)
-      {
-        return (6);
-      }
-      if (returnStatus != MR_DATA_ACK)
-      {
-        return (returnStatus);
-      }
-    }
-    dataBuffer[i] = TWDR;
-    bytesAvailable = i + 1;
-    totalBytes = i + 1;
-  }
-  returnStatus = _stop();
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (7);
-    }
-    return (returnStatus);
-  }
-  return (returnStatus);
+  data[totalBytes++] = value;
+  bytesAvailable = totalBytes;
 }
+#endif
 
 ////////// 16-Bit Methods ///////////
 
@@ -1465,6 +1165,7 @@ uint8_t I2C::write16(uint8_t address, uint16_t registerAddress, uint64_t data)
 
 // These functions will be used to read from Slaves that take 16-bit addresses
 
+#if I2C_STAGING_BUFFER
 /*
  *  Same as I2c.read(address, registerAddress, numberBytes), but reads from a
  *  slave device that takes 16-bit register addresses
@@ -1473,106 +1174,11 @@ uint8_t I2C::read16(uint8_t address, uint16_t registerAddress, uint8_t numberByt
 {
   bytesAvailable = 0;
   bufferIndex = 0;
+  totalBytes = 0;
   numberBytes = min(numberBytes, MAX_BUFFER_SIZE);
-  if (numberBytes == 0)
-  {
-    numberBytes++;
-  }
-  nack = numberBytes - 1;
-  returnStatus = 0;
-  returnStatus = _start();
-  if (returnStatus)
-  {
-    return (returnStatus);
-  }
-  returnStatus = _sendAddress(SLA_W(address));
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (2);
-    }
-    return (returnStatus);
-  }
-  // Send MSB of register address
-  returnStatus = _sendByte(registerAddress >> 8);
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (3);
-    }
-    return (returnStatus);
-  }
-  // Send LSB of register address
-  returnStatus = _sendByte(registerAddress & 0xFF);
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (3);
-    }
-    return (returnStatus);
-  }
-  returnStatus = _start();
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (4);
-    }
-    return (returnStatus);
-  }
-  returnStatus = _sendAddress(SLA_R(address));
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (5);
-    }
-    return (returnStatus);
-  }
-  for (uint8_t i = 0; i < numberBytes; i++)
-  {
-    if (i == nack)
-    {
-      returnStatus = _receiveByte(0);
-      if (returnStatus == 1)
-      {
-        return (6);
-      }
-      if (returnStatus != MR_DATA_NACK)
-      {
-        return (returnStatus);
-      }
-    }
-    else
-    {
-      returnStatus = _receiveByte(1);
-      if (returnStatus == 1)
-      {
-        return (6);
-      }
-      if (returnStatus != MR_DATA_ACK)
-      {
-        return (returnStatus);
-      }
-    }
-    data[i] = TWDR;
-    bytesAvailable = i + 1;
-    totalBytes = i + 1;
-  }
-  returnStatus = _stop();
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (7);
-    }
-    return (returnStatus);
-  }
-  return (returnStatus);
+  return readBytes(address, registerAddress, 2, numberBytes, nullptr, stage);
 }
+#endif
 
 /*
  *  Same as I2c.read(address, registerAddress, numberBytes, *dataBuffer), but
@@ -1580,106 +1186,7 @@ uint8_t I2C::read16(uint8_t address, uint16_t registerAddress, uint8_t numberByt
  */
 uint8_t I2C::read16(uint8_t address, uint16_t registerAddress, uint8_t numberBytes, uint8_t *dataBuffer)
 {
-  bytesAvailable = 0;
-  bufferIndex = 0;
-  if (numberBytes == 0)
-  {
-    numberBytes++;
-  }
-  nack = numberBytes - 1;
-  returnStatus = 0;
-  returnStatus = _start();
-  if (returnStatus)
-  {
-    return (returnStatus);
-  }
-  returnStatus = _sendAddress(SLA_W(address));
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (2);
-    }
-    return (returnStatus);
-  }
-  // Send MSB of register address
-  returnStatus = _sendByte(registerAddress >> 8);
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (3);
-    }
-    return (returnStatus);
-  }
-  // Send LSB of register address
-  returnStatus = _sendByte(registerAddress & 0xFF);
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (3);
-    }
-    return (returnStatus);
-  }
-  returnStatus = _start();
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (4);
-    }
-    return (returnStatus);
-  }
-  returnStatus = _sendAddress(SLA_R(address));
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (5);
-    }
-    return (returnStatus);
-  }
-  for (uint8_t i = 0; i < numberBytes; i++)
-  {
-    if (i == nack)
-    {
-      returnStatus = _receiveByte(0);
-      if (returnStatus == 1)
-      {
-        return (6);
-      }
-      if (returnStatus != MR_DATA_NACK)
-      {
-        return (returnStatus);
-      }
-    }
-    else
-    {
-      returnStatus = _receiveByte(1);
-      if (returnStatus == 1)
-      {
-        return (6);
-      }
-      if (returnStatus != MR_DATA_ACK)
-      {
-        return (returnStatus);
-      }
-    }
-    dataBuffer[i] = TWDR;
-    bytesAvailable = i + 1;
-    totalBytes = i + 1;
-  }
-  returnStatus = _stop();
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (7);
-    }
-    return (returnStatus);
-  }
-  return (returnStatus);
+  return readBytes(address, registerAddress, 2, numberBytes, dataBuffer);
 }
 
 //////////// LOW-LEVEL METHODS
@@ -1985,28 +1492,5 @@ uint8_t I2C::sendData(uint8_t address, const uint8_t *data, uint8_t length)
 
 uint8_t I2C::receiveData(uint8_t address, uint8_t *buffer, uint8_t length)
 {
-  bytesAvailable = 0;
-  bufferIndex = 0;
-  nack = length - 1;
-
-  returnStatus = _start();
-  if (returnStatus)
-    return returnStatus;
-
-  returnStatus = _sendAddress(SLA_R(address));
-  if (returnStatus)
-    return returnStatus;
-
-  for (uint8_t i = 0; i < length; ++i)
-  {
-    returnStatus = _receiveByte(i == nack ? 0 : 1);
-    if (returnStatus)
-      return returnStatus;
-    buffer[i] = TWDR;
-    bytesAvailable = i + 1;
-    totalBytes = i + 1;
-  }
-
-  returnStatus = _stop();
-  return returnStatus;
+  return readBytes(address, 0, 0, length, buffer);
 }
@@ -76,6 +76,7 @@
 
 #include <inttypes.h>
 #include <SimpleTimer.h>
+#include <FastCircularQueue.h>
 
 /**
  * @name TWI Status Codes
@@ -103,6 +104,17 @@
 
 #define MAX_BUFFER_SIZE 32 ///< Maximum buffer size for I2C data
 
+/**
+ * @brief Keep the internal receive buffer.
+ *
+ * Reads without a destination store into a 32 byte buffer drained with
+ * available() and receive(). Set to 0 to drop that buffer and those
+ * functions, and read into your own buffers or queues only.
+ */
+#ifndef I2C_STAGING_BUFFER
+#define I2C_STAGING_BUFFER 1
+#endif
+
 /**
  * @brief Enhanced I2C master library for Arduino
  *
@@ -156,6 +168,7 @@ public:
    */
   void scan();
 
+#if I2C_STAGING_BUFFER
   /**
    * @brief Get number of bytes available to read
    *
@@ -169,6 +182,7 @@ public:
    * @return Next byte in the receive buffer
    */
   uint8_t receive();
+#endif
 
   /**
    * @brief Write to a device without sending a register address
@@ -267,6 +281,7 @@ public:
    */
   uint8_t write(uint8_t address, uint8_t registerAddress, const uint8_t *data, uint8_t numberBytes);
 
+#if I2C_STAGING_BUFFER
   /**
    * @brief Read from a device without specifying a register
    *
@@ -304,6 +319,7 @@ public:
    * @return Status code
    */
   uint8_t read(int address, int registerAddress, int numberBytes);
+#endif
 
   /**
    * @brief Read from a device into a buffer
@@ -347,6 +363,40 @@ public:
    */
   uint8_t readex(uint8_t address, uint8_t registerAddress, uint16_t numberBytes, uint8_t *dataBuffer);
 
+  /**
+   * @brief Read from a device straight into a queue
+   *
+   * Bytes are pushed as they arrive, without passing through a buffer.
+   * At most the free space of the queue is read.
+   *
+   * @param address 7-bit I2C address
+   * @param numberBytes Number of bytes to read
+   * @param queue Queue to push the read data to
+   * @return Status code, 0 without a transfer if the queue is full
+   */
+  template <size_t BUFFER_SIZE, typename Policy, typename IndexType>
+  uint8_t read(uint8_t address, uint16_t numberBytes,
+               FastCircularQueue<uint8_t, BUFFER_SIZE, Policy, IndexType> &queue)
+  {
+    return readQueue(address, 0, 0, numberBytes, queue);
+  }
+
+  /**
+   * @brief Read from a device register straight into a queue
+   *
+   * @param address 7-bit I2C address
+   * @param registerAddress Register address
+   * @param numberBytes Number of bytes to read
+   * @param queue Queue to push the read data to
+   * @return Status code, 0 without a transfer if the queue is full
+   */
+  template <size_t BUFFER_SIZE, typename Policy, typename IndexType>
+  uint8_t read(uint8_t address, uint8_t registerAddress, uint16_t numberBytes,
+               FastCircularQueue<uint8_t, BUFFER_SIZE, Policy, IndexType> &queue)
+  {
+    return readQueue(address, registerAddress, 1, numberBytes, queue);
+  }
+
   /**
    * @brief Helper function to send data to a device
    *
@@ -379,8 +429,16 @@ public:
   uint8_t write16(uint8_t address, uint16_t registerAddress, uint32_t data);
   uint8_t write16(uint8_t address, uint16_t registerAddress, uint64_t data);
   uint8_t write16(uint8_t address, uint16_t registerAddress, const uint8_t *data, uint8_t numberBytes);
+#if I2C_STAGING_BUFFER
   uint8_t read16(uint8_t address, uint16_t registerAddress, uint8_t numberBytes);
+#endif
   uint8_t read16(uint8_t address, uint16_t registerAddress, uint8_t numberBytes, uint8_t *dataBuffer);
+  template <size_t BUFFER_SIZE, typename Policy, typename IndexType>
+  uint8_t read16(uint8_t address, uint16_t registerAddress, uint16_t numberBytes,
+                 FastCircularQueue<uint8_t, BUFFER_SIZE, Policy, IndexType> &queue)
+  {
+    return readQueue(address, registerAddress, 2, numberBytes, queue);
+  }
   /** @} */
 
   /**
@@ -438,17 +496,71 @@ public:
   /** @} */
 
 private:
+  /**
+   * @brief Destination of received bytes that are not stored in a buffer
+   */
+  typedef void (*ByteSink)(void *target, uint8_t value);
+
   /**
    * @brief Handle bus lockup by resetting TWI hardware
    */
   void lockUp();
 
-  static uint8_t returnStatus;          ///< Status code from last operation
-  static uint8_t nack;                  ///< Whether a NACK was received
+  /**
+   * @brief Read from a device, optionally after setting its register pointer
+   *
+   * Every read function ends here. Bytes are stored through dataBuffer, or
+   * passed to sink when dataBuffer is null.
+   *
+   * @param address 7-bit I2C address
+   * @param registerAddress Register address
+   * @param registerBytes Size of the register address: 0 (none), 1 or 2
+   * @param numberBytes Number of bytes to read, 0 reads one
+   * @param dataBuffer Buffer to store read data, or nullptr
+   * @param sink Called with each byte when dataBuffer is null
+   * @param target Passed to sink
+   * @return Status code
+   */
+  uint8_t readBytes(uint8_t address, uint16_t registerAddress, uint8_t registerBytes,
+                    uint16_t numberBytes, uint8_t *dataBuffer,
+                    ByteSink sink = nullptr, void *target = nullptr);
+
+  /**
+   * @brief Read into the free space of a queue
+   */
+  template <size_t BUFFER_SIZE, typename Policy, typename IndexType>
+  uint8_t readQueue(uint8_t address, uint16_t registerAddress, uint8_t registerBytes,
+                    uint16_t numberBytes, FastCircularQueue<uint8_t, BUFFER_SIZE, Policy, IndexType> &queue)
+  {
+    typedef FastCircularQueue<uint8_t, BUFFER_SIZE, Policy, IndexType> Queue;
+    // The consumer can only free space while we read, so this much always fits
+    uint16_t space = BUFFER_SIZE - 1 - queue.available();
+    if (numberBytes > space)
+    {
+      numberBytes = space;
+    }
+    if (numberBytes == 0)
+    {
+      return (0);
+    }
+    return readBytes(address, registerAddress, registerBytes, numberBytes, nullptr,
+                     [](void *target, uint8_t value)
+                     { static_cast<Queue *>(target)->push(value); },
+                     &queue);
+  }
+
+  static uint8_t returnStatus; ///< Status code from last operation
+#if I2C_STAGING_BUFFER
+  /**
+   * @brief ByteSink appending to the internal buffer
+   */
+  static void stage(void *target, uint8_t value);
+
   static uint8_t data[MAX_BUFFER_SIZE]; ///< Buffer for received data
   static uint8_t bytesAvailable;        ///< Number of bytes available in buffer
   static uint8_t bufferIndex;           ///< Current index in buffer
   static uint8_t totalBytes;            ///< Total bytes in current transaction
+#endif
   static SimpleTimer<uint8_t> timeoutTimer;  ///< Timer for timeout operations
 };
 
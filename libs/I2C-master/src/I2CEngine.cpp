@@ -0,0 +1,584 @@
+/**
+ * @file I2CEngine.cpp
+ * @brief Implementation of the interrupt-driven I2C transaction engine
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include "I2CEngine.h"
+
+/** Engine served by the TWI interrupt */
+static I2CEngine *activeEngine = nullptr;
+
+/** TWCR bits of every step while the engine owns the bus */
+#define TWCR_ENGINE (_BV(TWINT) | _BV(TWEN) | _BV(TWIE))
+
+I2CTransaction::I2CTransaction()
+    : address(0),
+      registerAddress(0),
+      buffer(nullptr),
+      length(0),
+      flags(0),
+      priority(0),
+      callback(nullptr),
+      context(nullptr),
+      taskId(0),
+      messageType(0),
+      status(OK),
+      result(OK),
+      device(nullptr),
+      time(0),
+      next(nullptr)
+{
+}
+
+void I2CTransaction::setRead(uint8_t address, uint8_t registerAddress, uint8_t *buffer, uint8_t length)
+{
+  setRead(address, buffer, length);
+  this->registerAddress = registerAddress;
+  flags = READ | REGISTER;
+}
+
+void I2CTransaction::setRead(uint8_t address, uint8_t *buffer, uint8_t length)
+{
+  this->address = address;
+  this->buffer = buffer;
+  this->length = length;
+  flags = READ;
+}
+
+void I2CTransaction::setWrite(uint8_t address, uint8_t registerAddress, const uint8_t *data, uint8_t length)
+{
+  setWrite(address, data, length);
+  this->registerAddress = registerAddress;
+  flags = REGISTER;
+}
+
+void I2CTransaction::setWrite(uint8_t address, const uint8_t *data, uint8_t length)
+{
+  this->address = address;
+  // Written data is only read by the engine
+  buffer = const_cast<uint8_t *>(data);
+  this->length = length;
+  flags = 0;
+}
+
+void I2CTransaction::notify(uint8_t target, uint8_t type)
+{
+  taskId = target;
+  messageType = type;
+}
+
+void I2CTransaction::onComplete(Callback function, void *data)
+{
+  callback = function;
+  context = data;
+}
+
+I2CDevice::I2CDevice(uint8_t address, uint8_t options)
+    : address(address),
+      options(options),
+      statistics{0, 0, 0, 0, 0, 0},
+      next(nullptr)
+{
+}
+
+uint32_t I2CDevice::getAverageLatency() const
+{
+  return statistics.transactions > 0 ? statistics.totalLatency / statistics.transactions : 0;
+}
+
+I2CEngine::I2CEngine()
+    : Task(F("I2CEngine")),
+      m_head(nullptr),
+      m_current(nullptr),
+      m_doneHead(nullptr),
+      m_doneTail(nullptr),
+      m_devices(nullptr),
+      m_queued(0),
+      m_index(0),
+      m_remaining(0),
+      m_sendRegister(false),
+      m_progress(0),
+      m_lastProgress(0),
+      m_timeoutTimer(I2C_ENGINE_TIMEOUT_MS),
+      m_busySince(0),
+      m_busyTime(0),
+      m_statisticsStart(0)
+{
+}
+
+void I2CEngine::on_start()
+{
+  begin();
+}
+
+void I2CEngine::begin()
+{
+  // Again would reset a transfer on the bus
+  if (activeEngine == this)
+  {
+    return;
+  }
+  I2c.begin();
+  activeEngine = this;
+  m_statisticsStart = micros();
+}
+
+/**
+ * @brief Delivers completions and checks the timeout
+ *
+ * @details The timeout counts from the last bus event, as seen at the
+ * task's period, so a slow transfer or a clock-stretching device is not
+ * cut off as long as the bus keeps moving.
+ */
+void I2CEngine::step()
+{
+  bool busy;
+  uint8_t progress;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    busy = m_current != nullptr;
+    progress = m_progress;
+  }
+
+  if (!busy || progress != m_lastProgress)
+  {
+    m_lastProgress = progress;
+    m_timeoutTimer.reset();
+  }
+  else if (m_timeoutTimer.isEnabled() && m_timeoutTimer.isReady())
+  {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+      // Still stuck with interrupts off: release the lines like I2C::lockUp()
+      if (m_current != nullptr && m_progress == progress)
+      {
+        TWCR = 0;
+        TWCR = _BV(TWEN) | _BV(TWEA);
+        finish(I2CTransaction::TIMEOUT, 0);
+      }
+    }
+    m_timeoutTimer.reset();
+  }
+
+  while (true)
+  {
+    I2CTransaction *transaction;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+      transaction = m_doneHead;
+      if (transaction != nullptr)
+      {
+        m_doneHead = transaction->next;
+        if (m_doneHead == nullptr)
+        {
+          m_doneTail = nullptr;
+        }
+      }
+    }
+    if (transaction == nullptr)
+    {
+      break;
+    }
+
+    // The descriptor may be submitted again from here on
+    const uint8_t result = transaction->result;
+    count(transaction);
+    transaction->next = nullptr;
+    transaction->status = result;
+    if (transaction->callback != nullptr)
+    {
+      transaction->callback(*transaction);
+    }
+    if (transaction->taskId != 0)
+    {
+      tell(transaction->taskId, transaction->messageType, result);
+    }
+  }
+}
+
+bool I2CEngine::submit(I2CTransaction &transaction)
+{
+  if (transaction.status == I2CTransaction::PENDING ||
+      ((transaction.flags & I2CTransaction::READ) && transaction.length == 0))
+  {
+    return false;
+  }
+  // Tasks may submit before the scheduler has started the engine
+  begin();
+
+  transaction.device = getDevice(transaction.address);
+  transaction.flags &= ~I2CTransaction::MERGED;
+  bool queued = false;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    if (m_queued < I2C_ENGINE_QUEUE_LENGTH)
+    {
+      transaction.status = I2CTransaction::PENDING;
+      transaction.time = micros();
+
+      // Behind every transaction of the same or a higher priority
+      I2CTransaction **link = &m_head;
+      while (*link != nullptr && (*link)->priority >= transaction.priority)
+      {
+        link = &(*link)->next;
+      }
+      transaction.next = *link;
+      *link = &transaction;
+      m_queued++;
+      queued = true;
+
+      if (m_current == nullptr)
+      {
+        // A STOP from the last transaction may still be on the bus
+        while (TWCR & _BV(TWSTO))
+        {
+        }
+        m_busySince = transaction.time;
+        startNext(0, nullptr);
+      }
+    }
+  }
+  return queued;
+}
+
+bool I2CEngine::addDevice(I2CDevice &device)
+{
+  if (getDevice(device.address) != nullptr)
+  {
+    return false;
+  }
+  device.next = m_devices;
+  m_devices = &device;
+  return true;
+}
+
+I2CDevice *I2CEngine::getDevice(uint8_t address) const
+{
+  I2CDevice *device = m_devices;
+  while (device != nullptr && device->address != address)
+  {
+    device = device->next;
+  }
+  return device;
+}
+
+uint32_t I2CEngine::getBusyTime() const
+{
+  uint32_t busyTime;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    busyTime = m_busyTime;
+    if (m_current != nullptr)
+    {
+      busyTime += micros() - m_busySince;
+    }
+  }
+  return busyTime;
+}
+
+uint8_t I2CEngine::getUtilization() const
+{
+  const uint32_t busyTime = getBusyTime();
+  const uint32_t elapsed = micros() - m_statisticsStart;
+  if (elapsed < 100)
+  {
+    return 0;
+  }
+  const uint32_t percent = busyTime / (elapsed / 100);
+  return percent < 100 ? percent : 100;
+}
+
+void I2CEngine::resetStatistics()
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    m_statisticsStart = micros();
+    m_busyTime = 0;
+    m_busySince = m_statisticsStart;
+  }
+  for (I2CDevice *device = m_devices; device != nullptr; device = device->next)
+  {
+    device->statistics = I2CDevice::Statistics{0, 0, 0, 0, 0, 0};
+  }
+}
+
+/**
+ * @brief Updates the device counters of a delivered transaction
+ *
+ * @details Runs in task context, so the counters need no locking.
+ */
+void I2CEngine::count(I2CTransaction *transaction)
+{
+  I2CDevice *device = transaction->device;
+  if (device == nullptr)
+  {
+    return;
+  }
+
+  I2CDevice::Statistics &statistics = device->statistics;
+  statistics.transactions++;
+  if (transaction->result == I2CTransaction::OK)
+  {
+    statistics.bytes += transaction->length;
+  }
+  else
+  {
+    statistics.errors++;
+  }
+  if (transaction->flags & I2CTransaction::MERGED)
+  {
+    statistics.merged++;
+  }
+  statistics.totalLatency += transaction->time;
+  if (transaction->time > statistics.maxLatency)
+  {
+    statistics.maxLatency = transaction->time;
+  }
+}
+
+bool I2CEngine::isIdle() const
+{
+  bool idle;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    idle = m_current == nullptr && m_head == nullptr;
+  }
+  return idle;
+}
+
+/**
+ * @brief Advances the running transaction
+ *
+ * @details One call per TWI event, following the master transmitter and
+ * master receiver flows of the datasheet. A read with a register address
+ * writes it, then turns the bus around with a repeated start. The bytes of
+ * a burst fill the buffer of each merged read in turn.
+ */
+void I2CEngine::processISR()
+{
+  I2CTransaction *transaction = m_current;
+  const uint8_t twiStatus = TWI_STATUS;
+  m_progress++;
+
+  if (transaction == nullptr)
+  {
+    // Not ours; leave the bus alone
+    TWCR = _BV(TWINT) | _BV(TWEN);
+    return;
+  }
+
+  const bool read = transaction->flags & I2CTransaction::READ;
+  switch (twiStatus)
+  {
+  case START:
+  case REPEATED_START:
+    TWDR = (read && !m_sendRegister) ? SLA_R(transaction->address) : SLA_W(transaction->address);
+    TWCR = TWCR_ENGINE;
+    break;
+
+  case MT_SLA_ACK:
+  case MT_DATA_ACK:
+    if (m_sendRegister)
+    {
+      m_sendRegister = false;
+      TWDR = transaction->registerAddress;
+      TWCR = TWCR_ENGINE;
+    }
+    else if (read)
+    {
+      TWCR = TWCR_ENGINE | _BV(TWSTA);
+    }
+    else if (m_index < transaction->length)
+    {
+      TWDR = transaction->buffer[m_index++];
+      TWCR = TWCR_ENGINE;
+    }
+    else
+    {
+      finish(I2CTransaction::OK, _BV(TWSTO));
+    }
+    break;
+
+  case MR_SLA_ACK:
+    // ACK every byte but the last, so the device stops sending
+    TWCR = TWCR_ENGINE | (m_remaining > 1 ? _BV(TWEA) : 0);
+    break;
+
+  case MR_DATA_ACK:
+    transaction->buffer[m_index++] = TWDR;
+    m_remaining--;
+    if (m_index == transaction->length)
+    {
+      // The next read of the burst takes the following bytes
+      m_current = transaction->next;
+      m_index = 0;
+      complete(transaction, I2CTransaction::OK);
+    }
+    TWCR = TWCR_ENGINE | (m_remaining > 1 ? _BV(TWEA) : 0);
+    break;
+
+  case MR_DATA_NACK:
+    transaction->buffer[m_index] = TWDR;
+    finish(I2CTransaction::OK, _BV(TWSTO));
+    break;
+
+  case LOST_ARBTRTN:
+    // Another master has the bus; the next START waits until it is free
+    finish(twiStatus, 0);
+    break;
+
+  case 0x00:
+    finish(I2CTransaction::BUS_ERROR, _BV(TWSTO));
+    break;
+
+  default:
+    // A NACK from the device
+    finish(twiStatus, _BV(TWSTO));
+    break;
+  }
+}
+
+void I2CEngine::finish(uint8_t result, uint8_t control)
+{
+  I2CTransaction *transaction = m_current;
+  const I2CDevice *device = transaction->device;
+  while (transaction != nullptr)
+  {
+    I2CTransaction *next = transaction->next;
+    complete(transaction, result);
+    transaction = next;
+  }
+
+  // After a failure the bus gets a proper STOP
+  startNext(control, result == I2CTransaction::OK ? device : nullptr);
+}
+
+void I2CEngine::complete(I2CTransaction *transaction, uint8_t result)
+{
+  transaction->result = result;
+  transaction->time = micros() - transaction->time;
+  transaction->next = nullptr;
+  if (m_doneTail != nullptr)
+  {
+    m_doneTail->next = transaction;
+  }
+  else
+  {
+    m_doneHead = transaction;
+  }
+  m_doneTail = transaction;
+}
+
+/**
+ * @brief Starts the first waiting transaction
+ *
+ * @details With TWSTO and TWSTA together the hardware sends the STOP of
+ * the last transaction and the START of the next one back to back. When
+ * both devices allow it, the STOP is left out and the START becomes a
+ * repeated start.
+ */
+void I2CEngine::startNext(uint8_t control, const I2CDevice *previous)
+{
+  I2CTransaction *transaction = m_head;
+  m_current = transaction;
+  if (transaction == nullptr)
+  {
+    TWCR = _BV(TWINT) | _BV(TWEN) | control;
+    m_busyTime += micros() - m_busySince;
+    return;
+  }
+
+  m_head = transaction->next;
+  m_queued--;
+  transaction->next = nullptr;
+  m_index = 0;
+  m_sendRegister = transaction->flags & I2CTransaction::REGISTER;
+  m_remaining = 0;
+  if (transaction->flags & I2CTransaction::READ)
+  {
+    m_remaining = transaction->length;
+    transaction = mergeReads(transaction);
+    m_current = transaction;
+  }
+
+  const I2CDevice *device = transaction->device;
+  if (previous != nullptr && device != nullptr &&
+      (previous->options & device->options & I2CDevice::RESTART))
+  {
+    control = 0;
+  }
+  TWCR = TWCR_ENGINE | _BV(TWSTA) | control;
+}
+
+/**
+ * @brief Builds a burst around a register read
+ *
+ * @details Queued register reads of the same BURST device that end where
+ * the burst starts, or start where it ends, are unlinked from the queue
+ * and chained before or behind it, until none is left. The queue is
+ * short, so the search stays within a few dozen comparisons.
+ *
+ * @param first Read taken from the queue
+ * @return I2CTransaction* First read of the burst
+ */
+I2CTransaction *I2CEngine::mergeReads(I2CTransaction *first)
+{
+  const I2CDevice *device = first->device;
+  const uint8_t readRegister = I2CTransaction::READ | I2CTransaction::REGISTER;
+  if (device == nullptr || !(device->options & I2CDevice::BURST) ||
+      (first->flags & readRegister) != readRegister)
+  {
+    return first;
+  }
+
+  I2CTransaction *last = first;
+  while (true)
+  {
+    const uint16_t start = first->registerAddress;
+    const uint16_t end = (uint16_t)last->registerAddress + last->length;
+    I2CTransaction **link = &m_head;
+    while (*link != nullptr &&
+           ((*link)->device != device ||
+            ((*link)->flags & readRegister) != readRegister ||
+            ((*link)->registerAddress != end &&
+             (uint16_t)(*link)->registerAddress + (*link)->length != start)))
+    {
+      link = &(*link)->next;
+    }
+    if (*link == nullptr)
+    {
+      return first;
+    }
+
+    I2CTransaction *merged = *link;
+    *link = merged->next;
+    m_queued--;
+    merged->flags |= I2CTransaction::MERGED;
+    m_remaining += merged->length;
+    if (merged->registerAddress == end)
+    {
+      merged->next = nullptr;
+      last->next = merged;
+      last = merged;
+    }
+    else
+    {
+      merged->next = first;
+      first = merged;
+    }
+  }
+}
+
+ISR(TWI_vect)
+{
+  if (activeEngine != nullptr)
+  {
+    activeEngine->processISR();
+  }
+  else
+  {
+    TWCR = _BV(TWINT) | _BV(TWEN);
+  }
+}
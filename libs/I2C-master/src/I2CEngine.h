@@ -0,0 +1,416 @@
+/**
+ * @file I2CEngine.h
+ * @brief Interrupt-driven, non-blocking I2C transactions for FsmOS tasks.
+ *
+ * The polled I2C methods wait on TWINT for every start, address and data
+ * byte, so a 6-byte register read at 100 kHz stalls the scheduler for
+ * about 700 µs. The engine runs the same transfers from the TWI interrupt
+ * instead. A task fills in an I2CTransaction, submits it and goes on; the
+ * engine tells the task with an FsmOS message, or calls a callback, once
+ * the transfer is over:
+ * @code
+ * I2CEngine i2cEngine;
+ * uint8_t sample[6];
+ * I2CTransaction readSample;
+ *
+ * // In setup()
+ * OS.add(&i2cEngine);
+ * i2cEngine.start();
+ *
+ * // In a task
+ * readSample.setRead(0x1E, 0x03, sample, sizeof(sample));
+ * readSample.notify(getId(), MSG_SAMPLE);
+ * i2cEngine.submit(readSample);
+ * // on_msg() gets MSG_SAMPLE with the status in msg.arg
+ * @endcode
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+#ifndef I2C_ENGINE_H
+#define I2C_ENGINE_H
+
+#include <Arduino.h>
+#include <SimpleTimer.h>
+#include <FsmOS.h>
+#include "I2C.h"
+
+/**
+ * @brief Default time the bus may go without progress, in milliseconds
+ *
+ * The engine gives up on a transaction, resets the TWI hardware and moves
+ * on to the next one after this long without a bus event. 0 disables the
+ * check.
+ */
+#ifndef I2C_ENGINE_TIMEOUT_MS
+#define I2C_ENGINE_TIMEOUT_MS 20
+#endif
+
+/**
+ * @brief Transactions that can wait in the queue
+ *
+ * submit() refuses more, so a task that floods the bus cannot hold up the
+ * others indefinitely. The running transaction and the ones waiting for
+ * delivery do not count.
+ */
+#ifndef I2C_ENGINE_QUEUE_LENGTH
+#define I2C_ENGINE_QUEUE_LENGTH 8
+#endif
+
+struct I2CDevice;
+
+/**
+ * @brief Descriptor of one I2C transfer
+ *
+ * A transaction writes an optional register address, then either writes
+ * the buffer or reads into it after a repeated start. The descriptor and
+ * the buffer belong to the caller and must stay valid until the status
+ * leaves PENDING.
+ */
+struct I2CTransaction
+{
+  /**
+   * @brief Completion callback
+   * @param transaction The finished transaction
+   */
+  typedef void (*Callback)(I2CTransaction &transaction);
+
+  /**
+   * @brief Transfer options
+   */
+  enum Flags : uint8_t
+  {
+    READ = 0x01,    ///< Read into the buffer; otherwise write it
+    REGISTER = 0x02, ///< Write registerAddress first
+    MERGED = 0x80   ///< Ran as part of another read's burst, set by the engine
+  };
+
+  /**
+   * @brief Outcome values besides the TWI status codes
+   *
+   * A failed transaction holds the TWI status that stopped it, such as
+   * MT_SLA_NACK or LOST_ARBTRTN, or one of these.
+   */
+  enum Status : uint8_t
+  {
+    OK = 0,         ///< Transfer completed
+    TIMEOUT = 1,    ///< No bus progress within the timeout; the hardware was reset
+    BUS_ERROR = 2,  ///< Illegal START or STOP on the bus
+    PENDING = 0xFF  ///< Waiting, running or not yet delivered
+  };
+
+  uint8_t address;         ///< 7-bit device address
+  uint8_t registerAddress; ///< Register written first with the REGISTER flag
+  uint8_t *buffer;         ///< Data to write or space to read into
+  uint8_t length;          ///< Bytes to transfer, at least 1 for reads
+  uint8_t flags;           ///< Combination of Flags
+  uint8_t priority;        ///< Higher runs first, such as the task's getPriority()
+  Callback callback;       ///< Called on completion, or nullptr
+  void *context;           ///< Free for the callback's use
+  uint8_t taskId;          ///< Id of the task told on completion, or 0
+  uint8_t messageType;     ///< Type of the message sent to the task; arg is the status
+  volatile uint8_t status; ///< PENDING, OK or the failure
+  uint8_t result;          ///< Outcome until it is delivered, used by the engine
+  I2CDevice *device;       ///< Registered device of the address, set by the engine
+  uint32_t time;           ///< Submission time, then latency in µs, used by the engine
+  I2CTransaction *next;    ///< Queue link, used by the engine
+
+  /**
+   * @brief Constructor
+   */
+  I2CTransaction();
+
+  /**
+   * @brief Sets up a register read
+   *
+   * @param address 7-bit device address
+   * @param registerAddress First register to read
+   * @param buffer Space for the data
+   * @param length Bytes to read, 1-255
+   */
+  void setRead(uint8_t address, uint8_t registerAddress, uint8_t *buffer, uint8_t length);
+
+  /**
+   * @brief Sets up a read without a register address
+   *
+   * @param address 7-bit device address
+   * @param buffer Space for the data
+   * @param length Bytes to read, 1-255
+   */
+  void setRead(uint8_t address, uint8_t *buffer, uint8_t length);
+
+  /**
+   * @brief Sets up a register write
+   *
+   * @param address 7-bit device address
+   * @param registerAddress First register to write
+   * @param data Bytes to write, left unchanged
+   * @param length Bytes to write, 0 to only set the register pointer
+   */
+  void setWrite(uint8_t address, uint8_t registerAddress, const uint8_t *data, uint8_t length);
+
+  /**
+   * @brief Sets up a write without a register address
+   *
+   * @param address 7-bit device address
+   * @param data Bytes to write, left unchanged
+   * @param length Bytes to write, 0 to only probe the address
+   */
+  void setWrite(uint8_t address, const uint8_t *data, uint8_t length);
+
+  /**
+   * @brief Sends a message to a task on completion
+   *
+   * @param target Id of the task to tell, from its getId()
+   * @param type Message type; the message arg holds the status
+   */
+  void notify(uint8_t target, uint8_t type);
+
+  /**
+   * @brief Calls a function on completion
+   *
+   * @param function Called from the engine task, not from the interrupt
+   * @param data Stored in context
+   */
+  void onComplete(Callback function, void *data = nullptr);
+
+  /**
+   * @brief Checks whether the transaction is finished
+   *
+   * @return true unless PENDING
+   */
+  bool isDone() const { return status != PENDING; }
+};
+
+/**
+ * @brief Bus options and statistics of one device
+ *
+ * Transactions to a registered device are counted, and may run in bursts
+ * or back to back with a repeated start if the device allows it.
+ * Unregistered addresses work the same, without either.
+ */
+struct I2CDevice
+{
+  /**
+   * @brief What the device allows
+   */
+  enum Options : uint8_t
+  {
+    BURST = 0x01,         ///< Register reads auto-increment, so adjacent reads can merge
+    RESTART = 0x02 ///< Needs no STOP between transactions, unlike EEPROMs that latch writes on it
+  };
+
+  /**
+   * @brief Counters since the device was added or resetStatistics()
+   */
+  struct Statistics
+  {
+    uint32_t transactions; ///< Transactions delivered
+    uint32_t bytes;        ///< Data bytes of the successful ones
+    uint16_t errors;       ///< Transactions that failed
+    uint16_t merged;       ///< Reads that rode along another read's burst
+    uint32_t totalLatency; ///< Sum of submit-to-completion times, µs
+    uint32_t maxLatency;   ///< Longest submit-to-completion time, µs
+  };
+
+  uint8_t address;       ///< 7-bit device address
+  uint8_t options;       ///< Combination of Options
+  Statistics statistics; ///< Counters, updated when transactions are delivered
+  I2CDevice *next;       ///< Device list link, used by the engine
+
+  /**
+   * @brief Constructor
+   *
+   * @param address 7-bit device address
+   * @param options Combination of Options
+   */
+  explicit I2CDevice(uint8_t address, uint8_t options = 0);
+
+  /**
+   * @brief Gets the average submit-to-completion time
+   *
+   * @return uint32_t Microseconds, 0 before the first transaction
+   */
+  uint32_t getAverageLatency() const;
+};
+
+/**
+ * @class I2CEngine
+ * @brief Runs queued I2C transactions from the TWI interrupt
+ *
+ * @details Submitted transactions wait in a bounded queue, highest
+ * priority first and in submission order within a priority. The interrupt
+ * handler walks each one through start, address, register, repeated start
+ * and data bytes, and starts the next one together with the STOP of the
+ * last, so the bus stays busy without the CPU waiting for it.
+ *
+ * For devices added with addDevice():
+ * - A register read of a BURST device takes along the queued reads of the
+ *   registers right before and after it. They run as one burst and each
+ *   is delivered on its own, so tasks reading neighbouring registers share
+ *   one start, address and register byte.
+ * - Between transactions of RESTART devices the bus goes straight
+ *   to the next START, without a STOP.
+ * - Latency, byte and error counters are kept per device, and the engine
+ *   measures how busy the bus is.
+ *
+ * Completion is delivered from step(), in task context: the status is set,
+ * then the callback runs and the message is sent. step() also watches the
+ * bus for lockups.
+ *
+ * There is one TWI unit, so there is one engine. Configure it with
+ * I2c.setSpeed() and I2c.pullup() after start(), and only use the polled
+ * I2c methods while isIdle().
+ */
+class I2CEngine : public Task
+{
+public:
+  /**
+   * @brief Constructor
+   */
+  I2CEngine();
+
+  /**
+   * @brief Task initialization - called when task starts
+   */
+  void on_start() override;
+
+  /**
+   * @brief Enables the TWI hardware for the engine
+   *
+   * @details Called by on_start() and the first submit(). Sets 100 kHz
+   * and the internal pullups like I2c.begin().
+   */
+  void begin();
+
+  /**
+   * @brief Task step - delivers completions and checks the timeout
+   */
+  void step() override;
+
+  /**
+   * @brief Queues a transaction
+   *
+   * @param transaction Descriptor, kept by the engine until it completes
+   * @return true if queued; false if it is still pending, reads 0 bytes or
+   *         the queue is full
+   */
+  bool submit(I2CTransaction &transaction);
+
+  /**
+   * @brief Registers a device for its options and statistics
+   *
+   * @param device Kept by the engine, with a unique address
+   * @return true if added, false if the address is already registered
+   */
+  bool addDevice(I2CDevice &device);
+
+  /**
+   * @brief Finds a registered device
+   *
+   * @param address 7-bit device address
+   * @return I2CDevice*, nullptr if not registered
+   */
+  I2CDevice *getDevice(uint8_t address) const;
+
+  /**
+   * @brief Gets the time the bus was busy since resetStatistics()
+   *
+   * @return uint32_t Microseconds from a START to the bus going idle
+   */
+  uint32_t getBusyTime() const;
+
+  /**
+   * @brief Gets the share of time the bus was busy since resetStatistics()
+   *
+   * @details Measured in microseconds, so call resetStatistics() at least
+   * every 70 minutes.
+   *
+   * @return uint8_t Percent
+   */
+  uint8_t getUtilization() const;
+
+  /**
+   * @brief Clears the bus time and the counters of every device
+   */
+  void resetStatistics();
+
+  /**
+   * @brief Checks whether the bus is free
+   *
+   * @return true if no transaction is running or waiting
+   */
+  bool isIdle() const;
+
+  /**
+   * @brief Sets the time the bus may go without progress
+   *
+   * @param timeoutMs Milliseconds, 0 to wait forever
+   */
+  void setTimeout(uint16_t timeoutMs) { m_timeoutTimer.setInterval(timeoutMs); }
+
+  /**
+   * @brief Advances the running transaction
+   *
+   * @details Called from the TWI interrupt.
+   */
+  void processISR();
+
+private:
+  /**
+   * @brief Ends the running transaction and its burst, and starts the next
+   *
+   * @param result Outcome of the transactions
+   * @param control TWSTO to release the bus first, or 0
+   */
+  void finish(uint8_t result, uint8_t control);
+
+  /**
+   * @brief Moves a finished transaction to the delivery list
+   *
+   * @param transaction Finished transaction
+   * @param result Its outcome
+   */
+  void complete(I2CTransaction *transaction, uint8_t result);
+
+  /**
+   * @brief Starts the first waiting transaction
+   *
+   * @param control TWSTO to send a STOP before the START, or 0
+   * @param previous Device of the finished transaction, or nullptr
+   */
+  void startNext(uint8_t control, const I2CDevice *previous);
+
+  /**
+   * @brief Builds a burst around a register read
+   *
+   * @param first Read taken from the queue
+   * @return I2CTransaction* First read of the burst
+   */
+  I2CTransaction *mergeReads(I2CTransaction *first);
+
+  /**
+   * @brief Updates the device counters of a delivered transaction
+   *
+   * @param transaction Delivered transaction
+   */
+  void count(I2CTransaction *transaction);
+
+  I2CTransaction *m_head;          ///< First waiting transaction
+  I2CTransaction *m_current;       ///< Transaction on the bus, linked to the rest of its burst
+  I2CTransaction *m_doneHead;      ///< First transaction to deliver
+  I2CTransaction *m_doneTail;      ///< Last transaction to deliver
+  I2CDevice *m_devices;            ///< Registered devices
+  uint8_t m_queued;                ///< Transactions waiting in the queue
+  uint8_t m_index;                 ///< Next byte of the current buffer
+  uint16_t m_remaining;            ///< Bytes left to read in the burst
+  bool m_sendRegister;             ///< Register address still to send
+  volatile uint8_t m_progress;     ///< Bus events so far, for the timeout
+  uint8_t m_lastProgress;          ///< m_progress at the last step
+  SimpleTimer<uint16_t> m_timeoutTimer; ///< Time since the last bus event
+  uint32_t m_busySince;            ///< Start of the current busy period, µs
+  uint32_t m_busyTime;             ///< Busy time of the finished periods, µs
+  uint32_t m_statisticsStart;      ///< Time of resetStatistics(), µs
+};
+
+#endif // I2C_ENGINE_H
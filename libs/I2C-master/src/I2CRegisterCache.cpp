@@ -0,0 +1,202 @@
+/**
+ * @file I2CRegisterCache.cpp
+ * @brief Implementation of the write-through I2C register cache
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include "I2CRegisterCache.h"
+
+#include <string.h>
+
+/** Tests bit index of a bitmap */
+static inline bool testBit(const uint8_t *bits, uint8_t index)
+{
+  return bits[index >> 3] & (1 << (index & 7));
+}
+
+/** Sets or clears bit index of a bitmap */
+static inline void putBit(uint8_t *bits, uint8_t index, bool value)
+{
+  if (value)
+  {
+    bits[index >> 3] |= 1 << (index & 7);
+  }
+  else
+  {
+    bits[index >> 3] &= ~(1 << (index & 7));
+  }
+}
+
+I2CRegisterCache::I2CRegisterCache(uint8_t address, uint8_t firstRegister, uint8_t count,
+                                   uint8_t *values, uint8_t *valid, uint8_t *volatileRegisters)
+    : statistics{0, 0, 0, 0},
+      m_address(address),
+      m_firstRegister(firstRegister),
+      m_count(count),
+      m_values(values),
+      m_valid(valid),
+      m_volatileRegisters(volatileRegisters)
+{
+}
+
+bool I2CRegisterCache::covers(uint8_t registerAddress) const
+{
+  return registerAddress >= m_firstRegister && registerAddress - m_firstRegister < m_count;
+}
+
+bool I2CRegisterCache::isCacheable(uint8_t registerAddress) const
+{
+  return covers(registerAddress) && !testBit(m_volatileRegisters, registerAddress - m_firstRegister);
+}
+
+bool I2CRegisterCache::isCached(uint8_t registerAddress) const
+{
+  return isCacheable(registerAddress) && testBit(m_valid, registerAddress - m_firstRegister);
+}
+
+/**
+ * @brief Records the device's value of a register
+ *
+ * @details Volatile and uncovered registers are not recorded.
+ */
+void I2CRegisterCache::store(uint8_t registerAddress, uint8_t value)
+{
+  if (isCacheable(registerAddress))
+  {
+    m_values[registerAddress - m_firstRegister] = value;
+    putBit(m_valid, registerAddress - m_firstRegister, true);
+  }
+}
+
+void I2CRegisterCache::setVolatile(uint8_t registerAddress, uint8_t count)
+{
+  for (uint8_t i = 0; i < count; ++i)
+  {
+    uint8_t reg = registerAddress + i;
+    if (covers(reg))
+    {
+      putBit(m_volatileRegisters, reg - m_firstRegister, true);
+      putBit(m_valid, reg - m_firstRegister, false);
+    }
+  }
+}
+
+void I2CRegisterCache::preset(uint8_t registerAddress, uint8_t value)
+{
+  store(registerAddress, value);
+}
+
+void I2CRegisterCache::invalidate()
+{
+  memset(m_valid, 0, (m_count + 7) / 8);
+}
+
+void I2CRegisterCache::invalidate(uint8_t registerAddress, uint8_t count)
+{
+  for (uint8_t i = 0; i < count; ++i)
+  {
+    uint8_t reg = registerAddress + i;
+    if (covers(reg))
+    {
+      putBit(m_valid, reg - m_firstRegister, false);
+    }
+  }
+}
+
+uint8_t I2CRegisterCache::read(uint8_t registerAddress, uint8_t &value)
+{
+  return read(registerAddress, &value, 1);
+}
+
+uint8_t I2CRegisterCache::read(uint8_t registerAddress, uint8_t *buffer, uint8_t count)
+{
+  // Serve the cached registers at both ends from RAM
+  uint8_t first = 0;
+  while (first < count && isCached(registerAddress + first))
+  {
+    buffer[first] = m_values[registerAddress + first - m_firstRegister];
+    first++;
+  }
+  uint8_t end = count;
+  while (end > first && isCached(registerAddress + end - 1))
+  {
+    end--;
+    buffer[end] = m_values[registerAddress + end - m_firstRegister];
+  }
+  statistics.hits += count - (end - first);
+  if (first == end)
+  {
+    return 0;
+  }
+
+  uint8_t status = I2c.read(m_address, (uint8_t)(registerAddress + first), (uint8_t)(end - first),
+                            buffer + first);
+  if (status)
+  {
+    return status;
+  }
+  statistics.reads += end - first;
+  for (uint8_t i = first; i < end; ++i)
+  {
+    store(registerAddress + i, buffer[i]);
+  }
+  return 0;
+}
+
+uint8_t I2CRegisterCache::write(uint8_t registerAddress, uint8_t value)
+{
+  return write(registerAddress, &value, 1);
+}
+
+uint8_t I2CRegisterCache::write(uint8_t registerAddress, const uint8_t *data, uint8_t count)
+{
+  // Leave out the registers at both ends that already hold their value
+  uint8_t first = 0;
+  while (first < count && isCached(registerAddress + first) &&
+         m_values[registerAddress + first - m_firstRegister] == data[first])
+  {
+    first++;
+  }
+  uint8_t end = count;
+  while (end > first && isCached(registerAddress + end - 1) &&
+         m_values[registerAddress + end - 1 - m_firstRegister] == data[end - 1])
+  {
+    end--;
+  }
+  statistics.skipped += count - (end - first);
+  if (first == end)
+  {
+    return 0;
+  }
+
+  uint8_t status = I2c.write(m_address, (uint8_t)(registerAddress + first), data + first,
+                             (uint8_t)(end - first));
+  if (status)
+  {
+    invalidate(registerAddress + first, end - first);
+    return status;
+  }
+  statistics.writes += end - first;
+  for (uint8_t i = first; i < end; ++i)
+  {
+    store(registerAddress + i, data[i]);
+  }
+  return 0;
+}
+
+uint8_t I2CRegisterCache::update(uint8_t registerAddress, uint8_t mask, uint8_t bits)
+{
+  uint8_t value;
+  uint8_t status = read(registerAddress, value);
+  if (status)
+  {
+    return status;
+  }
+  return write(registerAddress, (uint8_t)((value & ~mask) | (bits & mask)));
+}
+
+void I2CRegisterCache::resetStatistics()
+{
+  statistics = Statistics{0, 0, 0, 0};
+}
@@ -0,0 +1,240 @@
+/**
+ * @file I2CRegisterCache.h
+ * @brief Write-through RAM copy of a device's registers.
+ *
+ * Drivers configure devices with read-modify-write sequences, and each
+ * read costs a whole bus transaction although the firmware is the only
+ * one changing those registers. A register cache keeps the last value
+ * read or written for each register and talks to the device through I2c
+ * only when it has to:
+ * - Reads of cached registers come from RAM.
+ * - Writes of the value a register already holds are left out; multi-byte
+ *   writes send only the span from the first to the last changed byte.
+ * - Registers marked volatile, such as status and data registers the
+ *   device changes itself, always go to the bus.
+ * @code
+ * I2CShadowRegisters<13> compass(0x1E); // registers 0x00-0x0C
+ *
+ * // In setup(), after I2c.begin()
+ * compass.setVolatile(0x03, 7);             // data and status
+ * compass.update(0x00, 0x1C, 0x18);         // output rate bits of CONFIG_A
+ * compass.write(0x02, 0x00);                // continuous mode
+ * @endcode
+ *
+ * The cache trusts that nothing else writes the registers it holds; call
+ * invalidate() after a device reset or a write that bypasses it. Multi-byte
+ * calls need a device that auto-increments its register pointer. The cache
+ * uses the polled I2c methods, so with the I2CEngine running use it only
+ * while i2cEngine.isIdle().
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+#ifndef I2C_REGISTER_CACHE_H
+#define I2C_REGISTER_CACHE_H
+
+#include <Arduino.h>
+#include "I2C.h"
+
+/**
+ * @class I2CRegisterCache
+ * @brief Register cache of one device over caller-provided storage
+ *
+ * @details Covers the 8-bit registers firstRegister to
+ * firstRegister + count - 1; registers outside that range pass straight
+ * through to the bus. Declare an I2CShadowRegisters, which brings its own
+ * storage, rather than this class.
+ *
+ * All transfer functions return the I2c status: 0 on success, or the error
+ * of the transfer. A failed write forgets the registers it covered, since
+ * the device may have taken part of it.
+ */
+class I2CRegisterCache
+{
+public:
+  /**
+   * @brief Byte counters since construction or resetStatistics()
+   *
+   * The counters wrap at 65535.
+   */
+  struct Statistics
+  {
+    uint16_t hits;    ///< Register bytes read from RAM
+    uint16_t reads;   ///< Register bytes read over the bus
+    uint16_t writes;  ///< Register bytes written over the bus
+    uint16_t skipped; ///< Register bytes not written because they held the value
+  };
+
+  Statistics statistics; ///< Counters, updated by the transfer functions
+
+  /**
+   * @brief Constructor
+   *
+   * @param address 7-bit device address
+   * @param firstRegister Lowest cached register
+   * @param count Number of cached registers
+   * @param values One byte per register
+   * @param valid One bit per register, zeroed
+   * @param volatileRegisters One bit per register, zeroed
+   */
+  I2CRegisterCache(uint8_t address, uint8_t firstRegister, uint8_t count, uint8_t *values,
+                   uint8_t *valid, uint8_t *volatileRegisters);
+
+  /**
+   * @brief Gets the device address
+   *
+   * @return uint8_t 7-bit address
+   */
+  uint8_t getAddress() const { return m_address; }
+
+  /**
+   * @brief Marks registers the device changes on its own
+   *
+   * Volatile registers are read from and written to the bus every time.
+   *
+   * @param registerAddress First register
+   * @param count Number of registers
+   */
+  void setVolatile(uint8_t registerAddress, uint8_t count = 1);
+
+  /**
+   * @brief Sets a register's value without bus traffic
+   *
+   * For values known without asking, such as the datasheet reset value
+   * after a device reset. Ignored for volatile and uncached registers.
+   *
+   * @param registerAddress The register
+   * @param value Its value in the device
+   */
+  void preset(uint8_t registerAddress, uint8_t value);
+
+  /**
+   * @brief Forgets all cached values, so the next access reads the device
+   */
+  void invalidate();
+
+  /**
+   * @brief Forgets cached values of some registers
+   *
+   * @param registerAddress First register
+   * @param count Number of registers
+   */
+  void invalidate(uint8_t registerAddress, uint8_t count = 1);
+
+  /**
+   * @brief Checks whether reading a register needs no bus traffic
+   *
+   * @param registerAddress The register
+   * @return true if its value is cached
+   */
+  bool isCached(uint8_t registerAddress) const;
+
+  /**
+   * @brief Reads a register
+   *
+   * @param registerAddress The register
+   * @param value Receives its value
+   * @return uint8_t Status code (0 for success)
+   */
+  uint8_t read(uint8_t registerAddress, uint8_t &value);
+
+  /**
+   * @brief Reads consecutive registers
+   *
+   * Cached registers at either end of the range come from RAM; the rest
+   * is read in one transfer and cached.
+   *
+   * @param registerAddress First register
+   * @param buffer Receives the values
+   * @param count Number of registers
+   * @return uint8_t Status code (0 for success)
+   */
+  uint8_t read(uint8_t registerAddress, uint8_t *buffer, uint8_t count);
+
+  /**
+   * @brief Writes a register, unless it already holds the value
+   *
+   * @param registerAddress The register
+   * @param value New value
+   * @return uint8_t Status code (0 for success)
+   */
+  uint8_t write(uint8_t registerAddress, uint8_t value);
+
+  /**
+   * @brief Writes consecutive registers
+   *
+   * Registers at either end of the range that already hold their new
+   * value are left out; the rest is written in one transfer.
+   *
+   * @param registerAddress First register
+   * @param data New values
+   * @param count Number of registers
+   * @return uint8_t Status code (0 for success)
+   */
+  uint8_t write(uint8_t registerAddress, const uint8_t *data, uint8_t count);
+
+  /**
+   * @brief Changes some bits of a register
+   *
+   * Reads the register (from RAM when cached), replaces the bits in mask
+   * with those of bits and writes the result if it differs.
+   *
+   * @param registerAddress The register
+   * @param mask Bits to change
+   * @param bits Their new values
+   * @return uint8_t Status code (0 for success)
+   */
+  uint8_t update(uint8_t registerAddress, uint8_t mask, uint8_t bits);
+
+  /**
+   * @brief Clears the counters
+   */
+  void resetStatistics();
+
+private:
+  bool covers(uint8_t registerAddress) const;
+  bool isCacheable(uint8_t registerAddress) const;
+  void store(uint8_t registerAddress, uint8_t value);
+
+  uint8_t m_address;
+  uint8_t m_firstRegister;
+  uint8_t m_count;
+  uint8_t *m_values;
+  uint8_t *m_valid;             ///< Bit per register: m_values holds the device's value
+  uint8_t *m_volatileRegisters; ///< Bit per register: never cached
+};
+
+/**
+ * @brief Register cache with its storage
+ *
+ * Takes COUNT + 2 * ceil(COUNT / 8) bytes of RAM besides the cache itself.
+ *
+ * @tparam COUNT Number of cached registers, 1-255
+ */
+template <uint8_t COUNT>
+class I2CShadowRegisters : public I2CRegisterCache
+{
+public:
+  /**
+   * @brief Constructor
+   *
+   * @param address 7-bit device address
+   * @param firstRegister Lowest cached register
+   */
+  explicit I2CShadowRegisters(uint8_t address, uint8_t firstRegister = 0)
+      : I2CRegisterCache(address, firstRegister, COUNT, m_values, m_valid, m_volatile),
+        m_values(),
+        m_valid(),
+        m_volatile()
+  {
+  }
+
+private:
+  static_assert(COUNT > 0, "I2CShadowRegisters needs at least one register");
+
+  uint8_t m_values[COUNT];
+  uint8_t m_valid[(COUNT + 7) / 8];
+  uint8_t m_volatile[(COUNT + 7) / 8];
+};
+
+#endif // I2C_REGISTER_CACHE_H
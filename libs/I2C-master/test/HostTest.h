@@ -0,0 +1,63 @@
+/**
+ * @file HostTest.h
+ * @brief Checks for the host tests of the I2C library.
+ *
+ * Failed checks are reported with file and line; main() returns
+ * hostTestResult() so ctest sees the outcome.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+
+static int hostTestFailures = 0;
+
+#define CHECK(condition)                                                 \
+  do                                                                     \
+  {                                                                      \
+    if (!(condition))                                                    \
+    {                                                                    \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+      hostTestFailures++;                                                \
+    }                                                                    \
+  } while (0)
+
+#define CHECK_EQUAL(expected, actual)                                           \
+  do                                                                            \
+  {                                                                             \
+    long long _expected = (long long)(expected);                                \
+    long long _actual = (long long)(actual);                                    \
+    if (_expected != _actual)                                                   \
+    {                                                                           \
+      printf("%s:%d: %s is %lld (0x%llx), expected %lld (0x%llx)\n", __FILE__, \
+             __LINE__, #actual, _actual, _actual, _expected, _expected);        \
+      hostTestFailures++;                                                       \
+    }                                                                           \
+  } while (0)
+
+#define CHECK_TRACE(expected)                                                        \
+  do                                                                                 \
+  {                                                                                  \
+    if (Twi.getTrace() != (expected))                                                \
+    {                                                                                \
+      printf("%s:%d: trace is \"%s\", expected \"%s\"\n", __FILE__, __LINE__,       \
+             Twi.getTrace().c_str(), (expected));                                    \
+      hostTestFailures++;                                                            \
+    }                                                                                \
+    Twi.clearTrace();                                                                \
+  } while (0)
+
+/**
+ * @brief Print the summary and return the exit code for main()
+ */
+inline int hostTestResult(const char *name)
+{
+  printf("%s: %s\n", name, hostTestFailures ? "FAILED" : "passed");
+  return hostTestFailures ? 1 : 0;
+}
+
+#endif // HOST_TEST_H
@@ -0,0 +1,140 @@
+/**
+ * @file VirtualDevices.cpp
+ * @brief Slave models for the virtual TWI bus.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include "VirtualDevices.h"
+
+#include <string.h>
+
+// ---------------- RegisterFile ----------------
+
+RegisterFile::RegisterFile(uint8_t address, uint32_t size, uint8_t addressBytes)
+    : VirtualDevice(address), m_memory(new uint8_t[size]), m_size(size),
+      m_addressBytes(addressBytes), m_pointer(0), m_addressCount(0), m_wrote(false),
+      m_writeCycle(0), m_busyUntil(0), m_writeCount(0), m_readCount(0)
+{
+  memset(m_memory, 0xFF, size);
+}
+
+RegisterFile::~RegisterFile()
+{
+  delete[] m_memory;
+}
+
+bool RegisterFile::select(bool read)
+{
+  if (Twi.now() < m_busyUntil)
+  {
+    return false;
+  }
+  m_addressCount = read ? m_addressBytes : 0;
+  m_wrote = false;
+  return true;
+}
+
+bool RegisterFile::write(uint8_t data)
+{
+  if (m_addressCount < m_addressBytes)
+  {
+    m_pointer = (m_addressCount ? (uint16_t)(m_pointer << 8) : 0) | data;
+    m_pointer %= m_size;
+    m_addressCount++;
+    return true;
+  }
+  store(m_pointer, data);
+  m_pointer = nextIndex(m_pointer);
+  m_wrote = true;
+  m_writeCount++;
+  return true;
+}
+
+uint8_t RegisterFile::read(bool)
+{
+  uint8_t data = fetch(m_pointer);
+  m_pointer = nextIndex(m_pointer);
+  m_readCount++;
+  return data;
+}
+
+void RegisterFile::stop()
+{
+  if (m_wrote && m_writeCycle)
+  {
+    m_busyUntil = Twi.now() + m_writeCycle;
+  }
+  m_wrote = false;
+}
+
+// ---------------- VirtualHMC5883L ----------------
+
+VirtualHMC5883L::VirtualHMC5883L()
+    : RegisterFile(0x1E, 13)
+{
+  static const uint8_t defaults[13] = {0x10, 0x20, 0x01, 0, 0, 0, 0, 0, 0, 0x00, 'H', '4', '3'};
+  memcpy(m_memory, defaults, sizeof(defaults));
+}
+
+void VirtualHMC5883L::setField(int16_t x, int16_t y, int16_t z)
+{
+  const int16_t values[3] = {x, z, y};
+  for (uint8_t i = 0; i < 3; ++i)
+  {
+    m_memory[DATA_X_MSB + 2 * i] = (uint16_t)values[i] >> 8;
+    m_memory[DATA_X_MSB + 2 * i + 1] = values[i] & 0xFF;
+  }
+  m_memory[STATUS] |= 0x01;
+}
+
+void VirtualHMC5883L::store(uint16_t index, uint8_t data)
+{
+  if (index <= MODE)
+  {
+    m_memory[index] = data;
+  }
+}
+
+uint8_t VirtualHMC5883L::fetch(uint16_t index)
+{
+  uint8_t data = m_memory[index];
+  if (index == DATA_Y_LSB)
+  {
+    m_memory[STATUS] &= ~0x01;
+  }
+  return data;
+}
+
+uint16_t VirtualHMC5883L::nextIndex(uint16_t index) const
+{
+  if (index == DATA_Y_LSB)
+  {
+    return DATA_X_MSB;
+  }
+  const uint32_t next = static_cast<uint32_t>(index) + 1;
+  return next < m_size ? next : 0;
+}
+
+// ---------------- NackingDevice ----------------
+
+bool NackingDevice::select(bool read)
+{
+  m_written = 0;
+  if (m_nackAddress)
+  {
+    return false;
+  }
+  return m_device.select(read);
+}
+
+bool NackingDevice::write(uint8_t data)
+{
+  if (m_nackAfter && m_written >= m_nackAfter)
+  {
+    return false;
+  }
+  m_written++;
+  return m_device.write(data);
+}
@@ -0,0 +1,203 @@
+/**
+ * @file VirtualDevices.h
+ * @brief Slave models for the virtual TWI bus.
+ *
+ * - RegisterFile: register-based device or EEPROM with 8 or 16-bit
+ *   register addresses and an optional internal write cycle.
+ * - VirtualHMC5883L: the HMC5883L magnetometer register map.
+ * - StretchingDevice: holds SCL low before every byte of another device.
+ * - NackingDevice: refuses the address or data bytes of another device.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#ifndef VIRTUAL_DEVICES_H
+#define VIRTUAL_DEVICES_H
+
+#include "VirtualTwi.h"
+
+/**
+ * @brief Device with an auto-incrementing register pointer.
+ *
+ * A write transfer sets the pointer with its first one or two bytes and
+ * stores the rest; a read transfer returns bytes from the pointer on. The
+ * pointer wraps at the end of the memory. With a write cycle set, the
+ * device NACKs its address for that long after a STOP that ended a write,
+ * like an EEPROM programming its page.
+ */
+class RegisterFile : public VirtualDevice
+{
+public:
+  /**
+   * @brief Constructor
+   *
+   * @param address 7-bit I2C address
+   * @param size Memory size in bytes, at most 65536
+   * @param addressBytes Size of the register address: 1 or 2
+   */
+  RegisterFile(uint8_t address, uint32_t size = 256, uint8_t addressBytes = 1);
+  ~RegisterFile();
+
+  /**
+   * @brief Set the internal write cycle time
+   *
+   * @param us Microseconds, 0 (default) for none
+   */
+  void setWriteCycle(uint32_t us) { m_writeCycle = us * 1000ULL; }
+
+  /** @brief Memory access without bus traffic */
+  uint8_t &operator[](uint16_t index) { return m_memory[index % m_size]; }
+
+  /** @brief The register pointer */
+  uint16_t getPointer() const { return m_pointer; }
+
+  /** @brief Bytes stored by the master */
+  uint32_t getWriteCount() const { return m_writeCount; }
+
+  /** @brief Bytes read by the master */
+  uint32_t getReadCount() const { return m_readCount; }
+
+  /** @brief Forget the byte counts */
+  void resetCounts() { m_writeCount = m_readCount = 0; }
+
+  bool select(bool read) override;
+  bool write(uint8_t data) override;
+  uint8_t read(bool ack) override;
+  void stop() override;
+
+protected:
+  /**
+   * @brief Store a byte written by the master
+   *
+   * Override to give registers read-only bits or side effects.
+   */
+  virtual void store(uint16_t index, uint8_t data) { m_memory[index] = data; }
+
+  /**
+   * @brief Fetch a byte read by the master
+   */
+  virtual uint8_t fetch(uint16_t index) { return m_memory[index]; }
+
+  /**
+   * @brief Register after index, where the pointer moves to
+   */
+  virtual uint16_t nextIndex(uint16_t index) const { return (index + 1) % m_size; }
+
+  uint8_t *m_memory;
+  uint32_t m_size;
+  uint8_t m_addressBytes;
+  uint16_t m_pointer;
+  uint8_t m_addressCount; ///< Register address bytes received in this transfer
+  bool m_wrote;           ///< This transfer stored data
+  uint64_t m_writeCycle;
+  uint64_t m_busyUntil;
+  uint32_t m_writeCount;
+  uint32_t m_readCount;
+};
+
+/**
+ * @brief HMC5883L 3-axis magnetometer at address 0x1E.
+ *
+ * Registers 0-2 configure it, 3-8 hold X, Z and Y (MSB first), 9 is the
+ * status and 10-12 the identification "H43". Only 0-2 are writable. After
+ * register 8 the pointer returns to 3, after 12 to 0, as in the datasheet.
+ */
+class VirtualHMC5883L : public RegisterFile
+{
+public:
+  /** @brief Register addresses */
+  enum Register : uint8_t
+  {
+    CONFIG_A = 0,
+    CONFIG_B = 1,
+    MODE = 2,
+    DATA_X_MSB = 3,
+    DATA_Y_LSB = 8,
+    STATUS = 9,
+    ID_A = 10
+  };
+
+  VirtualHMC5883L();
+
+  /**
+   * @brief Publish a new measurement and set the ready bit
+   *
+   * The ready bit clears when the master reads the last data register.
+   */
+  void setField(int16_t x, int16_t y, int16_t z);
+
+protected:
+  void store(uint16_t index, uint8_t data) override;
+  uint8_t fetch(uint16_t index) override;
+  uint16_t nextIndex(uint16_t index) const override;
+};
+
+/**
+ * @brief Wraps a device and stretches the clock before each of its bytes.
+ */
+class StretchingDevice : public VirtualDevice
+{
+public:
+  /**
+   * @brief Constructor
+   *
+   * @param device Device to wrap; attach this object instead of it
+   * @param us Stretch in microseconds
+   */
+  StretchingDevice(VirtualDevice &device, uint32_t us)
+      : VirtualDevice(device.getAddress()), m_device(device), m_stretch(us * 1000) {}
+
+  /** @brief Change the stretch */
+  void setStretch(uint32_t us) { m_stretch = us * 1000; }
+
+  bool select(bool read) override { return m_device.select(read); }
+  bool write(uint8_t data) override { return m_device.write(data); }
+  uint8_t read(bool ack) override { return m_device.read(ack); }
+  void stop() override { m_device.stop(); }
+  uint32_t stretch() override { return m_stretch; }
+
+private:
+  VirtualDevice &m_device;
+  uint32_t m_stretch;
+};
+
+/**
+ * @brief Wraps a device and refuses some of its traffic.
+ */
+class NackingDevice : public VirtualDevice
+{
+public:
+  /**
+   * @brief Constructor
+   *
+   * @param device Device to wrap; attach this object instead of it
+   */
+  explicit NackingDevice(VirtualDevice &device)
+      : VirtualDevice(device.getAddress()), m_device(device), m_nackAddress(false),
+        m_nackAfter(0), m_written(0) {}
+
+  /** @brief NACK the address, as an absent or busy device does */
+  void nackAddress(bool nack) { m_nackAddress = nack; }
+
+  /**
+   * @brief NACK data bytes after a number of accepted ones per transfer
+   *
+   * @param bytes Bytes to accept, 0 to accept all
+   */
+  void nackAfter(uint16_t bytes) { m_nackAfter = bytes; }
+
+  bool select(bool read) override;
+  bool write(uint8_t data) override;
+  uint8_t read(bool ack) override { return m_device.read(ack); }
+  void stop() override { m_device.stop(); }
+  uint32_t stretch() override { return m_device.stretch(); }
+
+private:
+  VirtualDevice &m_device;
+  bool m_nackAddress;
+  uint16_t m_nackAfter;
+  uint16_t m_written;
+};
+
+#endif // VIRTUAL_DEVICES_H
@@ -0,0 +1,410 @@
+/**
+ * @file VirtualTwi.cpp
+ * @brief Host model of the AVR TWI unit and the bus behind it.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include "VirtualTwi.h"
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+/** Time a step never completes in */
+#define NEVER UINT64_MAX
+
+/** TWSR status codes, as in the datasheet */
+#define STATUS_START 0x08
+#define STATUS_REPEATED_START 0x10
+#define STATUS_MT_SLA_ACK 0x18
+#define STATUS_MT_SLA_NACK 0x20
+#define STATUS_MT_DATA_ACK 0x28
+#define STATUS_MT_DATA_NACK 0x30
+#define STATUS_LOST_ARBITRATION 0x38
+#define STATUS_MR_SLA_ACK 0x40
+#define STATUS_MR_SLA_NACK 0x48
+#define STATUS_MR_DATA_ACK 0x50
+#define STATUS_MR_DATA_NACK 0x58
+#define STATUS_NO_INFO 0xF8
+#define STATUS_BUS_ERROR 0x00
+
+// Weak, so sketches without an interrupt-driven driver link too
+extern "C" void TWI_vect(void) __attribute__((weak));
+
+VirtualTwi Twi;
+TwcrRegister TWCR;
+TwsrRegister TWSR;
+TwdrRegister TWDR;
+
+namespace host
+{
+  uint64_t nanos()
+  {
+    return Twi.now();
+  }
+
+  void advance(uint64_t ns)
+  {
+    Twi.advance(ns);
+  }
+}
+
+VirtualTwi::VirtualTwi()
+    : m_deviceCount(0), m_now(0), m_pollTime(500), m_tracing(false)
+{
+  reset();
+}
+
+void VirtualTwi::attach(VirtualDevice &device)
+{
+  if (m_deviceCount < sizeof(m_devices) / sizeof(m_devices[0]))
+  {
+    m_devices[m_deviceCount++] = &device;
+  }
+}
+
+void VirtualTwi::detach(VirtualDevice &device)
+{
+  for (uint8_t i = 0; i < m_deviceCount; ++i)
+  {
+    if (m_devices[i] == &device)
+    {
+      if (m_selected == &device)
+      {
+        m_selected = nullptr;
+      }
+      m_devices[i] = m_devices[--m_deviceCount];
+      return;
+    }
+  }
+}
+
+void VirtualTwi::reset()
+{
+  bitRate = 0;
+  m_selected = nullptr;
+  m_stepStart = m_stepEnd = m_stopEnd = 0;
+  m_step = STEP_IDLE;
+  m_control = 0;
+  m_interruptFlag = false;
+  m_stopPending = false;
+  m_collision = false;
+  m_status = STATUS_NO_INFO;
+  m_prescaler = 0;
+  m_data = 0xFF;
+  m_result = STATUS_NO_INFO;
+  m_owner = false;
+  m_reading = false;
+  m_sclHeld = false;
+  m_inInterrupt = false;
+  m_fault = NO_FAULT;
+  m_trace.clear();
+  resetStatistics();
+}
+
+void VirtualTwi::resetStatistics()
+{
+  m_statistics = Statistics();
+}
+
+uint32_t VirtualTwi::getSclFrequency() const
+{
+  return F_CPU / (16 + 2UL * bitRate * (1UL << (2 * m_prescaler)));
+}
+
+uint64_t VirtualTwi::bitTime() const
+{
+  return 1000000000ULL * (16 + 2ULL * bitRate * (1ULL << (2 * m_prescaler))) / F_CPU;
+}
+
+void VirtualTwi::holdScl(bool hold)
+{
+  m_sclHeld = hold;
+  if (hold)
+  {
+    if (m_step != STEP_IDLE)
+    {
+      m_stepEnd = NEVER;
+    }
+    if (m_stopPending)
+    {
+      m_stopEnd = NEVER;
+    }
+    return;
+  }
+  if (m_step != STEP_IDLE && m_stepEnd == NEVER)
+  {
+    m_stepEnd = m_now + bitTime();
+  }
+  if (m_stopPending && m_stopEnd == NEVER)
+  {
+    m_stopEnd = m_now + bitTime();
+  }
+}
+
+void VirtualTwi::trace(const char *text)
+{
+  if (!m_tracing)
+  {
+    return;
+  }
+  if (!m_trace.empty())
+  {
+    m_trace += ' ';
+  }
+  m_trace += text;
+}
+
+void VirtualTwi::begin(Step step, uint64_t duration)
+{
+  m_step = step;
+  m_stepStart = m_now;
+  m_stepEnd = m_sclHeld ? NEVER : m_now + duration;
+  m_statistics.busyTime += duration;
+}
+
+void VirtualTwi::endTransfer()
+{
+  if (m_selected)
+  {
+    m_selected->stop();
+    m_selected = nullptr;
+  }
+}
+
+void VirtualTwi::complete()
+{
+  if (m_step == STEP_DATA && m_reading)
+  {
+    m_data = m_received;
+  }
+  m_step = STEP_IDLE;
+  m_status = m_result;
+  m_interruptFlag = true;
+}
+
+void VirtualTwi::advance(uint64_t ns)
+{
+  run(m_now + ns, true);
+}
+
+void VirtualTwi::run(uint64_t until, bool interrupts)
+{
+  for (;;)
+  {
+    if (interrupts && !m_inInterrupt && m_interruptFlag && (m_control & _BV(TWIE)) &&
+        (m_control & _BV(TWEN)) && (SREG & SREG_I) && TWI_vect)
+    {
+      m_inInterrupt = true;
+      m_statistics.interrupts++;
+      TWI_vect();
+      m_inInterrupt = false;
+      if (m_interruptFlag && (m_control & _BV(TWIE)))
+      {
+        // The handler left TWINT set, so the hardware would call it forever
+        fprintf(stderr, "VirtualTwi: TWI_vect returned with TWINT and TWIE set\n");
+        abort();
+      }
+      continue;
+    }
+
+    uint64_t next = NEVER;
+    if (m_stopPending)
+    {
+      next = m_stopEnd;
+    }
+    if (m_step != STEP_IDLE && m_stepEnd < next)
+    {
+      next = m_stepEnd;
+    }
+    if (next == NEVER || next > until)
+    {
+      break;
+    }
+    if (next > m_now)
+    {
+      m_now = next;
+    }
+    if (m_stopPending && m_stopEnd <= m_now)
+    {
+      m_stopPending = false;
+    }
+    if (m_step != STEP_IDLE && m_stepEnd <= m_now)
+    {
+      complete();
+    }
+  }
+  if (until > m_now)
+  {
+    m_now = until;
+  }
+}
+
+uint8_t VirtualTwi::readControl()
+{
+  if (m_sclHeld && (m_step != STEP_IDLE || m_stopPending) &&
+      m_now - m_stepStart > (uint64_t)VIRTUAL_TWI_HANG_LIMIT_MS * 1000000)
+  {
+    fprintf(stderr, "VirtualTwi: driver polled a held bus for %d ms\n", VIRTUAL_TWI_HANG_LIMIT_MS);
+    abort();
+  }
+  run(m_now + m_pollTime, false);
+  return m_control | (m_interruptFlag ? _BV(TWINT) : 0) | (m_stopPending ? _BV(TWSTO) : 0) |
+         (m_collision ? _BV(TWWC) : 0);
+}
+
+void VirtualTwi::writeData(uint8_t value)
+{
+  if (!m_interruptFlag)
+  {
+    m_collision = true;
+    m_statistics.writeCollisions++;
+    return;
+  }
+  m_collision = false;
+  m_data = value;
+}
+
+void VirtualTwi::writeControl(uint8_t value)
+{
+  if (!(value & _BV(TWEN)))
+  {
+    if (m_control & _BV(TWEN))
+    {
+      trace("reset");
+      m_statistics.resets++;
+    }
+    endTransfer();
+    m_owner = false;
+    m_step = STEP_IDLE;
+    m_stopPending = false;
+    m_interruptFlag = false;
+    m_status = STATUS_NO_INFO;
+    m_control = value & ~(_BV(TWINT) | _BV(TWSTO) | _BV(TWWC));
+    return;
+  }
+
+  m_control = value & ~(_BV(TWINT) | _BV(TWSTO) | _BV(TWWC));
+  if (!(value & _BV(TWINT)) || m_step != STEP_IDLE)
+  {
+    // Writing TWINT as 0, or while a step runs, only changes the enable bits
+    return;
+  }
+  m_interruptFlag = false;
+
+  uint64_t stopTime = 0;
+  if (value & _BV(TWSTO))
+  {
+    if (m_owner)
+    {
+      trace("P");
+      m_statistics.stops++;
+      endTransfer();
+      m_owner = false;
+      stopTime = bitTime();
+      m_statistics.busyTime += stopTime;
+      m_stopPending = true;
+      m_stepStart = m_now;
+      m_stopEnd = m_sclHeld ? NEVER : m_now + stopTime;
+    }
+    if (!(value & _BV(TWSTA)))
+    {
+      return;
+    }
+  }
+
+  Fault fault = m_fault;
+  m_fault = NO_FAULT;
+
+  if (value & _BV(TWSTA))
+  {
+    bool repeated = m_owner;
+    if (repeated)
+    {
+      endTransfer();
+      m_statistics.repeatedStarts++;
+    }
+    trace(repeated ? "Sr" : "S");
+    m_statistics.starts++;
+    m_owner = true;
+    m_result = repeated ? STATUS_REPEATED_START : STATUS_START;
+  }
+  else if (!m_owner)
+  {
+    // Data steps need the bus
+    return;
+  }
+  else if (m_status == STATUS_START || m_status == STATUS_REPEATED_START)
+  {
+    uint8_t address = m_data >> 1;
+    m_reading = m_data & 0x01;
+    VirtualDevice *device = nullptr;
+    for (uint8_t i = 0; i < m_deviceCount; ++i)
+    {
+      if (m_devices[i]->getAddress() == address)
+      {
+        device = m_devices[i];
+        break;
+      }
+    }
+    bool ack = fault == NO_FAULT && device && device->select(m_reading);
+    m_selected = ack ? device : nullptr;
+    m_statistics.bytesWritten++;
+    if (!ack && fault == NO_FAULT)
+    {
+      m_statistics.nacks++;
+    }
+    char text[8];
+    snprintf(text, sizeof(text), "%02X%c%c", address, m_reading ? 'R' : 'W', ack ? '+' : '-');
+    trace(text);
+    m_result = m_reading ? (ack ? STATUS_MR_SLA_ACK : STATUS_MR_SLA_NACK)
+                         : (ack ? STATUS_MT_SLA_ACK : STATUS_MT_SLA_NACK);
+    begin(STEP_ADDRESS, 9 * bitTime() + (m_selected ? m_selected->stretch() : 0));
+  }
+  else
+  {
+    bool ack;
+    uint8_t data;
+    if (m_reading)
+    {
+      ack = (value & _BV(TWEA)) != 0;
+      data = m_selected ? m_selected->read(ack) : 0xFF;
+      m_statistics.bytesRead++;
+      m_result = ack ? STATUS_MR_DATA_ACK : STATUS_MR_DATA_NACK;
+    }
+    else
+    {
+      data = m_data;
+      ack = m_selected && m_selected->write(data);
+      m_statistics.bytesWritten++;
+      if (!ack)
+      {
+        m_statistics.nacks++;
+      }
+      m_result = ack ? STATUS_MT_DATA_ACK : STATUS_MT_DATA_NACK;
+    }
+    char text[8];
+    snprintf(text, sizeof(text), "%02X%c", data, ack ? '+' : '-');
+    trace(text);
+    m_received = data;
+    begin(STEP_DATA, 9 * bitTime() + (m_selected ? m_selected->stretch() : 0));
+  }
+
+  if (m_step == STEP_IDLE)
+  {
+    begin(STEP_START, stopTime + bitTime());
+  }
+  if (fault != NO_FAULT)
+  {
+    trace(fault == LOST_ARBITRATION ? "lost" : "error");
+    endTransfer();
+    m_owner = false;
+    m_result = fault == LOST_ARBITRATION ? STATUS_LOST_ARBITRATION : STATUS_BUS_ERROR;
+  }
+}
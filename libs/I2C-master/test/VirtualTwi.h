@@ -0,0 +1,320 @@
+/**
+ * @file VirtualTwi.h
+ * @brief Host model of the AVR TWI unit and the bus behind it.
+ *
+ * TWCR, TWSR, TWDR and TWBR behave like the ATmega328P registers, so the
+ * unmodified I2C and I2CEngine sources run on a PC against VirtualDevice
+ * models attached to the bus:
+ *
+ * - Writing TWCR with TWINT set starts a START, STOP, address or data step.
+ *   The step completes after its bus time at the SCL rate set by TWBR and
+ *   the prescaler, plus any clock stretching by the device; then TWINT is
+ *   set and TWSR holds the datasheet status code.
+ * - Time is virtual (see host::nanos()). Every read of TWCR costs
+ *   setPollTime() nanoseconds, which is how a polling driver lets time
+ *   pass. host::advance() moves time for the test and runs TWI_vect when
+ *   TWIE, TWINT and the global interrupt flag are set, so interrupt
+ *   handlers run between driver calls and never inside one.
+ * - Writing TWCR without TWEN resets the unit, as lockUp() does.
+ * - Faults can be injected: a held SCL line, lost arbitration and bus
+ *   errors. A driver that polls a held bus for VIRTUAL_TWI_HANG_LIMIT_MS
+ *   aborts the program instead of hanging the test.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#ifndef VIRTUAL_TWI_H
+#define VIRTUAL_TWI_H
+
+#include <stdint.h>
+#include <string>
+
+/**
+ * @brief Virtual time a driver may poll a bus that never completes.
+ */
+#ifndef VIRTUAL_TWI_HANG_LIMIT_MS
+#define VIRTUAL_TWI_HANG_LIMIT_MS 10000
+#endif
+
+/**
+ * @brief A slave on the virtual bus.
+ *
+ * A transfer starts with select() and ends with stop(), called for a STOP,
+ * a repeated START or a reset of the TWI unit.
+ */
+class VirtualDevice
+{
+public:
+  /**
+   * @brief Constructor
+   *
+   * @param address 7-bit I2C address the device answers to
+   */
+  explicit VirtualDevice(uint8_t address) : m_address(address) {}
+  virtual ~VirtualDevice() {}
+
+  /**
+   * @brief Get the 7-bit address of the device
+   */
+  uint8_t getAddress() const { return m_address; }
+
+  /**
+   * @brief The device was addressed
+   *
+   * @param read True for SLA+R, false for SLA+W
+   * @return True to ACK the address
+   */
+  virtual bool select(bool read) = 0;
+
+  /**
+   * @brief The master sent a data byte
+   *
+   * @param data The byte
+   * @return True to ACK it
+   */
+  virtual bool write(uint8_t data) = 0;
+
+  /**
+   * @brief The master clocks in a data byte
+   *
+   * @param ack True if the master will ACK it and read on
+   * @return The byte
+   */
+  virtual uint8_t read(bool ack) = 0;
+
+  /**
+   * @brief The transfer ended
+   */
+  virtual void stop() {}
+
+  /**
+   * @brief Time the device holds SCL low before the next byte completes
+   *
+   * @return Stretch in nanoseconds
+   */
+  virtual uint32_t stretch() { return 0; }
+
+protected:
+  uint8_t m_address; ///< 7-bit I2C address
+};
+
+/**
+ * @brief The TWI unit, the bus wires and the attached devices.
+ */
+class VirtualTwi
+{
+public:
+  /**
+   * @brief Faults that end the next bus step
+   */
+  enum Fault : uint8_t
+  {
+    NO_FAULT,         ///< Normal operation
+    LOST_ARBITRATION, ///< Another master wins the bus (status 0x38)
+    BUS_ERROR         ///< Illegal START or STOP on the bus (status 0x00)
+  };
+
+  /**
+   * @brief Bus activity counters
+   */
+  struct Statistics
+  {
+    uint32_t starts;          ///< START conditions, repeated ones included
+    uint32_t repeatedStarts;  ///< Repeated START conditions
+    uint32_t stops;           ///< STOP conditions
+    uint32_t bytesWritten;    ///< Bytes sent by the master, addresses included
+    uint32_t bytesRead;       ///< Bytes received by the master
+    uint32_t nacks;           ///< Address and data bytes not acknowledged by a slave
+    uint32_t resets;          ///< Resets of the TWI unit (TWEN cleared)
+    uint32_t writeCollisions; ///< TWDR writes while a step was running
+    uint32_t interrupts;      ///< TWI_vect calls
+    uint64_t busyTime;        ///< Time in nanoseconds the bus was driven
+  };
+
+  VirtualTwi();
+
+  /**
+   * @brief Connect a device to the bus
+   *
+   * The first attached device with a matching address answers.
+   */
+  void attach(VirtualDevice &device);
+
+  /**
+   * @brief Disconnect a device from the bus
+   */
+  void detach(VirtualDevice &device);
+
+  /**
+   * @brief Power-on reset of the unit, faults, trace and statistics
+   *
+   * Devices stay attached and time keeps running.
+   */
+  void reset();
+
+  /** @brief Virtual time in nanoseconds */
+  uint64_t now() const { return m_now; }
+
+  /**
+   * @brief Let time pass, running due TWI interrupts
+   *
+   * @param ns Nanoseconds
+   */
+  void advance(uint64_t ns);
+
+  /**
+   * @brief Set the virtual time one read of TWCR takes
+   *
+   * @param ns Nanoseconds, default 500
+   */
+  void setPollTime(uint32_t ns) { m_pollTime = ns; }
+
+  /**
+   * @brief SCL frequency from TWBR and the prescaler bits of TWSR
+   */
+  uint32_t getSclFrequency() const;
+
+  /**
+   * @brief A slave holds SCL low
+   *
+   * While held, running steps do not complete and a STOP does not finish.
+   * Releasing completes them one bit time later.
+   */
+  void holdScl(bool hold);
+
+  /**
+   * @brief End the next START or byte step with a fault
+   */
+  void injectFault(Fault fault) { m_fault = fault; }
+
+  /** @brief Bus activity since reset() or resetStatistics() */
+  const Statistics &getStatistics() const { return m_statistics; }
+
+  /** @brief Clear the bus activity counters */
+  void resetStatistics();
+
+  /**
+   * @brief Record bus activity as text
+   *
+   * Conditions are S, Sr and P; address bytes are printed as address and
+   * direction (50W, 50R), data bytes in hex. Each byte is followed by +
+   * for ACK or - for NACK, such as "S 50W+ 03+ Sr 50R+ 12+ 34- P".
+   */
+  void setTrace(bool enabled) { m_tracing = enabled; }
+
+  /** @brief Recorded activity */
+  const std::string &getTrace() const { return m_trace; }
+
+  /** @brief Forget the recorded activity */
+  void clearTrace() { m_trace.clear(); }
+
+  /** @name Register access, used by the register objects
+   *  @{ */
+  uint8_t readControl();
+  void writeControl(uint8_t value);
+  uint8_t readStatus() const { return m_status | m_prescaler; }
+  void writeStatus(uint8_t value) { m_prescaler = value & 0x03; }
+  uint8_t readData() const { return m_data; }
+  void writeData(uint8_t value);
+  uint8_t bitRate; ///< TWBR
+  /** @} */
+
+private:
+  enum Step : uint8_t
+  {
+    STEP_IDLE,    ///< Nothing running
+    STEP_START,   ///< START or repeated START
+    STEP_ADDRESS, ///< SLA+R or SLA+W
+    STEP_DATA     ///< Data byte
+  };
+
+  uint64_t bitTime() const;
+  void trace(const char *text);
+  void begin(Step step, uint64_t duration);
+  void endTransfer();
+  void finishStop();
+  void complete();
+  void run(uint64_t until, bool interrupts);
+
+  VirtualDevice *m_devices[16];
+  uint8_t m_deviceCount;
+  VirtualDevice *m_selected; ///< Device in the current transfer
+  uint64_t m_now;
+  uint32_t m_pollTime;
+  uint64_t m_stepStart;   ///< When the running step began
+  uint64_t m_stepEnd;     ///< When the running step completes
+  uint64_t m_stopEnd;     ///< When a pending STOP finishes
+  Step m_step;
+  uint8_t m_control;      ///< TWCR without TWINT and TWSTO
+  bool m_interruptFlag;   ///< TWINT
+  bool m_stopPending;     ///< TWSTO
+  bool m_collision;       ///< TWWC
+  uint8_t m_status;       ///< Status bits of TWSR
+  uint8_t m_prescaler;    ///< TWPS bits of TWSR
+  uint8_t m_data;         ///< TWDR
+  uint8_t m_received;     ///< Byte the running read step delivers
+  uint8_t m_result;       ///< Status the running step completes with
+  bool m_owner;           ///< The master owns the bus
+  bool m_reading;         ///< The current transfer is SLA+R
+  bool m_sclHeld;
+  bool m_inInterrupt;
+  Fault m_fault;
+  bool m_tracing;
+  std::string m_trace;
+  Statistics m_statistics;
+};
+
+/** Global instance of the bus */
+extern VirtualTwi Twi;
+
+/**
+ * @brief TWCR: control register, reads let time pass
+ */
+struct TwcrRegister
+{
+  TwcrRegister &operator=(uint8_t value)
+  {
+    Twi.writeControl(value);
+    return *this;
+  }
+  TwcrRegister &operator|=(uint8_t value) { return *this = Twi.readControl() | value; }
+  TwcrRegister &operator&=(uint8_t value) { return *this = Twi.readControl() & value; }
+  operator uint8_t() const { return Twi.readControl(); }
+};
+
+/**
+ * @brief TWSR: status bits are read-only, the prescaler bits writable
+ */
+struct TwsrRegister
+{
+  TwsrRegister &operator=(uint8_t value)
+  {
+    Twi.writeStatus(value);
+    return *this;
+  }
+  TwsrRegister &operator|=(uint8_t value) { return *this = Twi.readStatus() | value; }
+  TwsrRegister &operator&=(uint8_t value) { return *this = Twi.readStatus() & value; }
+  operator uint8_t() const { return Twi.readStatus(); }
+};
+
+/**
+ * @brief TWDR: data register
+ */
+struct TwdrRegister
+{
+  TwdrRegister &operator=(uint8_t value)
+  {
+    Twi.writeData(value);
+    return *this;
+  }
+  operator uint8_t() const { return Twi.readData(); }
+};
+
+extern TwcrRegister TWCR;
+extern TwsrRegister TWSR;
+extern TwdrRegister TWDR;
+
+#define TWBR (Twi.bitRate)
+
+#endif // VIRTUAL_TWI_H
@@ -0,0 +1,175 @@
+/**
+ * @file bench_I2C.cpp
+ * @brief Bus time of the I2C read paths and a fault stress run.
+ *
+ * Prints, for each way of reading a device at 100 and 400 kHz, the virtual
+ * bus time and the host time per call; then runs random transfers with
+ * random faults and checks that every clean transfer after a fault reads
+ * the right data. Pass the number of stress transfers as the argument.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+// Before the Arduino headers, whose min and max macros break <chrono>
+#include <chrono>
+#include <stdlib.h>
+
+#include <I2C.h>
+#include <FastCircularQueue.h>
+
+#include "HostTest.h"
+#include "VirtualDevices.h"
+
+static RegisterFile sensor(0x68);
+static NackingDevice picky(sensor);
+static StretchingDevice slow(picky, 0);
+
+static FastCircularQueue<uint8_t, 64> queue;
+static uint8_t buffer[32];
+static volatile uint8_t sink;
+
+/** Reads the way a driver using the internal buffer does */
+static uint8_t readStaging6()
+{
+#if I2C_STAGING_BUFFER
+  uint8_t status = I2c.read(0x68, 0x3B, 6);
+  while (I2c.available())
+  {
+    sink = I2c.receive();
+  }
+  return status;
+#else
+  return I2c.read(0x68, 0x3B, 6, buffer);
+#endif
+}
+
+static uint8_t readBuffer6() { return I2c.read(0x68, 0x3B, 6, buffer); }
+static uint8_t readBuffer32() { return I2c.read(0x68, 0x00, 32, buffer); }
+static uint8_t writeRegister() { return I2c.write(0x68, 0x6B, 0x00); }
+
+static uint8_t readQueue6()
+{
+  uint8_t status = I2c.read(0x68, 0x3B, 6, queue);
+  queue.clear();
+  return status;
+}
+
+static void measure(const char *name, uint8_t (*operation)(), uint32_t count)
+{
+  uint64_t busStart = Twi.now();
+  auto hostStart = std::chrono::steady_clock::now();
+  uint8_t status = 0;
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    status |= operation();
+  }
+  auto hostTime = std::chrono::steady_clock::now() - hostStart;
+  CHECK_EQUAL(0, status);
+  printf("  %-26s %8.1f us bus %8.0f ns host\n", name, (Twi.now() - busStart) / 1000.0 / count,
+         (double)std::chrono::duration_cast<std::chrono::nanoseconds>(hostTime).count() / count);
+}
+
+static void benchmark(uint8_t fast)
+{
+  I2c.setSpeed(fast);
+  printf("%u kHz\n", (unsigned)(Twi.getSclFrequency() / 1000));
+  measure("read 6, receive()", readStaging6, 2000);
+  measure("read 6 into buffer", readBuffer6, 2000);
+  measure("read 6 into queue", readQueue6, 2000);
+  measure("read 32 into buffer", readBuffer32, 500);
+  measure("write register", writeRegister, 2000);
+}
+
+static void stress(uint32_t count)
+{
+  I2c.setSpeed(1);
+  I2c.timeOut(5);
+  int failuresBefore = hostTestFailures;
+  uint32_t faults = 0;
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    int fault = rand() % 8;
+    switch (fault)
+    {
+    case 0:
+      picky.nackAddress(true);
+      break;
+    case 1:
+      picky.nackAfter(1 + rand() % 3);
+      break;
+    case 2:
+      Twi.injectFault(rand() % 2 ? VirtualTwi::LOST_ARBITRATION : VirtualTwi::BUS_ERROR);
+      break;
+    case 3:
+      slow.setStretch(8000); // past the timeout
+      break;
+    case 4:
+      slow.setStretch(rand() % 200);
+      break;
+    }
+
+    uint8_t length = 1 + rand() % 16;
+    uint8_t start = rand() % 64;
+    uint8_t status;
+    if (rand() % 2)
+    {
+      uint8_t data[16];
+      for (uint8_t j = 0; j < length; ++j)
+      {
+        data[j] = rand();
+      }
+      status = I2c.write(0x68, start, data, length);
+      if (fault >= 4)
+      {
+        CHECK_EQUAL(0, status);
+        for (uint8_t j = 0; j < length; ++j)
+        {
+          CHECK_EQUAL(data[j], sensor[start + j]);
+        }
+      }
+    }
+    else
+    {
+      status = I2c.read(0x68, start, length, buffer);
+      if (fault >= 4 || fault == 1) // the register byte is always accepted
+      {
+        CHECK_EQUAL(0, status);
+        for (uint8_t j = 0; j < length; ++j)
+        {
+          CHECK_EQUAL(sensor[start + j], buffer[j]);
+        }
+      }
+    }
+    if (status)
+    {
+      faults++;
+    }
+
+    picky.nackAddress(false);
+    picky.nackAfter(0);
+    slow.setStretch(0);
+    Twi.injectFault(VirtualTwi::NO_FAULT);
+  }
+  printf("stress: %u transfers, %u failed by injected faults, %u resets, %d wrong results\n",
+         (unsigned)count, (unsigned)faults, (unsigned)Twi.getStatistics().resets, hostTestFailures - failuresBefore);
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t count = argc > 1 ? strtoul(argv[1], nullptr, 10) : 2000;
+  Twi.attach(slow);
+  for (uint16_t i = 0; i < 256; ++i)
+  {
+    sensor[i] = i;
+  }
+  I2c.begin();
+  benchmark(0);
+  benchmark(1);
+
+  srand(1);
+  Twi.resetStatistics();
+  stress(count);
+  CHECK_EQUAL(0, Twi.getStatistics().writeCollisions);
+  return hostTestResult("bench_I2C");
+}
@@ -0,0 +1,157 @@
+/**
+ * @file Arduino.h
+ * @brief Minimal Arduino core for building the I2C driver on a host.
+ *
+ * Provides just what I2C, I2CEngine and FsmOS use. Time is virtual: it is
+ * owned by the TWI model in VirtualTwi.h and only moves when the bus works,
+ * the driver polls it or the test advances it.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+
+#define HEX 16
+#define DEC 10
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define LED_BUILTIN 13
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+namespace host
+{
+  /** @brief Virtual time since start in nanoseconds */
+  uint64_t nanos();
+
+  /** @brief Move virtual time forward, running due TWI interrupts */
+  void advance(uint64_t ns);
+}
+
+inline unsigned long micros() { return (unsigned long)(host::nanos() / 1000); }
+inline unsigned long millis() { return (unsigned long)(host::nanos() / 1000000); }
+inline void delay(unsigned long ms) { host::advance((uint64_t)ms * 1000000); }
+inline void delayMicroseconds(unsigned int us) { host::advance((uint64_t)us * 1000); }
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return LOW; }
+inline void yield() {}
+inline long random(long max) { return rand() % max; }
+inline long random(long min, long max) { return min + rand() % (max - min); }
+inline void randomSeed(unsigned long seed) { srand(seed); }
+
+#ifndef min
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(PSTR(string_literal)))
+
+/**
+ * @brief The parts of the Arduino String class used by the libraries.
+ */
+class String
+{
+public:
+  String(const char *text = "") : m_text(text ? text : "") {}
+  String(const __FlashStringHelper *text) : m_text(reinterpret_cast<const char *>(text)) {}
+  String(long value, int base = DEC);
+  String(int value, int base = DEC) : String((long)value, base) {}
+  String(unsigned long value, int base = DEC);
+  String(unsigned int value, int base = DEC) : String((unsigned long)value, base) {}
+  String(unsigned char value, int base = DEC) : String((unsigned long)value, base) {}
+
+  const char *c_str() const { return m_text.c_str(); }
+  unsigned int length() const { return m_text.size(); }
+  char operator[](unsigned int index) const { return m_text[index]; }
+  String operator+(const String &other) const { return String((m_text + other.m_text).c_str()); }
+  String &operator+=(const String &other)
+  {
+    m_text += other.m_text;
+    return *this;
+  }
+  bool operator==(const String &other) const { return m_text == other.m_text; }
+
+private:
+  std::string m_text;
+};
+
+/**
+ * @brief Character output, as in the Arduino core.
+ */
+class Print
+{
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size);
+  size_t write(const char *text) { return write((const uint8_t *)text, strlen(text)); }
+
+  size_t print(const char *text) { return write(text); }
+  size_t print(const __FlashStringHelper *text) { return write(reinterpret_cast<const char *>(text)); }
+  size_t print(const String &text) { return write(text.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(long value, int base = DEC);
+  size_t print(unsigned long value, int base = DEC);
+  size_t print(int value, int base = DEC) { return print((long)value, base); }
+  size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+  size_t print(unsigned char value, int base = DEC) { return print((unsigned long)value, base); }
+  size_t print(double value, int digits = 2);
+
+  size_t println() { return write("\r\n"); }
+  template <typename T>
+  size_t println(T value) { return print(value) + println(); }
+  template <typename T>
+  size_t println(T value, int format) { return print(value, format) + println(); }
+};
+
+/**
+ * @brief Character input and output, as in the Arduino core.
+ */
+class Stream : public Print
+{
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+};
+
+/**
+ * @brief Serial port writing to stdout. Quiet when disabled.
+ */
+class HostSerial : public Stream
+{
+public:
+  void begin(unsigned long) {}
+  void end() {}
+  size_t write(uint8_t c) override;
+  using Print::write;
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  operator bool() const { return true; }
+
+  bool enabled = false; ///< Whether output reaches stdout
+};
+
+extern HostSerial Serial;
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,72 @@
+/**
+ * @file HostArduino.cpp
+ * @brief Minimal Arduino core for building the I2C driver on a host.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include <Arduino.h>
+
+HostSerial Serial;
+volatile uint8_t SREG = SREG_I;
+uint8_t PORTC;
+uint8_t PORTD;
+
+// Heap bounds the FsmOS memory statistics look at
+char __heap_start;
+char *__brkval;
+
+String::String(long value, int base)
+{
+  char text[24];
+  snprintf(text, sizeof(text), base == HEX ? "%lx" : "%ld", value);
+  m_text = text;
+}
+
+String::String(unsigned long value, int base)
+{
+  char text[24];
+  snprintf(text, sizeof(text), base == HEX ? "%lx" : "%lu", value);
+  m_text = text;
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+  size_t written = 0;
+  while (size--)
+  {
+    written += write(*buffer++);
+  }
+  return written;
+}
+
+size_t Print::print(long value, int base)
+{
+  char text[24];
+  snprintf(text, sizeof(text), base == HEX ? "%lX" : "%ld", value);
+  return write(text);
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+  char text[24];
+  snprintf(text, sizeof(text), base == HEX ? "%lX" : "%lu", value);
+  return write(text);
+}
+
+size_t Print::print(double value, int digits)
+{
+  char text[48];
+  snprintf(text, sizeof(text), "%.*f", digits, value);
+  return write(text);
+}
+
+size_t HostSerial::write(uint8_t c)
+{
+  if (enabled)
+  {
+    putchar(c);
+  }
+  return 1;
+}
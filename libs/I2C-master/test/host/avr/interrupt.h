@@ -0,0 +1,26 @@
+/**
+ * @file interrupt.h
+ * @brief Interrupt vectors and the global interrupt flag for host builds.
+ *
+ * An ISR is an ordinary function the TWI model calls while time advances
+ * and interrupts are enabled.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#ifndef HOST_AVR_INTERRUPT_H
+#define HOST_AVR_INTERRUPT_H
+
+#include <stdint.h>
+
+#define SREG_I 0x80 ///< Global interrupt enable bit of SREG
+
+extern volatile uint8_t SREG;
+
+#define ISR(vector) extern "C" void vector(void); void vector(void)
+
+inline void cli() { SREG &= ~SREG_I; }
+inline void sei() { SREG |= SREG_I; }
+
+#endif // HOST_AVR_INTERRUPT_H
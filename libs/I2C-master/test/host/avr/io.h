@@ -0,0 +1,42 @@
+/**
+ * @file io.h
+ * @brief ATmega328P registers for host builds.
+ *
+ * The TWI registers are the VirtualTwi model; the port registers are plain
+ * bytes so the pull-up code has something to write to.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#ifndef HOST_AVR_IO_H
+#define HOST_AVR_IO_H
+
+#include <stdint.h>
+
+#define _BV(bit) (1 << (bit))
+#define _SFR_BYTE(sfr) (sfr)
+
+/** @name TWCR bits
+ *  @{ */
+#define TWINT 7
+#define TWEA 6
+#define TWSTA 5
+#define TWSTO 4
+#define TWWC 3
+#define TWEN 2
+#define TWIE 0
+/** @} */
+
+/** @name TWSR prescaler bits
+ *  @{ */
+#define TWPS1 1
+#define TWPS0 0
+/** @} */
+
+extern uint8_t PORTC; ///< SDA and SCL pull-ups on the ATmega328P
+extern uint8_t PORTD; ///< SDA and SCL pull-ups on the ATmega128 family
+
+#include <VirtualTwi.h>
+
+#endif // HOST_AVR_IO_H
@@ -0,0 +1,21 @@
+/**
+ * @file atomic.h
+ * @brief ATOMIC_BLOCK for host builds.
+ *
+ * The TWI model runs interrupt handlers only while time advances between
+ * driver calls, so a block needs no protection. The definitions match the
+ * non-AVR fallback in FsmOS.h.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#ifndef HOST_UTIL_ATOMIC_H
+#define HOST_UTIL_ATOMIC_H
+
+#include <stdint.h>
+
+#define ATOMIC_BLOCK(type) for (uint8_t _ab_once = 1; _ab_once; _ab_once = 0)
+#define ATOMIC_RESTORESTATE
+
+#endif // HOST_UTIL_ATOMIC_H
@@ -0,0 +1,256 @@
+/**
+ * @file test_I2C.cpp
+ * @brief The polled I2C driver against the virtual bus.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include <I2C.h>
+#include <FastCircularQueue.h>
+
+#include "HostTest.h"
+#include "VirtualDevices.h"
+
+static RegisterFile sensor(0x50);
+static RegisterFile eeprom(0x51, 4096, 2);
+static VirtualHMC5883L compass;
+
+static void testSpeed()
+{
+  I2c.begin();
+  CHECK_EQUAL(72, TWBR);
+  CHECK_EQUAL(100000, Twi.getSclFrequency());
+  I2c.setSpeed(1);
+  CHECK_EQUAL(400000, Twi.getSclFrequency());
+  I2c.setSpeed(0);
+}
+
+static void testRegisterAccess()
+{
+  Twi.clearTrace();
+  CHECK_EQUAL(0, I2c.write(0x50, 0x10, 0xA5));
+  CHECK_TRACE("S 50W+ 10+ A5+ P");
+  CHECK_EQUAL(0xA5, sensor[0x10]);
+
+  const uint8_t data[3] = {1, 2, 3};
+  CHECK_EQUAL(0, I2c.write(0x50, 0x20, data, 3));
+  CHECK_TRACE("S 50W+ 20+ 01+ 02+ 03+ P");
+
+  uint8_t buffer[3] = {0};
+  CHECK_EQUAL(0, I2c.read(0x50, 0x20, 3, buffer));
+  CHECK_TRACE("S 50W+ 20+ Sr 50R+ 01+ 02+ 03- P");
+  CHECK_EQUAL(1, buffer[0]);
+  CHECK_EQUAL(3, buffer[2]);
+
+  // Without a register the read goes on from the pointer
+  sensor[0x23] = 0x42;
+  CHECK_EQUAL(0, I2c.read(0x50, 1, buffer));
+  CHECK_TRACE("S 50R+ 42- P");
+  CHECK_EQUAL(0x42, buffer[0]);
+
+  // 8-bit register reads with a 16-bit count send one register byte
+  CHECK_EQUAL(0, I2c.readex(0x50, 0x20, 2, buffer));
+  CHECK_TRACE("S 50W+ 20+ Sr 50R+ 01+ 02- P");
+}
+
+static void testStagingAndQueue()
+{
+#if I2C_STAGING_BUFFER
+  CHECK_EQUAL(0, I2c.read(0x50, 0x20, 3));
+  CHECK_EQUAL(3, I2c.available());
+  CHECK_EQUAL(1, I2c.receive());
+  CHECK_EQUAL(2, I2c.receive());
+  CHECK_EQUAL(3, I2c.receive());
+  CHECK_EQUAL(0, I2c.available());
+  Twi.clearTrace();
+#endif
+
+  FastCircularQueue<uint8_t, 8> queue;
+  queue.push(0xEE);
+  CHECK_EQUAL(0, I2c.read(0x50, 0x20, 10, queue));
+  CHECK_EQUAL(7, queue.available());
+  uint8_t value = 0;
+  queue.pop(value);
+  CHECK_EQUAL(0xEE, value);
+  queue.pop(value);
+  CHECK_EQUAL(1, value);
+
+  // A full queue reads nothing
+  while (queue.push(0))
+  {
+  }
+  Twi.clearTrace();
+  CHECK_EQUAL(0, I2c.read(0x50, 0x20, 4, queue));
+  CHECK_TRACE("");
+  queue.clear();
+  Twi.clearTrace();
+}
+
+static void testEeprom()
+{
+  eeprom.setWriteCycle(5000);
+  const uint8_t page[4] = {0xDE, 0xAD, 0xBE, 0xEF};
+  CHECK_EQUAL(0, I2c.write16(0x51, 0x0123, page, 4));
+  CHECK_TRACE("S 51W+ 01+ 23+ DE+ AD+ BE+ EF+ P");
+
+  // Busy programming: the address is refused until the write cycle ends
+  uint8_t buffer[4] = {0};
+  CHECK_EQUAL(MT_SLA_NACK, I2c.read16(0x51, 0x0123, 4, buffer));
+  CHECK_TRACE("S 51W- P");
+  delay(5);
+  CHECK_EQUAL(0, I2c.read16(0x51, 0x0123, 4, buffer));
+  CHECK_TRACE("S 51W+ 01+ 23+ Sr 51R+ DE+ AD+ BE+ EF- P");
+  CHECK_EQUAL(0xEF, buffer[3]);
+  eeprom.setWriteCycle(0);
+}
+
+static void testCompass()
+{
+  CHECK_EQUAL(0, I2c.write(0x1E, 0x02, 0x00));
+  compass.setField(-2, 300, 4000);
+
+  uint8_t status = 0;
+  CHECK_EQUAL(0, I2c.read(0x1E, VirtualHMC5883L::STATUS, 1, &status));
+  CHECK_EQUAL(0x01, status);
+
+  uint8_t sample[6];
+  CHECK_EQUAL(0, I2c.read(0x1E, 0x03, 6, sample));
+  CHECK_EQUAL(-2, (int16_t)(sample[0] << 8 | sample[1]));
+  CHECK_EQUAL(4000, (int16_t)(sample[2] << 8 | sample[3]));
+  CHECK_EQUAL(300, (int16_t)(sample[4] << 8 | sample[5]));
+  CHECK_EQUAL(0, I2c.read(0x1E, VirtualHMC5883L::STATUS, 1, &status));
+  CHECK_EQUAL(0x00, status);
+
+  uint8_t id[3];
+  CHECK_EQUAL(0, I2c.read(0x1E, VirtualHMC5883L::ID_A, 3, id));
+  CHECK_EQUAL('H', id[0]);
+  CHECK_EQUAL('3', id[2]);
+
+  // The pointer wraps from the last data register back to the first
+  CHECK_EQUAL(0, I2c.read(0x1E, 0x08, 2, sample));
+  CHECK_EQUAL(300 & 0xFF, sample[0]);
+  CHECK_EQUAL(0xFF, sample[1]);
+  Twi.clearTrace();
+}
+
+static void testNack()
+{
+  uint8_t buffer[2];
+  CHECK_EQUAL(MT_SLA_NACK, I2c.read(0x33, 0x00, 2, buffer));
+  CHECK_TRACE("S 33W- P");
+  CHECK_EQUAL(MT_SLA_NACK, I2c.write(0x33, 0x00, 1));
+  Twi.clearTrace();
+
+  NackingDevice picky(sensor);
+  Twi.detach(sensor);
+  Twi.attach(picky);
+  picky.nackAfter(2);
+  const uint8_t data[4] = {9, 8, 7, 6};
+  CHECK_EQUAL(MT_DATA_NACK, I2c.write(0x50, 0x40, data, 4));
+  CHECK_EQUAL(9, sensor[0x40]);
+  CHECK_EQUAL(0xFF, sensor[0x41]);
+  Twi.detach(picky);
+  Twi.attach(sensor);
+
+  // The bus is usable afterwards
+  CHECK_EQUAL(0, I2c.read(0x50, 0x40, 1, buffer));
+  CHECK_EQUAL(9, buffer[0]);
+  Twi.clearTrace();
+}
+
+static void testClockStretching()
+{
+  StretchingDevice slow(sensor, 100);
+  Twi.detach(sensor);
+  Twi.attach(slow);
+  I2c.timeOut(10);
+
+  uint8_t buffer[4];
+  uint32_t start = micros();
+  CHECK_EQUAL(0, I2c.read(0x50, 0x20, 4, buffer));
+  // 8 bytes of 100 us stretch on top of the bus time
+  CHECK(micros() - start >= 800);
+  CHECK_EQUAL(1, buffer[0]);
+
+  // Stretching past the timeout resets the unit and reports where it hung
+  uint32_t resets = Twi.getStatistics().resets;
+  slow.setStretch(50000);
+  CHECK_EQUAL(2, I2c.read(0x50, 0x20, 4, buffer));
+  CHECK_EQUAL(resets + 1, Twi.getStatistics().resets);
+
+  Twi.detach(slow);
+  Twi.attach(sensor);
+  CHECK_EQUAL(0, I2c.read(0x50, 0x20, 4, buffer));
+  CHECK_EQUAL(3, buffer[2]);
+  I2c.timeOut(0);
+  Twi.clearTrace();
+}
+
+static void testLockUp()
+{
+  I2c.timeOut(20);
+  uint32_t resets = Twi.getStatistics().resets;
+  uint8_t buffer[2];
+
+  // SCL held low: the START never completes
+  Twi.holdScl(true);
+  uint32_t start = millis();
+  CHECK_EQUAL(1, I2c.read(0x50, 0x20, 2, buffer));
+  CHECK(millis() - start >= 20);
+  CHECK_EQUAL(resets + 1, Twi.getStatistics().resets);
+  Twi.holdScl(false);
+  CHECK_EQUAL(0, I2c.read(0x50, 0x20, 2, buffer));
+
+  // Held in the middle of a transfer
+  sensor[0x60] = 0x11;
+  Twi.clearTrace();
+  CHECK_EQUAL(0, I2c._start());
+  CHECK_EQUAL(0, I2c._sendAddress(SLA_W(0x50)));
+  Twi.holdScl(true);
+  CHECK_EQUAL(1, I2c._sendByte(0x60));
+  Twi.holdScl(false);
+  CHECK_TRACE("S 50W+ 60+ reset");
+  CHECK_EQUAL(0, I2c.read(0x50, 0x60, 1, buffer));
+  CHECK_EQUAL(0x11, buffer[0]);
+
+  // Another master wins the bus
+  Twi.injectFault(VirtualTwi::LOST_ARBITRATION);
+  CHECK_EQUAL(LOST_ARBTRTN, I2c.read(0x50, 0x20, 2, buffer));
+  CHECK_EQUAL(0, I2c.read(0x50, 0x20, 2, buffer));
+  I2c.timeOut(0);
+  Twi.clearTrace();
+}
+
+static void testScan()
+{
+  Serial.enabled = false;
+  uint32_t starts = Twi.getStatistics().starts;
+  I2c.scan();
+  CHECK_EQUAL(starts + 128, Twi.getStatistics().starts);
+}
+
+int main()
+{
+  Twi.attach(sensor);
+  Twi.attach(eeprom);
+  Twi.attach(compass);
+  Twi.setTrace(true);
+  for (uint16_t i = 0; i < 256; ++i)
+  {
+    sensor[i] = 0xFF;
+  }
+
+  testSpeed();
+  testRegisterAccess();
+  testStagingAndQueue();
+  testEeprom();
+  testCompass();
+  testNack();
+  testClockStretching();
+  testLockUp();
+  testScan();
+
+  CHECK_EQUAL(0, Twi.getStatistics().writeCollisions);
+  return hostTestResult("test_I2C");
+}
@@ -0,0 +1,153 @@
+/**
+ * @file test_I2CEngine.cpp
+ * @brief The interrupt-driven I2CEngine against the virtual bus.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include <I2CEngine.h>
+
+#include "HostTest.h"
+#include "VirtualDevices.h"
+
+static RegisterFile imu(0x68);
+static VirtualHMC5883L compass;
+static I2CEngine engine;
+static I2CDevice imuDevice(0x68, I2CDevice::BURST | I2CDevice::RESTART);
+
+static int callbacks = 0;
+
+static void countCallback(I2CTransaction &)
+{
+  callbacks++;
+}
+
+/** Let the bus run and the engine deliver, like the scheduler would */
+static void run(uint32_t us)
+{
+  for (uint32_t i = 0; i < us / 10; ++i)
+  {
+    Twi.advance(10000);
+    engine.step();
+  }
+}
+
+static void testWriteRead()
+{
+  const uint8_t config[3] = {0x70, 0xA0, 0x00};
+  uint8_t sample[6] = {0};
+  I2CTransaction write, read;
+  write.setWrite(0x1E, 0x00, config, 3);
+  read.setRead(0x1E, 0x03, sample, 6);
+  read.onComplete(countCallback, nullptr);
+  compass.setField(1, 2, 3);
+
+  Twi.clearTrace();
+  CHECK(engine.submit(write));
+  CHECK(engine.submit(read));
+  CHECK(!engine.isIdle());
+  run(5000);
+  CHECK(engine.isIdle());
+  CHECK(write.isDone());
+  CHECK_EQUAL(I2CTransaction::OK, write.status);
+  CHECK_EQUAL(I2CTransaction::OK, read.status);
+  CHECK_EQUAL(1, callbacks);
+  CHECK_EQUAL(1, sample[1]);
+  CHECK_EQUAL(3, sample[3]);
+  CHECK_EQUAL(2, sample[5]);
+  CHECK_TRACE("S 1EW+ 00+ 70+ A0+ 00+ P S 1EW+ 03+ Sr 1ER+ 00+ 01+ 00+ 03+ 00+ 02- P");
+  CHECK_EQUAL(0x70, compass[0]);
+  CHECK_EQUAL(0, Twi.getStatistics().writeCollisions);
+}
+
+static void testBurstMerge()
+{
+  for (uint16_t i = 0; i < 256; ++i)
+  {
+    imu[i] = i;
+  }
+  uint8_t blocker, accel[6], temperature[2], gyro[6];
+  I2CTransaction first, a, t, g;
+  first.setRead(0x1E, 0x0A, &blocker, 1);
+  g.setRead(0x68, 0x43, gyro, 6);
+  a.setRead(0x68, 0x3B, accel, 6);
+  t.setRead(0x68, 0x41, temperature, 2);
+
+  engine.submit(first);
+  engine.submit(g);
+  engine.submit(a);
+  engine.submit(t);
+  imu.resetCounts();
+  uint32_t stops = Twi.getStatistics().stops;
+  run(5000);
+  CHECK_EQUAL(I2CTransaction::OK, g.status);
+  CHECK_EQUAL(0x3B, accel[0]);
+  CHECK_EQUAL(0x41, temperature[0]);
+  CHECK_EQUAL(0x48, gyro[5]);
+  // One 14 byte burst instead of three transfers
+  CHECK_EQUAL(14, imu.getReadCount());
+  CHECK_EQUAL(2, imuDevice.statistics.merged);
+  // The compass read ends with a STOP, the burst with another
+  CHECK_EQUAL(stops + 2, Twi.getStatistics().stops);
+}
+
+static void testPriority()
+{
+  uint8_t blocker, low, high;
+  I2CTransaction first, lowRead, highRead;
+  first.setRead(0x1E, 0x0A, &blocker, 1);
+  lowRead.setRead(0x68, 0x10, &low, 1);
+  highRead.setRead(0x68, 0x80, &high, 1);
+  highRead.priority = 5;
+
+  Twi.clearTrace();
+  engine.submit(first);
+  engine.submit(lowRead);
+  engine.submit(highRead);
+  run(5000);
+  CHECK_TRACE("S 1EW+ 0A+ Sr 1ER+ 48- P S 68W+ 80+ Sr 68R+ 80- Sr 68W+ 10+ Sr 68R+ 10- P");
+}
+
+static void testErrors()
+{
+  uint8_t buffer[2];
+  I2CTransaction missing;
+  missing.setRead(0x33, 0x00, buffer, 2);
+  engine.submit(missing);
+  run(5000);
+  CHECK_EQUAL(MT_SLA_NACK, missing.status);
+
+  // A held bus times out, the engine resets the unit and goes on
+  uint32_t resets = Twi.getStatistics().resets;
+  I2CTransaction stuck, next;
+  stuck.setRead(0x1E, 0x03, buffer, 2);
+  next.setRead(0x1E, 0x0A, buffer, 1);
+  Twi.holdScl(true);
+  engine.submit(stuck);
+  engine.submit(next);
+  run(I2C_ENGINE_TIMEOUT_MS * 1000 + 5000);
+  CHECK_EQUAL(I2CTransaction::TIMEOUT, stuck.status);
+  CHECK_EQUAL(resets + 1, Twi.getStatistics().resets);
+  Twi.holdScl(false);
+  run(5000);
+  CHECK_EQUAL(I2CTransaction::OK, next.status);
+  CHECK_EQUAL('H', buffer[0]);
+}
+
+int main()
+{
+  Twi.attach(imu);
+  Twi.attach(compass);
+  Twi.setTrace(true);
+  engine.addDevice(imuDevice);
+  engine.begin();
+
+  testWriteRead();
+  testBurstMerge();
+  testPriority();
+  testErrors();
+
+  CHECK(engine.getBusyTime() > 0);
+  return hostTestResult("test_I2CEngine");
+}
@@ -0,0 +1,239 @@
+/**
+ * @file test_I2CRegisterCache.cpp
+ * @brief The I2C register cache against the virtual bus.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include <I2CRegisterCache.h>
+
+#include "HostTest.h"
+#include "VirtualDevices.h"
+
+static RegisterFile sensor(0x68);
+static NackingDevice picky(sensor);
+static VirtualHMC5883L compass;
+
+static void fillSensor()
+{
+  for (uint16_t i = 0; i < 256; ++i)
+  {
+    sensor[i] = i;
+  }
+}
+
+static void testReadAndWrite()
+{
+  I2CShadowRegisters<16> cache(0x68, 0x10);
+  uint8_t value = 0;
+
+  CHECK(!cache.isCached(0x12));
+  CHECK_EQUAL(0, cache.read(0x12, value));
+  CHECK_EQUAL(0x12, value);
+  CHECK_TRACE("S 68W+ 12+ Sr 68R+ 12- P");
+  CHECK(cache.isCached(0x12));
+  CHECK_EQUAL(0, cache.read(0x12, value));
+  CHECK_EQUAL(0x12, value);
+  CHECK_TRACE("");
+
+  // Writing the value the register holds costs nothing
+  CHECK_EQUAL(0, cache.write(0x12, 0x12));
+  CHECK_TRACE("");
+  CHECK_EQUAL(0, cache.write(0x12, 0x80));
+  CHECK_TRACE("S 68W+ 12+ 80+ P");
+  CHECK_EQUAL(0, cache.read(0x12, value));
+  CHECK_EQUAL(0x80, value);
+  CHECK_TRACE("");
+
+  // Unknown registers are written even when the device holds the value
+  CHECK_EQUAL(0, cache.write(0x13, 0x13));
+  CHECK_TRACE("S 68W+ 13+ 13+ P");
+
+  CHECK_EQUAL(2, cache.statistics.hits);
+  CHECK_EQUAL(1, cache.statistics.reads);
+  CHECK_EQUAL(2, cache.statistics.writes);
+  CHECK_EQUAL(1, cache.statistics.skipped);
+  cache.resetStatistics();
+  CHECK_EQUAL(0, cache.statistics.hits);
+}
+
+static void testUpdate()
+{
+  I2CShadowRegisters<16> cache(0x68, 0x10);
+  sensor[0x1A] = 0xF0;
+
+  CHECK_EQUAL(0, cache.update(0x1A, 0x0C, 0x04));
+  CHECK_TRACE("S 68W+ 1A+ Sr 68R+ F0- P S 68W+ 1A+ F4+ P");
+  CHECK_EQUAL(0xF4, sensor[0x1A]);
+  CHECK_EQUAL(0, cache.update(0x1A, 0x0C, 0x04));
+  CHECK_EQUAL(0, cache.update(0x1A, 0x0C, 0x0C));
+  CHECK_TRACE("S 68W+ 1A+ FC+ P");
+
+  // A known reset value saves the first read too
+  cache.preset(0x1B, 0x00);
+  CHECK_EQUAL(0, cache.update(0x1B, 0x01, 0x01));
+  CHECK_TRACE("S 68W+ 1B+ 01+ P");
+}
+
+static void testVolatile()
+{
+  I2CShadowRegisters<16> cache(0x68, 0x10);
+  cache.setVolatile(0x14, 2);
+  uint8_t value = 0;
+
+  CHECK_EQUAL(0, cache.read(0x14, value));
+  CHECK_EQUAL(0, cache.read(0x14, value));
+  CHECK_TRACE("S 68W+ 14+ Sr 68R+ 14- P S 68W+ 14+ Sr 68R+ 14- P");
+  CHECK(!cache.isCached(0x14));
+  CHECK_EQUAL(0, cache.write(0x15, 0x15));
+  CHECK_EQUAL(0, cache.write(0x15, 0x15));
+  CHECK_TRACE("S 68W+ 15+ 15+ P S 68W+ 15+ 15+ P");
+
+  // Outside the cached range nothing is cached
+  CHECK_EQUAL(0, cache.read(0x20, value));
+  CHECK_EQUAL(0, cache.read(0x20, value));
+  CHECK_TRACE("S 68W+ 20+ Sr 68R+ 20- P S 68W+ 20+ Sr 68R+ 20- P");
+  CHECK(!cache.isCached(0x0F));
+  CHECK(!cache.isCached(0x20));
+}
+
+static void testBursts()
+{
+  fillSensor();
+  I2CShadowRegisters<8> cache(0x68);
+  cache.setVolatile(5);
+  uint8_t data[8] = {0};
+
+  CHECK_EQUAL(0, cache.read(0x00, data, 2));
+  CHECK_TRACE("S 68W+ 00+ Sr 68R+ 00+ 01- P");
+  // Cached ends come from RAM, the middle in one transfer
+  CHECK_EQUAL(0, cache.read(0x00, data, 4));
+  CHECK_TRACE("S 68W+ 02+ Sr 68R+ 02+ 03- P");
+  CHECK_EQUAL(3, data[3]);
+  // A volatile register in the middle still goes to the bus
+  CHECK_EQUAL(0, cache.read(0x03, data, 4));
+  CHECK_TRACE("S 68W+ 04+ Sr 68R+ 04+ 05+ 06- P");
+  CHECK_EQUAL(3, data[0]);
+  CHECK_EQUAL(6, data[3]);
+
+  // Only the changed span is written; unchanged bytes inside it go along
+  const uint8_t config[4] = {0x00, 0xA1, 0x02, 0xA3};
+  CHECK_EQUAL(0, cache.write(0x00, config, 4));
+  CHECK_TRACE("S 68W+ 01+ A1+ 02+ A3+ P");
+  CHECK_EQUAL(0, cache.write(0x00, config, 4));
+  CHECK_TRACE("");
+  CHECK_EQUAL(0xA3, sensor[3]);
+}
+
+static void testInvalidate()
+{
+  fillSensor();
+  I2CShadowRegisters<4> cache(0x68);
+  uint8_t data[4];
+  CHECK_EQUAL(0, cache.read(0x00, data, 4));
+  Twi.clearTrace();
+
+  // The device was reset behind the cache's back
+  sensor[1] = 0x55;
+  sensor[2] = 0x66;
+  cache.invalidate(1);
+  CHECK_EQUAL(0, cache.read(0x00, data, 4));
+  CHECK_TRACE("S 68W+ 01+ Sr 68R+ 55- P");
+  CHECK_EQUAL(0x02, data[2]); // still trusted
+  cache.invalidate();
+  CHECK_EQUAL(0, cache.read(0x00, data, 4));
+  CHECK_TRACE("S 68W+ 00+ Sr 68R+ 00+ 55+ 66+ 03- P");
+}
+
+static void testErrors()
+{
+  fillSensor();
+  I2CShadowRegisters<4> cache(0x68);
+  uint8_t value = 0;
+
+  // A failed read caches nothing
+  picky.nackAddress(true);
+  CHECK(cache.read(0x01, value) != 0);
+  picky.nackAddress(false);
+  CHECK(!cache.isCached(0x01));
+
+  // A failed write forgets the registers, since the device may hold either value
+  CHECK_EQUAL(0, cache.read(0x01, value));
+  CHECK(cache.isCached(0x01));
+  picky.nackAfter(1);
+  const uint8_t data[2] = {0x11, 0x22};
+  CHECK(cache.write(0x01, data, 2) != 0);
+  picky.nackAfter(0);
+  CHECK(!cache.isCached(0x01));
+  CHECK(!cache.isCached(0x02));
+  CHECK_EQUAL(0, cache.read(0x01, value));
+  CHECK_EQUAL(0x01, value);
+  Twi.clearTrace();
+}
+
+/** The same reconfiguration sequence with and without the cache */
+static void testReconfigurationBurst()
+{
+  I2CShadowRegisters<13> cache(0x1E);
+  cache.setVolatile(VirtualHMC5883L::DATA_X_MSB, 7);
+  uint8_t sample[6];
+
+  compass.resetCounts();
+  uint64_t busStart = Twi.getStatistics().busyTime;
+  for (uint8_t round = 0; round < 4; ++round)
+  {
+    uint8_t value;
+    I2c.read(0x1E, 0x00, 1, &value);
+    I2c.write(0x1E, 0x00, (value & ~0x1C) | 0x18);
+    I2c.read(0x1E, 0x01, 1, &value);
+    I2c.write(0x1E, 0x01, (value & ~0xE0) | (round & 1 ? 0x20 : 0x40));
+    I2c.read(0x1E, 0x02, 1, &value);
+    I2c.write(0x1E, 0x02, value & ~0x03);
+    I2c.read(0x1E, 0x03, 6, sample);
+  }
+  uint64_t plainTime = Twi.getStatistics().busyTime - busStart;
+  uint32_t plainBytes = compass.getReadCount() + compass.getWriteCount();
+
+  compass.resetCounts();
+  busStart = Twi.getStatistics().busyTime;
+  for (uint8_t round = 0; round < 4; ++round)
+  {
+    CHECK_EQUAL(0, cache.update(0x00, 0x1C, 0x18));
+    CHECK_EQUAL(0, cache.update(0x01, 0xE0, round & 1 ? 0x20 : 0x40));
+    CHECK_EQUAL(0, cache.update(0x02, 0x03, 0x00));
+    CHECK_EQUAL(0, cache.read(0x03, sample, 6));
+  }
+  uint64_t cachedTime = Twi.getStatistics().busyTime - busStart;
+  uint32_t cachedBytes = compass.getReadCount() + compass.getWriteCount();
+  Twi.clearTrace();
+
+  // Config registers are read once and written when they change
+  CHECK_EQUAL(3 + 4 * 6, cache.statistics.reads);
+  CHECK_EQUAL(9, cache.statistics.hits);
+  CHECK_EQUAL(4, cache.statistics.writes);
+  CHECK_EQUAL(8, cache.statistics.skipped);
+  CHECK(cachedBytes < plainBytes);
+  printf("reconfiguration: %u bytes in %u us without the cache, %u bytes in %u us with it\n",
+         (unsigned)plainBytes, (unsigned)(plainTime / 1000), (unsigned)cachedBytes,
+         (unsigned)(cachedTime / 1000));
+}
+
+int main()
+{
+  Twi.attach(picky);
+  Twi.attach(compass);
+  Twi.setTrace(true);
+  fillSensor();
+  I2c.begin();
+
+  testReadAndWrite();
+  testUpdate();
+  testVolatile();
+  testBursts();
+  testInvalidate();
+  testErrors();
+  testReconfigurationBurst();
+
+  return hostTestResult("test_I2CRegisterCache");
+}
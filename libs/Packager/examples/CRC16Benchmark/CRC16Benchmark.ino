@@ -0,0 +1,73 @@
+/**
+ * @file CRC16Benchmark.ino
+ * @brief Cycles per byte of each CRC-16-CCITT engine
+ *
+ * This example checksums the same buffer with every CRC16 engine, checks
+ * that they agree, and prints the time per run and the resulting CPU
+ * cycles per byte.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include <CRC16.h>
+
+// Buffer size used for every run
+const uint16_t BUFFER_SIZE = 256;
+
+// Number of runs per measurement
+const uint16_t RUN_COUNT = 100;
+
+uint8_t buffer[BUFFER_SIZE];
+
+typedef uint16_t (*CRCEngine)(uint16_t crc, const uint8_t *data, uint16_t length);
+
+// Times one engine and prints the result line
+void runEngine(const __FlashStringHelper *name, CRCEngine engine)
+{
+  volatile uint16_t crc = 0;
+  const unsigned long start = micros();
+  for (uint16_t run = 0; run < RUN_COUNT; run++)
+  {
+    crc = engine(CRC16::INITIAL_VALUE, buffer, BUFFER_SIZE);
+  }
+  const unsigned long elapsed = micros() - start;
+
+  const uint32_t totalBytes = (uint32_t)BUFFER_SIZE * RUN_COUNT;
+  const uint32_t cyclesPerMicro = F_CPU / 1000000UL;
+
+  Serial.print(name);
+  Serial.print(F(": crc=0x"));
+  Serial.print(crc, HEX);
+  Serial.print(F(", "));
+  Serial.print(elapsed);
+  Serial.print(F(" us, "));
+  Serial.print((float)elapsed * cyclesPerMicro / totalBytes, 1);
+  Serial.println(F(" cycles/byte"));
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(1000);
+
+  Serial.println(F("CRC16 Benchmark"));
+  Serial.println(F("==============="));
+
+  randomSeed(42);
+  for (uint16_t i = 0; i < BUFFER_SIZE; i++)
+  {
+    buffer[i] = random(256);
+  }
+
+  runEngine(F("Bitwise"), CRC16::updateBitwise);
+  runEngine(F("Nibble"), CRC16::updateNibble);
+  runEngine(F("Table"), CRC16::updateTable);
+#if !defined(__AVR__)
+  runEngine(F("Slicing-by-8"), CRC16::updateSlicing8);
+#endif
+}
+
+void loop()
+{
+}
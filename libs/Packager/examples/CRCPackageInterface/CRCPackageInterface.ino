@@ -12,11 +12,12 @@
 #include <CRCPackageInterface.h>
 #include <PipedStream.h>
 
-// Create piped stream pair
-PipedStreamPair streams;
+// Create piped stream pair with inline (non-heap) buffers
+StaticPipedStreamPair<64> streams;
 
-// Create CRC package interface
-CRCPackageInterface packager(streams);
+// Create CRC package interface with inline encoded buffers, so nothing is
+// allocated on the heap
+StaticCRCPackageInterface<32> packager(streams);
 
 void setup() {
   Serial.begin(9600);
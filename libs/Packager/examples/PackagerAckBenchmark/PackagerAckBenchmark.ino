@@ -0,0 +1,151 @@
+/**
+ * @file PackagerAckBenchmark.ino
+ * @brief Frames on the wire and goodput for each acknowledgment mode
+ *
+ * This example connects two CRCPackageInterface instances through an
+ * emulated serial link with a fixed bandwidth and latency. For
+ * IMMEDIATE_ACKS and PIGGYBACKED_ACKS, stop-and-wait, window 4 and the largest
+ * window, it streams data in both directions at once and then in one
+ * direction only. Each line shows the frames sent per second by both
+ * ends, how many of them were ACK packets, and the goodput.
+ *
+ * With symmetric traffic piggybacked ACKs ride on the DATA packets going
+ * the other way, so almost no ACK packets are needed. With one-way
+ * traffic the ACKs are delayed and each one covers two DATA packets.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include <CRCPackageInterface.h>
+#include <LinkEmulator.h>
+#include <PipedStream.h>
+
+// Duration of each measurement
+const unsigned long RUN_TIME = 3000;
+
+// Emulated link: 115200 baud (11520 bytes/s) with 5 ms one-way latency
+const uint32_t LINK_BYTES_PER_SECOND = 11520;
+const uint32_t LINK_LATENCY_US = 5000;
+
+// Traffic flows both ways, so each side buffers a window in each direction
+const uint16_t BUFFER_SIZE = 256;
+
+StaticPipedStreamPair<BUFFER_SIZE> streamsA;
+StaticPipedStreamPair<BUFFER_SIZE> streamsB;
+
+// Keeps a plain stream full with a counting pattern
+void feed(PipedStream &plain, uint8_t &next)
+{
+  while (plain.availableForWrite() > 0)
+  {
+    plain.write(next++);
+  }
+}
+
+// Reads a plain stream and checks the counting pattern
+uint32_t drainChecked(PipedStream &plain, uint8_t &expected, bool &intact)
+{
+  uint32_t count = 0;
+  while (plain.available())
+  {
+    intact &= (plain.read() == expected++);
+    count++;
+  }
+  return count;
+}
+
+// Frames sent by one end: DATA packets, their retransmissions and ACKs
+uint32_t framesSent(const CRCPackageInterface &packager)
+{
+  const CRCPackageInterface::LinkStatistics &stats = packager.getStatistics();
+  return stats.packetsSent + stats.timeoutRetransmissions + stats.nackRetransmissions + stats.acksSent;
+}
+
+// Streams data for RUN_TIME and prints frames and goodput
+void runCase(const CRCPackageInterface::AckMode ackMode, const uint8_t windowSize, const bool symmetric)
+{
+  CRCPackageInterface a(streamsA, BUFFER_SIZE, windowSize, 8, CRCPackageInterface::START_STOP_FRAMING, ackMode);
+  CRCPackageInterface b(streamsB, BUFFER_SIZE, windowSize, 8, CRCPackageInterface::START_STOP_FRAMING, ackMode);
+
+  LinkEmulator link(a.getEncodedStream(), b.getEncodedStream());
+  LinkChannel::Settings settings = {};
+  settings.bytesPerSecond = LINK_BYTES_PER_SECOND;
+  settings.latencyUs = LINK_LATENCY_US;
+  link.setSettings(settings);
+
+  uint8_t nextA = 0;
+  uint8_t nextB = 0;
+  uint8_t expectedAtB = 0;
+  uint8_t expectedAtA = 0;
+  uint32_t receivedAtB = 0;
+  uint32_t receivedAtA = 0;
+  bool intact = true;
+
+  const unsigned long start = millis();
+  while (millis() - start < RUN_TIME)
+  {
+    feed(a.getPlainStream(), nextA);
+    if (symmetric)
+    {
+      feed(b.getPlainStream(), nextB);
+    }
+
+    a.loop();
+    b.loop();
+    link.loop();
+
+    receivedAtB += drainChecked(b.getPlainStream(), expectedAtB, intact);
+    receivedAtA += drainChecked(a.getPlainStream(), expectedAtA, intact);
+  }
+
+  // Drop data still queued for the next case
+  streamsA.clear();
+  streamsB.clear();
+
+  const uint32_t acks = a.getStatistics().acksSent + b.getStatistics().acksSent;
+  Serial.print(ackMode == CRCPackageInterface::PIGGYBACKED_ACKS ? F("Piggybacked") : F("Immediate  "));
+  Serial.print(F(", window "));
+  Serial.print(windowSize);
+  Serial.print(F(": "));
+  Serial.print((framesSent(a) + framesSent(b)) * 1000UL / RUN_TIME);
+  Serial.print(F(" frames/s ("));
+  Serial.print(acks * 1000UL / RUN_TIME);
+  Serial.print(F(" ACK), A->B "));
+  Serial.print(receivedAtB * 1000UL / RUN_TIME);
+  if (symmetric)
+  {
+    Serial.print(F(" B/s, B->A "));
+    Serial.print(receivedAtA * 1000UL / RUN_TIME);
+  }
+  Serial.print(F(" B/s"));
+  Serial.println(intact ? F("") : F(" (DATA MISMATCH)"));
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(1000);
+
+  Serial.println(F("Packager ACK Benchmark"));
+  Serial.println(F("======================"));
+  Serial.print(F("Link: "));
+  Serial.print(LINK_BYTES_PER_SECOND);
+  Serial.print(F(" B/s each way, RTT "));
+  Serial.print(2 * LINK_LATENCY_US / 1000);
+  Serial.println(F(" ms"));
+
+  for (uint8_t symmetric = 1; symmetric <= 1; symmetric--)
+  {
+    Serial.println(symmetric ? F("Symmetric traffic:") : F("One-way traffic:"));
+    runCase(CRCPackageInterface::IMMEDIATE_ACKS, 1, symmetric);
+    runCase(CRCPackageInterface::PIGGYBACKED_ACKS, 1, symmetric);
+    runCase(CRCPackageInterface::PIGGYBACKED_ACKS, 4, symmetric);
+    runCase(CRCPackageInterface::IMMEDIATE_ACKS, PACKAGER_MAX_WINDOW_SIZE, symmetric);
+    runCase(CRCPackageInterface::PIGGYBACKED_ACKS, PACKAGER_MAX_WINDOW_SIZE, symmetric);
+  }
+}
+
+void loop()
+{
+}
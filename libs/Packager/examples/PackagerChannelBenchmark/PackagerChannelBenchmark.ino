@@ -0,0 +1,173 @@
+/**
+ * @file PackagerChannelBenchmark.ino
+ * @brief Per-channel throughput and console latency over one link
+ *
+ * This example runs three channels from one CRCPackageInterface to another
+ * over an emulated 115200 baud link:
+ * - Console: a 4-byte message every 250 ms, carrying its send time
+ * - Telemetry: a 40-byte frame every 100 ms
+ * - Firmware: bulk data, as fast as the link allows, with large buffers
+ *
+ * It is run twice. "Single queue" gives every channel the same priority
+ * and lets the whole firmware buffer queue up in front of the interface,
+ * like ad-hoc sub-framing over one stream. "Prioritized" gives the
+ * console and the telemetry higher priorities and keeps the default
+ * backlog limit. For each channel it prints the throughput and the
+ * credit stalls, and for the console the average and worst latency.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include <CRCPackageInterface.h>
+#include <ChannelMultiplexer.h>
+#include <LinkEmulator.h>
+#include <PipedStream.h>
+
+// Duration of each measurement
+const unsigned long RUN_TIME = 10000;
+
+// Interface buffers, shared by all channels of the multiplexer
+const uint16_t BUFFER_SIZE = 256;
+const uint8_t WINDOW_SIZE = 4;
+
+// Channel numbers, the same on both ends
+const uint8_t CONSOLE = 0;
+const uint8_t TELEMETRY = 1;
+const uint8_t FIRMWARE = 2;
+
+const unsigned long CONSOLE_PERIOD = 250;
+const unsigned long TELEMETRY_PERIOD = 100;
+const uint8_t TELEMETRY_LENGTH = 40;
+
+StaticPipedStreamPair<BUFFER_SIZE> streamsA;
+StaticPipedStreamPair<BUFFER_SIZE> streamsB;
+StaticPipedStreamPair<64> consoleA;
+StaticPipedStreamPair<64> consoleB;
+StaticPipedStreamPair<64> telemetryA;
+StaticPipedStreamPair<64> telemetryB;
+StaticPipedStreamPair<512> firmwareA;
+StaticPipedStreamPair<512> firmwareB;
+
+// 115200 baud with a 5 ms latency, no errors
+LinkChannel::Settings serialLink()
+{
+  LinkChannel::Settings settings = {};
+  settings.bytesPerSecond = 11520;
+  settings.latencyUs = 5000;
+  return settings;
+}
+
+// Prints the throughput and credit stalls of one channel
+void printChannel(const __FlashStringHelper *name, const ChannelMultiplexer &sender,
+                  const ChannelMultiplexer &receiver, const uint8_t channel)
+{
+  Serial.print(F("  "));
+  Serial.print(name);
+  Serial.print(F(": "));
+  Serial.print(receiver.getStatistics(channel).bytesReceived * 1000UL / RUN_TIME);
+  Serial.print(F(" B/s, "));
+  Serial.print(sender.getStatistics(channel).creditStalls);
+  Serial.println(F(" credit stalls"));
+}
+
+// Runs all channels from A to B for RUN_TIME and prints the results
+void runCase(const __FlashStringHelper *name, const bool prioritized)
+{
+  CRCPackageInterface a(streamsA, BUFFER_SIZE, WINDOW_SIZE, PACKAGER_MAX_DATA_LENGTH);
+  CRCPackageInterface b(streamsB, BUFFER_SIZE, WINDOW_SIZE, PACKAGER_MAX_DATA_LENGTH);
+  LinkEmulator link(a.getEncodedStream(), b.getEncodedStream());
+  link.setSettings(serialLink());
+  randomSeed(1);
+
+  // Without a backlog limit, the whole firmware buffer can queue in the interface
+  const uint16_t backlog = prioritized ? 64 : 512;
+  ChannelMultiplexer muxA(a, 32, backlog);
+  ChannelMultiplexer muxB(b, 32, backlog);
+  muxA.addChannel(CONSOLE, consoleA, prioritized ? 2 : 0);
+  muxA.addChannel(TELEMETRY, telemetryA, prioritized ? 1 : 0);
+  muxA.addChannel(FIRMWARE, firmwareA, 0);
+  muxB.addChannel(CONSOLE, consoleB, prioritized ? 2 : 0);
+  muxB.addChannel(TELEMETRY, telemetryB, prioritized ? 1 : 0);
+  muxB.addChannel(FIRMWARE, firmwareB, 0);
+
+  uint32_t messages = 0;
+  uint32_t totalLatency = 0;
+  unsigned long maxLatency = 0;
+
+  const unsigned long start = millis();
+  unsigned long lastConsole = start;
+  unsigned long lastTelemetry = start;
+  while (millis() - start < RUN_TIME)
+  {
+    const unsigned long now = millis();
+    if (now - lastConsole >= CONSOLE_PERIOD && consoleA.first.availableForWrite() >= 4)
+    {
+      lastConsole = now;
+      const uint32_t sendTime = now;
+      consoleA.first.write(reinterpret_cast<const uint8_t *>(&sendTime), sizeof(sendTime));
+    }
+    if (now - lastTelemetry >= TELEMETRY_PERIOD)
+    {
+      lastTelemetry = now;
+      for (uint8_t i = 0; i < TELEMETRY_LENGTH && telemetryA.first.availableForWrite() > 0; i++)
+      {
+        telemetryA.first.write(i);
+      }
+    }
+    while (firmwareA.first.availableForWrite() > 0)
+    {
+      firmwareA.first.write(0xFF);
+    }
+
+    muxA.loop();
+    muxB.loop();
+    link.loop();
+
+    while (consoleB.first.available() >= 4)
+    {
+      uint32_t sendTime;
+      consoleB.first.readBytes(reinterpret_cast<uint8_t *>(&sendTime), sizeof(sendTime));
+      const unsigned long latency = millis() - sendTime;
+      totalLatency += latency;
+      maxLatency = max(maxLatency, latency);
+      messages++;
+    }
+    telemetryB.clear();
+    firmwareB.clear();
+  }
+
+  // Drop data still queued for the next case
+  streamsA.clear();
+  streamsB.clear();
+  consoleA.clear();
+  telemetryA.clear();
+  firmwareA.clear();
+  consoleB.clear();
+
+  Serial.println(name);
+  printChannel(F("console"), muxA, muxB, CONSOLE);
+  Serial.print(F("    latency: avg "));
+  Serial.print(messages ? totalLatency / messages : 0);
+  Serial.print(F(" ms, max "));
+  Serial.print(maxLatency);
+  Serial.println(F(" ms"));
+  printChannel(F("telemetry"), muxA, muxB, TELEMETRY);
+  printChannel(F("firmware"), muxA, muxB, FIRMWARE);
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(1000);
+
+  Serial.println(F("Packager Channel Benchmark"));
+  Serial.println(F("=========================="));
+
+  runCase(F("Single queue"), false);
+  runCase(F("Prioritized"), true);
+}
+
+void loop()
+{
+}
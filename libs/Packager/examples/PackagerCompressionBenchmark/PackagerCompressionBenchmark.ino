@@ -0,0 +1,323 @@
+/**
+ * @file PackagerCompressionBenchmark.ino
+ * @brief Compression ratio, CPU cost and goodput of the compression stage
+ *
+ * This example replays recorded telemetry, once as CSV text and once as
+ * packed binary frames:
+ * - Through LZCompressor and LZDecompressor alone, printing the
+ *   compression ratio and the CPU cycles per plain byte of each
+ * - From one CRCPackageInterface to another over an emulated HC-05 link
+ *   (9600 baud, Bluetooth-like latency), with and without a
+ *   CompressionStage, printing the goodput and the bytes on the wire
+ *
+ * Compression pays off when the link is the bottleneck. The cycles per
+ * byte times the link rate, over F_CPU, is the share of the CPU it costs. Build with
+ * -DPACKAGER_MAX_DATA_LENGTH=32 to see the effect with larger packets,
+ * and replace the recordings with data from the application at hand.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include <CRCPackageInterface.h>
+#include <CompressionStage.h>
+#include <LinkEmulator.h>
+#include <PipedStream.h>
+
+// Duration of each link measurement
+const unsigned long RUN_TIME = 10000;
+
+// Times each recording is compressed in the codec measurement
+const uint8_t CODEC_PASSES = 8;
+
+// Interface buffers; the encoded side holds a window of compressed packets
+const uint16_t BUFFER_SIZE = 256;
+const uint8_t WINDOW_SIZE = 4;
+
+// 48 lines of time,temperature,humidity,pressure,ax,ay,az at 10 Hz
+const char CSV_RECORDING[] PROGMEM =
+    "3600101,23.40,45.3,1013.25,-0.03,0.03,1.00\n"
+    "3600201,23.41,45.2,1013.25,0.01,-0.02,0.96\n"
+    "3600301,23.40,45.3,1013.25,-0.02,-0.03,1.00\n"
+    "3600400,23.40,45.2,1013.25,-0.02,0.02,1.00\n"
+    "3600500,23.39,45.2,1013.25,-0.03,0.01,0.97\n"
+    "3600601,23.38,45.2,1013.25,0.01,-0.01,1.00\n"
+    "3600701,23.38,45.1,1013.25,-0.01,-0.03,1.00\n"
+    "3600801,23.38,45.0,1013.25,0.00,0.02,1.00\n"
+    "3600900,23.39,45.1,1013.24,-0.01,-0.01,0.97\n"
+    "3601000,23.39,45.1,1013.25,0.01,0.00,0.98\n"
+    "3601099,23.40,45.0,1013.25,-0.03,0.01,0.99\n"
+    "3601199,23.41,45.0,1013.24,0.00,-0.03,0.96\n"
+    "3601300,23.42,45.0,1013.23,0.01,0.03,0.99\n"
+    "3601400,23.42,45.0,1013.22,0.02,0.02,0.96\n"
+    "3601500,23.43,44.9,1013.21,-0.01,0.02,0.99\n"
+    "3601601,23.43,45.0,1013.22,-0.02,0.01,0.96\n"
+    "3601700,23.43,45.0,1013.23,-0.02,0.02,0.97\n"
+    "3601799,23.42,45.1,1013.23,-0.02,0.00,0.99\n"
+    "3601900,23.42,45.2,1013.24,0.02,0.00,0.98\n"
+    "3601999,23.42,45.2,1013.24,-0.02,-0.02,0.97\n"
+    "3602099,23.42,45.3,1013.24,-0.01,-0.01,0.96\n"
+    "3602199,23.41,45.2,1013.25,0.01,0.01,0.98\n"
+    "3602299,23.41,45.3,1013.24,0.00,0.00,0.99\n"
+    "3602399,23.40,45.4,1013.24,-0.02,-0.03,0.97\n"
+    "3602498,23.40,45.4,1013.25,0.01,-0.03,0.96\n"
+    "3602598,23.40,45.3,1013.25,-0.01,0.01,0.96\n"
+    "3602698,23.40,45.2,1013.24,-0.02,0.02,0.98\n"
+    "3602799,23.41,45.3,1013.24,-0.03,0.03,0.99\n"
+    "3602898,23.40,45.4,1013.25,-0.03,-0.02,0.96\n"
+    "3602999,23.41,45.5,1013.25,0.01,-0.03,0.97\n"
+    "3603100,23.41,45.4,1013.25,0.03,0.01,0.98\n"
+    "3603200,23.42,45.3,1013.26,-0.02,-0.01,0.97\n"
+    "3603301,23.42,45.2,1013.26,0.03,-0.02,0.99\n"
+    "3603401,23.42,45.1,1013.25,-0.01,0.02,0.96\n"
+    "3603501,23.43,45.2,1013.26,-0.02,0.02,1.00\n"
+    "3603602,23.42,45.2,1013.27,-0.03,-0.02,0.96\n"
+    "3603702,23.41,45.2,1013.28,-0.02,0.00,1.00\n"
+    "3603802,23.40,45.2,1013.28,0.03,0.02,0.96\n"
+    "3603901,23.40,45.3,1013.28,0.00,0.03,0.98\n"
+    "3604001,23.39,45.4,1013.27,0.02,-0.03,0.97\n"
+    "3604101,23.39,45.4,1013.27,0.01,0.00,0.97\n"
+    "3604200,23.40,45.4,1013.27,-0.03,-0.03,0.96\n"
+    "3604300,23.39,45.4,1013.27,-0.03,-0.01,0.97\n"
+    "3604401,23.39,45.3,1013.28,-0.01,0.01,0.99\n"
+    "3604501,23.39,45.3,1013.27,0.02,0.01,1.00\n"
+    "3604600,23.39,45.2,1013.27,0.01,0.01,0.96\n"
+    "3604699,23.39,45.1,1013.27,0.03,0.03,0.97\n"
+    "3604799,23.39,45.2,1013.27,0.01,-0.03,0.98\n";
+
+// The same samples as packed 18-byte frames: sync, sequence, time, fixed-point values
+const uint8_t BINARY_RECORDING[] PROGMEM = {
+    0x5A, 0x00, 0xE5, 0xEE, 0x36, 0x00, 0x24, 0x09, 0xC5, 0x01, 0x3D, 0x2C, 0xE2, 0xFF, 0x1E, 0x00, 0xE8, 0x03,
+    0x5A, 0x01, 0x49, 0xEF, 0x36, 0x00, 0x25, 0x09, 0xC4, 0x01, 0x3D, 0x2C, 0x0A, 0x00, 0xEC, 0xFF, 0xC0, 0x03,
+    0x5A, 0x02, 0xAD, 0xEF, 0x36, 0x00, 0x24, 0x09, 0xC5, 0x01, 0x3D, 0x2C, 0xEC, 0xFF, 0xE2, 0xFF, 0xE8, 0x03,
+    0x5A, 0x03, 0x10, 0xF0, 0x36, 0x00, 0x24, 0x09, 0xC4, 0x01, 0x3D, 0x2C, 0xEC, 0xFF, 0x14, 0x00, 0xE8, 0x03,
+    0x5A, 0x04, 0x74, 0xF0, 0x36, 0x00, 0x23, 0x09, 0xC4, 0x01, 0x3D, 0x2C, 0xE2, 0xFF, 0x0A, 0x00, 0xCA, 0x03,
+    0x5A, 0x05, 0xD9, 0xF0, 0x36, 0x00, 0x22, 0x09, 0xC4, 0x01, 0x3D, 0x2C, 0x0A, 0x00, 0xF6, 0xFF, 0xE8, 0x03,
+    0x5A, 0x06, 0x3D, 0xF1, 0x36, 0x00, 0x22, 0x09, 0xC3, 0x01, 0x3D, 0x2C, 0xF6, 0xFF, 0xE2, 0xFF, 0xE8, 0x03,
+    0x5A, 0x07, 0xA1, 0xF1, 0x36, 0x00, 0x22, 0x09, 0xC2, 0x01, 0x3D, 0x2C, 0x00, 0x00, 0x14, 0x00, 0xE8, 0x03,
+    0x5A, 0x08, 0x04, 0xF2, 0x36, 0x00, 0x23, 0x09, 0xC3, 0x01, 0x3C, 0x2C, 0xF6, 0xFF, 0xF6, 0xFF, 0xCA, 0x03,
+    0x5A, 0x09, 0x68, 0xF2, 0x36, 0x00, 0x23, 0x09, 0xC3, 0x01, 0x3D, 0x2C, 0x0A, 0x00, 0x00, 0x00, 0xD4, 0x03,
+    0x5A, 0x0A, 0xCB, 0xF2, 0x36, 0x00, 0x24, 0x09, 0xC2, 0x01, 0x3D, 0x2C, 0xE2, 0xFF, 0x0A, 0x00, 0xDE, 0x03,
+    0x5A, 0x0B, 0x2F, 0xF3, 0x36, 0x00, 0x25, 0x09, 0xC2, 0x01, 0x3C, 0x2C, 0x00, 0x00, 0xE2, 0xFF, 0xC0, 0x03,
+    0x5A, 0x0C, 0x94, 0xF3, 0x36, 0x00, 0x26, 0x09, 0xC2, 0x01, 0x3B, 0x2C, 0x0A, 0x00, 0x1E, 0x00, 0xDE, 0x03,
+    0x5A, 0x0D, 0xF8, 0xF3, 0x36, 0x00, 0x26, 0x09, 0xC2, 0x01, 0x3A, 0x2C, 0x14, 0x00, 0x14, 0x00, 0xC0, 0x03,
+    0x5A, 0x0E, 0x5C, 0xF4, 0x36, 0x00, 0x27, 0x09, 0xC1, 0x01, 0x39, 0x2C, 0xF6, 0xFF, 0x14, 0x00, 0xDE, 0x03,
+    0x5A, 0x0F, 0xC1, 0xF4, 0x36, 0x00, 0x27, 0x09, 0xC2, 0x01, 0x3A, 0x2C, 0xEC, 0xFF, 0x0A, 0x00, 0xC0, 0x03,
+    0x5A, 0x10, 0x24, 0xF5, 0x36, 0x00, 0x27, 0x09, 0xC2, 0x01, 0x3B, 0x2C, 0xEC, 0xFF, 0x14, 0x00, 0xCA, 0x03,
+    0x5A, 0x11, 0x87, 0xF5, 0x36, 0x00, 0x26, 0x09, 0xC3, 0x01, 0x3B, 0x2C, 0xEC, 0xFF, 0x00, 0x00, 0xDE, 0x03,
+    0x5A, 0x12, 0xEC, 0xF5, 0x36, 0x00, 0x26, 0x09, 0xC4, 0x01, 0x3C, 0x2C, 0x14, 0x00, 0x00, 0x00, 0xD4, 0x03,
+    0x5A, 0x13, 0x4F, 0xF6, 0x36, 0x00, 0x26, 0x09, 0xC4, 0x01, 0x3C, 0x2C, 0xEC, 0xFF, 0xEC, 0xFF, 0xCA, 0x03,
+    0x5A, 0x14, 0xB3, 0xF6, 0x36, 0x00, 0x26, 0x09, 0xC5, 0x01, 0x3C, 0x2C, 0xF6, 0xFF, 0xF6, 0xFF, 0xC0, 0x03,
+    0x5A, 0x15, 0x17, 0xF7, 0x36, 0x00, 0x25, 0x09, 0xC4, 0x01, 0x3D, 0x2C, 0x0A, 0x00, 0x0A, 0x00, 0xD4, 0x03,
+    0x5A, 0x16, 0x7B, 0xF7, 0x36, 0x00, 0x25, 0x09, 0xC5, 0x01, 0x3C, 0x2C, 0x00, 0x00, 0x00, 0x00, 0xDE, 0x03,
+    0x5A, 0x17, 0xDF, 0xF7, 0x36, 0x00, 0x24, 0x09, 0xC6, 0x01, 0x3C, 0x2C, 0xEC, 0xFF, 0xE2, 0xFF, 0xCA, 0x03,
+    0x5A, 0x18, 0x42, 0xF8, 0x36, 0x00, 0x24, 0x09, 0xC6, 0x01, 0x3D, 0x2C, 0x0A, 0x00, 0xE2, 0xFF, 0xC0, 0x03,
+    0x5A, 0x19, 0xA6, 0xF8, 0x36, 0x00, 0x24, 0x09, 0xC5, 0x01, 0x3D, 0x2C, 0xF6, 0xFF, 0x0A, 0x00, 0xC0, 0x03,
+    0x5A, 0x1A, 0x0A, 0xF9, 0x36, 0x00, 0x24, 0x09, 0xC4, 0x01, 0x3C, 0x2C, 0xEC, 0xFF, 0x14, 0x00, 0xD4, 0x03,
+    0x5A, 0x1B, 0x6F, 0xF9, 0x36, 0x00, 0x25, 0x09, 0xC5, 0x01, 0x3C, 0x2C, 0xE2, 0xFF, 0x1E, 0x00, 0xDE, 0x03,
+    0x5A, 0x1C, 0xD2, 0xF9, 0x36, 0x00, 0x24, 0x09, 0xC6, 0x01, 0x3D, 0x2C, 0xE2, 0xFF, 0xEC, 0xFF, 0xC0, 0x03,
+    0x5A, 0x1D, 0x37, 0xFA, 0x36, 0x00, 0x25, 0x09, 0xC7, 0x01, 0x3D, 0x2C, 0x0A, 0x00, 0xE2, 0xFF, 0xCA, 0x03,
+    0x5A, 0x1E, 0x9C, 0xFA, 0x36, 0x00, 0x25, 0x09, 0xC6, 0x01, 0x3D, 0x2C, 0x1E, 0x00, 0x0A, 0x00, 0xD4, 0x03,
+    0x5A, 0x1F, 0x00, 0xFB, 0x36, 0x00, 0x26, 0x09, 0xC5, 0x01, 0x3E, 0x2C, 0xEC, 0xFF, 0xF6, 0xFF, 0xCA, 0x03,
+    0x5A, 0x20, 0x65, 0xFB, 0x36, 0x00, 0x26, 0x09, 0xC4, 0x01, 0x3E, 0x2C, 0x1E, 0x00, 0xEC, 0xFF, 0xDE, 0x03,
+    0x5A, 0x21, 0xC9, 0xFB, 0x36, 0x00, 0x26, 0x09, 0xC3, 0x01, 0x3D, 0x2C, 0xF6, 0xFF, 0x14, 0x00, 0xC0, 0x03,
+    0x5A, 0x22, 0x2D, 0xFC, 0x36, 0x00, 0x27, 0x09, 0xC4, 0x01, 0x3E, 0x2C, 0xEC, 0xFF, 0x14, 0x00, 0xE8, 0x03,
+    0x5A, 0x23, 0x92, 0xFC, 0x36, 0x00, 0x26, 0x09, 0xC4, 0x01, 0x3F, 0x2C, 0xE2, 0xFF, 0xEC, 0xFF, 0xC0, 0x03,
+    0x5A, 0x24, 0xF6, 0xFC, 0x36, 0x00, 0x25, 0x09, 0xC4, 0x01, 0x40, 0x2C, 0xEC, 0xFF, 0x00, 0x00, 0xE8, 0x03,
+    0x5A, 0x25, 0x5A, 0xFD, 0x36, 0x00, 0x24, 0x09, 0xC4, 0x01, 0x40, 0x2C, 0x1E, 0x00, 0x14, 0x00, 0xC0, 0x03,
+    0x5A, 0x26, 0xBD, 0xFD, 0x36, 0x00, 0x24, 0x09, 0xC5, 0x01, 0x40, 0x2C, 0x00, 0x00, 0x1E, 0x00, 0xD4, 0x03,
+    0x5A, 0x27, 0x21, 0xFE, 0x36, 0x00, 0x23, 0x09, 0xC6, 0x01, 0x3F, 0x2C, 0x14, 0x00, 0xE2, 0xFF, 0xCA, 0x03,
+    0x5A, 0x28, 0x85, 0xFE, 0x36, 0x00, 0x23, 0x09, 0xC6, 0x01, 0x3F, 0x2C, 0x0A, 0x00, 0x00, 0x00, 0xCA, 0x03,
+    0x5A, 0x29, 0xE8, 0xFE, 0x36, 0x00, 0x24, 0x09, 0xC6, 0x01, 0x3F, 0x2C, 0xE2, 0xFF, 0xE2, 0xFF, 0xC0, 0x03,
+    0x5A, 0x2A, 0x4C, 0xFF, 0x36, 0x00, 0x23, 0x09, 0xC6, 0x01, 0x3F, 0x2C, 0xE2, 0xFF, 0xF6, 0xFF, 0xCA, 0x03,
+    0x5A, 0x2B, 0xB1, 0xFF, 0x36, 0x00, 0x23, 0x09, 0xC5, 0x01, 0x40, 0x2C, 0xF6, 0xFF, 0x0A, 0x00, 0xDE, 0x03,
+    0x5A, 0x2C, 0x15, 0x00, 0x37, 0x00, 0x23, 0x09, 0xC5, 0x01, 0x3F, 0x2C, 0x14, 0x00, 0x0A, 0x00, 0xE8, 0x03,
+    0x5A, 0x2D, 0x78, 0x00, 0x37, 0x00, 0x23, 0x09, 0xC4, 0x01, 0x3F, 0x2C, 0x0A, 0x00, 0x0A, 0x00, 0xC0, 0x03,
+    0x5A, 0x2E, 0xDB, 0x00, 0x37, 0x00, 0x23, 0x09, 0xC3, 0x01, 0x3F, 0x2C, 0x1E, 0x00, 0x1E, 0x00, 0xCA, 0x03,
+    0x5A, 0x2F, 0x3F, 0x01, 0x37, 0x00, 0x23, 0x09, 0xC4, 0x01, 0x3F, 0x2C, 0x0A, 0x00, 0xE2, 0xFF, 0xD4, 0x03,
+};
+
+StaticPipedStreamPair<BUFFER_SIZE> streamsA;
+StaticPipedStreamPair<BUFFER_SIZE> streamsB;
+StaticPipedStreamPair<64> appStreamsA;
+StaticPipedStreamPair<64> appStreamsB;
+
+/**
+ * @brief Plays a recording from flash over and over
+ */
+class Player
+{
+public:
+  Player(const uint8_t *data, const uint16_t length) : m_data(data), m_length(length), m_position(0) {}
+
+  uint8_t next()
+  {
+    const uint8_t value = pgm_read_byte(m_data + m_position);
+    if (++m_position == m_length)
+    {
+      m_position = 0;
+    }
+    return value;
+  }
+
+private:
+  const uint8_t *m_data;
+  uint16_t m_length;
+  uint16_t m_position;
+};
+
+// HC-05 in data mode at its default 9600 baud
+LinkChannel::Settings hc05Link()
+{
+  LinkChannel::Settings settings = {};
+  settings.bytesPerSecond = 960;
+  settings.latencyUs = 20000;
+  settings.jitterUs = 10000;
+  return settings;
+}
+
+// Compresses and decompresses a recording, timing each codec
+void measureCodec(const __FlashStringHelper *name, const uint8_t *data, const uint16_t length)
+{
+  // Plain bytes go in at streamsA.first and come back out there
+  PipedStream &plainIn = streamsA.first;
+  PipedStream &plainOut = streamsA.second;
+  LZCompressor compressor;
+  LZDecompressor decompressor;
+  Player player(data, length);
+  Player reference(data, length);
+
+  const uint32_t total = (uint32_t)length * CODEC_PASSES;
+  const uint32_t cyclesPerMicro = F_CPU / 1000000UL;
+  uint32_t written = 0;
+  uint32_t checked = 0;
+  uint32_t compressUs = 0;
+  uint32_t decompressUs = 0;
+  bool intact = true;
+
+  while (checked < total)
+  {
+    while (written < total && plainIn.availableForWrite() > 0)
+    {
+      plainIn.write(player.next());
+      written++;
+    }
+
+    uint32_t start = micros();
+    compressor.compress(plainOut, streamsB.first);
+    compressUs += micros() - start;
+
+    start = micros();
+    decompressor.decompress(streamsB.second, plainOut);
+    decompressUs += micros() - start;
+
+    while (plainIn.available())
+    {
+      intact &= (plainIn.read() == reference.next());
+      checked++;
+    }
+  }
+
+  Serial.print(name);
+  Serial.print(F(": "));
+  Serial.print(compressor.getBytesIn());
+  Serial.print(F(" -> "));
+  Serial.print(compressor.getBytesOut());
+  Serial.print(F(" bytes ("));
+  Serial.print(100.0 * compressor.getBytesOut() / compressor.getBytesIn(), 1);
+  Serial.print(F("%), compress "));
+  Serial.print((float)compressUs * cyclesPerMicro / total, 1);
+  Serial.print(F(" cycles/byte, decompress "));
+  Serial.print((float)decompressUs * cyclesPerMicro / total, 1);
+  Serial.print(F(" cycles/byte"));
+  Serial.println(intact ? F("") : F(" (DATA MISMATCH)"));
+}
+
+// Streams a recording from A to B for RUN_TIME and prints the goodput
+void measureLink(const __FlashStringHelper *name, const uint8_t *data, const uint16_t length,
+                 const bool compressed)
+{
+  CRCPackageInterface a(streamsA, BUFFER_SIZE, WINDOW_SIZE, PACKAGER_MAX_DATA_LENGTH);
+  CRCPackageInterface b(streamsB, BUFFER_SIZE, WINDOW_SIZE, PACKAGER_MAX_DATA_LENGTH);
+  LinkEmulator link(a.getEncodedStream(), b.getEncodedStream());
+  link.setSettings(hc05Link());
+  randomSeed(1);
+
+  // The stages only run when compressing
+  CompressionStage stageA(appStreamsA, a);
+  CompressionStage stageB(appStreamsB, b);
+  PipedStream &input = compressed ? stageA.getPlainStream() : a.getPlainStream();
+  PipedStream &output = compressed ? stageB.getPlainStream() : b.getPlainStream();
+
+  Player player(data, length);
+  Player reference(data, length);
+  uint32_t received = 0;
+  bool intact = true;
+
+  const unsigned long start = millis();
+  while (millis() - start < RUN_TIME)
+  {
+    while (input.availableForWrite() > 0)
+    {
+      input.write(player.next());
+    }
+
+    if (compressed)
+    {
+      stageA.loop();
+      stageB.loop();
+    }
+    else
+    {
+      a.loop();
+      b.loop();
+    }
+    link.loop();
+
+    while (output.available())
+    {
+      intact &= (output.read() == reference.next());
+      received++;
+    }
+  }
+
+  // Drop data still queued for the next case
+  streamsA.clear();
+  streamsB.clear();
+  appStreamsA.clear();
+  appStreamsB.clear();
+
+  Serial.print(name);
+  Serial.print(compressed ? F(", compressed: ") : F(", plain: "));
+  Serial.print(received * 1000UL / RUN_TIME);
+  Serial.print(F(" B/s, wire "));
+  Serial.print(link.forward().getStatistics().bytesSent * 1000UL / RUN_TIME);
+  Serial.print(F(" B/s"));
+  Serial.println(intact ? F("") : F(" (DATA MISMATCH)"));
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(1000);
+
+  Serial.println(F("Packager Compression Benchmark"));
+  Serial.println(F("=============================="));
+
+  const uint8_t *csv = reinterpret_cast<const uint8_t *>(CSV_RECORDING);
+  const uint16_t csvLength = sizeof(CSV_RECORDING) - 1;
+
+  Serial.println(F("Codec:"));
+  measureCodec(F("CSV"), csv, csvLength);
+  measureCodec(F("Binary"), BINARY_RECORDING, sizeof(BINARY_RECORDING));
+
+  Serial.println(F("HC-05 link, 9600 baud:"));
+  measureLink(F("CSV"), csv, csvLength, false);
+  measureLink(F("CSV"), csv, csvLength, true);
+  measureLink(F("Binary"), BINARY_RECORDING, sizeof(BINARY_RECORDING), false);
+  measureLink(F("Binary"), BINARY_RECORDING, sizeof(BINARY_RECORDING), true);
+}
+
+void loop()
+{
+}
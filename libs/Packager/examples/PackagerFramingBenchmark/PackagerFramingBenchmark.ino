@@ -0,0 +1,160 @@
+/**
+ * @file PackagerFramingBenchmark.ino
+ * @brief Recovery time after stream corruption for each framing
+ *
+ * This example connects two CRCPackageInterface instances through a
+ * LinkEmulator and streams data from one side to the other. At regular
+ * intervals a burst of noise is inserted into the stream at a random
+ * position of the next packets sent, biased towards the bytes
+ * the framings synchronize on (0xAA and 0x00). For start/stop and COBS
+ * framing, and for stop-and-wait and the largest window, it prints the
+ * goodput and the average and worst recovery time: the time from the
+ * noise entering the line until everything sent before it has been
+ * delivered.
+ *
+ * With start/stop framing a spurious start byte makes the receiver
+ * read a misaligned packet, which may swallow the real one and wait
+ * for the reception timeout. With COBS framing decoding restarts at
+ * the next 0x00 delimiter, so at most the packet hit by the noise is
+ * lost and recovered by retransmission.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include <CRCPackageInterface.h>
+#include <LinkEmulator.h>
+#include <PipedStream.h>
+
+// Duration of each measurement
+const unsigned long RUN_TIME = 10000;
+
+// One-way delay of the emulated link
+const uint16_t LINK_DELAY_MS = 5;
+
+// Time between noise bursts
+const uint16_t NOISE_INTERVAL_MS = 250;
+
+// Buffers per interface; the encoded side holds a full window of packets
+const uint16_t BUFFER_SIZE = 128;
+
+StaticPipedStreamPair<BUFFER_SIZE> streamsA;
+StaticPipedStreamPair<BUFFER_SIZE> streamsB;
+
+// Random bytes, a quarter of them start bytes and a quarter delimiters
+uint8_t makeNoise(uint8_t *noise)
+{
+  const uint8_t length = random(1, LinkChannel::MAX_NOISE_LENGTH + 1);
+  for (uint8_t i = 0; i < length; i++)
+  {
+    const uint8_t kind = random(4);
+    noise[i] = kind == 0 ? 0xAA : (kind == 1 ? 0x00 : (uint8_t)random(256));
+  }
+  return length;
+}
+
+// Streams data from A to B with periodic noise and prints the results
+void runCase(const CRCPackageInterface::Framing framing, const uint8_t windowSize)
+{
+  CRCPackageInterface a(streamsA, BUFFER_SIZE, windowSize, 8, framing);
+  CRCPackageInterface b(streamsB, BUFFER_SIZE, windowSize, 8, framing);
+  randomSeed(1);
+
+  LinkEmulator link(a.getEncodedStream(), b.getEncodedStream());
+  LinkChannel::Settings settings = {};
+  settings.latencyUs = LINK_DELAY_MS * 1000UL;
+  link.setSettings(settings);
+
+  uint8_t nextSent = 0;
+  uint8_t nextExpected = 0;
+  uint32_t sent = 0;
+  uint32_t received = 0;
+  bool intact = true;
+
+  uint16_t bursts = 0;
+  uint32_t totalRecovery = 0;
+  unsigned long maxRecovery = 0;
+  bool recovering = false;
+  unsigned long noiseTime = 0;
+  uint32_t recoveredAt = 0;
+
+  const unsigned long start = millis();
+  unsigned long lastNoise = start;
+  while (millis() - start < RUN_TIME)
+  {
+    while (a.getPlainStream().availableForWrite() > 0)
+    {
+      a.getPlainStream().write(nextSent++);
+      sent++;
+    }
+
+    // A burst during recovery is folded into the one being measured
+    if (millis() - lastNoise >= NOISE_INTERVAL_MS)
+    {
+      lastNoise = millis();
+      uint8_t noise[LinkChannel::MAX_NOISE_LENGTH];
+      link.forward().injectNoise(noise, makeNoise(noise));
+    }
+
+    a.loop();
+    b.loop();
+    const bool noisePending = link.forward().noisePending();
+    link.loop();
+    if (noisePending && !link.forward().noisePending() && !recovering)
+    {
+      // Recovered once every byte already taken into packets arrived
+      recovering = true;
+      noiseTime = millis();
+      recoveredAt = sent - (BUFFER_SIZE - a.getPlainStream().availableForWrite());
+    }
+
+    while (b.getPlainStream().available())
+    {
+      intact &= (b.getPlainStream().read() == nextExpected++);
+      received++;
+    }
+
+    if (recovering && received >= recoveredAt)
+    {
+      const unsigned long recovery = millis() - noiseTime;
+      totalRecovery += recovery;
+      maxRecovery = max(maxRecovery, recovery);
+      bursts++;
+      recovering = false;
+    }
+  }
+
+  // Drop data still queued for the next case
+  streamsA.clear();
+  streamsB.clear();
+
+  Serial.print(framing == CRCPackageInterface::COBS_FRAMING ? F("COBS      ") : F("Start/stop"));
+  Serial.print(F(", window "));
+  Serial.print(windowSize);
+  Serial.print(F(": "));
+  Serial.print(received * 1000UL / RUN_TIME);
+  Serial.print(F(" B/s, recovery avg "));
+  Serial.print(bursts ? totalRecovery / bursts : 0);
+  Serial.print(F(" ms, max "));
+  Serial.print(maxRecovery);
+  Serial.print(F(" ms"));
+  Serial.println(intact ? F("") : F(" (DATA MISMATCH)"));
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(1000);
+
+  Serial.println(F("Packager Framing Benchmark"));
+  Serial.println(F("=========================="));
+
+  runCase(CRCPackageInterface::START_STOP_FRAMING, 1);
+  runCase(CRCPackageInterface::COBS_FRAMING, 1);
+  runCase(CRCPackageInterface::START_STOP_FRAMING, PACKAGER_MAX_WINDOW_SIZE);
+  runCase(CRCPackageInterface::COBS_FRAMING, PACKAGER_MAX_WINDOW_SIZE);
+}
+
+void loop()
+{
+}
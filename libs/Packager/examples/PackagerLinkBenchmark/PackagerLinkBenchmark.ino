@@ -0,0 +1,223 @@
+/**
+ * @file PackagerLinkBenchmark.ino
+ * @brief Protocol behaviour over emulated lossy links
+ *
+ * This example connects two CRCPackageInterface instances through a
+ * LinkEmulator and streams data from one side to the other over a range
+ * of link conditions: bit errors, lost and duplicated bytes, jitter and
+ * outages. For stop-and-wait and the largest window it prints:
+ * - Goodput and whether the data arrived intact
+ * - Retransmissions after a timeout and after a NACK
+ * - Packets rejected by both ends, by NackReason, and partial packets
+ *   dropped after the reception timeout
+ * - Connection resets
+ * - For links with outages, the average and worst recovery time: the
+ *   time from the end of an outage until everything sent before it has
+ *   been delivered
+ *
+ * The numbers are inputs for protocol tuning: payload size, window,
+ * framing and timeouts. Change the scenarios in setup() to match the
+ * link at hand.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include <CRCPackageInterface.h>
+#include <LinkEmulator.h>
+#include <PipedStream.h>
+
+// Duration of each measurement
+const unsigned long RUN_TIME = 5000;
+
+// Time between the starts of two outages
+const unsigned long OUTAGE_INTERVAL = 1000;
+
+// Room for a full window of packets in each buffer of both interfaces
+const uint16_t BUFFER_SIZE = 256;
+
+StaticPipedStreamPair<BUFFER_SIZE> streamsA;
+StaticPipedStreamPair<BUFFER_SIZE> streamsB;
+
+// 115200 baud with a 5 ms latency, no errors
+LinkChannel::Settings serialLink()
+{
+  LinkChannel::Settings settings = {};
+  settings.bytesPerSecond = 11520;
+  settings.latencyUs = 5000;
+  return settings;
+}
+
+// Streams data from A to B for RUN_TIME and prints the results
+void runCase(const __FlashStringHelper *name, const LinkChannel::Settings &settings, const uint16_t outageMs,
+             const uint8_t windowSize)
+{
+  CRCPackageInterface a(streamsA, BUFFER_SIZE, windowSize);
+  CRCPackageInterface b(streamsB, BUFFER_SIZE, windowSize);
+  LinkEmulator link(a.getEncodedStream(), b.getEncodedStream());
+  link.setSettings(settings);
+  randomSeed(1);
+
+  uint8_t nextSent = 0;
+  uint8_t nextExpected = 0;
+  uint32_t sent = 0;
+  uint32_t received = 0;
+  bool intact = true;
+
+  uint16_t outages = 0;
+  uint32_t totalRecovery = 0;
+  unsigned long maxRecovery = 0;
+  bool inOutage = false;
+  bool recovering = false;
+  unsigned long outageEnd = 0;
+  uint32_t recoveredAt = 0;
+
+  const unsigned long start = millis();
+  unsigned long lastOutage = start;
+  while (millis() - start < RUN_TIME)
+  {
+    while (a.getPlainStream().availableForWrite() > 0)
+    {
+      a.getPlainStream().write(nextSent++);
+      sent++;
+    }
+
+    // An outage during recovery is folded into the one being measured
+    if (outageMs > 0 && millis() - lastOutage >= OUTAGE_INTERVAL)
+    {
+      lastOutage = millis();
+      link.startOutage(outageMs);
+      inOutage = true;
+    }
+    if (inOutage && !link.forward().inOutage())
+    {
+      // Recovered once every byte already taken into packets arrived
+      inOutage = false;
+      if (!recovering)
+      {
+        recovering = true;
+        outageEnd = millis();
+        recoveredAt = sent - (BUFFER_SIZE - a.getPlainStream().availableForWrite());
+      }
+    }
+
+    a.loop();
+    b.loop();
+    link.loop();
+
+    while (b.getPlainStream().available())
+    {
+      intact &= (b.getPlainStream().read() == nextExpected++);
+      received++;
+    }
+
+    if (recovering && received >= recoveredAt)
+    {
+      const unsigned long recovery = millis() - outageEnd;
+      totalRecovery += recovery;
+      maxRecovery = max(maxRecovery, recovery);
+      outages++;
+      recovering = false;
+    }
+  }
+
+  // Drop data still queued for the next case
+  streamsA.clear();
+  streamsB.clear();
+
+  const CRCPackageInterface::LinkStatistics &statsA = a.getStatistics();
+  const CRCPackageInterface::LinkStatistics &statsB = b.getStatistics();
+
+  Serial.print(name);
+  Serial.print(F(", window "));
+  Serial.print(windowSize);
+  Serial.print(F(": "));
+  Serial.print(received * 1000UL / RUN_TIME);
+  Serial.print(F(" B/s"));
+  Serial.println(intact ? F("") : F(" (DATA MISMATCH)"));
+
+  Serial.print(F("  retransmissions: timeout "));
+  Serial.print(statsA.timeoutRetransmissions);
+  Serial.print(F(", NACK "));
+  Serial.print(statsA.nackRetransmissions);
+  Serial.print(F("; resets "));
+  Serial.println(statsA.connectionResets + statsB.connectionResets);
+
+  Serial.print(F("  rejected: CRC "));
+  Serial.print(a.getRejectedPackets(CRCPackageInterface::INVALID_CRC) +
+               b.getRejectedPackets(CRCPackageInterface::INVALID_CRC));
+  Serial.print(F(", start/stop "));
+  Serial.print(a.getRejectedPackets(CRCPackageInterface::INVALID_START_STOP) +
+               b.getRejectedPackets(CRCPackageInterface::INVALID_START_STOP));
+  Serial.print(F(", type "));
+  Serial.print(a.getRejectedPackets(CRCPackageInterface::INVALID_TYPE) +
+               b.getRejectedPackets(CRCPackageInterface::INVALID_TYPE));
+  Serial.print(F(", length "));
+  Serial.print(a.getRejectedPackets(CRCPackageInterface::INVALID_LENGTH) +
+               b.getRejectedPackets(CRCPackageInterface::INVALID_LENGTH));
+  Serial.print(F(", incomplete "));
+  Serial.println(statsA.incompletePackets + statsB.incompletePackets);
+
+  if (outageMs > 0)
+  {
+    Serial.print(F("  recovery: avg "));
+    Serial.print(outages ? totalRecovery / outages : 0);
+    Serial.print(F(" ms, max "));
+    Serial.print(maxRecovery);
+    Serial.println(F(" ms"));
+  }
+}
+
+// Runs a scenario with stop-and-wait and the largest window
+void runScenario(const __FlashStringHelper *name, const LinkChannel::Settings &settings,
+                 const uint16_t outageMs = 0)
+{
+  runCase(name, settings, outageMs, 1);
+  runCase(name, settings, outageMs, PACKAGER_MAX_WINDOW_SIZE);
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(1000);
+
+  Serial.println(F("Packager Link Benchmark"));
+  Serial.println(F("======================="));
+
+  LinkChannel::Settings settings = serialLink();
+  runScenario(F("Clean"), settings);
+
+  settings = serialLink();
+  settings.bitErrorPpm = 10;
+  runScenario(F("BER 1e-5"), settings);
+
+  settings = serialLink();
+  settings.bitErrorPpm = 100;
+  runScenario(F("BER 1e-4"), settings);
+
+  settings = serialLink();
+  settings.dropPpm = 1000;
+  runScenario(F("0.1% bytes lost"), settings);
+
+  settings = serialLink();
+  settings.duplicatePpm = 1000;
+  runScenario(F("0.1% bytes duplicated"), settings);
+
+  settings = serialLink();
+  settings.jitterUs = 10000;
+  runScenario(F("10 ms jitter"), settings);
+
+  settings = serialLink();
+  runScenario(F("100 ms outages"), settings, 100);
+
+  // Bluetooth SPP-like: slow and uneven delivery, some noise and dropouts
+  settings = serialLink();
+  settings.latencyUs = 15000;
+  settings.jitterUs = 15000;
+  settings.bitErrorPpm = 10;
+  runScenario(F("Bluetooth-like"), settings, 50);
+}
+
+void loop()
+{
+}
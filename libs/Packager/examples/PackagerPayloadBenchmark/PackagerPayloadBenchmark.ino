@@ -0,0 +1,136 @@
+/**
+ * @file PackagerPayloadBenchmark.ino
+ * @brief Goodput versus payload size of CRCPackageInterface
+ *
+ * This example connects two CRCPackageInterface instances through an
+ * emulated serial link with a fixed bandwidth and latency, then streams
+ * data across it for every payload size up to MAX_DATA_LENGTH. Each line
+ * shows the goodput and the link efficiency (goodput / bandwidth) for
+ * stop-and-wait and for the largest window.
+ *
+ * Payloads above the default 8 bytes need a larger buffer size, set as a
+ * build flag so the library is compiled with it too, for example
+ * -DPACKAGER_MAX_DATA_LENGTH=128. On AVR the buffers are sized for an
+ * Uno and the sweep stops at 16 bytes; other boards measure up to 255.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include <CRCPackageInterface.h>
+#include <LinkEmulator.h>
+#include <PipedStream.h>
+
+// Duration of each measurement
+const unsigned long RUN_TIME = 3000;
+
+// Emulated link: 115200 baud (11520 bytes/s) with 5 ms one-way latency
+const uint32_t LINK_BYTES_PER_SECOND = 11520;
+const uint32_t LINK_LATENCY_US = 5000;
+
+// Payload sizes to measure (sizes above MAX_PAYLOAD are skipped)
+const uint8_t PAYLOAD_SIZES[] = {4, 8, 16, 32, 64, 128, 255};
+
+// The encoded buffer holds a full window of the largest packets
+#if defined(__AVR__)
+const uint16_t BUFFER_SIZE = 128;
+const uint8_t MAX_PAYLOAD = 16;
+#else
+const uint16_t BUFFER_SIZE = 2048;
+const uint8_t MAX_PAYLOAD = 255;
+#endif
+
+StaticPipedStreamPair<BUFFER_SIZE> streamsA;
+StaticPipedStreamPair<BUFFER_SIZE> streamsB;
+
+// Streams data from A to B for RUN_TIME and returns the goodput in bytes/s
+uint32_t runCase(const uint8_t dataLength, const uint8_t windowSize)
+{
+  CRCPackageInterface a(streamsA, BUFFER_SIZE, windowSize, dataLength);
+  CRCPackageInterface b(streamsB, BUFFER_SIZE, windowSize, dataLength);
+  LinkEmulator link(a.getEncodedStream(), b.getEncodedStream());
+  LinkChannel::Settings settings = {};
+  settings.bytesPerSecond = LINK_BYTES_PER_SECOND;
+  settings.latencyUs = LINK_LATENCY_US;
+  link.setSettings(settings);
+
+  uint8_t nextSent = 0;
+  uint8_t nextExpected = 0;
+  uint32_t received = 0;
+  bool intact = true;
+
+  const unsigned long start = millis();
+  while (millis() - start < RUN_TIME)
+  {
+    while (a.getPlainStream().availableForWrite() > 0)
+    {
+      a.getPlainStream().write(nextSent++);
+    }
+
+    a.loop();
+    b.loop();
+    link.loop();
+
+    while (b.getPlainStream().available())
+    {
+      intact &= (b.getPlainStream().read() == nextExpected++);
+      received++;
+    }
+  }
+
+  // Drop data still queued for the next case
+  streamsA.clear();
+  streamsB.clear();
+
+  if (!intact)
+  {
+    Serial.println(F("DATA MISMATCH"));
+  }
+  return received * 1000UL / RUN_TIME;
+}
+
+// Prints goodput and link efficiency
+void printResult(const uint32_t goodput)
+{
+  Serial.print(goodput);
+  Serial.print(F(" B/s ("));
+  Serial.print(goodput * 100UL / LINK_BYTES_PER_SECOND);
+  Serial.print(F("%)"));
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(1000);
+
+  Serial.println(F("Packager Payload Benchmark"));
+  Serial.println(F("=========================="));
+  Serial.print(F("Link: "));
+  Serial.print(LINK_BYTES_PER_SECOND);
+  Serial.print(F(" B/s, RTT "));
+  Serial.print(2 * LINK_LATENCY_US / 1000);
+  Serial.println(F(" ms"));
+
+  for (uint8_t i = 0; i < sizeof(PAYLOAD_SIZES); i++)
+  {
+    const uint8_t dataLength = PAYLOAD_SIZES[i];
+    if (dataLength > CRCPackageInterface::MAX_DATA_LENGTH || dataLength > MAX_PAYLOAD)
+    {
+      break;
+    }
+
+    Serial.print(F("Payload "));
+    Serial.print(dataLength);
+    Serial.print(F(" B: window 1 "));
+    printResult(runCase(dataLength, 1));
+    Serial.print(F(", window "));
+    Serial.print(PACKAGER_MAX_WINDOW_SIZE);
+    Serial.print(F(" "));
+    printResult(runCase(dataLength, PACKAGER_MAX_WINDOW_SIZE));
+    Serial.println();
+  }
+}
+
+void loop()
+{
+}
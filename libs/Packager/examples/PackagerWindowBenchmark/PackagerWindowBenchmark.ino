@@ -0,0 +1,107 @@
+/**
+ * @file PackagerWindowBenchmark.ino
+ * @brief Goodput versus round-trip time for each sliding-window size
+ *
+ * This example connects two CRCPackageInterface instances through a
+ * LinkEmulator that holds every byte for a configurable time, emulating
+ * a link with a given round-trip time. For each delay and window size it
+ * streams data from one side to the other, checks that it arrives intact
+ * and in order, and prints the goodput together with the sender's
+ * retransmission timeout and retransmission count.
+ *
+ * With stop-and-wait (window 1) the goodput is bounded by one packet
+ * per round trip; larger windows keep several packets in flight.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include <CRCPackageInterface.h>
+#include <LinkEmulator.h>
+#include <PipedStream.h>
+
+// Duration of each measurement
+const unsigned long RUN_TIME = 3000;
+
+// One-way delays to measure (the round-trip time is twice this)
+const uint16_t DELAYS[] = {0, 10, 25, 50};
+
+// Buffers per interface; the encoded side holds a full window of packets
+const uint16_t BUFFER_SIZE = 128;
+
+StaticPipedStreamPair<BUFFER_SIZE> streamsA;
+StaticPipedStreamPair<BUFFER_SIZE> streamsB;
+
+// Streams data from A to B for RUN_TIME and prints the goodput and RTO
+void runCase(const uint16_t delayMs, const uint8_t windowSize)
+{
+  CRCPackageInterface a(streamsA, BUFFER_SIZE, windowSize);
+  CRCPackageInterface b(streamsB, BUFFER_SIZE, windowSize);
+
+  // Unlimited bandwidth, so the delay alone sets the round-trip time
+  LinkEmulator link(a.getEncodedStream(), b.getEncodedStream());
+  LinkChannel::Settings settings = {};
+  settings.latencyUs = delayMs * 1000UL;
+  link.setSettings(settings);
+
+  uint8_t nextSent = 0;
+  uint8_t nextExpected = 0;
+  uint32_t received = 0;
+  bool intact = true;
+
+  const unsigned long start = millis();
+  while (millis() - start < RUN_TIME)
+  {
+    while (a.getPlainStream().availableForWrite() > 0)
+    {
+      a.getPlainStream().write(nextSent++);
+    }
+
+    a.loop();
+    b.loop();
+    link.loop();
+
+    while (b.getPlainStream().available())
+    {
+      intact &= (b.getPlainStream().read() == nextExpected++);
+      received++;
+    }
+  }
+
+  // Drop data still queued for the next case
+  streamsA.clear();
+  streamsB.clear();
+
+  Serial.print(F("RTT "));
+  Serial.print(2 * delayMs);
+  Serial.print(F(" ms, window "));
+  Serial.print(windowSize);
+  Serial.print(F(": "));
+  Serial.print(received * 1000UL / RUN_TIME);
+  Serial.print(F(" B/s, RTO "));
+  Serial.print(a.getRto());
+  Serial.print(F(" ms, retransmissions "));
+  Serial.print(a.getStatistics().timeoutRetransmissions + a.getStatistics().nackRetransmissions);
+  Serial.println(intact ? F("") : F(" (DATA MISMATCH)"));
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  delay(1000);
+
+  Serial.println(F("Packager Window Benchmark"));
+  Serial.println(F("========================="));
+
+  for (uint8_t d = 0; d < sizeof(DELAYS) / sizeof(DELAYS[0]); d++)
+  {
+    for (uint8_t windowSize = 1; windowSize <= PACKAGER_MAX_WINDOW_SIZE; windowSize <<= 1)
+    {
+      runCase(DELAYS[d], windowSize);
+    }
+  }
+}
+
+void loop()
+{
+}
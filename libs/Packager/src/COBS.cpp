@@ -0,0 +1,136 @@
+/**
+ * @file COBS.cpp
+ * @brief Implementation of the COBS encoder/decoder
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include "COBS.h"
+
+/**
+ * @brief Encodes a frame
+ *
+ * @details Each block is found with memchr() and moved with memmove(),
+ * so the output may overlap the input as long as it starts overhead()
+ * bytes earlier: every code byte is written strictly before the unread
+ * input.
+ *
+ * @param source Unencoded bytes
+ * @param length Number of unencoded bytes
+ * @param destination Output, at least length + overhead(length) bytes
+ * @return uint16_t Encoded length
+ */
+uint16_t COBS::encode(const uint8_t *source, uint16_t length, uint8_t *destination)
+{
+    uint16_t written = 0;
+
+    while (true)
+    {
+        const uint8_t maxRun = (length < MAX_BLOCK_LENGTH) ? length : MAX_BLOCK_LENGTH;
+        const uint8_t *const zero = static_cast<const uint8_t *>(memchr(source, DELIMITER, maxRun));
+        const uint8_t run = zero ? zero - source : maxRun;
+
+        destination[written] = run + 1;
+        memmove(destination + written + 1, source, run);
+        written += run + 1;
+
+        if (zero)
+        {
+            // The zero is implied by the block; a trailing one still needs a final block
+            source += run + 1;
+            length -= run + 1;
+        }
+        else
+        {
+            source += run;
+            length -= run;
+            if (length == 0)
+            {
+                break;
+            }
+        }
+    }
+    return written;
+}
+
+/**
+ * @brief Encodes a frame straight into a stream
+ *
+ * @details Same block walk as the buffer encoder, writing each code
+ * byte and run with bulk writes so no staging buffer is needed.
+ *
+ * @param source Unencoded bytes
+ * @param length Number of unencoded bytes
+ * @param output Destination stream
+ * @return uint16_t Encoded length
+ */
+uint16_t COBS::encode(const uint8_t *source, uint16_t length, Print &output)
+{
+    uint16_t written = 0;
+
+    while (true)
+    {
+        const uint8_t maxRun = (length < MAX_BLOCK_LENGTH) ? length : MAX_BLOCK_LENGTH;
+        const uint8_t *const zero = static_cast<const uint8_t *>(memchr(source, DELIMITER, maxRun));
+        const uint8_t run = zero ? zero - source : maxRun;
+
+        output.write(static_cast<uint8_t>(run + 1));
+        output.write(source, run);
+        written += run + 1;
+
+        if (zero)
+        {
+            source += run + 1;
+            length -= run + 1;
+        }
+        else
+        {
+            source += run;
+            length -= run;
+            if (length == 0)
+            {
+                break;
+            }
+        }
+    }
+    return written;
+}
+
+/**
+ * @brief Decodes a frame
+ *
+ * @details Walks the blocks, restoring the implied zeros. The output
+ * never gets ahead of the input, so decoding in place is safe.
+ *
+ * @param source Encoded bytes
+ * @param length Number of encoded bytes
+ * @param destination Output, at least @p length bytes
+ * @return int Decoded length, or -1 if the frame is malformed
+ */
+int COBS::decode(const uint8_t *source, uint16_t length, uint8_t *destination)
+{
+    uint16_t read = 0;
+    uint16_t written = 0;
+
+    while (read < length)
+    {
+        const uint8_t code = source[read++];
+        const uint8_t run = code - 1;
+
+        // A zero code or a block running past the end is not COBS
+        if (code == DELIMITER || run > length - read || memchr(source + read, DELIMITER, run))
+        {
+            return -1;
+        }
+
+        memmove(destination + written, source + read, run);
+        read += run;
+        written += run;
+
+        if (code != 0xFF && read < length)
+        {
+            destination[written++] = 0;
+        }
+    }
+    return written;
+}
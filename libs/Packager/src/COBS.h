@@ -0,0 +1,82 @@
+/**
+ * @file COBS.h
+ * @brief Consistent Overhead Byte Stuffing for the Packager protocol
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ *
+ * @details COBS rewrites a frame so that it contains no 0x00 byte, which
+ * then serves as an unambiguous frame delimiter. The encoded frame is a
+ * sequence of blocks: a code byte n (1-255) followed by n - 1 data bytes,
+ * with an implied 0x00 after every block whose code is below 0xFF except
+ * the last one. The overhead is one byte per 254 data bytes, at least one.
+ *
+ * Encoding and decoding both work in place, so a frame can be built and
+ * parsed in the buffer it lives in.
+ */
+#ifndef COBS_H
+#define COBS_H
+
+#include <Arduino.h>
+
+/**
+ * @class COBS
+ * @brief COBS encoder/decoder
+ */
+class COBS
+{
+public:
+    /** @brief Frame delimiter on the wire */
+    static constexpr uint8_t DELIMITER = 0x00;
+
+    /** @brief Largest number of data bytes in one block */
+    static constexpr uint8_t MAX_BLOCK_LENGTH = 254;
+
+    /**
+     * @brief Gets the worst-case encoding overhead
+     *
+     * @param length Unencoded length
+     * @return uint16_t Bytes added by encoding (excluding the delimiter)
+     */
+    static constexpr uint16_t overhead(const uint16_t length) { return length / MAX_BLOCK_LENGTH + 1; }
+
+    /**
+     * @brief Encodes a frame
+     *
+     * @details The delimiter is not appended. Encoding in place is
+     * allowed when @p source starts exactly overhead(@p length) bytes
+     * after @p destination.
+     *
+     * @param source Unencoded bytes
+     * @param length Number of unencoded bytes
+     * @param destination Output, at least length + overhead(length) bytes
+     * @return uint16_t Encoded length
+     */
+    static uint16_t encode(const uint8_t *source, uint16_t length, uint8_t *destination);
+
+    /**
+     * @brief Encodes a frame straight into a stream
+     *
+     * @details The delimiter is not appended.
+     *
+     * @param source Unencoded bytes
+     * @param length Number of unencoded bytes
+     * @param output Destination stream
+     * @return uint16_t Encoded length
+     */
+    static uint16_t encode(const uint8_t *source, uint16_t length, Print &output);
+
+    /**
+     * @brief Decodes a frame
+     *
+     * @details @p source holds one encoded frame without its delimiter.
+     * Decoding in place is allowed (@p destination equal to @p source).
+     *
+     * @param source Encoded bytes
+     * @param length Number of encoded bytes
+     * @param destination Output, at least @p length bytes
+     * @return int Decoded length, or -1 if the frame is malformed
+     */
+    static int decode(const uint8_t *source, uint16_t length, uint8_t *destination);
+};
+
+#endif
@@ -0,0 +1,157 @@
+/**
+ * @file CRC16.h
+ * @brief Selectable CRC-16-CCITT engines for the Packager protocol
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ *
+ * @details All engines compute the same CRC-16-CCITT (polynomial 0x1021,
+ * initial value 0xFFFF, no reflection, no final XOR) and differ only in
+ * their speed/flash trade-off:
+ * - Bitwise: eight shift/xor steps per byte, no table
+ * - Nibble: two lookups per byte in a 16-entry (32 B) PROGMEM table
+ * - Table: one lookup per byte in a 256-entry (512 B) PROGMEM table
+ * - Slicing-by-8: eight bytes per step over eight 256-entry tables
+ *   (the byte table plus 3.5 KB of const tables; not available on AVR)
+ *
+ * Every engine takes the running CRC as input, so a frame can be
+ * checksummed incrementally while its bytes arrive.
+ *
+ * The engine used by CRC16::update() is chosen at compile time with
+ * PACKAGER_CRC16_ENGINE. Unused tables are dropped by the linker.
+ */
+#ifndef CRC16_H
+#define CRC16_H
+
+#include <Arduino.h>
+
+#define CRC16_ENGINE_BITWISE 0  ///< Bit-by-bit loop
+#define CRC16_ENGINE_NIBBLE 1   ///< 16-entry PROGMEM table
+#define CRC16_ENGINE_TABLE 2    ///< 256-entry PROGMEM table
+#define CRC16_ENGINE_SLICING8 3 ///< Slicing-by-8 (non-AVR only)
+
+/**
+ * @brief CRC engine used by the Packager protocol
+ * @details Defaults to the 256-entry table on every target. Define as
+ * CRC16_ENGINE_NIBBLE when flash is tight, or as CRC16_ENGINE_SLICING8
+ * on a 32-bit target with flash to spare for long frames.
+ */
+#ifndef PACKAGER_CRC16_ENGINE
+#define PACKAGER_CRC16_ENGINE CRC16_ENGINE_TABLE
+#endif
+
+#if defined(__AVR__) && PACKAGER_CRC16_ENGINE == CRC16_ENGINE_SLICING8
+#error "CRC16_ENGINE_SLICING8 is not available on AVR"
+#endif
+
+/**
+ * @class CRC16
+ * @brief CRC-16-CCITT computation with interchangeable engines
+ */
+class CRC16
+{
+public:
+    /** @brief Initial CRC value */
+    static constexpr uint16_t INITIAL_VALUE = 0xFFFF;
+
+    /**
+     * @brief Continues a CRC with the bitwise engine
+     *
+     * @param crc Running CRC (INITIAL_VALUE for a new frame)
+     * @param data Input bytes
+     * @param length Number of bytes
+     * @return uint16_t Updated CRC
+     */
+    static uint16_t updateBitwise(uint16_t crc, const uint8_t *data, uint16_t length);
+
+    /**
+     * @brief Continues a CRC with the 16-entry nibble table
+     *
+     * @param crc Running CRC (INITIAL_VALUE for a new frame)
+     * @param data Input bytes
+     * @param length Number of bytes
+     * @return uint16_t Updated CRC
+     */
+    static uint16_t updateNibble(uint16_t crc, const uint8_t *data, uint16_t length);
+
+    /**
+     * @brief Continues a CRC with the 256-entry table
+     *
+     * @param crc Running CRC (INITIAL_VALUE for a new frame)
+     * @param data Input bytes
+     * @param length Number of bytes
+     * @return uint16_t Updated CRC
+     */
+    static uint16_t updateTable(uint16_t crc, const uint8_t *data, uint16_t length);
+
+#if !defined(__AVR__)
+    /**
+     * @brief Continues a CRC eight bytes at a time
+     *
+     * @param crc Running CRC (INITIAL_VALUE for a new frame)
+     * @param data Input bytes
+     * @param length Number of bytes
+     * @return uint16_t Updated CRC
+     */
+    static uint16_t updateSlicing8(uint16_t crc, const uint8_t *data, uint16_t length);
+#endif
+
+    /**
+     * @brief Continues a CRC with the configured engine
+     *
+     * @param crc Running CRC (INITIAL_VALUE for a new frame)
+     * @param data Input bytes
+     * @param length Number of bytes
+     * @return uint16_t Updated CRC
+     */
+    static inline uint16_t update(const uint16_t crc, const uint8_t *const data, const uint16_t length)
+    {
+#if PACKAGER_CRC16_ENGINE == CRC16_ENGINE_BITWISE
+        return updateBitwise(crc, data, length);
+#elif PACKAGER_CRC16_ENGINE == CRC16_ENGINE_NIBBLE
+        return updateNibble(crc, data, length);
+#elif PACKAGER_CRC16_ENGINE == CRC16_ENGINE_TABLE
+        return updateTable(crc, data, length);
+#else
+        return updateSlicing8(crc, data, length);
+#endif
+    }
+
+    /**
+     * @brief Continues a CRC by a single byte
+     *
+     * @param crc Running CRC
+     * @param data Input byte
+     * @return uint16_t Updated CRC
+     */
+    static inline uint16_t update(const uint16_t crc, const uint8_t data)
+    {
+#if PACKAGER_CRC16_ENGINE == CRC16_ENGINE_BITWISE
+        return updateBitwise(crc, &data, 1);
+#elif PACKAGER_CRC16_ENGINE == CRC16_ENGINE_NIBBLE
+        return updateNibble(crc, &data, 1);
+#else
+        return updateTable(crc, &data, 1);
+#endif
+    }
+
+    /**
+     * @brief Computes the CRC of a complete buffer
+     *
+     * @param data Input bytes
+     * @param length Number of bytes
+     * @return uint16_t CRC-16-CCITT of the buffer
+     */
+    static inline uint16_t compute(const uint8_t *const data, const uint16_t length)
+    {
+        return update(INITIAL_VALUE, data, length);
+    }
+
+private:
+    static const uint16_t NIBBLE_TABLE[16] PROGMEM; ///< CRC of each nibble value
+    static const uint16_t TABLE[256] PROGMEM;       ///< CRC of each byte value
+#if !defined(__AVR__)
+    static const uint16_t SLICES[7][256]; ///< CRC of each byte value followed by 1-7 zero bytes
+#endif
+};
+
+#endif
@@ -7,9 +7,13 @@
  * @details Implements a robust communication protocol optimized for embedded systems:
  *
  * Protocol Features:
- * - Fixed 15-byte packet format (4B header + 8B payload + 3B footer)
+ * - Fixed-size packets (4B header + configurable payload + 3B footer)
+ * - Start/stop byte or COBS framing
+ * - Message fragmentation over DATA/DATA_END packets
  * - CRC-16-CCITT error detection
- * - Automatic retransmission
+ * - Selective-repeat sliding window with per-packet retransmission
+ * - Adaptive retransmission timeout (Jacobson/Karels, Karn's rule)
+ * - Optional ACKs piggybacked on DATA packets, otherwise delayed
  * - Connection state monitoring
  *
  * Implementation Highlights:
@@ -19,8 +23,9 @@
  * - Non-blocking operation
  *
  * State Machines:
- * - Outgoing: READ_DATA → SEND_PACKAGE → WAIT_FOR_ACK_OR_NACK
+ * - Outgoing: sliding window of collecting/in-flight slots
  * - Incoming: WAIT_FOR_START_BYTE → READ_INCOMING_DATA → PROCESS_INCOMING_DATA
+ *   (with COBS framing, WAIT_FOR_START_BYTE only skips a broken frame)
  *
  * Error Handling:
  * - Comprehensive validation
@@ -29,6 +34,7 @@
  */
 
 #include "CRCPackageInterface.h"
+#include "CRC16.h"
 #include "PipedStream.h"
 #include "Utilities.h"
 
@@ -54,12 +60,52 @@ const char CRCPackageInterface::INVALID_TYPE_STR[] PROGMEM = "Invalid type";
 const char CRCPackageInterface::INVALID_LENGTH_STR[] PROGMEM = "Invalid length";         ///< Invalid payload length
 const char CRCPackageInterface::RESET_NUM_STR[] PROGMEM = "Reset number";                ///< Sequence number reset
 
+/**
+ * @brief Gets the encoded buffer size to allocate
+ *
+ * @details A COBS frame is a few bytes longer than the packet it
+ * carries, so a buffer sized for one packet (the default) is grown to
+ * hold one frame; otherwise nothing could ever be sent.
+ *
+ * @param encodedBufferSize Requested size
+ * @param framing Wire framing
+ * @return uint16_t Size to allocate
+ */
+static uint16_t encodedBufferSizeFor(const uint16_t encodedBufferSize, const CRCPackageInterface::Framing framing)
+{
+    if (framing == CRCPackageInterface::COBS_FRAMING && encodedBufferSize < CRCPackageInterface::MIN_ENCODED_BUFFER_SIZE)
+    {
+        return CRCPackageInterface::MIN_ENCODED_BUFFER_SIZE;
+    }
+    return encodedBufferSize;
+}
+
 /**
  * @brief Constructor implementation
  *
- * @details Initializes protocol state:
+ * @details Allocates the encoded buffers and initializes the protocol
+ * state with the constructor below.
+ */
+CRCPackageInterface::CRCPackageInterface(PipedStreamPair &pipedStreamPair, const uint16_t encodedBufferSize,
+                                         const uint8_t windowSize, const uint8_t dataLength,
+                                         const Framing framing, const AckMode ackMode)
+    : CRCPackageInterface(pipedStreamPair, nullptr, nullptr, encodedBufferSize, windowSize, dataLength, framing,
+                          ackMode)
+{
+}
+
+/**
+ * @brief Constructor over caller-provided encoded buffers
+ *
+ * @details Allocated buffers are grown to hold one COBS frame; given
+ * storage has a fixed size, which StaticCRCPackageInterface checks at
+ * compile time. Initializes protocol state:
  * - Packet counters (out: 1, in: 0)
- * - State machines (READ_DATA, WAIT_FOR_START_BYTE)
+ * - Windows (empty, size clamped to 1..PACKAGER_MAX_WINDOW_SIZE)
+ * - Payload length (clamped to 1..MAX_DATA_LENGTH) and packet size
+ * - Framing and the resulting frame size
+ * - RTO estimator (no sample yet, initial timeout)
+ * - Incoming state machine (WAIT_FOR_START_BYTE, or READ_INCOMING_DATA with COBS)
  * - Timers (data, ACK/NACK, reset)
  * - Message queues (cleared)
  * - Packet buffers (zeroed)
@@ -67,28 +113,60 @@ const char CRCPackageInterface::RESET_NUM_STR[] PROGMEM = "Reset number";
  * Note: Starting packet number is 1 (not 0) for outgoing packets
  * to distinguish from reset packets.
  */
-CRCPackageInterface::CRCPackageInterface(PipedStreamPair &pipedStreamPair, const uint16_t encodedBufferSize)
-    : PackageInterface(pipedStreamPair, encodedBufferSize),
+CRCPackageInterface::CRCPackageInterface(PipedStreamPair &pipedStreamPair, uint8_t *encodedStorage1,
+                                         uint8_t *encodedStorage2, const uint16_t encodedBufferSize,
+                                         const uint8_t windowSize, const uint8_t dataLength,
+                                         const Framing framing, const AckMode ackMode)
+    : PackageInterface(pipedStreamPair,
+                       encodedStorage1 != nullptr ? encodedBufferSize : encodedBufferSizeFor(encodedBufferSize, framing),
+                       encodedStorage1, encodedStorage2),
       m_outgoingTimer(OUTGOING_DATA_READ_TIMEOUT),
       m_incomingTimer(INCOMING_DATA_WAIT_TIMEOUT),
       m_resetDetectionTimer(RESET_DETECTION_TIMEOUT),
       m_outgoingPacketNumber(1),
-      m_lastIncomingPacketNumber(0)
+      m_lastIncomingPacketNumber(0),
+      m_dataLength(constrain(dataLength, 1, PACKAGER_MAX_DATA_LENGTH)),
+      m_packageLength(HEADER_LENGTH + m_dataLength + (ackMode == PIGGYBACKED_ACKS ? ACK_FIELD_LENGTH : 0) +
+                      FOOTER_LENGTH),
+      m_crcScopeLength(m_packageLength - CRC_SCOPE_OFFSET - FOOTER_LENGTH),
+      m_frameLength(framing == COBS_FRAMING ? m_packageLength + COBS::overhead(m_packageLength) + 2
+                                            : m_packageLength),
+      m_framing(framing),
+      m_ackMode(ackMode),
+      m_ackTimer(PACKAGER_ACK_DELAY),
+      m_pendingAcks(0),
+      m_windowSize(constrain(windowSize, 1, PACKAGER_MAX_WINDOW_SIZE)),
+      m_packetsInFlight(0),
+      m_outgoingWindowHead(0),
+      m_incomingWindowHead(0),
+      m_incomingReceivedMask(0),
+      m_smoothedRtt8(0),
+      m_rttVariation4(0),
+      m_rto(OUTGOING_DATA_ACK_NACK_TIMEOUT),
+      m_rtoBackoff(0),
+      m_hasRttSample(false),
+      m_incomingCrc(CRC16::INITIAL_VALUE),
+      m_cobsBlockRemaining(0),
+      m_outgoingMessageRemaining(0),
+      m_incomingMessageLength(0),
+      m_incomingDiscardLength(0)
 {
     // Zero packet buffers
-    memset(&m_outgoingPackage, 0, sizeof(m_outgoingPackage));
     memset(&m_incomingPackage, 0, sizeof(m_incomingPackage));
+    memset(m_incomingSlots, 0, sizeof(m_incomingSlots));
 
-    // Clear status flags
-    memset(&m_outgoingFlags, 0, sizeof(m_outgoingFlags));
+    // Clear status flags and counters
     memset(&m_incomingFlags, 0, sizeof(m_incomingFlags));
+    resetStatistics();
 
-    // Clear message queue
+    // Clear message queues
     m_messageQueue.clear();
+    m_outgoingMessageLengths.clear();
+    m_incomingMessageLengths.clear();
 
     // Set initial states
-    m_outgoingFlags.m_currentState = OutgoingState::READ_DATA;
-    m_incomingFlags.m_currentState = IncomingState::WAIT_FOR_START_BYTE;
+    resetOutgoingState();
+    resetIncomingState();
 }
 
 /**
@@ -99,11 +177,13 @@ CRCPackageInterface::CRCPackageInterface(PipedStreamPair &pipedStreamPair, const
  * 1. Connection Monitoring:
  *    - Checks reset detection timer
  *    - Resets protocol if timeout
+ *    - Delivers buffered packets held back by a full plain stream
  *
  * 2. Outgoing Channel:
- *    - Processes state machine
+ *    - Processes sliding window
  *    - Limits state transitions
  *    - Reports excessive transitions
+ *    - Sends a delayed ACK no DATA packet carried
  *
  * 3. Incoming Channel:
  *    - Processes state machine
@@ -122,9 +202,22 @@ void CRCPackageInterface::loop()
         m_resetDetectionTimer.reset();
     }
 
+    // Retry in-order packets the plain stream had no room for
+    if ((m_incomingReceivedMask & 1) && m_frameLength <= getInternalEncodedStream().availableForWrite())
+    {
+        deliverBufferedPackets();
+        if (!(m_incomingReceivedMask & 1))
+        {
+            sendAck();
+        }
+    }
+
+    // A full window of packets may be handled in a single call
+    const uint16_t maxStateChanges = MAX_REPLAY_COUNT * m_windowSize;
+
     {
         // Process outgoing channel with transition limit
-        uint8_t outgoingStateChanges = 0;
+        uint16_t outgoingStateChanges = 0;
         bool outgoingChanged = false;
         do
         {
@@ -133,19 +226,22 @@ void CRCPackageInterface::loop()
             {
                 outgoingStateChanges++;
             }
-        } while (outgoingChanged && outgoingStateChanges < MAX_REPLAY_COUNT);
+        } while (outgoingChanged && outgoingStateChanges < maxStateChanges);
 
         // Report if limit reached
-        if (outgoingStateChanges == MAX_REPLAY_COUNT)
+        if (outgoingStateChanges == maxStateChanges)
         {
             String msg = String(PGMT(PREFIX_O_STR)) + String(PGMT(MAX_STATE_CHG_STR));
             OS.logMessage(nullptr, Scheduler::LOG_WARN, msg.c_str());
         }
     }
 
+    // No DATA packet took the pending ACK along
+    flushPendingAck();
+
     {
         // Process incoming channel with transition limit
-        uint8_t incomingStateChanges = 0;
+        uint16_t incomingStateChanges = 0;
         bool incomingChanged = false;
         do
         {
@@ -154,10 +250,10 @@ void CRCPackageInterface::loop()
             {
                 incomingStateChanges++;
             }
-        } while (incomingChanged && incomingStateChanges < MAX_REPLAY_COUNT);
+        } while (incomingChanged && incomingStateChanges < maxStateChanges);
 
         // Report if limit reached
-        if (incomingStateChanges == MAX_REPLAY_COUNT)
+        if (incomingStateChanges == maxStateChanges)
         {
             String msg = String(PGMT(PREFIX_I_STR)) + String(PGMT(MAX_STATE_CHG_STR));
             OS.logMessage(nullptr, Scheduler::LOG_WARN, msg.c_str());
@@ -183,7 +279,7 @@ void CRCPackageInterface::sendResetPacket()
     PipedStream &encodedStream = getInternalEncodedStream();
 
     // Verify buffer capacity
-    if (PACKAGE_LENGTH > encodedStream.availableForWrite())
+    if (m_frameLength > encodedStream.availableForWrite())
     {
         String msg = String(PGMT(PREFIX_O_STR)) + String(PGMT(BUFFER_FULL_STR));
         OS.logMessage(nullptr, Scheduler::LOG_WARN, msg.c_str());
@@ -191,10 +287,7 @@ void CRCPackageInterface::sendResetPacket()
     }
 
     // Send reset packet
-    Package resetPackage;
-    memset(&resetPackage, 0, sizeof(resetPackage));
-    preparePackage(resetPackage, RESET_TYPE, 0);
-    sendPackage(resetPackage);
+    sendControlPackage(RESET_TYPE, 0);
 
     // Reset local state
     resetPacketNumbering();
@@ -205,33 +298,122 @@ void CRCPackageInterface::sendResetPacket()
  *
  * @details Performs complete protocol reset:
  * 1. Resets packet counters (out: 1, in: 0)
- * 2. Clears message queues
- * 3. Resets state machines
- * 4. Reports reset event
+ * 2. Empties both windows
+ * 3. Drops the fragments of partially transferred messages
+ * 4. Clears message queues
+ * 5. Resets state machines
+ * 6. Reports reset event
  *
- * Note: Only resets if outgoing number isn't already 1
- * to avoid unnecessary operations.
+ * Note: Skipped while both directions are still at their initial
+ * numbers with nothing in flight, to avoid unnecessary operations
+ * and to keep data being collected for the first packet.
  */
 void CRCPackageInterface::resetPacketNumbering()
 {
-    if (m_outgoingPacketNumber == 1)
+    if (m_outgoingPacketNumber == 1 && m_lastIncomingPacketNumber == 0 &&
+        m_packetsInFlight == 0 && m_incomingReceivedMask == 0)
     {
         return;
     }
 
+    m_statistics.connectionResets++;
+
     // Reset packet sequence
     m_outgoingPacketNumber = 1;
     m_lastIncomingPacketNumber = 0;
 
+    // Drop out-of-order packets and their pending ACK
+    m_incomingWindowHead = 0;
+    m_incomingReceivedMask = 0;
+    m_pendingAcks = 0;
+
+    // Fragments of a message cut short are already in the plain stream;
+    // readMessage() skips them
+    m_incomingDiscardLength += m_incomingMessageLength;
+    m_incomingMessageLength = 0;
+    if (m_incomingDiscardLength > 0 && m_incomingMessageLengths.push(m_incomingDiscardLength | DISCARD_MESSAGE_FLAG))
+    {
+        m_incomingDiscardLength = 0;
+    }
+
+    // The rest of a message whose first fragments were sent is useless
+    if (m_outgoingMessageRemaining > 0)
+    {
+        getInternalPlainStream().consume(m_outgoingMessageRemaining);
+        m_outgoingMessageRemaining = 0;
+    }
+
     // Clear queues and states
     m_messageQueue.clear();
     resetOutgoingState();
     resetIncomingState();
 
+    // Layered stages restart with the connection
+    notifyReset();
+
     String msg = String(PGMT(PREFIX_STR)) + String(PGMT(RESET_NUM_STR));
     OS.logMessage(nullptr, Scheduler::LOG_INFO, msg.c_str());
 }
 
+/**
+ * @brief Queues a message for fragmented transmission
+ *
+ * @details The message bytes go to the plain stream like any other
+ * data; only its length is kept, so the outgoing window knows where
+ * the message ends. A message is never merged with the next one into
+ * a packet.
+ *
+ * @param data Message bytes
+ * @param length Message length
+ * @return true if the message was queued
+ * @return false if the plain stream or message queue is full
+ */
+bool CRCPackageInterface::writeMessage(const uint8_t *const data, const uint16_t length)
+{
+    PipedStream &plainStream = getPlainStream();
+
+    if (length == 0 || length >= DISCARD_MESSAGE_FLAG || m_outgoingMessageLengths.isFull() ||
+        (int)length > plainStream.availableForWrite())
+    {
+        return false;
+    }
+
+    plainStream.write(data, length);
+    m_outgoingMessageLengths.push(length);
+    return true;
+}
+
+/**
+ * @brief Reads one reassembled message
+ *
+ * @details Skips the fragments of messages interrupted by a reset,
+ * then copies the oldest complete message out of the plain stream.
+ *
+ * @param buffer Destination buffer
+ * @param size Size of the destination buffer
+ * @return int Bytes copied, or -1 if no complete message is available
+ */
+int CRCPackageInterface::readMessage(uint8_t *const buffer, const uint16_t size)
+{
+    PipedStream &plainStream = getPlainStream();
+    uint16_t length;
+
+    while (m_incomingMessageLengths.pop(length))
+    {
+        if (length & DISCARD_MESSAGE_FLAG)
+        {
+            plainStream.consume(length & ~DISCARD_MESSAGE_FLAG);
+            continue;
+        }
+
+        const uint16_t copied = (length < size) ? length : size;
+        plainStream.readBytes(buffer, copied);
+        plainStream.consume(length - copied);
+        return copied;
+    }
+    return -1;
+}
+
 /**
  * @brief Calculates CRC-16-CCITT checksum
  *
@@ -240,31 +422,16 @@ void CRCPackageInterface::resetPacketNumbering()
  * - Initial value: 0xFFFF
  * - No final XOR
  *
- * Algorithm steps:
- * 1. Initialize CRC to 0xFFFF
- * 2. For each byte:
- *    - XOR byte into high byte of CRC
- *    - For each bit:
- *      - If MSB set: shift left and XOR with polynomial
- *      - If MSB clear: shift left only
+ * The engine (bitwise, nibble table, byte table or slicing-by-8)
+ * is selected with PACKAGER_CRC16_ENGINE, see CRC16.h.
  *
  * @param data Input data buffer
  * @param length Number of bytes to process
  * @return uint16_t Calculated CRC-16 value
  */
-uint16_t CRCPackageInterface::crc16(const uint8_t *const data, const uint8_t length)
+uint16_t CRCPackageInterface::crc16(const uint8_t *const data, const uint16_t length)
 {
-    uint16_t crc = 0xFFFF;
-    for (uint8_t i = 0; i < length; i++)
-    {
-        crc ^= (uint16_t)data[i] << 8;
-
-        for (uint8_t bit = 0; bit < 8; bit++)
-        {
-            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
-        }
-    }
-    return crc;
+    return CRC16::compute(data, length);
 }
 
 /**
@@ -338,21 +505,79 @@ const __FlashStringHelper *CRCPackageInterface::toString(const NackReason reason
     return errorMessage;
 }
 
+/**
+ * @brief Gets the number of received packets rejected for a reason
+ *
+ * @param reason Validation failure
+ * @return uint32_t Matching LinkStatistics counter, 0 for NO_ERROR and UNKNOWN_ERROR
+ */
+uint32_t CRCPackageInterface::getRejectedPackets(const NackReason reason) const
+{
+    switch (reason)
+    {
+    case NackReason::INVALID_CRC:
+        return m_statistics.crcErrors;
+    case NackReason::INVALID_START_STOP:
+        return m_statistics.startStopErrors;
+    case NackReason::INVALID_TYPE:
+        return m_statistics.typeErrors;
+    case NackReason::INVALID_LENGTH:
+        return m_statistics.lengthErrors;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Counts a received packet that failed validation
+ *
+ * @param reason Validation failure
+ */
+void CRCPackageInterface::countRejection(const NackReason reason)
+{
+    switch (reason)
+    {
+    case NackReason::INVALID_CRC:
+        m_statistics.crcErrors++;
+        break;
+    case NackReason::INVALID_START_STOP:
+        m_statistics.startStopErrors++;
+        break;
+    case NackReason::INVALID_TYPE:
+        m_statistics.typeErrors++;
+        break;
+    case NackReason::INVALID_LENGTH:
+        m_statistics.lengthErrors++;
+        break;
+    default:
+        break;
+    }
+}
+
 /**
  * @brief Resets outgoing channel state
  *
  * @details Performs complete outgoing reset:
- * 1. Clears packet buffer
- * 2. Resets state to READ_DATA
- * 3. Clears retry counter
- * 4. Resets timeout timer
+ * 1. Clears all window slots
+ * 2. Empties the window
+ * 3. Drops the timeout backoff (the RTT estimate is kept)
+ * 4. Resets collect timer
  */
 void CRCPackageInterface::resetOutgoingState()
 {
-    memset(&m_outgoingPackage, 0, sizeof(m_outgoingPackage));
-    m_outgoingFlags.m_currentState = OutgoingState::READ_DATA;
-    m_outgoingFlags.m_retryCount = 0;
-    m_outgoingTimer.setInterval(OUTGOING_DATA_READ_TIMEOUT);
+    m_rtoBackoff = 0;
+    for (uint8_t i = 0; i < PACKAGER_MAX_WINDOW_SIZE; i++)
+    {
+        OutgoingSlot &slot = m_outgoingSlots[i];
+        memset(&slot.package, 0, sizeof(slot.package));
+        slot.timer.setInterval(getRto());
+        slot.retryCount = 0;
+        slot.retransmitted = 0;
+        slot.acknowledged = 0;
+        slot.retransmitNow = 0;
+    }
+    m_outgoingWindowHead = 0;
+    m_packetsInFlight = 0;
     m_outgoingTimer.reset();
 }
 
@@ -362,15 +587,26 @@ void CRCPackageInterface::resetOutgoingState()
  * @details Performs complete incoming reset:
  * 1. Clears packet buffer
  * 2. Resets byte counter
- * 3. Resets state to WAIT_FOR_START_BYTE
+ * 3. Resets state to WAIT_FOR_START_BYTE (READ_INCOMING_DATA with
+ *    COBS framing, since the delimiter was already consumed)
  * 4. Resets timeout timer
+ *
+ * Once the round-trip time is known, a partial packet is dropped after
+ * half the RTO without new bytes. Waiting longer would let the peer's
+ * retransmission complete the broken packet and be lost with it.
  */
 void CRCPackageInterface::resetIncomingState()
 {
     memset(&m_incomingPackage, 0, sizeof(m_incomingPackage));
     m_incomingFlags.m_incomingDataLength = 0;
-    m_incomingFlags.m_currentState = IncomingState::WAIT_FOR_START_BYTE;
-    m_incomingTimer.setInterval(INCOMING_DATA_WAIT_TIMEOUT);
+    m_incomingFlags.m_cobsZeroPending = 0;
+    m_cobsBlockRemaining = 0;
+    m_incomingCrc = CRC16::INITIAL_VALUE;
+    m_incomingFlags.m_currentState = (m_framing == COBS_FRAMING) ? IncomingState::READ_INCOMING_DATA
+                                                                 : IncomingState::WAIT_FOR_START_BYTE;
+    const uint16_t maxTimeout = INCOMING_DATA_WAIT_TIMEOUT;
+    const uint16_t stallTimeout = m_rto / 2;
+    m_incomingTimer.setInterval((m_hasRttSample && stallTimeout < maxTimeout) ? stallTimeout : maxTimeout);
     m_incomingTimer.reset();
 }
 
@@ -389,9 +625,9 @@ void CRCPackageInterface::resetIncomingState()
  *    - Stop byte (0x55)
  *
  * @param package Packet structure to prepare
- * @param type Packet type (DATA/ACK/NACK/RESET)
+ * @param type Packet type (DATA/ACK/NACK/RESET/DATA_END)
  * @param packetNumber Sequence number
- * @param dataLength Payload length (0-8 bytes)
+ * @param dataLength Payload length (up to the configured payload size)
  * @param data Payload buffer (nullptr if no data)
  */
 void CRCPackageInterface::preparePackage(Package &package, const uint8_t type, const uint8_t packetNumber,
@@ -410,11 +646,12 @@ void CRCPackageInterface::preparePackage(Package &package, const uint8_t type, c
     }
 
     // Set footer fields
-    package.footer.stopByte = STOP_BYTE;
+    PackageFooter &footer = footerOf(package);
+    footer.stopByte = STOP_BYTE;
 
     // Calculate and store CRC
-    const uint16_t calculatedCrc = crc16((uint8_t *)&package.header.packetNumber, CRC_SCOPE_LENGTH);
-    storeCRC(package.footer.crc, calculatedCrc);
+    const uint16_t calculatedCrc = crc16((uint8_t *)&package + CRC_SCOPE_OFFSET, m_crcScopeLength);
+    storeCRC(footer.crc, calculatedCrc);
 }
 
 /**
@@ -422,46 +659,49 @@ void CRCPackageInterface::preparePackage(Package &package, const uint8_t type, c
  *
  * @details Performs comprehensive validation:
  * 1. Frame markers (0xAA/0x55)
- * 2. Packet type (0-3)
+ * 2. Packet type (0-4)
  * 3. Length constraints:
- *    - DATA: 0-8 bytes
- *    - ACK: 0 bytes
+ *    - DATA/DATA_END: up to the configured payload size
+ *    - ACK: 0 bytes, or 1 byte of selective ACK bitmap
  *    - NACK: 1 byte
  *    - RESET: 0 bytes
  * 4. CRC-16 integrity
  *
  * @param package Packet to validate
+ * @param calculatedCrc CRC-16 computed over the packet's CRC scope
  * @return NackReason Error code (NO_ERROR if valid)
  */
-CRCPackageInterface::NackReason CRCPackageInterface::validatePackage(const Package &package) const
+CRCPackageInterface::NackReason CRCPackageInterface::validatePackage(const Package &package,
+                                                                     const uint16_t calculatedCrc) const
 {
+    const PackageFooter &footer = footerOf(package);
+
     // Check frame markers
-    if (package.header.startByte != START_BYTE || package.footer.stopByte != STOP_BYTE)
+    if (package.header.startByte != START_BYTE || footer.stopByte != STOP_BYTE)
     {
         return NackReason::INVALID_START_STOP;
     }
 
     // Check packet type
-    if (package.header.type > RESET_TYPE)
+    if (package.header.type > DATA_END_TYPE)
     {
         return NackReason::INVALID_TYPE;
     }
 
     // Validate length based on type
-    if (package.header.type == DATA_TYPE && package.header.length > MAX_DATA_LENGTH)
+    if (isDataType(package.header.type) && package.header.length > m_dataLength)
     {
         return NackReason::INVALID_LENGTH;
     }
     else if ((package.header.type == NACK_TYPE && package.header.length != 1) ||
-             (package.header.type == ACK_TYPE && package.header.length != 0) ||
+             (package.header.type == ACK_TYPE && package.header.length > 1) ||
              (package.header.type == RESET_TYPE && package.header.length != 0))
     {
         return NackReason::INVALID_LENGTH;
     }
 
     // Validate CRC
-    const uint16_t calculatedCrc = crc16((uint8_t *)&package.header.packetNumber, CRC_SCOPE_LENGTH);
-    const uint16_t packageCrc = retrieveCRC(package.footer.crc);
+    const uint16_t packageCrc = retrieveCRC(footer.crc);
 
     if (calculatedCrc != packageCrc)
     {
@@ -476,14 +716,99 @@ CRCPackageInterface::NackReason CRCPackageInterface::validatePackage(const Packa
  *
  * @details Sends complete packet:
  * 1. Serializes to byte array
- * 2. Writes to encoded stream
+ * 2. Writes to encoded stream; with COBS framing the packet is
+ *    encoded block by block straight into the stream and followed
+ *    by the delimiter, see leadingDelimiterLength()
  * 3. No buffering/queueing
  *
  * @param package Prepared packet to send
  */
 void CRCPackageInterface::sendPackage(const Package &package)
 {
-    getInternalEncodedStream().write(reinterpret_cast<const uint8_t *>(&package), PACKAGE_LENGTH);
+    PipedStream &encodedStream = getInternalEncodedStream();
+    const uint8_t *const raw = reinterpret_cast<const uint8_t *>(&package);
+
+    if (m_framing == COBS_FRAMING)
+    {
+        if (leadingDelimiterLength())
+        {
+            encodedStream.write(COBS::DELIMITER);
+        }
+        COBS::encode(raw, m_packageLength, encodedStream);
+        encodedStream.write(COBS::DELIMITER);
+        return;
+    }
+
+    encodedStream.write(raw, m_packageLength);
+}
+
+/**
+ * @brief Assembles and transmits a control packet
+ *
+ * @details Builds the packet directly in the encoded stream's ring
+ * storage when a contiguous slot is free, so ACK/NACK/RESET packets
+ * never pass through an intermediate buffer. Falls back to a stack
+ * copy when the free space wraps around the end of the ring.
+ *
+ * With COBS framing the packet is prepared overhead() bytes past the
+ * start of the encoded frame and encoded in place.
+ *
+ * @param type Packet type (ACK/NACK/RESET)
+ * @param packetNumber Sequence number
+ * @param dataLength Payload length (up to the configured payload size)
+ * @param data Payload buffer (nullptr if no data)
+ */
+void CRCPackageInterface::sendControlPackage(const uint8_t type, const uint8_t packetNumber,
+                                             const uint8_t dataLength, const uint8_t *const data)
+{
+    PipedStream &encodedStream = getInternalEncodedStream();
+
+    uint8_t *const slot = encodedStream.reserve(m_frameLength);
+    if (slot)
+    {
+        // Package is packed, so any byte address is suitably aligned;
+        // only the first m_packageLength bytes of it may be touched
+        const uint8_t leading = leadingDelimiterLength();
+        const uint16_t offset = (m_framing == COBS_FRAMING) ? leading + COBS::overhead(m_packageLength) : 0;
+        Package &package = *reinterpret_cast<Package *>(slot + offset);
+        memset(slot + offset, 0, m_packageLength);
+        preparePackage(package, type, packetNumber, dataLength, data);
+
+        if (m_framing == COBS_FRAMING)
+        {
+            if (leading)
+            {
+                slot[0] = COBS::DELIMITER;
+            }
+            const uint16_t encodedLength = COBS::encode(slot + offset, m_packageLength, slot + leading);
+            slot[leading + encodedLength] = COBS::DELIMITER;
+            encodedStream.commit(leading + encodedLength + 1);
+            return;
+        }
+
+        encodedStream.commit(m_packageLength);
+        return;
+    }
+
+    Package package;
+    memset(&package, 0, sizeof(package));
+    preparePackage(package, type, packetNumber, dataLength, data);
+    sendPackage(package);
+}
+
+/**
+ * @brief Gets the number of delimiters to send ahead of a COBS frame
+ *
+ * @details Back-to-back frames are separated by the delimiter ending
+ * the previous one. A frame sent after the link went idle also gets a
+ * leading delimiter, which flushes any noise the receiver picked up in
+ * the meantime instead of letting it corrupt the frame.
+ *
+ * @return uint8_t 1 if nothing is queued for transmission, otherwise 0
+ */
+uint8_t CRCPackageInterface::leadingDelimiterLength()
+{
+    return (getEncodedStream().available() == 0) ? 1 : 0;
 }
 
 /**
@@ -491,71 +816,104 @@ void CRCPackageInterface::sendPackage(const Package &package)
  *
  * @details Handles packet based on type:
  *
- * DATA:
+ * DATA/DATA_END:
  * 1. Validate packet
- * 2. Check sequence number
- * 3. Store payload
- * 4. Send ACK
+ * 2. Locate it in the receive window
+ * 3. Deliver it (and any buffered successors) if next in order,
+ *    buffer it if ahead of a gap, ignore it if a duplicate
+ * 4. Send cumulative/selective ACK
  *
  * ACK/NACK:
- * 1. Verify packet number
- * 2. Queue for outgoing state machine
+ * 1. Drop ACKs without information
+ * 2. Queue for outgoing window
  *
  * RESET:
  * 1. Reset protocol state
  * 2. Send ACK
  *
+ * @param package Received packet, either m_incomingPackage or a
+ *                packet lying in the encoded stream's ring storage
+ * @param calculatedCrc CRC-16 computed over the packet's CRC scope
  * @return true if processing successful
  * @return false if error occurred
  */
-bool CRCPackageInterface::processPackage()
+bool CRCPackageInterface::processPackage(const Package &package, const uint16_t calculatedCrc)
 {
-    PipedStream &plainStream = getInternalPlainStream();
     PipedStream &encodedStream = getInternalEncodedStream();
 
     // Reset detection timer
     m_resetDetectionTimer.reset();
 
     // Validate packet
-    const NackReason validationResult = validatePackage(m_incomingPackage);
+    const NackReason validationResult = validatePackage(package, calculatedCrc);
 
     if (validationResult == NackReason::NO_ERROR)
     {
-        if (m_incomingPackage.header.type == DATA_TYPE)
+        if (isDataType(package.header.type))
         {
-            // Check buffer space for response
-            if (PACKAGE_LENGTH > encodedStream.availableForWrite())
+            // Position relative to the next expected packet
+            const uint8_t offset = package.header.packetNumber
+                                       ? packetDistance(m_lastIncomingPacketNumber, package.header.packetNumber) - 1
+                                       : 0xFF;
+
+            // Packets after a gap, and the one filling it, are acknowledged at once
+            const bool urgentAck = (offset != 0 || m_incomingReceivedMask != 0);
+
+            // Check buffer space for a response sent right away
+            if ((m_ackMode == IMMEDIATE_ACKS || urgentAck) && m_frameLength > encodedStream.availableForWrite())
             {
                 String msg = String(PGMT(PREFIX_I_STR)) + String(PGMT(BUFFER_FULL_STR));
                 OS.logMessage(nullptr, Scheduler::LOG_WARN, msg.c_str());
                 return false;
             }
+            const uint8_t safeLength = min(package.header.length, m_dataLength);
+            const bool messageEnd = (package.header.type == DATA_END_TYPE);
 
-            // Process if new packet
-            if (m_incomingPackage.header.packetNumber > m_lastIncomingPacketNumber)
+            if (offset == 0)
             {
-                const uint8_t safeLength = min(m_incomingPackage.header.length, MAX_DATA_LENGTH);
-
-                // Check buffer space for payload
-                if (safeLength > plainStream.availableForWrite())
+                // Store payload, if there is room for it
+                if (!deliverPayload(package.data, safeLength, messageEnd))
                 {
                     String msg = String(PGMT(PREFIX_I_STR)) + String(PGMT(BUFFER_FULL_STR));
                     OS.logMessage(nullptr, Scheduler::LOG_WARN, msg.c_str());
                     return false;
                 }
 
-                // Store payload and update sequence
-                plainStream.write(m_incomingPackage.data, safeLength);
-                m_lastIncomingPacketNumber = m_incomingPackage.header.packetNumber;
+                // Slide the window and release what it unblocks
+                m_lastIncomingPacketNumber = package.header.packetNumber;
+                m_incomingWindowHead = (m_incomingWindowHead + 1) & WINDOW_MASK;
+                m_incomingReceivedMask >>= 1;
+                deliverBufferedPackets();
             }
+            else if (offset < m_windowSize)
+            {
+                // Ahead of a missing packet - hold back until the gap is filled
+                IncomingSlot &slot = m_incomingSlots[(m_incomingWindowHead + offset) & WINDOW_MASK];
+                slot.length = safeLength;
+                slot.messageEnd = messageEnd;
+                memcpy(slot.data, package.data, safeLength);
+                m_incomingReceivedMask |= (1 << offset);
+            }
+            // Anything else is a duplicate of a delivered packet
 
-            // Send ACK
-            const uint8_t packetNumber = m_incomingPackage.header.packetNumber;
-            memset(&m_incomingPackage, 0, sizeof(m_incomingPackage));
-            preparePackage(m_incomingPackage, ACK_TYPE, packetNumber);
-            sendPackage(m_incomingPackage);
+            acknowledge(urgentAck);
+
+            // The peer's ACK field, if it carries one
+            if (m_ackMode == PIGGYBACKED_ACKS)
+            {
+                const uint8_t *const field = package.data + m_dataLength;
+                if (field[0] != 0 || field[1] != 0)
+                {
+                    PendingMessage message;
+                    message.type = PendingMessageType::ACK_RECEIVED;
+                    message.packetNumber = field[0];
+                    message.selectiveMask = field[1];
+                    message.nackReason = NackReason::NO_ERROR;
+                    m_messageQueue.push(message);
+                }
+            }
         }
-        else if (m_incomingPackage.header.type == RESET_TYPE)
+        else if (package.header.type == RESET_TYPE)
         {
             // Handle reset request
             String msg = String(PGMT(PREFIX_I_STR)) + String(PGMT(RESET_NUM_STR));
@@ -564,36 +922,36 @@ bool CRCPackageInterface::processPackage()
             resetPacketNumbering();
 
             // Send ACK
-            memset(&m_incomingPackage, 0, sizeof(m_incomingPackage));
-            preparePackage(m_incomingPackage, ACK_TYPE, 0);
-            sendPackage(m_incomingPackage);
+            sendControlPackage(ACK_TYPE, 0);
         }
-        else if (m_incomingPackage.header.type == ACK_TYPE &&
-                 m_incomingPackage.header.packetNumber == m_outgoingPacketNumber)
+        else if (package.header.type == ACK_TYPE &&
+                 (package.header.packetNumber != 0 || package.header.length > 0))
         {
-            // Queue ACK
+            // Queue ACK - a bare ACK 0 acknowledges a RESET and carries nothing
             PendingMessage message;
             message.type = PendingMessageType::ACK_RECEIVED;
-            message.packetNumber = m_incomingPackage.header.packetNumber;
+            message.packetNumber = package.header.packetNumber;
+            message.selectiveMask = (package.header.length > 0) ? package.data[0] : 0;
             message.nackReason = NackReason::NO_ERROR;
             m_messageQueue.push(message);
         }
-        else if (m_incomingPackage.header.type == NACK_TYPE &&
-                 m_incomingPackage.header.packetNumber == m_outgoingPacketNumber)
+        else if (package.header.type == NACK_TYPE && package.header.packetNumber != 0)
         {
             // Extract and report NACK reason
             NackReason nackReason = NackReason::NO_ERROR;
-            if (m_incomingPackage.header.length > 0)
+            if (package.header.length > 0)
             {
-                nackReason = static_cast<NackReason>(m_incomingPackage.data[0]);
+                nackReason = static_cast<NackReason>(package.data[0]);
                 String msg = String(PGMT(PREFIX_O_STR)) + String(toString(nackReason));
                 OS.logMessage(nullptr, Scheduler::LOG_ERROR, msg.c_str());
             }
 
             // Queue NACK
+            m_statistics.nacksReceived++;
             PendingMessage message;
             message.type = PendingMessageType::NACK_RECEIVED;
-            message.packetNumber = m_incomingPackage.header.packetNumber;
+            message.packetNumber = package.header.packetNumber;
+            message.selectiveMask = 0;
             message.nackReason = nackReason;
             m_messageQueue.push(message);
         }
@@ -603,22 +961,27 @@ bool CRCPackageInterface::processPackage()
         // Report validation failure
         String msg = String(PGMT(PREFIX_I_STR)) + String(toString(validationResult));
         OS.logMessage(nullptr, Scheduler::LOG_ERROR, msg.c_str());
+        countRejection(validationResult);
 
         // Send NACK if DATA packet
-        if (m_incomingPackage.header.type == DATA_TYPE)
+        if (isDataType(package.header.type))
         {
-            if (PACKAGE_LENGTH > encodedStream.availableForWrite())
+            if (m_frameLength > encodedStream.availableForWrite())
             {
                 String msg = String(PGMT(PREFIX_I_STR)) + String(PGMT(BUFFER_FULL_STR));
                 OS.logMessage(nullptr, Scheduler::LOG_WARN, msg.c_str());
                 return false;
             }
 
-            const uint8_t packetNumber = m_incomingPackage.header.packetNumber;
             const uint8_t reasonData[1] = {validationResult};
-            memset(&m_incomingPackage, 0, sizeof(m_incomingPackage));
-            preparePackage(m_incomingPackage, NACK_TYPE, packetNumber, 1, reasonData);
-            sendPackage(m_incomingPackage);
+            sendControlPackage(NACK_TYPE, package.header.packetNumber, 1, reasonData);
+            m_statistics.nacksSent++;
+        }
+
+        if (m_framing == START_STOP_FRAMING)
+        {
+            resyncIncoming(package);
+            return true;
         }
     }
 
@@ -627,28 +990,343 @@ bool CRCPackageInterface::processPackage()
 }
 
 /**
- * @brief Handles outgoing state machine
+ * @brief Resynchronizes on the bytes of a rejected packet
  *
- * @details Processes one state machine iteration:
+ * @details A start byte inside a payload makes the receiver read a
+ * misaligned packet that swallows the head of the real one behind it.
+ * Rather than dropping all of its bytes, reception restarts at the
+ * next start byte among them, so the real packet is still recovered.
  *
- * READ_DATA:
- * - Collect data until timeout or buffer full
- * - Reset timer on first byte
- * - Move to SEND_PACKAGE when ready
+ * @param package Rejected packet, in the ring or in m_incomingPackage
+ */
+void CRCPackageInterface::resyncIncoming(const Package &package)
+{
+    const uint8_t *const raw = reinterpret_cast<const uint8_t *>(&package);
+    const uint8_t *const start =
+        static_cast<const uint8_t *>(memchr(raw + 1, START_BYTE, m_packageLength - 1));
+    if (!start)
+    {
+        resetIncomingState();
+        return;
+    }
+
+    // The bytes may already be in the buffer - appendIncoming() moves them down
+    m_incomingFlags.m_incomingDataLength = 0;
+    m_incomingCrc = CRC16::INITIAL_VALUE;
+    appendIncoming(start, raw + m_packageLength - start);
+    m_incomingFlags.m_currentState = IncomingState::READ_INCOMING_DATA;
+    m_incomingTimer.reset();
+}
+
+/**
+ * @brief Sends the receiver's cumulative and selective ACK
  *
- * SEND_PACKAGE:
- * - Prepare packet with CRC
- * - Transmit over encoded stream
- * - Move to WAIT_FOR_ACK_OR_NACK
+ * @details The packet number is the last packet delivered in order.
+ * Packets buffered beyond a gap are reported in a one-byte bitmap,
+ * bit i standing for packet number + 2 + i. Without buffered packets
+ * the ACK has no payload, exactly as a stop-and-wait ACK.
+ */
+void CRCPackageInterface::sendAck()
+{
+    const uint8_t selectiveMask = m_incomingReceivedMask >> 1;
+    if (selectiveMask)
+    {
+        sendControlPackage(ACK_TYPE, m_lastIncomingPacketNumber, 1, &selectiveMask);
+    }
+    else
+    {
+        sendControlPackage(ACK_TYPE, m_lastIncomingPacketNumber);
+    }
+    m_pendingAcks = 0;
+    m_statistics.acksSent++;
+}
+
+/**
+ * @brief Acknowledges a received DATA packet according to the ACK mode
  *
- * WAIT_FOR_ACK_OR_NACK:
- * - Wait for response with timeout
- * - On ACK: Increment sequence, reset state
- * - On NACK: Retry if attempts remain
- * - On timeout: Retry if attempts remain
+ * @details Packets around a gap and duplicates are answered at once:
+ * the selective bitmap, the ACK past the filled gap or the repeated ACK
+ * lets the sender recover without waiting for a timeout. In-order
+ * packets wait for a DATA packet to carry the ACK, or for
+ * flushPendingAck().
  *
- * @return true if state changed
- * @return false if no state change
+ * @param urgent Packet was out of order, filled a gap or was a duplicate
+ */
+void CRCPackageInterface::acknowledge(const bool urgent)
+{
+    if (m_ackMode == IMMEDIATE_ACKS || urgent)
+    {
+        sendAck();
+        return;
+    }
+
+    if (m_pendingAcks == 0)
+    {
+        m_ackTimer.reset();
+    }
+    if (m_pendingAcks < 0xFF)
+    {
+        m_pendingAcks++;
+    }
+}
+
+/**
+ * @brief Sends a pending ACK that waited long enough
+ *
+ * @details Every DELAYED_ACK_COUNT-th packet is acknowledged, which
+ * halves the ACK packets while the sender's window stays open. Windows
+ * too small for that, stop-and-wait included, are acknowledged on the
+ * next call. The ACK delay bounds the wait for a lone packet.
+ */
+void CRCPackageInterface::flushPendingAck()
+{
+    if (m_pendingAcks == 0)
+    {
+        return;
+    }
+
+    const uint8_t delayedAckCount = DELAYED_ACK_COUNT;
+    const uint8_t threshold = (m_windowSize >= 2 * delayedAckCount) ? delayedAckCount : 1;
+    if ((m_pendingAcks >= threshold || m_ackTimer.isReady()) &&
+        m_frameLength <= getInternalEncodedStream().availableForWrite())
+    {
+        sendAck();
+    }
+}
+
+/**
+ * @brief Fills in the ACK field of an outgoing DATA packet
+ *
+ * @details The field always holds the latest state, so a retransmitted
+ * packet does not repeat an outdated ACK and every DATA packet makes up
+ * for a lost ACK packet. The caller updates the CRC afterwards.
+ *
+ * @param package DATA packet about to be sent
+ */
+void CRCPackageInterface::attachAck(Package &package)
+{
+    if (m_ackMode != PIGGYBACKED_ACKS)
+    {
+        return;
+    }
+
+    uint8_t *const field = package.data + m_dataLength;
+    field[0] = m_lastIncomingPacketNumber;
+    field[1] = m_incomingReceivedMask >> 1;
+
+    if (m_pendingAcks > 0)
+    {
+        m_pendingAcks = 0;
+        m_statistics.piggybackedAcks++;
+    }
+}
+
+/**
+ * @brief Feeds a round-trip time sample to the RTO estimator
+ *
+ * @details Jacobson/Karels estimator in fixed point (RFC 6298):
+ * - First sample: SRTT = R, RTTVAR = R / 2
+ * - Then: RTTVAR += (|SRTT - R| - RTTVAR) / 4, SRTT += (R - SRTT) / 8
+ * - RTO = SRTT + max(G, 4 * RTTVAR), clamped to PACKAGER_MIN_RTO..PACKAGER_MAX_RTO,
+ *   where G (RTO_GRANULARITY) absorbs millis() ticks and loop() latency
+ *
+ * SRTT is kept scaled by 8 and RTTVAR by 4, so each update is a few
+ * additions and shifts. A valid sample also ends the backoff.
+ *
+ * @param sample Measured round-trip time in milliseconds
+ */
+void CRCPackageInterface::updateRto(uint16_t sample)
+{
+    if (sample > PACKAGER_MAX_RTO)
+    {
+        sample = PACKAGER_MAX_RTO;
+    }
+
+    if (!m_hasRttSample)
+    {
+        m_smoothedRtt8 = sample << 3;
+        m_rttVariation4 = sample << 1;
+        m_hasRttSample = true;
+    }
+    else
+    {
+        const int16_t error = (int16_t)sample - (int16_t)(m_smoothedRtt8 >> 3);
+        m_smoothedRtt8 += error;
+        m_rttVariation4 += (uint16_t)(error < 0 ? -error : error) - (m_rttVariation4 >> 2);
+    }
+
+    const uint16_t granularity = RTO_GRANULARITY;
+    const uint16_t rto = (m_smoothedRtt8 >> 3) + ((m_rttVariation4 > granularity) ? m_rttVariation4 : granularity);
+    const uint16_t minRto = PACKAGER_MIN_RTO;
+    const uint16_t maxRto = PACKAGER_MAX_RTO;
+    m_rto = (rto < minRto) ? minRto : ((rto > maxRto) ? maxRto : rto);
+    m_rtoBackoff = 0;
+    m_statistics.rttSamples++;
+}
+
+/**
+ * @brief Gets the current retransmission timeout
+ *
+ * @return uint16_t Timeout in milliseconds, backoff included
+ */
+uint16_t CRCPackageInterface::getRto() const
+{
+    const uint32_t rto = (uint32_t)m_rto << m_rtoBackoff;
+    const uint16_t maxRto = PACKAGER_MAX_RTO;
+    return (rto > maxRto) ? maxRto : rto;
+}
+
+/**
+ * @brief Delivers a payload to the plain stream
+ *
+ * @details Writes the payload and tracks the length of the message it
+ * belongs to. The last fragment of a message also records the message
+ * length for readMessage(), so it is only delivered when the message
+ * queue has room.
+ *
+ * @param data Payload bytes
+ * @param length Payload length
+ * @param messageEnd Whether the payload ends a message
+ * @return true if delivered
+ * @return false if the plain stream or message queue is full
+ */
+bool CRCPackageInterface::deliverPayload(const uint8_t *const data, const uint8_t length, const bool messageEnd)
+{
+    PipedStream &plainStream = getInternalPlainStream();
+
+    // Fragments dropped by a reset must be skipped before the next message
+    if (m_incomingDiscardLength > 0 && m_incomingMessageLengths.push(m_incomingDiscardLength | DISCARD_MESSAGE_FLAG))
+    {
+        m_incomingDiscardLength = 0;
+    }
+
+    if (length > plainStream.availableForWrite() ||
+        (messageEnd && (m_incomingDiscardLength > 0 || m_incomingMessageLengths.isFull())))
+    {
+        return false;
+    }
+
+    plainStream.write(data, length);
+    m_incomingMessageLength += length;
+
+    if (messageEnd)
+    {
+        m_incomingMessageLengths.push(m_incomingMessageLength);
+        m_incomingMessageLength = 0;
+    }
+    return true;
+}
+
+/**
+ * @brief Delivers buffered packets that became in-order
+ *
+ * @details Writes the payloads at the front of the receive window to
+ * the plain stream until a gap is reached. Stops early, keeping the
+ * packet buffered, when the plain stream has no room for it.
+ */
+void CRCPackageInterface::deliverBufferedPackets()
+{
+    while (m_incomingReceivedMask & 1)
+    {
+        const IncomingSlot &slot = m_incomingSlots[m_incomingWindowHead];
+        if (!deliverPayload(slot.data, slot.length, slot.messageEnd))
+        {
+            return;
+        }
+
+        m_lastIncomingPacketNumber = nextPacketNumber(m_lastIncomingPacketNumber);
+        m_incomingWindowHead = (m_incomingWindowHead + 1) & WINDOW_MASK;
+        m_incomingReceivedMask >>= 1;
+    }
+}
+
+/**
+ * @brief Applies an ACK to the outgoing window
+ *
+ * @details Marks every packet up to @p cumulative and every packet
+ * flagged in @p selectiveMask as acknowledged, then slides the window
+ * past the acknowledged packets at its front. ACKs that do not refer
+ * to the packets in flight are stale and ignored.
+ *
+ * The most recently sent of the newly acknowledged packets gives the
+ * RTT sample, unless it was retransmitted: its ACK could belong to
+ * any of its transmissions (Karn's rule).
+ *
+ * @param cumulative Highest packet number received in order
+ * @param selectiveMask Bit i: packet cumulative + 2 + i received
+ */
+void CRCPackageInterface::applyAck(const uint8_t cumulative, const uint8_t selectiveMask)
+{
+    const uint8_t distance = packetDistance(cumulative, m_outgoingPacketNumber);
+    if (distance == 0 || distance > m_packetsInFlight + 1)
+    {
+        return;
+    }
+
+    // Number of packets covered by the cumulative part
+    const uint8_t covered = m_packetsInFlight + 1 - distance;
+
+    const OutgoingSlot *newest = nullptr;
+    for (uint8_t offset = 0; offset < m_packetsInFlight; offset++)
+    {
+        OutgoingSlot &slot = outgoingSlot(offset);
+        if (!slot.acknowledged &&
+            (offset < covered || (offset > covered && ((selectiveMask >> (offset - covered - 1)) & 1))))
+        {
+            slot.acknowledged = 1;
+            newest = &slot;
+        }
+    }
+
+    if (newest && !newest->retransmitted)
+    {
+        updateRto(newest->timer.elapsed());
+
+        // Packets still in flight may have been sent with a backed-off
+        // timeout; rearm them with the new estimate
+        const uint16_t rto = getRto();
+        for (uint8_t offset = 0; offset < m_packetsInFlight; offset++)
+        {
+            outgoingSlot(offset).timer.setInterval(rto);
+        }
+    }
+
+    // Slide past acknowledged packets, freeing their slots
+    while (m_packetsInFlight > 0 && outgoingSlot(0).acknowledged)
+    {
+        OutgoingSlot &slot = outgoingSlot(0);
+        memset(&slot.package, 0, sizeof(slot.package));
+        slot.retryCount = 0;
+        slot.retransmitted = 0;
+        slot.acknowledged = 0;
+        slot.retransmitNow = 0;
+        m_outgoingWindowHead = (m_outgoingWindowHead + 1) & WINDOW_MASK;
+        m_packetsInFlight--;
+    }
+}
+
+/**
+ * @brief Handles the outgoing sliding window
+ *
+ * @details Performs one action per call, in priority order:
+ *
+ * 1. Queued ACK/NACK:
+ *    - ACK: mark packets acknowledged and slide the window
+ *    - NACK: flag the packet for immediate retransmission
+ *
+ * 2. Retransmission (oldest first):
+ *    - Resend a NACKed packet or one whose timer expired
+ *    - Double the timeout after the oldest packet expired (exponential backoff)
+ *    - After MAX_RETRY_COUNT timeouts, reset the connection
+ *
+ * 3. New packet, while fewer than the window size are in flight:
+ *    - Collect data into the slot following the packets in flight
+ *    - Send it once full, or once the collect timeout expires
+ *
+ * A full encoded stream simply defers sending until there is room.
+ *
+ * @return true if an action was taken
+ * @return false if there was nothing to do
  */
 bool CRCPackageInterface::handleOutgoingState()
 {
@@ -659,110 +1337,155 @@ bool CRCPackageInterface::handleOutgoingState()
     PendingMessage message;
     if (m_messageQueue.pop(message))
     {
-        if (message.type == PendingMessageType::ACK_RECEIVED &&
-            message.packetNumber == m_outgoingPacketNumber &&
-            m_outgoingFlags.m_currentState == OutgoingState::WAIT_FOR_ACK_OR_NACK)
+        if (message.type == PendingMessageType::ACK_RECEIVED)
         {
-            // Process ACK - advance sequence and reset state
-            m_outgoingPacketNumber++;
-            if (m_outgoingPacketNumber == 0) // Handle overflow
-            {
-                m_outgoingPacketNumber = 1;
-                m_lastIncomingPacketNumber = 0;
-                String msg = String(PGMT(PREFIX_O_STR)) + String(PGMT(RESET_NUM_STR));
-                OS.logMessage(nullptr, Scheduler::LOG_INFO, msg.c_str());
-            }
-            resetOutgoingState();
-            return true;
+            applyAck(message.packetNumber, message.selectiveMask);
         }
-        else if (message.type == PendingMessageType::NACK_RECEIVED &&
-                 message.packetNumber == m_outgoingPacketNumber &&
-                 m_outgoingFlags.m_currentState == OutgoingState::WAIT_FOR_ACK_OR_NACK)
+        else if (message.type == PendingMessageType::NACK_RECEIVED)
         {
-            // Process NACK - retry if attempts remain
-            m_outgoingFlags.m_retryCount++;
-            String msg = String(PGMT(PREFIX_O_STR)) + String(PGMT(NACK_STR));
-            OS.logMessage(nullptr, Scheduler::LOG_ERROR, msg.c_str());
-            m_outgoingFlags.m_currentState = OutgoingState::SEND_PACKAGE;
-            return true;
+            // Retransmit without waiting if the packet is still in flight
+            const uint8_t distance = packetDistance(message.packetNumber, m_outgoingPacketNumber);
+            if (distance > 0 && distance <= m_packetsInFlight)
+            {
+                OutgoingSlot &slot = outgoingSlot(m_packetsInFlight - distance);
+                if (!slot.acknowledged)
+                {
+                    slot.retransmitNow = 1;
+                    String msg = String(PGMT(PREFIX_O_STR)) + String(PGMT(NACK_STR));
+                    OS.logMessage(nullptr, Scheduler::LOG_ERROR, msg.c_str());
+                }
+            }
         }
+        return true;
     }
 
-    switch (m_outgoingFlags.m_currentState)
+    const bool canSend = m_frameLength <= encodedStream.availableForWrite();
+
+    // Retransmit NACKed or timed-out packets
+    for (uint8_t offset = 0; offset < m_packetsInFlight; offset++)
     {
-    case OutgoingState::READ_DATA:
-        if (m_outgoingPackage.header.length == 0)
+        OutgoingSlot &slot = outgoingSlot(offset);
+        if (slot.acknowledged || !(slot.retransmitNow || slot.timer.isReady()))
         {
-            m_outgoingTimer.reset();
+            continue;
         }
 
-        // Collect data until full or timeout
-        while (plainStream.available() &&
-               m_outgoingPackage.header.length < MAX_DATA_LENGTH)
+        if (!canSend)
         {
-            m_outgoingPackage.data[m_outgoingPackage.header.length++] = plainStream.read();
+            return false;
         }
 
-        // Move to SEND_PACKAGE if data ready
-        if (m_outgoingTimer.isReady() && (m_outgoingPackage.header.length > 0))
+        if (slot.retryCount >= MAX_RETRY_COUNT)
         {
-            m_outgoingFlags.m_retryCount = 0;
-            m_outgoingFlags.m_currentState = OutgoingState::SEND_PACKAGE;
+            // Max retries reached - resynchronize with the peer
+            String msg = String(PGMT(PREFIX_O_STR)) + String(PGMT(MAX_RETRY_STR));
+            OS.logMessage(nullptr, Scheduler::LOG_ERROR, msg.c_str());
+            sendResetPacket();
             return true;
         }
-        break;
 
-    case OutgoingState::SEND_PACKAGE:
-        // Verify buffer space
-        if (PACKAGE_LENGTH > encodedStream.availableForWrite())
+        // A NACK shows the peer is alive, so only timeouts count towards
+        // giving up; a timeout also means the estimate is too low - back
+        // off until the next sample, once per expiry of the oldest packet
+        // rather than once per packet of the window timing out with it
+        if (slot.retransmitNow)
         {
-            String msg = String(PGMT(PREFIX_O_STR)) + String(PGMT(BUFFER_FULL_STR));
-            OS.logMessage(nullptr, Scheduler::LOG_WARN, msg.c_str());
-            return false;
+            m_statistics.nackRetransmissions++;
         }
+        else
+        {
+            m_statistics.timeoutRetransmissions++;
+            slot.retryCount++;
+            if (offset == 0 && m_rtoBackoff < MAX_RTO_BACKOFF)
+            {
+                m_rtoBackoff++;
+            }
+        }
+
+        slot.retransmitted = 1;
+        slot.retransmitNow = 0;
+        String msg = String(PGMT(PREFIX_O_STR)) + String(PGMT(RETRY_STR));
+        OS.logMessage(nullptr, Scheduler::LOG_ERROR, msg.c_str());
+        if (m_ackMode == PIGGYBACKED_ACKS)
+        {
+            // Carry the current ACK, not the one of the first transmission
+            Package &package = slot.package;
+            attachAck(package);
+            preparePackage(package, package.header.type, package.header.packetNumber, package.header.length);
+        }
+        sendPackage(slot.package);
+        slot.timer.setInterval(getRto());
+        slot.timer.reset();
+        return true;
+    }
 
-        // Prepare and send packet
-        preparePackage(m_outgoingPackage, DATA_TYPE, m_outgoingPacketNumber,
-                       m_outgoingPackage.header.length);
-        sendPackage(m_outgoingPackage);
+    // Window full - wait for ACKs
+    if (m_packetsInFlight >= m_windowSize)
+    {
+        return false;
+    }
 
-        // Move to wait state
-        m_outgoingFlags.m_currentState = OutgoingState::WAIT_FOR_ACK_OR_NACK;
-        m_outgoingTimer.setInterval(OUTGOING_DATA_ACK_NACK_TIMEOUT);
+    // Collect data for the next packet
+    OutgoingSlot &slot = outgoingSlot(m_packetsInFlight);
+    Package &package = slot.package;
+    if (package.header.length == 0)
+    {
         m_outgoingTimer.reset();
-        return true;
+    }
 
-    case OutgoingState::WAIT_FOR_ACK_OR_NACK:
-        // Check for timeout
-        if (m_outgoingTimer.isReady())
+    // Start the next queued message on a fresh packet
+    if (package.header.length == 0 && m_outgoingMessageRemaining == 0)
+    {
+        m_outgoingMessageLengths.pop(m_outgoingMessageRemaining);
+    }
+
+    // A packet ending a message takes no further bytes
+    if (package.header.type != DATA_END_TYPE)
+    {
+        const bool inMessage = (m_outgoingMessageRemaining > 0);
+        uint16_t limit = m_dataLength - package.header.length;
+        if (inMessage && m_outgoingMessageRemaining < limit)
         {
-            if (m_outgoingFlags.m_retryCount >= MAX_RETRY_COUNT)
-            {
-                // Max retries reached - reset state
-                String msg = String(PGMT(PREFIX_O_STR)) + String(PGMT(MAX_RETRY_STR));
-                OS.logMessage(nullptr, Scheduler::LOG_ERROR, msg.c_str());
-                resetOutgoingState();
-            }
-            else
+            limit = m_outgoingMessageRemaining;
+        }
+
+        const int available = plainStream.available();
+        const uint8_t count = ((uint16_t)available < limit) ? available : limit;
+        if (count > 0)
+        {
+            plainStream.readBytes(package.data + package.header.length, count);
+            package.header.length += count;
+        }
+
+        if (inMessage)
+        {
+            m_outgoingMessageRemaining -= count;
+            if (m_outgoingMessageRemaining == 0)
             {
-                // Retry transmission
-                m_outgoingFlags.m_retryCount++;
-                String msg = String(PGMT(PREFIX_O_STR)) + String(PGMT(RETRY_STR));
-                OS.logMessage(nullptr, Scheduler::LOG_ERROR, msg.c_str());
-                m_outgoingFlags.m_currentState = OutgoingState::SEND_PACKAGE;
+                package.header.type = DATA_END_TYPE;
             }
-            return true;
         }
-        break;
+    }
 
-    default:
-        // Invalid state - reset
-        String msg = String(PGMT(PREFIX_O_STR)) + String(PGMT(UNKNOWN_STATE_STR));
-        OS.logMessage(nullptr, Scheduler::LOG_ERROR, msg.c_str());
-        resetOutgoingState();
-        return true;
+    // Send once full, at the end of a message, or once data waited long enough
+    if (package.header.length == 0 || !canSend ||
+        (package.header.length < m_dataLength && package.header.type != DATA_END_TYPE &&
+         !m_outgoingTimer.isReady()))
+    {
+        return false;
     }
-    return false;
+
+    attachAck(package);
+    preparePackage(package, package.header.type, m_outgoingPacketNumber, package.header.length);
+    sendPackage(package);
+    slot.timer.setInterval(getRto());
+    slot.timer.reset();
+    slot.retryCount = 0;
+    slot.retransmitted = 0;
+    m_statistics.packetsSent++;
+    m_packetsInFlight++;
+    m_outgoingPacketNumber = nextPacketNumber(m_outgoingPacketNumber);
+    return true;
 }
 
 /**
@@ -790,23 +1513,30 @@ bool CRCPackageInterface::handleOutgoingState()
  */
 bool CRCPackageInterface::handleIncomingState()
 {
+    if (m_framing == COBS_FRAMING)
+    {
+        return handleCobsIncomingState();
+    }
+
     PipedStream &encodedStream = getInternalEncodedStream();
-    uint8_t *buffer = reinterpret_cast<uint8_t *>(&m_incomingPackage);
+    const uint8_t *data;
+    uint16_t length;
 
     switch (m_incomingFlags.m_currentState)
     {
     case IncomingState::WAIT_FOR_START_BYTE:
-        if (encodedStream.available())
+        if (encodedStream.peekContiguous(data, length))
         {
-            const uint8_t peekByte = static_cast<uint8_t>(encodedStream.peek());
-            if (peekByte != START_BYTE)
+            const uint8_t *const start = static_cast<const uint8_t *>(memchr(data, START_BYTE, length));
+            if (!start)
             {
-                // Discard non-start bytes
-                encodedStream.read();
+                // Discard the whole run of non-start bytes
+                encodedStream.consume(length);
             }
             else
             {
                 // Start byte found - begin packet reception
+                encodedStream.consume(start - data);
                 m_incomingFlags.m_currentState = IncomingState::READ_INCOMING_DATA;
                 m_incomingTimer.reset();
                 return true;
@@ -815,18 +1545,36 @@ bool CRCPackageInterface::handleIncomingState()
         break;
 
     case IncomingState::READ_INCOMING_DATA:
-        // Check for reception timeout
+        // Check for reception stall
         if (m_incomingTimer.isReady() && !encodedStream.available())
         {
+            m_statistics.incompletePackets++;
             resetIncomingState();
             return true;
         }
 
-        // Store next byte
-        buffer[m_incomingFlags.m_incomingDataLength++] = encodedStream.read();
+        // A complete contiguous packet is parsed in place, without copying
+        if (m_incomingFlags.m_incomingDataLength == 0 &&
+            encodedStream.peekContiguous(data, length) && length >= m_packageLength)
+        {
+            m_incomingFlags.m_currentState = IncomingState::PROCESS_INCOMING_DATA;
+            return true;
+        }
+
+        // Otherwise collect whatever has arrived, at most two runs,
+        // and fold the bytes in CRC scope into the running CRC
+        while (m_incomingFlags.m_incomingDataLength < m_packageLength &&
+               encodedStream.peekContiguous(data, length))
+        {
+            const uint16_t missing = m_packageLength - m_incomingFlags.m_incomingDataLength;
+            const uint16_t count = (length < missing) ? length : missing;
+            appendIncoming(data, count);
+            encodedStream.consume(count);
+            m_incomingTimer.reset();
+        }
 
         // Check if packet complete
-        if (m_incomingFlags.m_incomingDataLength == PACKAGE_LENGTH)
+        if (m_incomingFlags.m_incomingDataLength == m_packageLength)
         {
             m_incomingFlags.m_currentState = IncomingState::PROCESS_INCOMING_DATA;
             return true;
@@ -834,7 +1582,19 @@ bool CRCPackageInterface::handleIncomingState()
         break;
 
     case IncomingState::PROCESS_INCOMING_DATA:
-        return processPackage();
+        if (m_incomingFlags.m_incomingDataLength == 0)
+        {
+            // Packet still lies in the ring - release it only once handled
+            encodedStream.peekContiguous(data, length);
+            if (processPackage(*reinterpret_cast<const Package *>(data),
+                               crc16(data + CRC_SCOPE_OFFSET, m_crcScopeLength)))
+            {
+                encodedStream.consume(m_packageLength);
+                return true;
+            }
+            return false;
+        }
+        return processPackage(m_incomingPackage, m_incomingCrc);
 
     default:
         // Invalid state - reset
@@ -844,4 +1604,232 @@ bool CRCPackageInterface::handleIncomingState()
         return true;
     }
     return false;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Handles incoming state machine with COBS framing
+ *
+ * @details Processes one state machine iteration:
+ *
+ * WAIT_FOR_START_BYTE:
+ * - Entered only after a broken frame
+ * - Discard bytes up to and including the next 0x00 delimiter
+ * - Move to READ_INCOMING_DATA
+ *
+ * READ_INCOMING_DATA:
+ * - Decode COBS blocks straight into the incoming packet buffer,
+ *   restoring the implied zeros and folding bytes into the running CRC
+ * - On the delimiter, move to PROCESS_INCOMING_DATA if a whole packet
+ *   was decoded, otherwise drop the frame
+ * - Drop a frame that outgrows a packet or stalls
+ *
+ * PROCESS_INCOMING_DATA:
+ * - Validate packet integrity
+ * - Handle based on packet type
+ * - Send ACK/NACK as appropriate
+ *
+ * Since a delimiter never occurs inside an encoded frame, noise costs
+ * at most the frame it hits: decoding restarts right after the next
+ * delimiter instead of hunting for a start byte.
+ *
+ * @return true if state changed
+ * @return false if no state change
+ */
+bool CRCPackageInterface::handleCobsIncomingState()
+{
+    PipedStream &encodedStream = getInternalEncodedStream();
+    const uint8_t *data;
+    uint16_t length;
+
+    switch (m_incomingFlags.m_currentState)
+    {
+    case IncomingState::WAIT_FOR_START_BYTE:
+        if (encodedStream.peekContiguous(data, length))
+        {
+            const uint8_t *const delimiter = static_cast<const uint8_t *>(memchr(data, COBS::DELIMITER, length));
+            if (!delimiter)
+            {
+                // Discard the whole run of the broken frame
+                encodedStream.consume(length);
+            }
+            else
+            {
+                // Delimiter found - the next frame starts right after it
+                encodedStream.consume(delimiter - data + 1);
+                resetIncomingState();
+                return true;
+            }
+        }
+        break;
+
+    case IncomingState::READ_INCOMING_DATA:
+        // Drop a partial frame that stopped arriving
+        if (m_incomingTimer.isReady() && !encodedStream.available())
+        {
+            if (m_incomingFlags.m_incomingDataLength > 0 || m_cobsBlockRemaining > 0)
+            {
+                m_statistics.incompletePackets++;
+                resetIncomingState();
+                return true;
+            }
+            m_incomingTimer.reset();
+        }
+
+        while (encodedStream.peekContiguous(data, length))
+        {
+            m_incomingTimer.reset();
+            uint16_t index = 0;
+
+            while (index < length)
+            {
+                if (m_cobsBlockRemaining == 0)
+                {
+                    const uint8_t code = data[index++];
+
+                    if (code == COBS::DELIMITER)
+                    {
+                        encodedStream.consume(index);
+
+                        if (m_incomingFlags.m_incomingDataLength == m_packageLength)
+                        {
+                            m_incomingFlags.m_currentState = IncomingState::PROCESS_INCOMING_DATA;
+                            return true;
+                        }
+
+                        // Runt frame - empty frames between delimiters are not reported
+                        if (m_incomingFlags.m_incomingDataLength > 0)
+                        {
+                            rejectIncomingFrame();
+                        }
+                        resetIncomingState();
+                        return true;
+                    }
+
+                    // The zero implied by the previous block precedes this one
+                    static const uint8_t zero = 0;
+                    if (m_incomingFlags.m_cobsZeroPending && !appendIncoming(&zero, 1))
+                    {
+                        encodedStream.consume(index);
+                        rejectIncomingFrame();
+                        resetIncomingState();
+                        m_incomingFlags.m_currentState = IncomingState::WAIT_FOR_START_BYTE;
+                        return true;
+                    }
+
+                    m_cobsBlockRemaining = code - 1;
+                    m_incomingFlags.m_cobsZeroPending = (code != 0xFF);
+                    continue;
+                }
+
+                // Copy the literal run; a delimiter inside it cuts the frame short
+                uint16_t run = length - index;
+                if (run > m_cobsBlockRemaining)
+                {
+                    run = m_cobsBlockRemaining;
+                }
+                const uint8_t *const delimiter =
+                    static_cast<const uint8_t *>(memchr(data + index, COBS::DELIMITER, run));
+                if (delimiter)
+                {
+                    run = delimiter - (data + index);
+                }
+
+                if (!appendIncoming(data + index, run))
+                {
+                    // Longer than a packet - skip the rest of the frame
+                    encodedStream.consume(index);
+                    rejectIncomingFrame();
+                    resetIncomingState();
+                    m_incomingFlags.m_currentState = IncomingState::WAIT_FOR_START_BYTE;
+                    return true;
+                }
+                index += run;
+
+                if (delimiter)
+                {
+                    // Let the delimiter end the (now incomplete) frame
+                    m_cobsBlockRemaining = 0;
+                    m_incomingFlags.m_cobsZeroPending = 0;
+                }
+                else
+                {
+                    m_cobsBlockRemaining -= run;
+                }
+            }
+
+            encodedStream.consume(index);
+        }
+        break;
+
+    case IncomingState::PROCESS_INCOMING_DATA:
+        return processPackage(m_incomingPackage, m_incomingCrc);
+
+    default:
+        // Invalid state - reset
+        String msg = String(PGMT(PREFIX_I_STR)) + String(PGMT(UNKNOWN_STATE_STR));
+        OS.logMessage(nullptr, Scheduler::LOG_ERROR, msg.c_str());
+        resetIncomingState();
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Reports a COBS frame of the wrong length
+ *
+ * @details Noise inserted into or cut out of a frame changes its
+ * length. If the header still looks like a DATA packet, it is NACKed
+ * like a packet failing validation, so the sender retransmits without
+ * waiting for its timer; a wrong packet number only causes a needless
+ * retransmission.
+ */
+void CRCPackageInterface::rejectIncomingFrame()
+{
+    String msg = String(PGMT(PREFIX_I_STR)) + String(PGMT(INVALID_LENGTH_STR));
+    OS.logMessage(nullptr, Scheduler::LOG_ERROR, msg.c_str());
+    countRejection(NackReason::INVALID_LENGTH);
+
+    if (m_incomingFlags.m_incomingDataLength >= HEADER_LENGTH && m_incomingPackage.header.startByte == START_BYTE &&
+        isDataType(m_incomingPackage.header.type) && m_incomingPackage.header.packetNumber != 0 &&
+        m_frameLength <= getInternalEncodedStream().availableForWrite())
+    {
+        const uint8_t reasonData[1] = {NackReason::INVALID_LENGTH};
+        sendControlPackage(NACK_TYPE, m_incomingPackage.header.packetNumber, 1, reasonData);
+        m_statistics.nacksSent++;
+    }
+}
+
+/**
+ * @brief Appends received bytes to the incoming packet
+ *
+ * @details Copies the bytes after those already received and folds the
+ * part within the CRC scope into the running CRC, so the packet needs
+ * no second pass once complete. The bytes may overlap the buffer.
+ *
+ * @param data Received bytes
+ * @param count Number of bytes
+ * @return true if appended
+ * @return false if they do not fit in a packet
+ */
+bool CRCPackageInterface::appendIncoming(const uint8_t *const data, const uint16_t count)
+{
+    const uint16_t offset = m_incomingFlags.m_incomingDataLength;
+    if (count > m_packageLength - offset)
+    {
+        return false;
+    }
+
+    uint8_t *const buffer = reinterpret_cast<uint8_t *>(&m_incomingPackage);
+    memmove(buffer + offset, data, count);
+    m_incomingFlags.m_incomingDataLength += count;
+
+    const uint16_t scopeFirst = CRC_SCOPE_OFFSET;
+    const uint16_t scopeLast = CRC_SCOPE_OFFSET + m_crcScopeLength;
+    const uint16_t scopeStart = (offset > scopeFirst) ? offset : scopeFirst;
+    const uint16_t scopeEnd = (offset + count < scopeLast) ? offset + count : scopeLast;
+    if (scopeEnd > scopeStart)
+    {
+        m_incomingCrc = CRC16::update(m_incomingCrc, buffer + scopeStart, scopeEnd - scopeStart);
+    }
+    return true;
+}
@@ -1,9 +1,11 @@
 #ifndef CRC_PACKAGE_INTERFACE_H
 #define CRC_PACKAGE_INTERFACE_H
 
+#include "COBS.h"
 #include "PackageInterface.h"
 #include "SimpleTimer.h"
 #include <FastCircularQueue.h>
+
 /**
  * @file CRCPackageInterface.h
  * @brief Reliable packet-based communication protocol with CRC-16 validation
@@ -13,13 +15,77 @@
  * @details Implements a robust communication protocol for reliable data exchange between
  * microcontrollers and external devices. Key features:
  * - CRC-16 error detection for data integrity
- * - 8-byte packet payload with minimal overhead
- * - Automatic retransmission with ACK/NACK
+ * - Configurable packet payload (8 bytes by default, up to 255)
+ * - Message fragmentation and reassembly
+ * - Sliding-window selective-repeat retransmission with ACK/NACK
+ * - Adaptive retransmission timeout from round-trip time estimation
+ * - Start/stop byte or COBS framing
+ * - ACKs optionally piggybacked on DATA packets and delayed
  * - Bidirectional flow control
  * - Connection state synchronization
  * - Flash memory optimization for embedded systems
  */
 
+/**
+ * @brief Maximum sliding-window size
+ * @details Storage for this many outstanding packets (and as many
+ * out-of-order received packets) is reserved in every interface;
+ * the window actually used is chosen in the constructor. Must be a
+ * power of two no larger than 8.
+ */
+#ifndef PACKAGER_MAX_WINDOW_SIZE
+#if defined(__AVR__)
+#define PACKAGER_MAX_WINDOW_SIZE 4
+#else
+#define PACKAGER_MAX_WINDOW_SIZE 8
+#endif
+#endif
+
+/**
+ * @brief Largest payload per packet, in bytes (1-255)
+ * @details Sizes the packet buffers; the payload length actually used is
+ * chosen in the constructor. Set it as a build flag so the library and
+ * the sketch agree on the class layout.
+ */
+#ifndef PACKAGER_MAX_DATA_LENGTH
+#define PACKAGER_MAX_DATA_LENGTH 8
+#endif
+
+/**
+ * @brief Number of complete messages buffered per direction
+ * @details Bounds the message boundaries kept by writeMessage() and
+ * readMessage(); the message bytes themselves live in the plain streams.
+ */
+#ifndef PACKAGER_MAX_QUEUED_MESSAGES
+#define PACKAGER_MAX_QUEUED_MESSAGES 4
+#endif
+
+/**
+ * @brief Lower bound of the retransmission timeout, in milliseconds
+ * @details Keeps a fast link from retransmitting on a peer that is only
+ * slow to call loop().
+ */
+#ifndef PACKAGER_MIN_RTO
+#define PACKAGER_MIN_RTO 20
+#endif
+
+/**
+ * @brief Upper bound of the retransmission timeout, in milliseconds
+ * @details Also caps the exponential backoff after timeouts.
+ */
+#ifndef PACKAGER_MAX_RTO
+#define PACKAGER_MAX_RTO 4000
+#endif
+
+/**
+ * @brief Longest time a delayed ACK is held back, in milliseconds
+ * @details Only used with PIGGYBACKED_ACKS. Adds to the round-trip time
+ * the sender measures when there is no reverse traffic to carry the ACK.
+ */
+#ifndef PACKAGER_ACK_DELAY
+#define PACKAGER_ACK_DELAY 20
+#endif
+
 /**
  * @class CRCPackageInterface
  * @brief High-reliability packet protocol with error detection
@@ -27,12 +93,20 @@
  * @details Provides a complete communication stack with the following features:
  *
  * Protocol Structure:
- * - Fixed 15-byte packet format (4B header + 8B payload + 3B footer)
+ * - Fixed-size packets: 4B header + payload + 3B footer
+ *   (15 bytes with the default 8-byte payload)
  * - CRC-16-CCITT error detection (polynomial: 0x1021)
- * - Start/stop byte framing (0xAA/0x55)
+ * - Start/stop byte framing (0xAA/0x55), optionally COBS-encoded
+ *   with a 0x00 delimiter for fast resynchronization
  *
  * Reliability Features:
  * - Automatic packet acknowledgment (ACK/NACK)
+ * - Up to PACKAGER_MAX_WINDOW_SIZE packets in flight, each with
+ *   its own retransmission timer
+ * - Retransmission timeout adapted to the measured round-trip time
+ *   (Jacobson/Karels), with exponential backoff
+ * - Cumulative ACKs with a selective bitmap, out-of-order buffering
+ * - Optional ACKs carried by DATA packets, with delayed standalone ACKs
  * - Configurable retry mechanism
  * - Sequence number tracking
  * - Connection state monitoring
@@ -73,6 +147,43 @@ public:
         UNKNOWN_ERROR = 0xFF       ///< Unclassified protocol error
     };
 
+    /**
+     * @enum Framing
+     * @brief How packets are delimited on the wire
+     *
+     * @details With START_STOP_FRAMING packets are sent as they are and
+     * the receiver hunts for the 0xAA start byte, which may also occur
+     * inside a packet. With COBS_FRAMING every packet is COBS-encoded and
+     * followed by a 0x00 delimiter that cannot occur anywhere else, so
+     * after corruption the receiver is back in sync at the next
+     * delimiter. Both ends must use the same framing.
+     */
+    enum Framing : uint8_t
+    {
+        START_STOP_FRAMING = 0, ///< Raw packets, synchronized on the start byte
+        COBS_FRAMING            ///< COBS-encoded packets, each ended by 0x00
+    };
+
+    /**
+     * @enum AckMode
+     * @brief How received DATA packets are acknowledged
+     *
+     * @details With IMMEDIATE_ACKS every DATA packet is answered by its
+     * own ACK packet. With PIGGYBACKED_ACKS every packet carries a 2-byte
+     * ACK field after the payload, which DATA packets fill with the
+     * receiver's current cumulative ACK and selective bitmap. A separate
+     * ACK is then only sent when no DATA packet took it along: for every
+     * second packet (every packet with windows below 4), after
+     * PACKAGER_ACK_DELAY, or at once around a gap (a packet out of
+     * order, one filling the gap) and for a packet already delivered.
+     * Both ends must use the same mode.
+     */
+    enum AckMode : uint8_t
+    {
+        IMMEDIATE_ACKS = 0, ///< One ACK packet per DATA packet
+        PIGGYBACKED_ACKS    ///< ACKs carried by DATA packets, otherwise delayed
+    };
+
     /**
      * @struct PackageHeader
      * @brief Packet framing and control information
@@ -90,7 +201,7 @@ public:
         uint8_t startByte;    ///< Frame start marker (constant: 0xAA)
         uint8_t packetNumber; ///< Sequence number (1-255, 0 reserved)
         uint8_t type;         ///< Packet type (DATA/ACK/NACK/RESET)
-        uint8_t length;       ///< Payload length (0-8 bytes)
+        uint8_t length;       ///< Payload length (0 to the configured payload size)
     };
 
     /**
@@ -109,8 +220,38 @@ public:
         uint8_t stopByte; ///< Frame end marker (constant: 0x55)
     };
 
+    /**
+     * @struct LinkStatistics
+     * @brief Transmission counters
+     *
+     * @details Counts since construction or the last resetStatistics().
+     */
+    struct LinkStatistics
+    {
+        uint32_t packetsSent;            ///< DATA packets sent for the first time
+        uint32_t timeoutRetransmissions; ///< Retransmissions after the timeout expired
+        uint32_t nackRetransmissions;    ///< Retransmissions requested by a NACK
+        uint32_t rttSamples;             ///< Round-trip times measured
+        uint32_t acksSent;               ///< ACK packets sent
+        uint32_t piggybackedAcks;        ///< Pending ACKs carried by DATA packets instead
+        uint32_t nacksSent;              ///< NACK packets sent for rejected DATA packets
+        uint32_t nacksReceived;          ///< NACK packets received
+        uint32_t crcErrors;              ///< Packets rejected with INVALID_CRC
+        uint32_t startStopErrors;        ///< Packets rejected with INVALID_START_STOP
+        uint32_t typeErrors;             ///< Packets rejected with INVALID_TYPE
+        uint32_t lengthErrors;           ///< Packets or COBS frames rejected with INVALID_LENGTH
+        uint32_t incompletePackets;      ///< Partial packets dropped after the reception timeout
+        uint32_t connectionResets;       ///< Protocol resets, local or requested by the peer
+    };
+
     /** @brief Maximum allowed payload size per packet */
-    static constexpr uint8_t MAX_DATA_LENGTH = 8;
+    static constexpr uint8_t MAX_DATA_LENGTH = PACKAGER_MAX_DATA_LENGTH;
+
+    static_assert(PACKAGER_MAX_DATA_LENGTH >= 1 && PACKAGER_MAX_DATA_LENGTH <= 255,
+                  "PACKAGER_MAX_DATA_LENGTH must be between 1 and 255");
+
+    /** @brief Size of the ACK field following the payload with PIGGYBACKED_ACKS */
+    static constexpr uint8_t ACK_FIELD_LENGTH = 2;
 
     /**
      * @struct Package
@@ -118,21 +259,29 @@ public:
      *
      * @details Represents a complete protocol packet with:
      * - 4-byte header (framing, control)
-     * - 8-byte payload (data)
+     * - Payload (data)
+     * - 2-byte ACK field (PIGGYBACKED_ACKS only)
      * - 3-byte footer (integrity check)
      *
-     * Total packet size is fixed at 15 bytes for predictable behavior.
+     * Every packet of an interface has the same size, set by its
+     * payload length and ACK mode. The ACK field and the footer
+     * directly follow the payload, so the footer is at the @c footer
+     * member only for the largest such packet; otherwise @c footer is
+     * unused room.
      * Memory layout is guaranteed by packed attribute for cross-platform compatibility.
      */
     struct __attribute__((packed)) Package
     {
-        PackageHeader header;          ///< Packet control information (4B)
-        uint8_t data[MAX_DATA_LENGTH]; ///< Payload buffer (8B)
-        PackageFooter footer;          ///< Integrity verification (3B)
+        PackageHeader header;                             ///< Packet control information (4B)
+        uint8_t data[MAX_DATA_LENGTH + ACK_FIELD_LENGTH]; ///< Payload buffer, then the ACK field
+        PackageFooter footer;                             ///< Integrity verification (3B)
     };
 
-    /** @brief Total packet size including header, payload, and footer */
-    static constexpr uint8_t PACKAGE_LENGTH = sizeof(Package);
+    /** @brief Largest packet size including header, payload, ACK field and footer */
+    static constexpr uint16_t PACKAGE_LENGTH = sizeof(Package);
+
+    /** @brief Smallest encoded buffer that holds the largest frame of either framing */
+    static constexpr uint16_t MIN_ENCODED_BUFFER_SIZE = PACKAGE_LENGTH + COBS::overhead(PACKAGE_LENGTH) + 2;
 
     /**
      * @brief Constructs a new CRC package interface
@@ -143,10 +292,33 @@ public:
      * - State machines for both channels
      * - Timers for timeout management
      *
+     * A window of 1 is plain stop-and-wait and interoperates with peers
+     * that do not support windowing. Larger windows need both ends to
+     * use the same window size, and an encoded buffer large enough for
+     * several packets to benefit from it.
+     *
+     * Both ends must also use the same payload length; the default of 8
+     * bytes matches the original 15-byte packet format.
+     *
+     * COBS framing costs two bytes per packet (the code byte and the
+     * delimiter), one more per 254 bytes of packet and one more for a
+     * packet sent on an idle link, and must be selected on both ends. An
+     * encoded buffer smaller than one COBS frame is enlarged to fit one.
+     *
+     * PIGGYBACKED_ACKS adds two bytes to every packet and must also be
+     * selected on both ends.
+     *
      * @param pipedStreamPair Bidirectional stream for raw/encoded data
      * @param encodedBufferSize Size of encoded data buffer (default: PACKAGE_LENGTH)
+     * @param windowSize Packets in flight (1 to PACKAGER_MAX_WINDOW_SIZE, default: 1)
+     * @param dataLength Payload bytes per packet (1 to MAX_DATA_LENGTH, default: 8)
+     * @param framing Wire framing (default: START_STOP_FRAMING)
+     * @param ackMode Acknowledgment mode (default: IMMEDIATE_ACKS)
      */
-    explicit CRCPackageInterface(PipedStreamPair &pipedStreamPair, const uint16_t encodedBufferSize = PACKAGE_LENGTH);
+    explicit CRCPackageInterface(PipedStreamPair &pipedStreamPair, const uint16_t encodedBufferSize = PACKAGE_LENGTH,
+                                 const uint8_t windowSize = 1, const uint8_t dataLength = 8,
+                                 const Framing framing = START_STOP_FRAMING,
+                                 const AckMode ackMode = IMMEDIATE_ACKS);
 
     /**
      * @brief Destructor
@@ -183,21 +355,184 @@ public:
      */
     void sendResetPacket();
 
+    /**
+     * @brief Gets the configured window size
+     *
+     * @return uint8_t Maximum number of packets in flight
+     */
+    uint8_t getWindowSize() const { return m_windowSize; }
+
+    /**
+     * @brief Gets the number of packets awaiting acknowledgment
+     *
+     * @return uint8_t Packets sent but not yet acknowledged
+     */
+    uint8_t getPacketsInFlight() const { return m_packetsInFlight; }
+
+    /**
+     * @brief Gets the configured payload length
+     *
+     * @return uint8_t Payload bytes per packet
+     */
+    uint8_t getDataLength() const { return m_dataLength; }
+
+    /**
+     * @brief Gets the size of every packet on the wire
+     *
+     * @return uint16_t Header, payload, ACK field and footer bytes
+     */
+    uint16_t getPackageLength() const { return m_packageLength; }
+
+    /**
+     * @brief Gets the configured framing
+     *
+     * @return Framing Wire framing
+     */
+    Framing getFraming() const { return m_framing; }
+
+    /**
+     * @brief Gets the largest number of bytes a packet takes on the wire
+     *
+     * @return uint16_t Packet length plus framing overhead
+     */
+    uint16_t getFrameLength() const { return m_frameLength; }
+
+    /**
+     * @brief Gets the configured acknowledgment mode
+     *
+     * @return AckMode Acknowledgment mode
+     */
+    AckMode getAckMode() const { return m_ackMode; }
+
+    /**
+     * @brief Gets the current retransmission timeout
+     *
+     * @details Smoothed RTT plus four times its variation (at least
+     * 10 ms), clamped to PACKAGER_MIN_RTO..PACKAGER_MAX_RTO and doubled
+     * for every timeout since the last RTT sample. Before the first
+     * sample it is 500 ms.
+     *
+     * @return uint16_t Timeout in milliseconds
+     */
+    uint16_t getRto() const;
+
+    /**
+     * @brief Gets the smoothed round-trip time
+     *
+     * @return uint16_t Smoothed RTT in milliseconds (0 before the first sample)
+     */
+    uint16_t getSmoothedRtt() const { return m_smoothedRtt8 >> 3; }
+
+    /**
+     * @brief Gets the round-trip time variation
+     *
+     * @return uint16_t Mean deviation of the RTT in milliseconds
+     */
+    uint16_t getRttVariation() const { return m_rttVariation4 >> 2; }
+
+    /**
+     * @brief Gets the transmission counters
+     *
+     * @return const LinkStatistics& Counters
+     */
+    const LinkStatistics &getStatistics() const { return m_statistics; }
+
+    /**
+     * @brief Gets the number of received packets rejected for a reason
+     *
+     * @param reason Validation failure
+     * @return uint32_t Matching LinkStatistics counter, 0 for NO_ERROR
+     *         and UNKNOWN_ERROR
+     */
+    uint32_t getRejectedPackets(const NackReason reason) const;
+
+    /**
+     * @brief Clears the transmission counters
+     */
+    void resetStatistics() { memset(&m_statistics, 0, sizeof(m_statistics)); }
+
+    /**
+     * @brief Queues a message for fragmented transmission
+     *
+     * @details Copies the whole message into the plain stream and
+     * records its length. The message is split across as many packets
+     * as needed; its last packet is sent without waiting for the
+     * collect timeout and is marked so the receiver can reassemble the
+     * message with readMessage(). The peer must support message
+     * packets.
+     *
+     * Do not write to the plain stream directly while messages are
+     * in use, or message boundaries get lost.
+     *
+     * @param data Message bytes
+     * @param length Message length (1 to the plain stream buffer size)
+     * @return true if the message was queued
+     * @return false if there is not enough room yet (try again later)
+     */
+    bool writeMessage(const uint8_t *data, const uint16_t length);
+
+    /**
+     * @brief Gets the number of complete messages received
+     *
+     * @return uint8_t Messages ready for readMessage()
+     */
+    uint8_t availableMessages() const { return m_incomingMessageLengths.available(); }
+
+    /**
+     * @brief Reads one reassembled message
+     *
+     * @details Copies the oldest complete message into @p buffer. A
+     * message longer than @p size is truncated and its remainder is
+     * discarded. Fragments of a message cut short by a connection reset
+     * are dropped silently.
+     *
+     * @param buffer Destination buffer
+     * @param size Size of the destination buffer
+     * @return int Bytes copied, or -1 if no complete message is available
+     */
+    int readMessage(uint8_t *buffer, const uint16_t size);
+
+protected:
+    /**
+     * @brief Constructs an interface over caller-provided encoded buffers
+     *
+     * @details Used by StaticCRCPackageInterface. Null storage is
+     * allocated, and then the size is grown for COBS as in the public
+     * constructor; given storage is used at the size given.
+     *
+     * @param pipedStreamPair Bidirectional stream for raw/encoded data
+     * @param encodedStorage1 Storage for encoded data from the line, or nullptr
+     * @param encodedStorage2 Storage for encoded data to the line, or nullptr
+     * @param encodedBufferSize Size of each encoded storage
+     * @param windowSize Packets in flight (1 to PACKAGER_MAX_WINDOW_SIZE)
+     * @param dataLength Payload bytes per packet (1 to MAX_DATA_LENGTH)
+     * @param framing Wire framing
+     * @param ackMode Acknowledgment mode
+     */
+    CRCPackageInterface(PipedStreamPair &pipedStreamPair, uint8_t *encodedStorage1, uint8_t *encodedStorage2,
+                        const uint16_t encodedBufferSize, const uint8_t windowSize, const uint8_t dataLength,
+                        const Framing framing, const AckMode ackMode);
+
 private:
     // Protocol Constants
     static constexpr uint8_t START_BYTE = 0xAA; ///< Packet frame start marker
     static constexpr uint8_t STOP_BYTE = 0x55;  ///< Packet frame end marker
 
     // Packet Types
-    static constexpr uint8_t DATA_TYPE = 0;  ///< Data packet (with payload)
-    static constexpr uint8_t ACK_TYPE = 1;   ///< Positive acknowledgment
-    static constexpr uint8_t NACK_TYPE = 2;  ///< Negative acknowledgment
-    static constexpr uint8_t RESET_TYPE = 3; ///< Connection reset request
+    static constexpr uint8_t DATA_TYPE = 0;     ///< Data packet (with payload)
+    static constexpr uint8_t ACK_TYPE = 1;      ///< Positive acknowledgment
+    static constexpr uint8_t NACK_TYPE = 2;     ///< Negative acknowledgment
+    static constexpr uint8_t RESET_TYPE = 3;    ///< Connection reset request
+    static constexpr uint8_t DATA_END_TYPE = 4; ///< Data packet ending a message
 
     // Protocol Parameters
-    static constexpr uint8_t MAX_PENDING_MESSAGES = 4;              ///< ACK/NACK queue size
-    static constexpr uint8_t MAX_RETRY_COUNT = 5;                   ///< Max retransmission attempts
-    static constexpr uint8_t MAX_REPLAY_COUNT = PACKAGE_LENGTH + 2; ///< Max state transitions per loop
+    /** @brief ACK/NACK queue size; the queue holds one less, so a full window of ACKs fits */
+    static constexpr uint8_t MAX_PENDING_MESSAGES = (PACKAGER_MAX_WINDOW_SIZE < 4) ? 8 : 2 * PACKAGER_MAX_WINDOW_SIZE;
+    static constexpr uint8_t MAX_RETRY_COUNT = 5;                    ///< Max timeouts per packet
+    static constexpr uint16_t MAX_REPLAY_COUNT = PACKAGE_LENGTH + 2; ///< Max state transitions per loop and window slot
+
+    /** @brief Message length entry marking fragments to discard */
+    static constexpr uint16_t DISCARD_MESSAGE_FLAG = 0x8000;
 
     /**
      * @enum PendingMessageType
@@ -219,16 +554,47 @@ private:
      *
      * @details Stores acknowledgment information including:
      * - Message type (ACK/NACK)
-     * - Associated packet number
+     * - Associated packet number (cumulative for ACK)
+     * - Selective ACK bitmap
      * - Error reason (for NACK)
      */
     struct PendingMessage
     {
         PendingMessageType type; ///< Message classification
         uint8_t packetNumber;    ///< Associated packet sequence number
+        uint8_t selectiveMask;   ///< Bit i: packet packetNumber + 2 + i received (ACK only)
         NackReason nackReason;   ///< Error code (if NACK)
     };
 
+    /**
+     * @struct OutgoingSlot
+     * @brief Sliding-window entry for a sent packet
+     *
+     * @details Keeps the packet as sent for retransmission, together
+     * with its own retransmission timer and timeout counter. The slot
+     * just past the packets in flight collects the next packet.
+     */
+    struct OutgoingSlot
+    {
+        Package package;             ///< Packet as sent
+        SimpleTimer<uint16_t> timer; ///< Retransmission timer
+        uint8_t retryCount : 3;      ///< Timeouts so far (0-7)
+        uint8_t acknowledged : 1;    ///< Selectively acknowledged
+        uint8_t retransmitNow : 1;   ///< NACK received, resend without waiting
+        uint8_t retransmitted : 1;   ///< Sent more than once, no RTT sample
+    };
+
+    /**
+     * @struct IncomingSlot
+     * @brief Receive-window entry for an out-of-order packet
+     */
+    struct IncomingSlot
+    {
+        uint8_t length;                ///< Payload length
+        bool messageEnd;               ///< Last fragment of a message
+        uint8_t data[MAX_DATA_LENGTH]; ///< Payload buffered until delivery
+    };
+
     // Error Message Strings (stored in flash)
     static const char PREFIX_O_STR[] PROGMEM; ///< "O:" - Outgoing channel
     static const char PREFIX_I_STR[] PROGMEM; ///< "I:" - Incoming channel
@@ -248,39 +614,30 @@ private:
     static const char RESET_NUM_STR[] PROGMEM;          ///< Sequence number reset
 
     // Protocol Timeouts (milliseconds)
-    static constexpr uint16_t OUTGOING_DATA_READ_TIMEOUT = 100;     ///< Max time to collect outgoing data
-    static constexpr uint16_t OUTGOING_DATA_ACK_NACK_TIMEOUT = 500; ///< Max time to wait for ACK/NACK
-    static constexpr uint16_t INCOMING_DATA_WAIT_TIMEOUT = 500;     ///< Max time to receive complete packet
+    static constexpr uint16_t OUTGOING_DATA_READ_TIMEOUT = 100;     ///< Max time to collect a partial packet
+    static constexpr uint16_t OUTGOING_DATA_ACK_NACK_TIMEOUT = 500; ///< Initial ACK/NACK timeout, before any RTT sample
+    static constexpr uint8_t MAX_RTO_BACKOFF = 6;                   ///< Max doublings of the timeout
+    static constexpr uint8_t DELAYED_ACK_COUNT = 2;                 ///< Packets covered by one delayed ACK
+    static constexpr uint16_t RTO_GRANULARITY = 10;                 ///< Least margin of the timeout over the smoothed RTT
+    static constexpr uint16_t INCOMING_DATA_WAIT_TIMEOUT = 500;     ///< Max stall while receiving a packet
     static constexpr uint16_t RESET_DETECTION_TIMEOUT = 10000;      ///< Connection timeout threshold
 
     // Packet Structure Constants
     static constexpr uint8_t HEADER_LENGTH = sizeof(PackageHeader); ///< Header size (4B)
     static constexpr uint8_t FOOTER_LENGTH = sizeof(PackageFooter); ///< Footer size (3B)
 
-    /**
-     * @brief CRC calculation scope
-     * @details CRC-16 is computed over:
-     * - Header fields after startByte
-     * - Complete payload
-     * Total: packetNumber + type + length + data (11 bytes)
-     */
-    static constexpr uint8_t CRC_SCOPE_LENGTH = HEADER_LENGTH - 1 + MAX_DATA_LENGTH;
+    /** @brief Offset of the CRC scope within a packet (after startByte) */
+    static constexpr uint8_t CRC_SCOPE_OFFSET = 1;
 
-    /**
-     * @enum OutgoingState
-     * @brief State machine for outgoing packets
-     *
-     * @details Controls the transmission sequence:
-     * 1. READ_DATA: Collect data until timeout or buffer full
-     * 2. SEND_PACKAGE: Transmit packet with CRC
-     * 3. WAIT_FOR_ACK_OR_NACK: Wait for response, retry if needed
-     */
-    enum OutgoingState : uint8_t
-    {
-        READ_DATA = 0,       ///< Collecting outgoing data
-        SEND_PACKAGE,        ///< Transmitting packet
-        WAIT_FOR_ACK_OR_NACK ///< Awaiting acknowledgment
-    };
+    /** @brief Slot index mask for the window rings */
+    static constexpr uint8_t WINDOW_MASK = PACKAGER_MAX_WINDOW_SIZE - 1;
+
+    static_assert(PACKAGER_MIN_RTO >= 1 && PACKAGER_MIN_RTO <= PACKAGER_MAX_RTO && PACKAGER_MAX_RTO <= 30000,
+                  "PACKAGER_MIN_RTO and PACKAGER_MAX_RTO must satisfy 1 <= min <= max <= 30000");
+
+    static_assert(PACKAGER_MAX_WINDOW_SIZE >= 1 && PACKAGER_MAX_WINDOW_SIZE <= 8 &&
+                      (PACKAGER_MAX_WINDOW_SIZE & (PACKAGER_MAX_WINDOW_SIZE - 1)) == 0,
+                  "PACKAGER_MAX_WINDOW_SIZE must be a power of two between 1 and 8");
 
     /**
      * @enum IncomingState
@@ -299,49 +656,179 @@ private:
     };
 
     /**
-     * @struct OutgoingFlags
-     * @brief Packed status flags for outgoing channel
+     * @struct IncomingFlags
+     * @brief Packed status flags for incoming channel
      *
      * @details Bit-field structure containing:
-     * - Retry counter (3 bits, 0-7)
      * - Current state (2 bits, 0-3)
+     * - Received data length (9 bits, 0-511)
+     * - Pending COBS zero (1 bit)
      *
      * Memory layout is guaranteed by packed attribute.
      */
-    struct __attribute__((packed)) OutgoingFlags
+    struct __attribute__((packed)) IncomingFlags
     {
-        uint8_t m_retryCount : 3;   ///< Current retry attempt (0-7)
-        uint8_t m_currentState : 2; ///< Current state (0-3)
+        uint16_t m_currentState : 2;       ///< Current state (0-3)
+        uint16_t m_incomingDataLength : 9; ///< Bytes received (0-511)
+        uint16_t m_cobsZeroPending : 1;    ///< COBS block ended, a zero follows unless the frame ends
     };
 
     /**
-     * @struct IncomingFlags
-     * @brief Packed status flags for incoming channel
+     * @brief Handles the outgoing sliding window
      *
-     * @details Bit-field structure containing:
-     * - Current state (2 bits, 0-3)
-     * - Received data length (5 bits, 0-31)
+     * @details Performs at most one action per call:
+     * - Applies queued ACK/NACK messages and slides the window
+     * - Retransmits a NACKed or timed-out packet
+     * - Sends the collecting packet once full or timed out
      *
-     * Memory layout is guaranteed by packed attribute.
+     * @return true if an action was taken
+     * @return false if there was nothing to do
      */
-    struct __attribute__((packed)) IncomingFlags
+    bool handleOutgoingState();
+
+    /**
+     * @brief Applies an ACK to the outgoing window
+     *
+     * @param cumulative Highest packet number received in order
+     * @param selectiveMask Bit i: packet cumulative + 2 + i received
+     */
+    void applyAck(const uint8_t cumulative, const uint8_t selectiveMask);
+
+    /**
+     * @brief Sends the receiver's cumulative and selective ACK
+     */
+    void sendAck();
+
+    /**
+     * @brief Acknowledges a received DATA packet according to the ACK mode
+     *
+     * @details Sends the ACK at once with IMMEDIATE_ACKS or when
+     * @p urgent; otherwise counts it as pending for a later DATA packet
+     * or flushPendingAck().
+     *
+     * @param urgent Packet was out of order, filled a gap or was a duplicate
+     */
+    void acknowledge(const bool urgent);
+
+    /**
+     * @brief Sends a pending ACK that waited long enough
+     *
+     * @details Called once the outgoing channel had its chance to carry
+     * the ACK. Sends it once DELAYED_ACK_COUNT packets are pending or
+     * the ACK delay expired.
+     */
+    void flushPendingAck();
+
+    /**
+     * @brief Fills in the ACK field of an outgoing DATA packet
+     *
+     * @details Writes the cumulative ACK and selective bitmap and clears
+     * the pending ACK; the CRC is computed afterwards. Does nothing with
+     * IMMEDIATE_ACKS.
+     *
+     * @param package DATA packet about to be sent
+     */
+    void attachAck(Package &package);
+
+    /**
+     * @brief Feeds a round-trip time sample to the RTO estimator
+     *
+     * @param sample Measured round-trip time in milliseconds
+     */
+    void updateRto(uint16_t sample);
+
+    /**
+     * @brief Delivers buffered packets that became in-order
+     */
+    void deliverBufferedPackets();
+
+    /**
+     * @brief Gets the outgoing slot at a window offset
+     *
+     * @param offset Distance from the oldest unacknowledged packet
+     * @return OutgoingSlot& The slot
+     */
+    OutgoingSlot &outgoingSlot(const uint8_t offset)
     {
-        uint8_t m_currentState : 2;       ///< Current state (0-3)
-        uint8_t m_incomingDataLength : 5; ///< Bytes received (0-31)
-    };
+        return m_outgoingSlots[(m_outgoingWindowHead + offset) & WINDOW_MASK];
+    }
 
     /**
-     * @brief Handles outgoing state machine
+     * @brief Gets a packet's footer
      *
-     * @details Processes one state machine iteration:
-     * - READ_DATA: Collect/batch data
-     * - SEND_PACKAGE: Transmit packet
-     * - WAIT_FOR_ACK_OR_NACK: Handle response
+     * @details The footer follows the configured payload length and the
+     * ACK field, if any, so it is usually short of the @c footer member.
      *
-     * @return true if state changed
-     * @return false if no state change
+     * @param package Packet
+     * @return PackageFooter& Footer within the packet
      */
-    bool handleOutgoingState();
+    PackageFooter &footerOf(Package &package) const
+    {
+        return *reinterpret_cast<PackageFooter *>(package.data + m_dataLength + ackFieldLength());
+    }
+
+    /** @copydoc footerOf(Package &) const */
+    const PackageFooter &footerOf(const Package &package) const
+    {
+        return *reinterpret_cast<const PackageFooter *>(package.data + m_dataLength + ackFieldLength());
+    }
+
+    /**
+     * @brief Gets the size of the ACK field of every packet
+     *
+     * @return uint8_t ACK_FIELD_LENGTH with PIGGYBACKED_ACKS, otherwise 0
+     */
+    uint8_t ackFieldLength() const { return (m_ackMode == PIGGYBACKED_ACKS) ? ACK_FIELD_LENGTH : 0; }
+
+    /**
+     * @brief Delivers a payload to the plain stream
+     *
+     * @details Writes the payload and records message boundaries for
+     * readMessage().
+     *
+     * @param data Payload bytes
+     * @param length Payload length
+     * @param messageEnd Whether the payload ends a message
+     * @return true if delivered
+     * @return false if the plain stream or message queue is full
+     */
+    bool deliverPayload(const uint8_t *data, const uint8_t length, const bool messageEnd);
+
+    /**
+     * @brief Checks whether a packet type carries data
+     *
+     * @param type Packet type
+     * @return true for DATA and DATA_END packets
+     */
+    static bool isDataType(const uint8_t type) { return type == DATA_TYPE || type == DATA_END_TYPE; }
+
+    /**
+     * @brief Gets the packet number following another
+     *
+     * @details Packet numbers cycle through 1-255; 0 is reserved for
+     * RESET and for "nothing received yet".
+     *
+     * @param packetNumber Current packet number
+     * @return uint8_t Next packet number
+     */
+    static uint8_t nextPacketNumber(const uint8_t packetNumber)
+    {
+        return (packetNumber >= 255) ? 1 : packetNumber + 1;
+    }
+
+    /**
+     * @brief Counts the steps between two packet numbers
+     *
+     * @param from Earlier packet number (0 counts as 255)
+     * @param to Later packet number
+     * @return uint8_t Number of nextPacketNumber() steps from @p from to @p to
+     */
+    static uint8_t packetDistance(const uint8_t from, const uint8_t to)
+    {
+        const uint8_t start = from ? from : 255;
+        const uint8_t distance = to - start;
+        return (to < start) ? distance - 1 : distance;
+    }
 
     /**
      * @brief Handles incoming state machine
@@ -356,6 +843,50 @@ private:
      */
     bool handleIncomingState();
 
+    /**
+     * @brief Handles incoming state machine with COBS framing
+     *
+     * @details Decodes the stream on the fly into the incoming packet
+     * buffer:
+     * - WAIT_FOR_START_BYTE: Skip a broken frame up to its delimiter
+     * - READ_INCOMING_DATA: Decode blocks until the delimiter
+     * - PROCESS_INCOMING_DATA: Handle packet
+     *
+     * @return true if state changed
+     * @return false if no state change
+     */
+    bool handleCobsIncomingState();
+
+    /**
+     * @brief Appends received bytes to the incoming packet
+     *
+     * @details Folds the bytes in CRC scope into the running CRC.
+     *
+     * @param data Received bytes
+     * @param count Number of bytes
+     * @return true if appended
+     * @return false if they do not fit in a packet
+     */
+    bool appendIncoming(const uint8_t *const data, const uint16_t count);
+
+    /**
+     * @brief Restarts reception at the next start byte of a rejected packet
+     *
+     * @details Start/stop framing only. Falls back to resetIncomingState()
+     * when the packet holds no further start byte.
+     *
+     * @param package Rejected packet
+     */
+    void resyncIncoming(const Package &package);
+
+    /**
+     * @brief Reports a COBS frame of the wrong length
+     *
+     * @details Logs the error and NACKs the frame if its header is that
+     * of a DATA packet.
+     */
+    void rejectIncomingFrame();
+
     /**
      * @brief Resets packet sequence numbers
      *
@@ -379,7 +910,7 @@ private:
      * @param length Number of bytes to process
      * @return uint16_t Calculated CRC-16 value
      */
-    static uint16_t crc16(const uint8_t *const data, const uint8_t length);
+    static uint16_t crc16(const uint8_t *const data, const uint16_t length);
 
     /**
      * @brief Validates received packet
@@ -391,9 +922,10 @@ private:
      * 4. CRC-16 integrity
      *
      * @param package Packet to validate
+     * @param calculatedCrc CRC-16 computed over the packet's CRC scope
      * @return NackReason Error code (NO_ERROR if valid)
      */
-    NackReason validatePackage(const Package &package) const;
+    NackReason validatePackage(const Package &package, const uint16_t calculatedCrc) const;
 
     /**
      * @brief Prepares packet for transmission
@@ -407,7 +939,7 @@ private:
      * @param package Packet structure to prepare
      * @param type Packet type (DATA/ACK/NACK/RESET)
      * @param packetNumber Sequence number
-     * @param dataLength Payload length (0-8 bytes)
+     * @param dataLength Payload length (up to the configured payload size)
      * @param data Payload buffer (nullptr if no data)
      */
     void preparePackage(Package &package, const uint8_t type, const uint8_t packetNumber,
@@ -421,14 +953,20 @@ private:
      */
     const __FlashStringHelper *toString(const NackReason reason) const;
 
+    /**
+     * @brief Counts a received packet that failed validation
+     *
+     * @param reason Validation failure
+     */
+    void countRejection(const NackReason reason);
+
     /**
      * @brief Resets outgoing channel state
      *
      * @details Performs complete outgoing reset:
-     * 1. Clears packet buffer
-     * 2. Resets state to READ_DATA
-     * 3. Clears retry counter
-     * 4. Resets timeout timer
+     * 1. Clears all window slots
+     * 2. Empties the window
+     * 3. Resets collect timer
      */
     void resetOutgoingState();
 
@@ -438,8 +976,11 @@ private:
      * @details Performs complete incoming reset:
      * 1. Clears packet buffer
      * 2. Resets byte counter
-     * 3. Resets state to WAIT_FOR_START_BYTE
+     * 3. Resets state to WAIT_FOR_START_BYTE (READ_INCOMING_DATA with
+     *    COBS framing, where every byte after a delimiter starts a frame)
      * 4. Resets timeout timer
+     *
+     * The receive window is kept; see resetPacketNumbering().
      */
     void resetIncomingState();
 
@@ -448,13 +989,35 @@ private:
      *
      * @details Sends complete packet:
      * 1. Serializes to byte array
-     * 2. Writes to encoded stream
+     * 2. Writes to encoded stream, COBS-encoded if selected
      * 3. No buffering/queueing
      *
      * @param package Prepared packet to send
      */
     void sendPackage(const Package &package);
 
+    /**
+     * @brief Assembles and transmits a control packet
+     *
+     * @details Prepares (and COBS-encodes) the packet in place in the
+     * encoded stream's ring storage when possible, otherwise in a stack
+     * copy.
+     *
+     * @param type Packet type (ACK/NACK/RESET)
+     * @param packetNumber Sequence number
+     * @param dataLength Payload length (up to the configured payload size)
+     * @param data Payload buffer (nullptr if no data)
+     */
+    void sendControlPackage(const uint8_t type, const uint8_t packetNumber,
+                            const uint8_t dataLength = 0, const uint8_t *const data = nullptr);
+
+    /**
+     * @brief Gets the number of delimiters to send ahead of a COBS frame
+     *
+     * @return uint8_t 1 if the link is idle, otherwise 0
+     */
+    uint8_t leadingDelimiterLength();
+
     /**
      * @brief Processes complete received packet
      *
@@ -462,27 +1025,108 @@ private:
      * - DATA: Validate, store, send ACK
      * - ACK/NACK: Queue for outgoing state machine
      * - RESET: Reset protocol state, send ACK
+     * - Invalid: NACK if DATA, then resynchronize (start/stop framing)
      *
+     * @param package Received packet (incoming buffer or in-place in the ring)
+     * @param calculatedCrc CRC-16 computed over the packet's CRC scope
      * @return true if processing successful
      * @return false if error occurred
      */
-    bool processPackage();
+    bool processPackage(const Package &package, const uint16_t calculatedCrc);
 
     // Member variables
     SimpleTimer<uint16_t> m_outgoingTimer;       /**< Timer for outgoing data handling */
     SimpleTimer<uint16_t> m_incomingTimer;       /**< Timer for incoming data handling */
     SimpleTimer<uint16_t> m_resetDetectionTimer; /**< Timer for detecting communication resets */
 
-    uint8_t m_outgoingPacketNumber;     /**< Current outgoing packet sequence number */
-    uint8_t m_lastIncomingPacketNumber; /**< Last received incoming packet sequence number */
+    uint8_t m_outgoingPacketNumber;     /**< Packet number of the collecting packet */
+    uint8_t m_lastIncomingPacketNumber; /**< Last packet number delivered in order */
+
+    uint8_t m_dataLength;      /**< Payload bytes per packet */
+    uint16_t m_packageLength;  /**< Packet size on the wire */
+    uint16_t m_crcScopeLength; /**< CRC scope: packetNumber + type + length + payload + ACK field */
+    uint16_t m_frameLength;    /**< Largest packet size on the wire, framing included */
+    Framing m_framing;         /**< Wire framing */
+    AckMode m_ackMode;         /**< Acknowledgment mode */
+
+    SimpleTimer<uint16_t> m_ackTimer; /**< Age of the oldest pending ACK */
+    uint8_t m_pendingAcks;            /**< DATA packets received and not yet acknowledged */
+
+    uint8_t m_windowSize;           /**< Packets allowed in flight */
+    uint8_t m_packetsInFlight;      /**< Packets sent and not yet acknowledged */
+    uint8_t m_outgoingWindowHead;   /**< Slot of the oldest unacknowledged packet */
+    uint8_t m_incomingWindowHead;   /**< Slot of the next expected packet */
+    uint8_t m_incomingReceivedMask; /**< Bit k: packet at offset k from expected is buffered */
+
+    uint16_t m_smoothedRtt8;     /**< Smoothed RTT, scaled by 8 */
+    uint16_t m_rttVariation4;    /**< RTT mean deviation, scaled by 4 */
+    uint16_t m_rto;              /**< Retransmission timeout before backoff */
+    uint8_t m_rtoBackoff;        /**< Timeout doublings since the last RTT sample */
+    bool m_hasRttSample;         /**< An RTT sample was taken */
+    LinkStatistics m_statistics; /**< Transmission counters */
+
+    OutgoingSlot m_outgoingSlots[PACKAGER_MAX_WINDOW_SIZE]; /**< Sent packets awaiting ACK */
+    IncomingSlot m_incomingSlots[PACKAGER_MAX_WINDOW_SIZE]; /**< Out-of-order received packets */
 
-    Package m_outgoingPackage; /**< Buffer for outgoing packet */
     Package m_incomingPackage; /**< Buffer for incoming packet */
 
-    OutgoingFlags m_outgoingFlags; /**< State flags for outgoing channel */
     IncomingFlags m_incomingFlags; /**< State flags for incoming channel */
+    uint16_t m_incomingCrc;        /**< CRC accumulated while the incoming packet arrives */
+    uint8_t m_cobsBlockRemaining;  /**< Data bytes left in the current COBS block */
 
     FastCircularQueue<PendingMessage, MAX_PENDING_MESSAGES> m_messageQueue; /**< Queue for ACK/NACK messages */
+
+    FastCircularQueue<uint16_t, PACKAGER_MAX_QUEUED_MESSAGES> m_outgoingMessageLengths; /**< Lengths of queued messages */
+    FastCircularQueue<uint16_t, PACKAGER_MAX_QUEUED_MESSAGES> m_incomingMessageLengths; /**< Lengths of received messages */
+    uint16_t m_outgoingMessageRemaining; /**< Bytes of the current message not yet collected */
+    uint16_t m_incomingMessageLength;    /**< Bytes of the message being reassembled */
+    uint16_t m_incomingDiscardLength;    /**< Bytes of interrupted messages not yet queued for skipping */
+};
+
+/**
+ * @class StaticCRCPackageInterface
+ * @brief A CRCPackageInterface whose encoded buffers are part of the object
+ *
+ * @details CRCPackageInterface allocates its two encoded buffers when it
+ * is constructed, which for a global instance happens before setup().
+ * Together with a StaticPipedStreamPair this one makes no heap
+ * allocation at all:
+ * @code
+ * StaticPipedStreamPair<64> streams;
+ * StaticCRCPackageInterface<64> packager(streams);
+ * @endcode
+ *
+ * @tparam ENCODED_BUFFER_SIZE Size of each encoded buffer (power of two,
+ * at least MIN_ENCODED_BUFFER_SIZE so that either framing fits)
+ */
+template <uint16_t ENCODED_BUFFER_SIZE>
+class StaticCRCPackageInterface : private StaticPipedStreamStorage<ENCODED_BUFFER_SIZE>, public CRCPackageInterface
+{
+    static_assert((ENCODED_BUFFER_SIZE & (ENCODED_BUFFER_SIZE - 1)) == 0,
+                  "StaticCRCPackageInterface size must be a power of two");
+    static_assert(ENCODED_BUFFER_SIZE >= CRCPackageInterface::MIN_ENCODED_BUFFER_SIZE,
+                  "StaticCRCPackageInterface size must hold one frame");
+
+public:
+    /**
+     * @brief Constructor that attaches the encoded side to the inline storage
+     *
+     * @param pipedStreamPair Bidirectional stream for raw/encoded data
+     * @param windowSize Packets in flight (1 to PACKAGER_MAX_WINDOW_SIZE, default: 1)
+     * @param dataLength Payload bytes per packet (1 to MAX_DATA_LENGTH, default: 8)
+     * @param framing Wire framing (default: START_STOP_FRAMING)
+     * @param ackMode Acknowledgment mode (default: IMMEDIATE_ACKS)
+     */
+    explicit StaticCRCPackageInterface(PipedStreamPair &pipedStreamPair, const uint8_t windowSize = 1,
+                                       const uint8_t dataLength = 8, const Framing framing = START_STOP_FRAMING,
+                                       const AckMode ackMode = IMMEDIATE_ACKS)
+        : CRCPackageInterface(pipedStreamPair, this->m_storage1, this->m_storage2, ENCODED_BUFFER_SIZE,
+                              windowSize, dataLength, framing, ackMode)
+    {
+    }
+
+    StaticCRCPackageInterface(const StaticCRCPackageInterface &) = delete;
+    StaticCRCPackageInterface &operator=(const StaticCRCPackageInterface &) = delete;
 };
 
 #endif
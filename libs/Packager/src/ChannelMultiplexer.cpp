@@ -0,0 +1,346 @@
+/**
+ * @file ChannelMultiplexer.cpp
+ * @brief Implementation of the channel multiplexer
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include "ChannelMultiplexer.h"
+
+/**
+ * @brief Constructor
+ *
+ * @param transport Interface carrying the segments
+ * @param segmentLength Largest payload per segment, 1-255
+ * @param maxBacklog Bytes allowed to wait in the interface's plain stream
+ */
+ChannelMultiplexer::ChannelMultiplexer(PackageInterface &transport, const uint8_t segmentLength,
+                                       const uint16_t maxBacklog)
+    : m_transport(transport),
+      m_segmentLength(max(segmentLength, (uint8_t)1)),
+      m_maxBacklog(maxBacklog),
+      m_lastChannel(0),
+      m_receiveState(READ_HEADER),
+      m_receiveHeader(0),
+      m_receiveRemaining(0),
+      m_receiveDiscard(false),
+      m_errors(0)
+{
+    memset(m_channels, 0, sizeof(m_channels));
+    m_transport.addResetListener(this);
+}
+
+/**
+ * @brief Destructor, stops listening to transport resets
+ */
+ChannelMultiplexer::~ChannelMultiplexer()
+{
+    m_transport.removeResetListener(this);
+}
+
+/**
+ * @brief Adds a channel
+ *
+ * @details The channel sends nothing until the peer grants it credit.
+ *
+ * @param channel Channel number, below PACKAGER_MAX_CHANNELS
+ * @param streams Streams between the application and the multiplexer
+ * @param priority Higher is served first
+ * @return true if added, false for an invalid or used channel number
+ */
+bool ChannelMultiplexer::addChannel(const uint8_t channel, PipedStreamPair &streams, const uint8_t priority)
+{
+    if (channel >= PACKAGER_MAX_CHANNELS || m_channels[channel].streams != nullptr)
+    {
+        return false;
+    }
+
+    Channel &state = m_channels[channel];
+    memset(&state, 0, sizeof(state));
+    state.streams = &streams;
+    state.priority = priority;
+    return true;
+}
+
+/**
+ * @brief Grants credit, sends segments, runs the transport and receives
+ *
+ * @details Credit goes out first, so a peer waiting for it is never held
+ * back by this end's own data.
+ */
+void ChannelMultiplexer::loop()
+{
+    PipedStream &link = m_transport.getPlainStream();
+
+    grantCredit(link);
+    sendSegments(link);
+    m_transport.loop();
+    receive(link);
+}
+
+/**
+ * @brief Gets the counters of a channel
+ *
+ * @param channel Channel number
+ * @return const ChannelStatistics& Counters, all zero for an unused channel
+ */
+const ChannelMultiplexer::ChannelStatistics &ChannelMultiplexer::getStatistics(const uint8_t channel) const
+{
+    static const ChannelStatistics none = {};
+    return (channel < PACKAGER_MAX_CHANNELS) ? m_channels[channel].statistics : none;
+}
+
+/**
+ * @brief Clears the counters of every channel
+ */
+void ChannelMultiplexer::resetStatistics()
+{
+    for (uint8_t i = 0; i < PACKAGER_MAX_CHANNELS; i++)
+    {
+        memset(&m_channels[i].statistics, 0, sizeof(m_channels[i].statistics));
+    }
+}
+
+/**
+ * @brief Drops all credit along with the transport connection
+ *
+ * @details Segments not yet sent or parsed belong to the old connection
+ * and are dropped. Data still in the channel streams is kept and sent
+ * once the peer grants credit again.
+ */
+void ChannelMultiplexer::onReset()
+{
+    m_transport.getPlainStream().clear();
+    m_receiveState = READ_HEADER;
+    m_receiveRemaining = 0;
+    m_receiveDiscard = false;
+
+    for (uint8_t i = 0; i < PACKAGER_MAX_CHANNELS; i++)
+    {
+        m_channels[i].sendCredit = 0;
+        m_channels[i].grantedCredit = 0;
+        m_channels[i].stalled = false;
+    }
+}
+
+/**
+ * @brief Tells the peer about freed receive space
+ *
+ * @details Credit is granted in steps of at least one segment, so the
+ * 2-byte credit segments stay rare. A channel without any credit
+ * outstanding gets whatever space there is, however small.
+ *
+ * @param link Plain stream of the transport
+ */
+void ChannelMultiplexer::grantCredit(PipedStream &link)
+{
+    for (uint8_t i = 0; i < PACKAGER_MAX_CHANNELS; i++)
+    {
+        Channel &channel = m_channels[i];
+        if (channel.streams == nullptr)
+        {
+            continue;
+        }
+
+        const int space = channel.streams->second.availableForWrite() - channel.grantedCredit;
+        if (space <= 0 || (space < m_segmentLength && channel.grantedCredit > 0))
+        {
+            continue;
+        }
+        if (link.availableForWrite() < SEGMENT_HEADER_LENGTH)
+        {
+            return;
+        }
+
+        const uint8_t credit = min(space, 255);
+        link.write((uint8_t)(CREDIT_SEGMENT | i));
+        link.write(credit);
+        channel.grantedCredit += credit;
+    }
+}
+
+/**
+ * @brief Sends segments of the most urgent channels
+ *
+ * @details Stops once the transport holds m_maxBacklog bytes: bytes
+ * queued there are sent in order, so anything more would only delay the
+ * segments of a channel that becomes urgent later.
+ *
+ * @param link Plain stream of the transport
+ */
+void ChannelMultiplexer::sendSegments(PipedStream &link)
+{
+    while (link.backDoor().available() < (int)m_maxBacklog)
+    {
+        Channel *const channel = nextChannel();
+        if (channel == nullptr)
+        {
+            return;
+        }
+
+        PipedStream &source = channel->streams->second;
+        int length = min(source.available(), (int)channel->sendCredit);
+        length = min(length, (int)m_segmentLength);
+        length = min(length, link.availableForWrite() - SEGMENT_HEADER_LENGTH);
+        if (length <= 0)
+        {
+            return;
+        }
+
+        link.write((uint8_t)(DATA_SEGMENT | (channel - m_channels)));
+        link.write((uint8_t)length);
+        channel->sendCredit -= length;
+        channel->statistics.bytesSent += length;
+        channel->statistics.segmentsSent++;
+
+        // The payload may wrap around the end of the channel buffer
+        while (length > 0)
+        {
+            const uint8_t *data;
+            uint16_t contiguous;
+            source.peekContiguous(data, contiguous);
+            const uint16_t count = min((int)contiguous, length);
+            link.write(data, count);
+            source.consume(count);
+            length -= count;
+        }
+    }
+}
+
+/**
+ * @brief Picks the channel to send next
+ *
+ * @details The highest priority among the channels with data and credit
+ * wins. Ties go to the first one after the channel served last.
+ *
+ * @return Channel*, nullptr if no channel can send
+ */
+ChannelMultiplexer::Channel *ChannelMultiplexer::nextChannel()
+{
+    Channel *best = nullptr;
+    uint8_t index = m_lastChannel;
+
+    for (uint8_t i = 0; i < PACKAGER_MAX_CHANNELS; i++)
+    {
+        index = (index + 1 < PACKAGER_MAX_CHANNELS) ? index + 1 : 0;
+        Channel &channel = m_channels[index];
+        if (channel.streams == nullptr || channel.streams->second.available() <= 0)
+        {
+            continue;
+        }
+
+        if (channel.sendCredit == 0)
+        {
+            if (!channel.stalled)
+            {
+                channel.stalled = true;
+                channel.statistics.creditStalls++;
+            }
+            continue;
+        }
+
+        channel.stalled = false;
+        if (best == nullptr || channel.priority > best->priority)
+        {
+            best = &channel;
+        }
+    }
+
+    if (best != nullptr)
+    {
+        m_lastChannel = best - m_channels;
+    }
+    return best;
+}
+
+/**
+ * @brief Parses received segments
+ *
+ * @details Credit guarantees room in the channel stream, so the payload
+ * is never held up by a slow application. A segment for an unknown
+ * channel or beyond the credit is dropped and counted.
+ *
+ * @param link Plain stream of the transport
+ */
+void ChannelMultiplexer::receive(PipedStream &link)
+{
+    while (link.available() > 0)
+    {
+        switch (m_receiveState)
+        {
+        case READ_HEADER:
+            m_receiveHeader = link.read();
+            m_receiveState = READ_LENGTH;
+            break;
+
+        case READ_LENGTH:
+        {
+            const uint8_t length = link.read();
+            const uint8_t index = m_receiveHeader & CHANNEL_MASK;
+            Channel *const channel =
+                (index < PACKAGER_MAX_CHANNELS && m_channels[index].streams != nullptr) ? &m_channels[index] : nullptr;
+            m_receiveState = READ_HEADER;
+
+            if ((m_receiveHeader & TYPE_MASK) == CREDIT_SEGMENT && channel != nullptr)
+            {
+                channel->sendCredit += length;
+            }
+            else if ((m_receiveHeader & TYPE_MASK) == DATA_SEGMENT && length > 0)
+            {
+                m_receiveDiscard = (channel == nullptr || length > channel->grantedCredit);
+                if (m_receiveDiscard)
+                {
+                    m_errors++;
+                }
+                else
+                {
+                    channel->grantedCredit -= length;
+                    channel->statistics.bytesReceived += length;
+                    channel->statistics.segmentsReceived++;
+                }
+                m_receiveRemaining = length;
+                m_receiveState = READ_PAYLOAD;
+            }
+            else
+            {
+                m_errors++;
+            }
+            break;
+        }
+
+        case READ_PAYLOAD:
+        {
+            int count = min(link.available(), (int)m_receiveRemaining);
+            m_receiveRemaining -= count;
+
+            if (m_receiveDiscard)
+            {
+                while (count-- > 0)
+                {
+                    link.read();
+                }
+            }
+            else
+            {
+                PipedStream &sink = m_channels[m_receiveHeader & CHANNEL_MASK].streams->second;
+                while (count > 0)
+                {
+                    const uint8_t *data;
+                    uint16_t contiguous;
+                    link.peekContiguous(data, contiguous);
+                    const uint16_t chunk = min((int)contiguous, count);
+                    sink.write(data, chunk);
+                    link.consume(chunk);
+                    count -= chunk;
+                }
+            }
+
+            if (m_receiveRemaining == 0)
+            {
+                m_receiveState = READ_HEADER;
+            }
+            break;
+        }
+        }
+    }
+}
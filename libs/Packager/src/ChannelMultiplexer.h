@@ -0,0 +1,230 @@
+/**
+ * @file ChannelMultiplexer.h
+ * @brief Logical channels over one package interface
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ *
+ * @details A ChannelMultiplexer carries several independent byte streams
+ * over the plain stream of one package interface, such as console,
+ * telemetry and firmware update traffic over the same UART. Each channel
+ * has its own PipedStreamPair endpoint, a priority and a flow-control
+ * credit:
+ * @code
+ * StaticPipedStreamPair<256> packagerStreams;
+ * // 32-byte payloads need -DPACKAGER_MAX_DATA_LENGTH=32; the default is 8
+ * CRCPackageInterface packager(packagerStreams, 256, 4, 32);
+ * ChannelMultiplexer mux(packager);
+ *
+ * StaticPipedStreamPair<64> console;
+ * StaticPipedStreamPair<128> firmware;
+ * mux.addChannel(0, console, 1);  // served first
+ * mux.addChannel(1, firmware, 0); // bulk
+ *
+ * console.first.print(F("ready"));
+ * mux.loop(); // runs packager.loop() too
+ * @endcode
+ *
+ * Data travels in segments of a 2-byte header and up to the segment length
+ * of payload. The header holds the segment type, the channel and the
+ * payload length.
+ */
+#ifndef CHANNEL_MULTIPLEXER_H
+#define CHANNEL_MULTIPLEXER_H
+
+#include "PackageInterface.h"
+
+/**
+ * @brief Number of channels a multiplexer can carry
+ * @details At most 16. Each channel takes 28 bytes of RAM on AVR, plus
+ * its streams.
+ */
+#ifndef PACKAGER_MAX_CHANNELS
+#define PACKAGER_MAX_CHANNELS 4
+#endif
+
+static_assert(PACKAGER_MAX_CHANNELS >= 1 && PACKAGER_MAX_CHANNELS <= 16,
+              "PACKAGER_MAX_CHANNELS must be from 1 to 16");
+
+/**
+ * @class ChannelMultiplexer
+ * @brief Prioritized, flow-controlled channels over a package interface
+ *
+ * @details Sending:
+ * - The waiting channel with the highest priority sends the next segment.
+ *   Channels of equal priority take turns.
+ * - Segments enter the interface's plain stream only while it holds less
+ *   than the backlog limit. An urgent segment therefore waits behind at
+ *   most that many bytes of bulk data, plus the packets in flight.
+ *
+ * Flow control:
+ * - A channel sends only as many bytes as the peer granted in credit.
+ * - Credit is the free space of the peer's receiving stream. A channel
+ *   whose application stops reading stalls alone; the others keep going.
+ *
+ * Both ends must add the same channels. The multiplexer is a reset
+ * listener of the interface: after a connection reset both ends drop
+ * their credit and grant it anew.
+ */
+class ChannelMultiplexer : private PackageInterface::ResetListener
+{
+public:
+    /**
+     * @struct ChannelStatistics
+     * @brief Per-channel counters
+     *
+     * @details Counts since the channel was added or the last
+     * resetStatistics(). Divide by the elapsed time for throughput.
+     */
+    struct ChannelStatistics
+    {
+        uint32_t bytesSent;        ///< Payload bytes sent
+        uint32_t bytesReceived;    ///< Payload bytes received
+        uint32_t segmentsSent;     ///< Segments sent
+        uint32_t segmentsReceived; ///< Segments received
+        uint32_t creditStalls;     ///< Times sending stopped for lack of credit
+    };
+
+    static constexpr uint8_t SEGMENT_HEADER_LENGTH = 2; ///< Type and channel, then payload length
+
+    /**
+     * @brief Constructor
+     *
+     * @param transport Interface carrying the segments
+     * @param segmentLength Largest payload per segment, 1-255
+     * @param maxBacklog Bytes allowed to wait in the interface's plain
+     *        stream. At least one packet payload, so packets go out full.
+     */
+    explicit ChannelMultiplexer(PackageInterface &transport, const uint8_t segmentLength = 32,
+                                const uint16_t maxBacklog = 64);
+
+    /**
+     * @brief Destructor, stops listening to transport resets
+     */
+    ~ChannelMultiplexer();
+
+    ChannelMultiplexer(const ChannelMultiplexer &) = delete;
+    ChannelMultiplexer &operator=(const ChannelMultiplexer &) = delete;
+
+    /**
+     * @brief Adds a channel
+     *
+     * @details The application writes to and reads from streams.first.
+     *
+     * @param channel Channel number, below PACKAGER_MAX_CHANNELS
+     * @param streams Streams between the application and the multiplexer
+     * @param priority Higher is served first
+     * @return true if added, false for an invalid or used channel number
+     */
+    bool addChannel(const uint8_t channel, PipedStreamPair &streams, const uint8_t priority = 0);
+
+    /**
+     * @brief Grants credit, sends segments, runs the transport and receives
+     */
+    void loop();
+
+    /**
+     * @brief Gets the counters of a channel
+     *
+     * @param channel Channel number
+     * @return const ChannelStatistics& Counters, all zero for an unused channel
+     */
+    const ChannelStatistics &getStatistics(const uint8_t channel) const;
+
+    /**
+     * @brief Clears the counters of every channel
+     */
+    void resetStatistics();
+
+    /**
+     * @brief Gets the number of malformed segments received
+     *
+     * @return uint32_t Segments for unknown channels or beyond the credit
+     */
+    uint32_t getErrors() const { return m_errors; }
+
+private:
+    /**
+     * @enum SegmentType
+     * @brief Upper nibble of the segment header
+     */
+    enum SegmentType : uint8_t
+    {
+        DATA_SEGMENT = 0x00,  ///< Payload for a channel
+        CREDIT_SEGMENT = 0x10 ///< The length field grants that many bytes of credit
+    };
+
+    /**
+     * @enum ReceiveState
+     * @brief Segment parsing progress
+     */
+    enum ReceiveState : uint8_t
+    {
+        READ_HEADER,  ///< Expecting a segment header
+        READ_LENGTH,  ///< Expecting the length field
+        READ_PAYLOAD  ///< Copying payload to the channel
+    };
+
+    /**
+     * @struct Channel
+     * @brief State of one channel
+     */
+    struct Channel
+    {
+        PipedStreamPair *streams;     ///< Application streams, nullptr if unused
+        uint8_t priority;             ///< Higher is served first
+        bool stalled;                 ///< Data is waiting for credit
+        uint16_t sendCredit;          ///< Bytes the peer can still take
+        uint16_t grantedCredit;       ///< Bytes the peer may send that have not arrived
+        ChannelStatistics statistics; ///< Counters
+    };
+
+    static constexpr uint8_t CHANNEL_MASK = 0x0F; ///< Channel bits of the segment header
+    static constexpr uint8_t TYPE_MASK = 0xF0;    ///< Type bits of the segment header
+
+    /**
+     * @brief Drops all credit along with the transport connection
+     */
+    virtual void onReset() override;
+
+    /**
+     * @brief Tells the peer about freed receive space
+     *
+     * @param link Plain stream of the transport
+     */
+    void grantCredit(PipedStream &link);
+
+    /**
+     * @brief Sends segments of the most urgent channels
+     *
+     * @param link Plain stream of the transport
+     */
+    void sendSegments(PipedStream &link);
+
+    /**
+     * @brief Picks the channel to send next
+     *
+     * @return Channel*, nullptr if no channel can send
+     */
+    Channel *nextChannel();
+
+    /**
+     * @brief Parses received segments
+     *
+     * @param link Plain stream of the transport
+     */
+    void receive(PipedStream &link);
+
+    PackageInterface &m_transport;              /**< Interface carrying the segments */
+    Channel m_channels[PACKAGER_MAX_CHANNELS];  /**< Channel states */
+    uint8_t m_segmentLength;                    /**< Largest payload per segment */
+    uint16_t m_maxBacklog;                      /**< Bytes allowed in the transport's plain stream */
+    uint8_t m_lastChannel;                      /**< Channel served last, for turns */
+
+    ReceiveState m_receiveState; /**< Segment parsing progress */
+    uint8_t m_receiveHeader;     /**< Header of the segment being received */
+    uint8_t m_receiveRemaining;  /**< Payload bytes of the segment still to come */
+    bool m_receiveDiscard;       /**< The payload being received is dropped */
+    uint32_t m_errors;           /**< Malformed segments */
+};
+
+#endif // CHANNEL_MULTIPLEXER_H
@@ -0,0 +1,58 @@
+/**
+ * @file CompressionStage.cpp
+ * @brief Implementation of the payload compression stage
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include "CompressionStage.h"
+
+/**
+ * @brief Constructor
+ *
+ * @param pipedStreamPair Streams between the application and the stage
+ * @param transport Interface carrying the compressed bytes
+ */
+CompressionStage::CompressionStage(PipedStreamPair &pipedStreamPair, PackageInterface &transport)
+    : p_pipedStreamPair(&pipedStreamPair),
+      m_transport(transport)
+{
+    m_transport.addResetListener(this);
+}
+
+/**
+ * @brief Destructor, stops listening to transport resets
+ */
+CompressionStage::~CompressionStage()
+{
+    m_transport.removeResetListener(this);
+}
+
+/**
+ * @brief Compresses, runs the transport and decompresses
+ *
+ * @details Compressing right before the transport loop lets the
+ * compressed bytes of a record join the packet being collected.
+ */
+void CompressionStage::loop()
+{
+    PipedStream &plain = p_pipedStreamPair->second;
+    PipedStream &compressed = m_transport.getPlainStream();
+
+    m_compressor.compress(plain, compressed);
+    m_transport.loop();
+    m_decompressor.decompress(compressed, plain);
+}
+
+/**
+ * @brief Restarts both directions
+ *
+ * @details Plain bytes still waiting in the application stream are kept
+ * and start the new stream.
+ */
+void CompressionStage::reset()
+{
+    m_transport.getPlainStream().clear();
+    m_compressor.reset();
+    m_decompressor.reset();
+}
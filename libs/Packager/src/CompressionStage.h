@@ -0,0 +1,118 @@
+/**
+ * @file CompressionStage.h
+ * @brief Payload compression in front of a package interface
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ *
+ * @details A CompressionStage sits between the application and the plain
+ * stream of a package interface. Bytes written to its plain stream are
+ * compressed into the interface's plain stream, and the interface's
+ * received bytes are decompressed into it. The stage offers the same
+ * getPlainStream(), getEncodedStream() and loop() as a PackageInterface,
+ * so it replaces the interface in the application code:
+ * @code
+ * StaticPipedStreamPair<64> appStreams;
+ * StaticPipedStreamPair<256> packagerStreams;
+ * // 32-byte payloads need -DPACKAGER_MAX_DATA_LENGTH=32; the default is 8
+ * CRCPackageInterface packager(packagerStreams, 256, 4, 32);
+ * CompressionStage stage(appStreams, packager);
+ *
+ * stage.getPlainStream().write(frame, sizeof(frame));
+ * stage.loop(); // runs packager.loop() too
+ * // stage.getEncodedStream() is packager.getEncodedStream()
+ * @endcode
+ *
+ * Both ends need a stage with the same PACKAGER_LZ_WINDOW_SIZE. On AVR a
+ * stage takes 2 * PACKAGER_LZ_WINDOW_SIZE + 105 bytes, 361 bytes with the
+ * default window, plus the application streams.
+ */
+#ifndef COMPRESSION_STAGE_H
+#define COMPRESSION_STAGE_H
+
+#include "LZCompression.h"
+#include "PackageInterface.h"
+
+/**
+ * @class CompressionStage
+ * @brief Streaming compression layered on a package interface
+ *
+ * @details The codec history spans packets, so it stays consistent only
+ * as long as the transport delivers every byte in order. The stage is a
+ * reset listener of the transport: when the connection resets, both
+ * directions restart. Compressed bytes not yet sent or decoded are
+ * dropped and the histories are cleared. The peer restarts at the same
+ * point, as its interface resets too.
+ */
+class CompressionStage : private PackageInterface::ResetListener
+{
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param pipedStreamPair Streams between the application and the stage
+     * @param transport Interface carrying the compressed bytes
+     */
+    CompressionStage(PipedStreamPair &pipedStreamPair, PackageInterface &transport);
+
+    /**
+     * @brief Destructor, stops listening to transport resets
+     */
+    ~CompressionStage();
+
+    CompressionStage(const CompressionStage &) = delete;
+    CompressionStage &operator=(const CompressionStage &) = delete;
+
+    /**
+     * @brief Compresses, runs the transport and decompresses
+     */
+    void loop();
+
+    /**
+     * @brief Restarts both directions
+     *
+     * @details Called on every transport reset. Call it by hand only when
+     * the peer does the same at the same point of the stream.
+     */
+    void reset();
+
+    /**
+     * @brief Gets the uncompressed data stream
+     *
+     * @return PipedStream& Stream the application reads and writes
+     */
+    PipedStream &getPlainStream() { return p_pipedStreamPair->first; }
+
+    /**
+     * @brief Gets the encoded stream of the transport
+     *
+     * @return PipedStream& Stream to connect to the serial line
+     */
+    PipedStream &getEncodedStream() { return m_transport.getEncodedStream(); }
+
+    /**
+     * @brief Gets the outgoing codec
+     *
+     * @return const LZCompressor& Compressor, for its byte counters
+     */
+    const LZCompressor &getCompressor() const { return m_compressor; }
+
+    /**
+     * @brief Gets the incoming codec
+     *
+     * @return const LZDecompressor& Decompressor, for its byte and error counters
+     */
+    const LZDecompressor &getDecompressor() const { return m_decompressor; }
+
+private:
+    /**
+     * @brief Restarts both directions along with the transport
+     */
+    virtual void onReset() override { reset(); }
+
+    PipedStreamPair *p_pipedStreamPair; /**< Streams to the application */
+    PackageInterface &m_transport;      /**< Interface carrying the compressed bytes */
+    LZCompressor m_compressor;          /**< Outgoing codec */
+    LZDecompressor m_decompressor;      /**< Incoming codec */
+};
+
+#endif // COMPRESSION_STAGE_H
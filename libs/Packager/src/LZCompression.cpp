@@ -0,0 +1,339 @@
+/**
+ * @file LZCompression.cpp
+ * @brief Implementation of the streaming LZ77 codec
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include "LZCompression.h"
+
+/**
+ * @brief Constructor
+ */
+LZCompressor::LZCompressor()
+    : m_bytesIn(0),
+      m_bytesOut(0)
+{
+    reset();
+}
+
+/**
+ * @brief Forgets the history
+ *
+ * @details Bytes already taken from the input but not yet encoded are
+ * dropped with it.
+ */
+void LZCompressor::reset()
+{
+    memset(m_hashTable, 0, sizeof(m_hashTable));
+    m_position = 0;
+    m_end = 0;
+    m_literalStart = 0;
+    m_history = 0;
+}
+
+/**
+ * @brief Compresses what the input holds
+ *
+ * @details Greedy parsing: at each position the last occurrence of the
+ * next 3 bytes is looked up in the hash table and extended as far as
+ * the lookahead allows. Positions inside a match are indexed too, so a
+ * long repeated record is found again from any of its bytes. Literals
+ * accumulate in the window and are written as one run before the next
+ * match, when the run is full, or when the input runs dry.
+ *
+ * @param input Plain bytes
+ * @param output Compressed bytes
+ */
+void LZCompressor::compress(PipedStream &input, PipedStream &output)
+{
+    const uint16_t mask = WINDOW_SIZE - 1;
+    const uint8_t maxMatch = MAX_MATCH;
+    const uint8_t maxDistance = MAX_DISTANCE;
+    const uint8_t maxLiteralRun = MAX_LITERAL_RUN;
+
+    while (true)
+    {
+        // A full run must leave before the lookahead overwrites its bytes
+        if ((uint16_t)(m_position - m_literalStart) >= maxLiteralRun && !flushLiterals(output))
+        {
+            return;
+        }
+
+        while ((uint16_t)(m_end - m_position) < maxMatch && input.available() > 0)
+        {
+            m_window[m_end & mask] = input.read();
+            m_end++;
+            m_bytesIn++;
+        }
+
+        // A short lookahead means the input ran dry; encode it rather than wait
+        const uint8_t lookahead = m_end - m_position;
+        if (lookahead == 0)
+        {
+            flushLiterals(output);
+            return;
+        }
+
+        uint8_t slot = 0;
+        uint8_t distance = 0;
+        uint8_t length = 0;
+        if (lookahead >= MIN_MATCH)
+        {
+            slot = hash(m_position);
+            distance = (uint8_t)m_position - m_hashTable[slot];
+            if (distance > 0 && distance <= m_history)
+            {
+                const uint16_t candidate = m_position - distance;
+                while (length < lookahead &&
+                       m_window[(candidate + length) & mask] == m_window[(m_position + length) & mask])
+                {
+                    length++;
+                }
+            }
+        }
+
+        uint8_t advance = 1;
+        if (length >= MIN_MATCH)
+        {
+            if (!flushLiterals(output) || output.availableForWrite() < 2)
+            {
+                return;
+            }
+            output.write(MATCH_TOKEN + length - MIN_MATCH);
+            output.write(distance - 1);
+            m_bytesOut += 2;
+
+            for (uint8_t i = 0; i < length; i++)
+            {
+                if ((uint16_t)(m_end - m_position) >= MIN_MATCH)
+                {
+                    m_hashTable[hash(m_position)] = m_position;
+                }
+                m_position++;
+            }
+            m_literalStart = m_position;
+            advance = length;
+        }
+        else
+        {
+            if (lookahead >= MIN_MATCH)
+            {
+                m_hashTable[slot] = m_position;
+            }
+            m_position++;
+        }
+
+        const uint16_t history = m_history + advance;
+        m_history = (history < maxDistance) ? history : maxDistance;
+    }
+}
+
+/**
+ * @brief Hashes the 3 bytes at a window position
+ *
+ * @param position Stream position
+ * @return uint8_t Hash table index
+ */
+uint8_t LZCompressor::hash(const uint16_t position) const
+{
+    const uint16_t mask = WINDOW_SIZE - 1;
+    const uint16_t key = ((uint16_t)m_window[position & mask] << 8 | m_window[(position + 1) & mask]) ^
+                         ((uint16_t)m_window[(position + 2) & mask] << 4);
+    return (uint16_t)(key * 40503U) >> (16 - HASH_BITS);
+}
+
+/**
+ * @brief Writes the pending literals
+ *
+ * @details A run that does not fit the output is split, so literals
+ * trickle out even through a small buffer.
+ *
+ * @param output Compressed bytes
+ * @return true if none are left
+ */
+bool LZCompressor::flushLiterals(PipedStream &output)
+{
+    const uint16_t mask = WINDOW_SIZE - 1;
+
+    while (m_literalStart != m_position)
+    {
+        const int space = output.availableForWrite() - 1;
+        if (space <= 0)
+        {
+            return false;
+        }
+
+        const uint8_t pending = m_position - m_literalStart;
+        const uint8_t count = (space < pending) ? space : pending;
+        output.write(count - 1);
+
+        // The run may wrap around the end of the window
+        const uint16_t index = m_literalStart & mask;
+        const uint8_t first = (WINDOW_SIZE - index < count) ? WINDOW_SIZE - index : count;
+        output.write(m_window + index, first);
+        output.write(m_window, count - first);
+
+        m_literalStart += count;
+        m_bytesOut += count + 1;
+    }
+    return true;
+}
+
+/**
+ * @brief Constructor
+ */
+LZDecompressor::LZDecompressor()
+    : m_bytesIn(0),
+      m_bytesOut(0),
+      m_errors(0)
+{
+    reset();
+}
+
+/**
+ * @brief Forgets the history
+ *
+ * @details A token being decoded is dropped.
+ */
+void LZDecompressor::reset()
+{
+    m_position = 0;
+    m_history = 0;
+    m_state = READ_TOKEN;
+    m_remaining = 0;
+    m_distance = 0;
+}
+
+/**
+ * @brief Decompresses what the input holds
+ *
+ * @details Copies in batches bounded by both streams, so a blocked
+ * output costs one check per call rather than per byte.
+ *
+ * @param input Compressed bytes
+ * @param output Plain bytes
+ */
+void LZDecompressor::decompress(PipedStream &input, PipedStream &output)
+{
+    const uint16_t mask = WINDOW_SIZE - 1;
+
+    while (true)
+    {
+        switch (m_state)
+        {
+        case READ_TOKEN:
+        {
+            if (input.available() <= 0)
+            {
+                return;
+            }
+            const uint8_t token = input.read();
+            m_bytesIn++;
+
+            if (token < LZCompressor::MATCH_TOKEN)
+            {
+                m_remaining = token + 1;
+                m_state = COPY_LITERALS;
+            }
+            else if (token - LZCompressor::MATCH_TOKEN <= LZCompressor::MAX_MATCH - LZCompressor::MIN_MATCH)
+            {
+                m_remaining = token - LZCompressor::MATCH_TOKEN + LZCompressor::MIN_MATCH;
+                m_state = READ_DISTANCE;
+            }
+            else
+            {
+                m_errors++;
+            }
+            break;
+        }
+
+        case COPY_LITERALS:
+        {
+            int count = min(input.available(), output.availableForWrite());
+            if (count <= 0)
+            {
+                return;
+            }
+            if (count > m_remaining)
+            {
+                count = m_remaining;
+            }
+
+            m_bytesIn += count;
+            m_remaining -= count;
+            while (count-- > 0)
+            {
+                put(input.read(), output);
+            }
+            if (m_remaining == 0)
+            {
+                m_state = READ_TOKEN;
+            }
+            break;
+        }
+
+        case READ_DISTANCE:
+            if (input.available() <= 0)
+            {
+                return;
+            }
+            m_distance = input.read() + 1;
+            m_bytesIn++;
+
+            // Only a corrupted or desynchronized stream refers beyond the history
+            if (m_distance > m_history)
+            {
+                m_errors++;
+                m_state = READ_TOKEN;
+            }
+            else
+            {
+                m_state = COPY_MATCH;
+            }
+            break;
+
+        case COPY_MATCH:
+        {
+            int count = output.availableForWrite();
+            if (count <= 0)
+            {
+                return;
+            }
+            if (count > m_remaining)
+            {
+                count = m_remaining;
+            }
+
+            m_remaining -= count;
+            while (count-- > 0)
+            {
+                put(m_window[(m_position - m_distance) & mask], output);
+            }
+            if (m_remaining == 0)
+            {
+                m_state = READ_TOKEN;
+            }
+            break;
+        }
+        }
+    }
+}
+
+/**
+ * @brief Emits a plain byte
+ *
+ * @param value Byte
+ * @param output Plain bytes
+ */
+void LZDecompressor::put(const uint8_t value, PipedStream &output)
+{
+    m_window[m_position & (WINDOW_SIZE - 1)] = value;
+    m_position++;
+    if (m_history < WINDOW_SIZE)
+    {
+        m_history++;
+    }
+    output.write(value);
+    m_bytesOut++;
+}
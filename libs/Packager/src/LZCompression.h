@@ -0,0 +1,217 @@
+/**
+ * @file LZCompression.h
+ * @brief Streaming small-window LZ77 codec for Packager payloads
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ *
+ * @details The codec replaces repeated byte strings with references to
+ * the last few dozen bytes of the stream. It works incrementally on
+ * piped streams: the history carries over from one call to the next, so
+ * a record that repeats the previous one compresses even when the two
+ * end up in different packets.
+ *
+ * The compressed stream is a sequence of byte-aligned tokens:
+ * - 0x00-0x7F: a run of token + 1 literal bytes follows
+ * - 0x80 and up: a match of token - 0x80 + MIN_MATCH bytes, followed by
+ *   one byte holding its distance - 1
+ *
+ * The compressor never waits for more input than it has: whenever the
+ * input runs dry it encodes what it holds. Compression costs one hash
+ * lookup per byte, and decompression a ring buffer copy.
+ */
+#ifndef LZ_COMPRESSION_H
+#define LZ_COMPRESSION_H
+
+#include <Arduino.h>
+#include <PipedStream.h>
+
+/**
+ * @brief History kept by the compressor and the decompressor
+ * @details Power of two from 32 to 256. Matches reach back
+ * 3/4 of it. Both ends must use the same value.
+ */
+#ifndef PACKAGER_LZ_WINDOW_SIZE
+#define PACKAGER_LZ_WINDOW_SIZE 128
+#endif
+
+/**
+ * @class LZCompressor
+ * @brief Incremental compressor
+ *
+ * @details Uses WINDOW_SIZE + HASH_SIZE bytes of RAM plus a few
+ * counters. The window holds the bytes matches may refer to and the
+ * lookahead being encoded. The hash table remembers the last position
+ * of each 3-byte prefix; only that one candidate is checked.
+ */
+class LZCompressor
+{
+public:
+    static constexpr uint16_t WINDOW_SIZE = PACKAGER_LZ_WINDOW_SIZE; ///< History size
+    static constexpr uint8_t MIN_MATCH = 3;                          ///< Shortest match encoded
+    static constexpr uint8_t MAX_MATCH = WINDOW_SIZE / 4;            ///< Longest match encoded
+    static constexpr uint8_t MAX_DISTANCE = WINDOW_SIZE - MAX_MATCH; ///< Farthest match encoded
+    static constexpr uint8_t MATCH_TOKEN = 0x80;                     ///< First match token
+
+    static_assert(WINDOW_SIZE >= 32 && WINDOW_SIZE <= 256 && (WINDOW_SIZE & (WINDOW_SIZE - 1)) == 0,
+                  "PACKAGER_LZ_WINDOW_SIZE must be a power of two from 32 to 256");
+
+    /**
+     * @brief Constructor
+     */
+    LZCompressor();
+
+    /**
+     * @brief Forgets the history
+     *
+     * @details The peer's decompressor must be reset at the same point
+     * of the stream.
+     */
+    void reset();
+
+    /**
+     * @brief Compresses what the input holds
+     *
+     * @details Stops when the input is empty or the output is full; the
+     * rest follows on later calls.
+     *
+     * @param input Plain bytes
+     * @param output Compressed bytes
+     */
+    void compress(PipedStream &input, PipedStream &output);
+
+    /**
+     * @brief Gets the number of plain bytes taken
+     *
+     * @return uint32_t Bytes read from the input
+     */
+    uint32_t getBytesIn() const { return m_bytesIn; }
+
+    /**
+     * @brief Gets the number of compressed bytes produced
+     *
+     * @return uint32_t Bytes written to the output
+     */
+    uint32_t getBytesOut() const { return m_bytesOut; }
+
+private:
+    static constexpr uint8_t HASH_BITS = 6;              ///< Hash table index width
+    static constexpr uint8_t HASH_SIZE = 1 << HASH_BITS; ///< Hash table entries
+
+    /** @brief Longest literal run, so that its bytes stay in the window */
+    static constexpr uint8_t MAX_LITERAL_RUN =
+        (WINDOW_SIZE - MAX_MATCH < MATCH_TOKEN) ? WINDOW_SIZE - MAX_MATCH : MATCH_TOKEN;
+
+    /**
+     * @brief Hashes the 3 bytes at a window position
+     *
+     * @param position Stream position
+     * @return uint8_t Hash table index
+     */
+    uint8_t hash(const uint16_t position) const;
+
+    /**
+     * @brief Writes the pending literals
+     *
+     * @param output Compressed bytes
+     * @return true if none are left
+     */
+    bool flushLiterals(PipedStream &output);
+
+    uint8_t m_window[WINDOW_SIZE];   /**< History and lookahead, indexed by stream position */
+    uint8_t m_hashTable[HASH_SIZE];  /**< Low byte of the last position of each prefix hash */
+    uint16_t m_position;             /**< Next byte to encode */
+    uint16_t m_end;                  /**< End of the lookahead */
+    uint16_t m_literalStart;         /**< First literal not yet written */
+    uint8_t m_history;               /**< Bytes before m_position that matches may refer to */
+    uint32_t m_bytesIn;              /**< Plain bytes taken */
+    uint32_t m_bytesOut;             /**< Compressed bytes produced */
+};
+
+/**
+ * @class LZDecompressor
+ * @brief Incremental decompressor
+ *
+ * @details Uses WINDOW_SIZE bytes of RAM plus a few counters. Tokens
+ * may be split anywhere across calls.
+ */
+class LZDecompressor
+{
+public:
+    /**
+     * @brief Constructor
+     */
+    LZDecompressor();
+
+    /**
+     * @brief Forgets the history
+     */
+    void reset();
+
+    /**
+     * @brief Decompresses what the input holds
+     *
+     * @details Stops when the input is empty or the output is full; the
+     * rest follows on later calls. Invalid tokens and references beyond
+     * the history are counted and skipped.
+     *
+     * @param input Compressed bytes
+     * @param output Plain bytes
+     */
+    void decompress(PipedStream &input, PipedStream &output);
+
+    /**
+     * @brief Gets the number of compressed bytes taken
+     *
+     * @return uint32_t Bytes read from the input
+     */
+    uint32_t getBytesIn() const { return m_bytesIn; }
+
+    /**
+     * @brief Gets the number of plain bytes produced
+     *
+     * @return uint32_t Bytes written to the output
+     */
+    uint32_t getBytesOut() const { return m_bytesOut; }
+
+    /**
+     * @brief Gets the number of invalid tokens
+     *
+     * @return uint32_t Tokens skipped since construction
+     */
+    uint32_t getErrors() const { return m_errors; }
+
+private:
+    static constexpr uint16_t WINDOW_SIZE = LZCompressor::WINDOW_SIZE; ///< History size
+
+    /**
+     * @enum State
+     * @brief Decoding progress
+     */
+    enum State : uint8_t
+    {
+        READ_TOKEN,    ///< Expecting a token
+        COPY_LITERALS, ///< Copying literals from the input
+        READ_DISTANCE, ///< Expecting the distance of a match
+        COPY_MATCH     ///< Copying a match from the history
+    };
+
+    /**
+     * @brief Emits a plain byte
+     *
+     * @param value Byte
+     * @param output Plain bytes
+     */
+    void put(const uint8_t value, PipedStream &output);
+
+    uint8_t m_window[WINDOW_SIZE]; /**< Last plain bytes, indexed by stream position */
+    uint16_t m_position;           /**< Next plain byte */
+    uint16_t m_history;            /**< Valid bytes in the window */
+    State m_state;                 /**< Decoding progress */
+    uint8_t m_remaining;           /**< Bytes left in the current token */
+    uint16_t m_distance;           /**< Distance of the current match */
+    uint32_t m_bytesIn;            /**< Compressed bytes taken */
+    uint32_t m_bytesOut;           /**< Plain bytes produced */
+    uint32_t m_errors;             /**< Invalid tokens */
+};
+
+#endif // LZ_COMPRESSION_H
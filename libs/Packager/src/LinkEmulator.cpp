@@ -0,0 +1,284 @@
+/**
+ * @file LinkEmulator.cpp
+ * @brief Implementation of the emulated serial link
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include "LinkEmulator.h"
+
+/**
+ * @brief Constructor
+ */
+LinkChannel::LinkChannel()
+    : m_current(),
+      m_lineFree(micros()),
+      m_lastRelease(m_lineFree),
+      m_outageStart(0),
+      m_outageLength(0),
+      m_noiseLength(0)
+{
+    memset(&m_settings, 0, sizeof(m_settings));
+    resetStatistics();
+}
+
+/**
+ * @brief Sets the link characteristics
+ *
+ * @param settings New characteristics
+ */
+void LinkChannel::setSettings(const Settings &settings)
+{
+    m_settings = settings;
+}
+
+/**
+ * @brief Loses everything sent for a while
+ *
+ * @param durationMs Outage length in milliseconds
+ */
+void LinkChannel::startOutage(const uint32_t durationMs)
+{
+    m_outageStart = millis();
+    m_outageLength = durationMs;
+}
+
+/**
+ * @brief Checks for an ongoing outage
+ *
+ * @return true while bytes sent are lost
+ */
+bool LinkChannel::inOutage() const
+{
+    return m_outageLength > 0 && millis() - m_outageStart < m_outageLength;
+}
+
+/**
+ * @brief Inserts bytes into the stream, as line noise would
+ *
+ * @param bytes Noise bytes
+ * @param length Number of bytes, at most MAX_NOISE_LENGTH
+ * @return false if a burst is still waiting or length is too long
+ */
+bool LinkChannel::injectNoise(const uint8_t *bytes, const uint8_t length)
+{
+    if (m_noiseLength > 0 || length > MAX_NOISE_LENGTH)
+    {
+        return false;
+    }
+    memcpy(m_noise, bytes, length);
+    m_noiseLength = length;
+    return true;
+}
+
+/**
+ * @brief Drops the bytes in flight and ends an outage
+ */
+void LinkChannel::clear()
+{
+    m_bytes.clear();
+    m_chunks.clear();
+    m_current.count = 0;
+    m_lineFree = micros();
+    m_lastRelease = m_lineFree;
+    m_outageLength = 0;
+    m_noiseLength = 0;
+}
+
+/**
+ * @brief Moves bytes along the line
+ *
+ * @param from Sending stream
+ * @param to Receiving stream
+ */
+void LinkChannel::pump(PipedStream &from, PipedStream &to)
+{
+    const uint32_t now = micros();
+    accept(from, now);
+    release(to, now);
+}
+
+/**
+ * @brief Takes bytes from the sender and impairs them
+ *
+ * @details The sender is read whenever there is room, as if it had a
+ * deep transmit buffer; the bandwidth only decides when the bytes leave
+ * it. Every byte is then dropped, corrupted or duplicated on its own.
+ * With the bit error rates of interest a byte rarely has two bad bits,
+ * so one flipped bit per corrupted byte stands for all of them.
+ *
+ * @param from Sending stream
+ * @param now Current micros()
+ */
+void LinkChannel::accept(PipedStream &from, const uint32_t now)
+{
+    // Room for every byte to be duplicated, and for a noise burst
+    const int space = (m_bytes.availableForWrite() - m_noiseLength) / 2;
+    if (m_chunks.isFull() || space <= 0)
+    {
+        return;
+    }
+
+    uint8_t buffer[MAX_CHUNK_LENGTH];
+    const size_t count = from.readBytes(buffer, min(space, (int)sizeof(buffer)));
+    if (count == 0)
+    {
+        return;
+    }
+    m_statistics.bytesSent += count;
+
+    // Serialize after the bytes still leaving the sender
+    if ((int32_t)(now - m_lineFree) > 0)
+    {
+        m_lineFree = now;
+    }
+    if (m_settings.bytesPerSecond > 0)
+    {
+        m_lineFree += count * 1000000UL / m_settings.bytesPerSecond;
+    }
+
+    if (inOutage())
+    {
+        m_statistics.bytesDropped += count;
+        return;
+    }
+
+    const uint32_t byteErrorPpm = m_settings.bitErrorPpm * 8;
+    const size_t noiseAt = m_noiseLength > 0 ? random(count) : count;
+    uint16_t stored = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (i == noiseAt)
+        {
+            m_bytes.write(m_noise, m_noiseLength);
+            stored += m_noiseLength;
+            m_statistics.bytesInjected += m_noiseLength;
+            m_noiseLength = 0;
+        }
+
+        if (chance(m_settings.dropPpm))
+        {
+            m_statistics.bytesDropped++;
+            continue;
+        }
+
+        uint8_t value = buffer[i];
+        if (chance(byteErrorPpm))
+        {
+            value ^= 1 << random(8);
+            m_statistics.bytesCorrupted++;
+        }
+
+        m_bytes.write(value);
+        stored++;
+        if (chance(m_settings.duplicatePpm))
+        {
+            m_bytes.write(value);
+            stored++;
+            m_statistics.bytesDuplicated++;
+        }
+    }
+    if (stored == 0)
+    {
+        return;
+    }
+
+    // Jitter delays a chunk, but it never overtakes the one before it
+    uint32_t releaseTime = m_lineFree + m_settings.latencyUs;
+    if (m_settings.jitterUs > 0)
+    {
+        releaseTime += random(m_settings.jitterUs + 1);
+    }
+    if ((int32_t)(releaseTime - m_lastRelease) < 0)
+    {
+        releaseTime = m_lastRelease;
+    }
+    m_lastRelease = releaseTime;
+
+    const Chunk chunk = {releaseTime, stored};
+    m_chunks.push(chunk);
+}
+
+/**
+ * @brief Hands the chunks whose time has come to the receiver
+ *
+ * @details A chunk the receiving stream has no room for is delivered
+ * in part and finished on a later call.
+ *
+ * @param to Receiving stream
+ * @param now Current micros()
+ */
+void LinkChannel::release(PipedStream &to, const uint32_t now)
+{
+    while (true)
+    {
+        if (m_current.count == 0 && !m_chunks.pop(m_current))
+        {
+            return;
+        }
+        if ((int32_t)(now - m_current.releaseTime) < 0)
+        {
+            return;
+        }
+
+        while (m_current.count > 0 && to.availableForWrite() > 0)
+        {
+            to.write(m_bytes.read());
+            m_current.count--;
+            m_statistics.bytesDelivered++;
+        }
+        if (m_current.count > 0)
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Moves bytes along both directions
+ */
+void LinkEmulator::loop()
+{
+    m_forward.pump(m_endA, m_endB);
+    m_backward.pump(m_endB, m_endA);
+}
+
+/**
+ * @brief Sets the same characteristics for both directions
+ *
+ * @param settings Link characteristics
+ */
+void LinkEmulator::setSettings(const LinkChannel::Settings &settings)
+{
+    m_forward.setSettings(settings);
+    m_backward.setSettings(settings);
+}
+
+/**
+ * @brief Starts an outage in both directions
+ *
+ * @param durationMs Outage length in milliseconds
+ */
+void LinkEmulator::startOutage(const uint32_t durationMs)
+{
+    m_forward.startOutage(durationMs);
+    m_backward.startOutage(durationMs);
+}
+
+/**
+ * @brief Drops the bytes in flight in both directions
+ */
+void LinkEmulator::clear()
+{
+    m_forward.clear();
+    m_backward.clear();
+}
+
+/**
+ * @brief Clears the byte counters of both directions
+ */
+void LinkEmulator::resetStatistics()
+{
+    m_forward.resetStatistics();
+    m_backward.resetStatistics();
+}
@@ -0,0 +1,324 @@
+/**
+ * @file LinkEmulator.h
+ * @brief Emulated serial link for testing and tuning the Packager protocol
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ *
+ * @details A LinkEmulator connects the encoded streams of two package
+ * interfaces in place of a real serial line. Each direction is a
+ * LinkChannel that delivers the bytes written on one side to the other
+ * side with a configurable:
+ * - Bandwidth (bytes per second)
+ * - Latency and random jitter
+ * - Bit error rate
+ * - Byte drop and duplication rates
+ * - Outages, during which everything sent is lost
+ * - Noise bursts, bytes inserted into the stream on request
+ *
+ * Bytes are never reordered, as on a real serial line. Random decisions
+ * use random(), so runs repeat after randomSeed(). Error rates are given
+ * in parts per million to avoid floating point. Each channel buffers
+ * PACKAGER_LINK_BUFFER_SIZE bytes and PACKAGER_LINK_MAX_CHUNKS chunks in
+ * flight, about 400 bytes of RAM with the AVR defaults.
+ */
+#ifndef LINK_EMULATOR_H
+#define LINK_EMULATOR_H
+
+#include <Arduino.h>
+#include <FastCircularQueue.h>
+#include <LoopbackStream.h>
+#include <PipedStream.h>
+
+/**
+ * @brief Bytes each LinkChannel can hold in flight
+ * @details Must be a power of two. Half of it is kept free for duplicated
+ * bytes. Raise it when bandwidth times latency, or a full window of
+ * packets, exceeds that half; the sender waits meanwhile.
+ */
+#ifndef PACKAGER_LINK_BUFFER_SIZE
+#if defined(__AVR__)
+#define PACKAGER_LINK_BUFFER_SIZE 256
+#else
+#define PACKAGER_LINK_BUFFER_SIZE 1024
+#endif
+#endif
+
+/**
+ * @brief Chunks each LinkChannel can hold in flight
+ * @details Must be a power of two. Each read from the sender is one chunk.
+ */
+#ifndef PACKAGER_LINK_MAX_CHUNKS
+#if defined(__AVR__)
+#define PACKAGER_LINK_MAX_CHUNKS 16
+#else
+#define PACKAGER_LINK_MAX_CHUNKS 64
+#endif
+#endif
+
+/**
+ * @class LinkChannel
+ * @brief One direction of an emulated link
+ *
+ * @details Bytes are taken from the sending stream in chunks, impaired
+ * as they enter the line and timed by the bandwidth: a chunk has left
+ * the sender once all its bytes were serialized. It is handed to the
+ * receiving stream after the latency plus a random jitter, but never
+ * before the chunk sent ahead of it.
+ */
+class LinkChannel
+{
+public:
+    /**
+     * @struct Settings
+     * @brief Link characteristics
+     *
+     * @details Zero disables an impairment; a bandwidth of zero is
+     * unlimited.
+     */
+    struct Settings
+    {
+        uint32_t bytesPerSecond; ///< Bandwidth, 0 for unlimited
+        uint32_t latencyUs;      ///< Delay after a chunk was serialized
+        uint32_t jitterUs;       ///< Random extra delay, up to this value
+        uint32_t bitErrorPpm;    ///< Flipped bits per million bits (at most 125000)
+        uint32_t dropPpm;        ///< Lost bytes per million bytes
+        uint32_t duplicatePpm;   ///< Repeated bytes per million bytes
+    };
+
+    /**
+     * @struct Statistics
+     * @brief Byte counters
+     *
+     * @details Counts since construction or the last resetStatistics().
+     */
+    struct Statistics
+    {
+        uint32_t bytesSent;       ///< Bytes taken from the sending stream
+        uint32_t bytesDelivered;  ///< Bytes written to the receiving stream
+        uint32_t bytesDropped;    ///< Bytes lost, outages included
+        uint32_t bytesCorrupted;  ///< Bytes with a flipped bit
+        uint32_t bytesDuplicated; ///< Bytes delivered twice
+        uint32_t bytesInjected;   ///< Noise bytes inserted
+    };
+
+    static constexpr uint8_t MAX_NOISE_LENGTH = 8; ///< Longest noise burst
+
+    /**
+     * @brief Constructor
+     *
+     * @details Starts as an ideal link: unlimited bandwidth, no latency
+     * and no errors.
+     */
+    LinkChannel();
+
+    /**
+     * @brief Sets the link characteristics
+     *
+     * @details Bytes already in flight keep their timing.
+     *
+     * @param settings New characteristics
+     */
+    void setSettings(const Settings &settings);
+
+    /**
+     * @brief Gets the link characteristics
+     *
+     * @return const Settings& Current characteristics
+     */
+    const Settings &getSettings() const { return m_settings; }
+
+    /**
+     * @brief Loses everything sent for a while
+     *
+     * @details Bytes already in flight are still delivered.
+     *
+     * @param durationMs Outage length in milliseconds
+     */
+    void startOutage(const uint32_t durationMs);
+
+    /**
+     * @brief Checks for an ongoing outage
+     *
+     * @return true while bytes sent are lost
+     */
+    bool inOutage() const;
+
+    /**
+     * @brief Inserts bytes into the stream, as line noise would
+     *
+     * @details The bytes go in at a random position of the next chunk
+     * that enters the line, and are not impaired themselves.
+     *
+     * @param bytes Noise bytes
+     * @param length Number of bytes, at most MAX_NOISE_LENGTH
+     * @return false if a burst is still waiting or length is too long
+     */
+    bool injectNoise(const uint8_t *bytes, const uint8_t length);
+
+    /**
+     * @brief Checks for a noise burst not yet in the line
+     *
+     * @return true until the burst entered the line
+     */
+    bool noisePending() const { return m_noiseLength > 0; }
+
+    /**
+     * @brief Drops the bytes in flight and ends an outage
+     */
+    void clear();
+
+    /**
+     * @brief Moves bytes along the line
+     *
+     * @details Call as often as possible; the timing is only as fine as
+     * the calls.
+     *
+     * @param from Sending stream
+     * @param to Receiving stream
+     */
+    void pump(PipedStream &from, PipedStream &to);
+
+    /**
+     * @brief Gets the byte counters
+     *
+     * @return const Statistics& Counters
+     */
+    const Statistics &getStatistics() const { return m_statistics; }
+
+    /**
+     * @brief Clears the byte counters
+     */
+    void resetStatistics() { memset(&m_statistics, 0, sizeof(m_statistics)); }
+
+private:
+    /**
+     * @struct Chunk
+     * @brief Bytes that entered the line together
+     */
+    struct Chunk
+    {
+        uint32_t releaseTime; ///< micros() at which the chunk reaches the receiver
+        uint16_t count;       ///< Bytes of the chunk still to deliver
+    };
+
+    static constexpr uint8_t MAX_CHUNK_LENGTH = 32; ///< Bytes taken from the sender at once
+
+    /**
+     * @brief Draws a random event
+     *
+     * @param ppm Probability in parts per million
+     * @return true with the given probability
+     */
+    static bool chance(const uint32_t ppm) { return ppm > 0 && (uint32_t)random(1000000L) < ppm; }
+
+    /**
+     * @brief Takes bytes from the sender and impairs them
+     *
+     * @param from Sending stream
+     * @param now Current micros()
+     */
+    void accept(PipedStream &from, const uint32_t now);
+
+    /**
+     * @brief Hands the chunks whose time has come to the receiver
+     *
+     * @param to Receiving stream
+     * @param now Current micros()
+     */
+    void release(PipedStream &to, const uint32_t now);
+
+    Settings m_settings;     /**< Link characteristics */
+    Statistics m_statistics; /**< Byte counters */
+
+    StaticLoopbackStream<PACKAGER_LINK_BUFFER_SIZE> m_bytes; /**< Bytes in flight, in order */
+    FastCircularQueue<Chunk, PACKAGER_LINK_MAX_CHUNKS> m_chunks; /**< Timing of the bytes in flight */
+    Chunk m_current;                                         /**< Chunk being delivered */
+
+    uint32_t m_lineFree;     /**< micros() at which the sender finishes serializing */
+    uint32_t m_lastRelease;  /**< Release time of the latest chunk */
+    uint32_t m_outageStart;  /**< millis() at which the outage started */
+    uint32_t m_outageLength; /**< Outage length in milliseconds, 0 if none */
+
+    uint8_t m_noise[MAX_NOISE_LENGTH]; /**< Noise burst waiting for the next chunk */
+    uint8_t m_noiseLength;             /**< Bytes of the waiting burst, 0 if none */
+};
+
+/**
+ * @class LinkEmulator
+ * @brief Bidirectional emulated link between two encoded streams
+ *
+ * @details Pass the encoded streams of both interfaces and call loop()
+ * together with their loop():
+ * @code
+ * LinkEmulator link(a.getEncodedStream(), b.getEncodedStream());
+ * link.setSettings(settings);
+ * while (true)
+ * {
+ *     a.loop();
+ *     b.loop();
+ *     link.loop();
+ * }
+ * @endcode
+ */
+class LinkEmulator
+{
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param endA Encoded stream of the first interface
+     * @param endB Encoded stream of the second interface
+     */
+    LinkEmulator(PipedStream &endA, PipedStream &endB) : m_endA(endA), m_endB(endB) {}
+
+    /**
+     * @brief Moves bytes along both directions
+     */
+    void loop();
+
+    /**
+     * @brief Sets the same characteristics for both directions
+     *
+     * @param settings Link characteristics
+     */
+    void setSettings(const LinkChannel::Settings &settings);
+
+    /**
+     * @brief Starts an outage in both directions
+     *
+     * @param durationMs Outage length in milliseconds
+     */
+    void startOutage(const uint32_t durationMs);
+
+    /**
+     * @brief Drops the bytes in flight in both directions
+     */
+    void clear();
+
+    /**
+     * @brief Clears the byte counters of both directions
+     */
+    void resetStatistics();
+
+    /**
+     * @brief Gets the direction from the first to the second interface
+     *
+     * @return LinkChannel& Channel, for asymmetric settings and counters
+     */
+    LinkChannel &forward() { return m_forward; }
+
+    /**
+     * @brief Gets the direction from the second to the first interface
+     *
+     * @return LinkChannel& Channel, for asymmetric settings and counters
+     */
+    LinkChannel &backward() { return m_backward; }
+
+private:
+    PipedStream &m_endA;    /**< Encoded stream of the first interface */
+    PipedStream &m_endB;    /**< Encoded stream of the second interface */
+    LinkChannel m_forward;  /**< From the first to the second interface */
+    LinkChannel m_backward; /**< From the second to the first interface */
+};
+
+#endif // LINK_EMULATOR_H
@@ -16,14 +16,18 @@
  *
  * Initializes the PackageInterface with the provided paired streams and buffer size.
  * The paired streams are used for external communication, while an internal paired
- * stream is created for packet processing.
+ * stream is created for packet processing, over the given storage or allocated.
  *
  * @param pipedStreamPair The paired streams used for external communication.
  * @param encodedBufferSize The size of the buffer for encoded data.
+ * @param encodedStorage1 Storage for encoded data from the line, or nullptr to allocate it.
+ * @param encodedStorage2 Storage for encoded data to the line, or nullptr to allocate it.
  */
-PackageInterface::PackageInterface(PipedStreamPair &pipedStreamPair, const uint16_t encodedBufferSize)
+PackageInterface::PackageInterface(PipedStreamPair &pipedStreamPair, const uint16_t encodedBufferSize,
+                                   uint8_t *encodedStorage1, uint8_t *encodedStorage2)
     : p_pipedStreamPair(&pipedStreamPair),
-      m_packagerStreamPair(encodedBufferSize)
+      m_packagerStreamPair(encodedStorage1, encodedStorage2, encodedBufferSize),
+      p_resetListeners(nullptr)
 {
 }
 
@@ -41,3 +45,57 @@ void PackageInterface::clear()
     m_packagerStreamPair.first.clear();
     m_packagerStreamPair.second.clear();
 }
+
+/**
+ * @brief Adds a receiver of connection resets.
+ *
+ * The listener is appended, so listeners are told in the order they were added.
+ *
+ * @param listener Receiver to add; ignored if it was already added.
+ */
+void PackageInterface::addResetListener(ResetListener *listener)
+{
+    ResetListener **link = &p_resetListeners;
+    while (*link != nullptr)
+    {
+        if (*link == listener)
+        {
+            return;
+        }
+        link = &(*link)->p_nextListener;
+    }
+    listener->p_nextListener = nullptr;
+    *link = listener;
+}
+
+/**
+ * @brief Removes a receiver of connection resets.
+ *
+ * @param listener Receiver to remove; ignored if it was not added.
+ */
+void PackageInterface::removeResetListener(ResetListener *listener)
+{
+    for (ResetListener **link = &p_resetListeners; *link != nullptr; link = &(*link)->p_nextListener)
+    {
+        if (*link == listener)
+        {
+            *link = listener->p_nextListener;
+            listener->p_nextListener = nullptr;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Tells the reset listeners that the connection state was lost.
+ *
+ * Derived classes call this once their own state is reset, before any
+ * data of the new connection reaches the plain stream.
+ */
+void PackageInterface::notifyReset()
+{
+    for (ResetListener *listener = p_resetListeners; listener != nullptr; listener = listener->p_nextListener)
+    {
+        listener->onReset();
+    }
+}
@@ -24,13 +24,46 @@
 class PackageInterface
 {
 public:
+    /**
+     * @brief Receiver of connection resets.
+     *
+     * Stages layered on the plain stream, such as CompressionStage, keep
+     * state that must restart together with the protocol. An interface
+     * keeps its listeners in a list linked through the listeners, so any
+     * number of stages can share one interface.
+     */
+    class ResetListener
+    {
+    public:
+        /**
+         * @brief Called right after the protocol lost its connection state.
+         *
+         * Bytes in the plain stream before the call belong to the old
+         * connection, bytes added after it to the new one.
+         */
+        virtual void onReset() = 0;
+
+    protected:
+        ~ResetListener() = default;
+
+    private:
+        friend class PackageInterface;
+        ResetListener *p_nextListener = nullptr; ///< Next listener of the same interface
+    };
+
     /**
      * @brief Constructs a PackageInterface instance.
      *
+     * The internal encoded buffers are allocated unless storage is given
+     * for them, as StaticCRCPackageInterface does.
+     *
      * @param pipedStreamPair The paired streams used for external communication.
      * @param maxPackageSize The maximum size allowed for a packet.
+     * @param encodedStorage1 Storage of maxPackageSize bytes for encoded data from the line, or nullptr.
+     * @param encodedStorage2 Storage of maxPackageSize bytes for encoded data to the line, or nullptr.
      */
-    PackageInterface(PipedStreamPair &pipedStreamPair, const uint16_t maxPackageSize);
+    PackageInterface(PipedStreamPair &pipedStreamPair, const uint16_t maxPackageSize,
+                     uint8_t *encodedStorage1 = nullptr, uint8_t *encodedStorage2 = nullptr);
 
     /**
      * @brief Main processing loop.
@@ -61,6 +94,24 @@ public:
      */
     PipedStream &getEncodedStream() { return m_packagerStreamPair.first; }
 
+    /**
+     * @brief Adds a receiver of connection resets.
+     *
+     * Listeners are told in the order they were added. Interfaces without
+     * connection state never call them. A listener belongs to at most one
+     * interface and must be removed before it is destroyed.
+     *
+     * @param listener Receiver to add; ignored if it was already added.
+     */
+    void addResetListener(ResetListener *listener);
+
+    /**
+     * @brief Removes a receiver of connection resets.
+     *
+     * @param listener Receiver to remove; ignored if it was not added.
+     */
+    void removeResetListener(ResetListener *listener);
+
 protected:
     /**
      * @brief Gets the internal plain data stream.
@@ -76,9 +127,15 @@ protected:
      */
     PipedStream &getInternalEncodedStream() { return m_packagerStreamPair.second; }
 
+    /**
+     * @brief Tells the reset listeners that the connection state was lost.
+     */
+    void notifyReset();
+
 private:
     PipedStreamPair *p_pipedStreamPair;   ///< Pointer to the external paired streams
     PipedStreamPair m_packagerStreamPair; ///< Internal paired streams for packet processing
+    ResetListener *p_resetListeners;      ///< First receiver of connection resets, if any
 };
 
 #endif
\ No newline at end of file
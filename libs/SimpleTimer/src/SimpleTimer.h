@@ -55,6 +55,13 @@ public:
      */
     inline bool isReady() const { return (TimeType)(millis() - _start) >= _interval; }
 
+    /**
+     * @brief Gets the time since the timer was started or last reset.
+     *
+     * @return Elapsed time in milliseconds.
+     */
+    inline TimeType elapsed() const { return (TimeType)(millis() - _start); }
+
     /**
      * @brief Sets a new time interval.
      *
@@ -162,9 +162,9 @@ private:
    */
   static unsigned long getBaudRateValue(const BaudRate code);
 
-  FastCircularQueue<uint8_t, RX_BUFFER_SIZE> m_rxQueue;      ///< RX buffer queue
-  FastCircularQueue<uint8_t, TX_BUFFER_SIZE> m_txQueue;      ///< TX buffer queue
-  FastCircularQueue<uint16_t, RX_BUFFER_SIZE> m_rxTempQueue; ///< Temporary RX buffer queue
+  FastCircularQueue<uint8_t, RX_BUFFER_SIZE> m_rxQueue;                       ///< RX buffer queue
+  FastCircularQueue<uint8_t, TX_BUFFER_SIZE> m_txQueue;                       ///< TX buffer queue
+  FastCircularQueue<uint16_t, RX_BUFFER_SIZE, SPSCQueuePolicy> m_rxTempQueue; ///< Raw RX frames, ISR to loop()
 
   uint16_t m_receivedData; ///< Stores received data bits
 
@@ -170,12 +170,10 @@ void SoftSerial<RX_BUFFER_SIZE, TX_BUFFER_SIZE>::loop()
 
   for (uint8_t i = 0; (i < 8) && !m_rxQueue.isFull(); i++)
   {
+    // The ISR is the only producer, so frames can be taken without disabling interrupts
     uint16_t frame;
-    {
-      SafeInterrupts::ScopedDisable guard;
-      if (!m_rxTempQueue.pop(frame))
-        break;
-    }
+    if (!m_rxTempQueue.pop(frame))
+      break;
 
     bool hasError = false;
 
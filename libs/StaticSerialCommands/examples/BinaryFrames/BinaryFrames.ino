@@ -0,0 +1,80 @@
+/*---------------------------------------------------------------------
+Author         : naszly
+License        : BSD
+Repository     : https://github.com/naszly/Arduino-StaticSerialCommands
+-----------------------------------------------------------------------*/
+
+/*
+The same commands serve people over the text console and machine clients
+over binary frames.
+
+Type commands in the serial monitor as usual, or drive the board from a
+computer with the client in the extras folder (needs pyserial):
+    python3 serial_commands_client.py /dev/ttyUSB0 --list
+    python3 serial_commands_client.py /dev/ttyUSB0 --call "led on" 13
+    python3 serial_commands_client.py /dev/ttyUSB0 --call pwm 9 0.25
+    python3 serial_commands_client.py /dev/ttyUSB0 --generate board.py
+
+Numbers travel as 4 binary bytes instead of text, and the reply carries
+what the command printed followed by a status.
+*/
+
+#include <StaticSerialCommands.h>
+
+void cmd_help(SerialCommands &sender, Args &args);
+void cmd_led_on(SerialCommands &sender, Args &args);
+void cmd_led_off(SerialCommands &sender, Args &args);
+void cmd_pwm(SerialCommands &sender, Args &args);
+void cmd_uptime(SerialCommands &sender, Args &args);
+
+Command ledCommands[]{
+    COMMAND(cmd_led_on, "on", ARG(ArgType::Int, 2, 13, "pin"), nullptr, "turn a led on"),
+    COMMAND(cmd_led_off, "off", ARG(ArgType::Int, 2, 13, "pin"), nullptr, "turn a led off"),
+};
+
+Command commands[]{
+    COMMAND(cmd_help, "help", nullptr, "list commands"),
+    COMMAND(nullptr, "led", ledCommands, "leds"),
+    COMMAND(cmd_pwm, "pwm", ARG(ArgType::Int, 2, 13, "pin"), ARG(ArgType::Float, 0, 1, "duty"), nullptr, "set a pwm duty cycle"),
+    COMMAND(cmd_uptime, "uptime", nullptr, "milliseconds since reset"),
+};
+
+SerialCommands serialCommands(Serial, commands, sizeof(commands) / sizeof(Command));
+
+void setup()
+{
+    Serial.begin(115200);
+}
+
+void loop()
+{
+    serialCommands.readSerial();
+}
+
+void cmd_help(SerialCommands &sender, Args &args)
+{
+    sender.listAllCommands();
+}
+
+void cmd_led_on(SerialCommands &sender, Args &args)
+{
+    pinMode(args[0].getInt(), OUTPUT);
+    digitalWrite(args[0].getInt(), HIGH);
+}
+
+void cmd_led_off(SerialCommands &sender, Args &args)
+{
+    pinMode(args[0].getInt(), OUTPUT);
+    digitalWrite(args[0].getInt(), LOW);
+}
+
+void cmd_pwm(SerialCommands &sender, Args &args)
+{
+    analogWrite(args[0].getInt(), (int)(args[1].getFloat() * 255));
+}
+
+void cmd_uptime(SerialCommands &sender, Args &args)
+{
+    // Printed output reaches binary clients in Output frames
+    sender.getSerial().println(millis());
+}
@@ -0,0 +1,101 @@
+/*---------------------------------------------------------------------
+Author         : naszly
+License        : BSD
+Repository     : https://github.com/naszly/Arduino-StaticSerialCommands
+-----------------------------------------------------------------------*/
+
+/*
+Measures command dispatch time with a 64 command maintenance console.
+
+Command lines are fed from memory instead of the serial port, so only
+parsing and lookup are timed. Build once as is and once with
+-DSERIAL_COMMANDS_SORTED_LOOKUP=0 to compare binary and linear search.
+*/
+
+#include <StaticSerialCommands.h>
+
+// Serves a command line from RAM and discards the output
+class LineStream : public Stream
+{
+public:
+    void setLine(const char *line) { this->line = line; }
+    int available() override { return *line != '\0'; }
+    int read() override { return *line != '\0' ? *line++ : -1; }
+    int peek() override { return *line != '\0' ? *line : -1; }
+    size_t write(uint8_t) override { return 1; }
+
+private:
+    const char *line = "";
+};
+
+LineStream lines;
+uint32_t dispatched = 0;
+
+void cmd_count(SerialCommands &sender, Args &args)
+{
+    dispatched++;
+}
+
+#define CMD(name) COMMAND(cmd_count, name, nullptr, name)
+
+Command commands[]{
+    CMD("adc"), CMD("alarm"), CMD("baud"), CMD("beep"), CMD("boot"), CMD("cal"), CMD("clear"), CMD("clock"),
+    CMD("config"), CMD("date"), CMD("debug"), CMD("dump"), CMD("echo"), CMD("eeprom"), CMD("erase"), CMD("error"),
+    CMD("fan"), CMD("flash"), CMD("freq"), CMD("gain"), CMD("gpio"), CMD("heap"), CMD("help"), CMD("i2c"),
+    CMD("id"), CMD("info"), CMD("led"), CMD("level"), CMD("limit"), CMD("load"), CMD("log"), CMD("mode"),
+    CMD("motor"), CMD("name"), CMD("offset"), CMD("pid"), CMD("ping"), CMD("power"), CMD("pwm"), CMD("radio"),
+    CMD("read"), CMD("reboot"), CMD("relay"), CMD("reset"), CMD("rtc"), CMD("save"), CMD("scan"), CMD("sensor"),
+    CMD("serial"), CMD("sleep"), CMD("spi"), CMD("stack"), CMD("stats"), CMD("status"), CMD("stop"), CMD("task"),
+    CMD("temp"), CMD("test"), CMD("time"), CMD("trace"), CMD("uart"), CMD("uptime"), CMD("version"), CMD("write"),
+};
+
+SerialCommands serialCommands(lines, commands, sizeof(commands) / sizeof(Command));
+
+// Full names from the whole table, unique prefixes, and an unknown name
+const char *const inputs[] = {
+    "adc\n", "write\n", "status\n", "help\n", "reboot\n", "temp\n", "mode\n", "eeprom\n",
+    "ver\n", "upt\n", "sen\n", "mot\n", "nosuchcommand\n",
+};
+
+void setup()
+{
+    Serial.begin(115200);
+    delay(1000);
+
+    Serial.println(F("Command Lookup Benchmark"));
+    Serial.println(F("========================"));
+    Serial.print(F("Commands: "));
+    Serial.println(sizeof(commands) / sizeof(Command));
+    Serial.print(F("Lookup: "));
+    Serial.println(SERIAL_COMMANDS_SORTED_LOOKUP ? F("binary search") : F("linear search"));
+
+    const uint16_t rounds = 200;
+    const uint8_t inputCount = sizeof(inputs) / sizeof(inputs[0]);
+
+    // The first call sorts the table; keep it out of the measurement
+    lines.setLine("help\n");
+    serialCommands.readSerial();
+
+    const uint32_t start = micros();
+    for (uint16_t round = 0; round < rounds; round++)
+    {
+        for (uint8_t i = 0; i < inputCount; i++)
+        {
+            lines.setLine(inputs[i]);
+            serialCommands.readSerial();
+        }
+    }
+    const uint32_t elapsed = micros() - start;
+
+    Serial.print(F("Dispatched: "));
+    Serial.print(dispatched - 1);
+    Serial.print(F(" of "));
+    Serial.println((uint32_t)rounds * inputCount);
+    Serial.print(F("Time per line: "));
+    Serial.print(elapsed / ((uint32_t)rounds * inputCount));
+    Serial.println(F(" us"));
+}
+
+void loop()
+{
+}
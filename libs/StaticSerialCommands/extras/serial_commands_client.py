@@ -0,0 +1,335 @@
+#!/usr/bin/env python3
+"""
+Host client for the binary frame mode of StaticSerialCommands.
+
+The client reads the command table of a device with Describe frames and
+calls its commands with Call frames, so the same COMMAND() definitions
+serve both the text console and machine clients.
+
+Usage:
+    python3 serial_commands_client.py PORT --list
+    python3 serial_commands_client.py PORT --call "calc add" 3 1 2
+    python3 serial_commands_client.py PORT --generate device_commands.py
+
+As a library:
+    client = SerialCommandsClient(serial.Serial(PORT, 115200, timeout=1))
+    client.describe()
+    output = client.call("calc add", 3, 1, 2)
+
+--generate writes a module with one method per command, holding the ids
+and argument types of the firmware it was generated from. Regenerate it
+when the command tables change.
+
+Requires pyserial for the command line.
+"""
+
+import argparse
+import builtins
+import keyword
+import struct
+import sys
+
+FRAME_START = 0xA5
+
+CALL = 0x01
+DESCRIBE = 0x02
+OUTPUT = 0x81
+RESULT = 0x82
+DESCRIPTION = 0x83
+
+STATUS_NAMES = [
+    "Ok",
+    "UnknownCommand",
+    "BadArguments",
+    "OutOfRange",
+    "BadCrc",
+    "TooLong",
+    "BadType",
+]
+STATUS_OK = 0
+STATUS_UNKNOWN_COMMAND = 1
+
+ARG_INT = 1
+ARG_FLOAT = 2
+ARG_STRING = 3
+ARG_TYPE_NAMES = {ARG_INT: "int", ARG_FLOAT: "float", ARG_STRING: "string"}
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16-CCITT, polynomial 0x1021, as computed by the device."""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def encode_args(types, values):
+    """Encodes argument values as the device expects them in a Call frame."""
+    if len(values) != len(types):
+        raise TypeError("expected %d arguments, got %d" % (len(types), len(values)))
+    body = b""
+    for arg_type, value in zip(types, values):
+        if arg_type == ARG_INT:
+            body += struct.pack("<i", int(value))
+        elif arg_type == ARG_FLOAT:
+            body += struct.pack("<f", float(value))
+        elif arg_type == ARG_STRING:
+            data = value.encode() if isinstance(value, str) else bytes(value)
+            if b"\0" in data:
+                raise ValueError("string arguments cannot contain a null byte")
+            body += data + b"\0"
+        else:
+            raise ValueError("unsupported argument type %d" % arg_type)
+    return body
+
+
+class CommandError(Exception):
+    """A request was refused by the device."""
+
+    def __init__(self, status, argument=0):
+        name = STATUS_NAMES[status] if status < len(STATUS_NAMES) else str(status)
+        message = name if argument == 0 else "%s (argument %d)" % (name, argument)
+        super().__init__(message)
+        self.status = status
+        self.argument = argument
+
+
+class Argument:
+    """One argument constraint of a command."""
+
+    def __init__(self, arg_type, minimum, maximum, name):
+        self.type = arg_type
+        self.minimum = minimum
+        self.maximum = maximum
+        self.name = name
+
+
+class CommandInfo:
+    """The table entry of a command, as described by the device."""
+
+    def __init__(self, command_id, parent, args, name, description):
+        self.id = command_id
+        self.parent = parent
+        self.args = args
+        self.name = name
+        self.description = description
+
+    @property
+    def path(self):
+        """Full name, with the names of the parent commands."""
+        if self.parent is None:
+            return self.name
+        return self.parent.path + " " + self.name
+
+    @property
+    def all_args(self):
+        """Arguments of the parent commands followed by the own ones."""
+        if self.parent is None:
+            return list(self.args)
+        return self.parent.all_args + self.args
+
+    def syntax(self):
+        """Text mode syntax, as listed by the device."""
+        words = [] if self.parent is None else [self.parent.syntax()]
+        words.append(self.name)
+        words += ["<%s>" % arg.name for arg in self.args]
+        return " ".join(words)
+
+
+class SerialCommandsClient:
+    """Calls commands over any port with read(size) and write(data)."""
+
+    def __init__(self, port):
+        self.port = port
+        self.commands = {}
+
+    def send_frame(self, frame_type, body=b""):
+        """Sends one frame."""
+        payload = bytes([len(body) + 1, frame_type]) + body
+        crc = crc16(payload)
+        self.port.write(bytes([FRAME_START]) + payload + struct.pack("<H", crc))
+
+    def receive_frame(self):
+        """Receives one frame, skipping any text before it."""
+        while True:
+            start = self.port.read(1)
+            if not start:
+                raise TimeoutError("no response from the device")
+            if start[0] != FRAME_START:
+                continue
+            length = self._read_exactly(1)[0]
+            payload = self._read_exactly(length)
+            crc = struct.unpack("<H", self._read_exactly(2))[0]
+            if crc16(bytes([length]) + payload) == crc:
+                return payload[0], payload[1:]
+
+    def _read_exactly(self, size):
+        data = b""
+        while len(data) < size:
+            chunk = self.port.read(size - len(data))
+            if not chunk:
+                raise TimeoutError("frame cut short")
+            data += chunk
+        return data
+
+    def call_id(self, command_id, types, *values):
+        """Calls a command by id and returns what it printed."""
+        body = struct.pack("<H", command_id) + encode_args(types, values)
+        self.send_frame(CALL, body)
+        output = b""
+        while True:
+            frame_type, body = self.receive_frame()
+            if frame_type == OUTPUT:
+                output += body
+            elif frame_type == RESULT:
+                if body[0] != STATUS_OK:
+                    raise CommandError(body[0], body[1])
+                return output
+
+    def call(self, path, *values):
+        """Calls a command by its full name, such as "calc add"."""
+        if not self.commands:
+            self.describe()
+        info = self.commands.get(" ".join(path.split()))
+        if info is None:
+            raise KeyError(path)
+        return self.call_id(info.id, [arg.type for arg in info.all_args], *values)
+
+    def describe_id(self, command_id):
+        """Reads the table entry of one command, or None past the last id."""
+        self.send_frame(DESCRIBE, struct.pack("<H", command_id))
+        while True:
+            frame_type, body = self.receive_frame()
+            if frame_type == RESULT:
+                if body[0] == STATUS_UNKNOWN_COMMAND:
+                    return None
+                raise CommandError(body[0], body[1])
+            if frame_type == DESCRIPTION:
+                return self._parse_description(body)
+
+    def describe(self):
+        """Reads the whole command table; returns the commands by full name."""
+        by_id = {}
+        self.commands = {}
+        command_id = 0
+        while True:
+            entry = self.describe_id(command_id)
+            if entry is None:
+                break
+            parent_id, args, name, description = entry
+            parent = by_id.get(parent_id)
+            info = CommandInfo(command_id, parent, args, name, description)
+            by_id[command_id] = info
+            self.commands[info.path] = info
+            command_id += 1
+        return self.commands
+
+    @staticmethod
+    def _parse_description(body):
+        _, parent_id, count = struct.unpack_from("<HHB", body)
+        offset = 5
+        args = []
+        for _ in range(count):
+            arg_type, minimum, maximum = struct.unpack_from("<Bii", body, offset)
+            offset += 9
+            end = body.index(b"\0", offset)
+            args.append(Argument(arg_type, minimum, maximum, body[offset:end].decode()))
+            offset = end + 1
+        end = body.index(b"\0", offset)
+        name = body[offset:end].decode()
+        offset = end + 1
+        end = body.index(b"\0", offset)
+        description = body[offset:end].decode()
+        return parent_id, args, name, description
+
+
+def _identifier(text, fallback, parameter=False):
+    """Turns a command or argument name into a Python identifier."""
+    word = "".join(c if c.isalnum() else "_" for c in text).strip("_")
+    shadows = parameter and hasattr(builtins, word)
+    if not word or word[0].isdigit() or keyword.iskeyword(word) or shadows:
+        word = fallback if not word else fallback + "_" + word
+    return word
+
+
+def generate(commands, out):
+    """Writes a module with one method per command."""
+    out.write('"""Generated by serial_commands_client.py from the device command table."""\n\n')
+    out.write("from serial_commands_client import SerialCommandsClient\n\n\n")
+    out.write("class DeviceCommands:\n")
+    out.write('    """Commands of the device, called with binary frames."""\n\n')
+    out.write("    def __init__(self, port):\n")
+    out.write("        self.client = SerialCommandsClient(port)\n")
+    for info in sorted(commands.values(), key=lambda c: c.id):
+        names = [_identifier(word, "cmd%d" % info.id) for word in info.path.split()]
+        method = "_".join(names)
+        params = []
+        for number, arg in enumerate(info.all_args, 1):
+            param = _identifier(arg.name, "arg", parameter=True)
+            if param in params or param == "self":
+                param = "%s%d" % (param, number)
+            params.append(param)
+        types = [arg.type for arg in info.all_args]
+        out.write("\n    def %s(%s):\n" % (method, ", ".join(["self"] + params)))
+        out.write('        """%s\n\n        %s\n        """\n' % (info.description or info.path, info.syntax()))
+        out.write("        return self.client.call_id(%s)\n" % ", ".join([str(info.id), repr(types)] + params))
+
+
+def _parse_value(text):
+    for convert in (int, float):
+        try:
+            return convert(text)
+        except ValueError:
+            pass
+    return text
+
+
+def main():
+    parser = argparse.ArgumentParser(description="StaticSerialCommands binary client")
+    parser.add_argument("port", help="serial port, such as /dev/ttyUSB0 or COM3")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--timeout", type=float, default=1.0)
+    group = parser.add_mutually_exclusive_group(required=True)
+    group.add_argument("--list", action="store_true", help="print the command table")
+    group.add_argument("--call", nargs="+", metavar="ARG", help="command name, then its arguments")
+    group.add_argument("--generate", metavar="FILE", help="write a client module for the table")
+    options = parser.parse_args()
+
+    import serial
+
+    client = SerialCommandsClient(serial.Serial(options.port, options.baud, timeout=options.timeout))
+    commands = client.describe()
+
+    if options.list:
+        for info in sorted(commands.values(), key=lambda c: c.id):
+            ranges = ", ".join(
+                "%s %s %d..%d" % (arg.name, ARG_TYPE_NAMES.get(arg.type, "?"), arg.minimum, arg.maximum)
+                for arg in info.all_args
+            )
+            print("%3d  %-30s %s" % (info.id, info.syntax(), ranges))
+    elif options.generate:
+        with open(options.generate, "w") as out:
+            generate(commands, out)
+    else:
+        # The longest known command name at the front of the words is the command
+        words = options.call
+        for length in range(len(words), 0, -1):
+            info = commands.get(" ".join(words[:length]))
+            if info is not None:
+                break
+        else:
+            sys.exit("unknown command: %s" % " ".join(words))
+        values = [_parse_value(word) for word in words[length:]]
+        values = [
+            str(value) if arg.type == ARG_STRING else value for arg, value in zip(info.all_args, values)
+        ] + values[len(info.all_args):]
+        try:
+            sys.stdout.write(client.call(info.path, *values).decode(errors="replace"))
+        except CommandError as error:
+            sys.exit("error: %s" % error)
+
+
+if __name__ == "__main__":
+    main()
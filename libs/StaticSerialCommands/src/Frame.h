@@ -0,0 +1,93 @@
+/**
+ * @file Frame.h
+ * @brief Binary frame format of StaticSerialCommands.
+ *
+ * Machine clients can call commands with binary frames instead of text
+ * lines. A frame starting at the beginning of a line is recognized by its
+ * start byte, so both modes share one serial port:
+ *
+ * | Field  | Size   | Contents                                        |
+ * |--------|--------|-------------------------------------------------|
+ * | start  | 1      | CMD_FRAME_START                                 |
+ * | length | 1      | Size of type and body, 1-255                    |
+ * | type   | 1      | FrameType                                       |
+ * | body   | 0-254  | Depends on the type                             |
+ * | crc    | 2      | CRC-16-CCITT of length, type and body, LSB first |
+ *
+ * Multi-byte values are little-endian. Commands are numbered in depth-first
+ * order of the sorted command tree: a command is followed by its subcommands,
+ * then by its next sibling.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#ifndef STATIC_SERIAL_COMMANDS_FRAME_H
+#define STATIC_SERIAL_COMMANDS_FRAME_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Enable binary frames.
+ *
+ * Set to 0 to leave out the binary mode and keep only the text console.
+ */
+#ifndef SERIAL_COMMANDS_FRAMES
+#define SERIAL_COMMANDS_FRAMES 1
+#endif
+
+/**
+ * @brief First byte of a binary frame.
+ *
+ * Recognized only at the beginning of a line. It is not printable, so it
+ * does not appear in text commands.
+ */
+#define CMD_FRAME_START 0xA5
+
+/**
+ * @brief Types of binary frames.
+ */
+enum class FrameType : uint8_t
+{
+  Call = 0x01,       ///< Request: command id (2 bytes), then its arguments
+  Describe = 0x02,   ///< Request: command id (2 bytes)
+  Output = 0x81,     ///< Response: bytes the command printed
+  Result = 0x82,     ///< Response: FrameStatus, then the 1-based argument number or 0
+  Description = 0x83 ///< Response: the table entry of a command
+};
+
+/**
+ * @brief Outcome of a binary request, sent in the Result frame.
+ */
+enum class FrameStatus : uint8_t
+{
+  Ok,             ///< Command ran
+  UnknownCommand, ///< No command with that id
+  BadArguments,   ///< Arguments missing, malformed or left over
+  OutOfRange,     ///< Argument outside its range
+  BadCrc,         ///< Frame corrupted
+  TooLong,        ///< Frame larger than the command buffer
+  BadType         ///< Not a request type
+};
+
+namespace frame
+{
+  /**
+   * @brief Add a byte to a CRC-16-CCITT.
+   *
+   * Polynomial 0x1021, initial value 0xFFFF, no reflection.
+   *
+   * @param crc The CRC so far.
+   * @param data The next byte.
+   * @return The updated CRC.
+   */
+  inline uint16_t crc16(uint16_t crc, uint8_t data)
+  {
+    crc ^= (uint16_t)data << 8;
+    for (uint8_t i = 0; i < 8; ++i)
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    return crc;
+  }
+}
+
+#endif // STATIC_SERIAL_COMMANDS_FRAME_H
@@ -7,12 +7,27 @@ Repository     : https://github.com/naszly/Arduino-StaticSerialCommands
 #include "Parse.h"
 #include "StaticSerialCommands.h"
 
+namespace
+{
+  // Compares two names in program memory like strcmp
+  int compareNamesPgm(PGM_P a, PGM_P b)
+  {
+    while (true)
+    {
+      const uint8_t ca = pgm_read_byte(a++);
+      const uint8_t cb = pgm_read_byte(b++);
+      if (ca != cb || ca == '\0')
+        return (int)ca - (int)cb;
+    }
+  }
+}
+
 void SerialCommands::printCommand(const Command &command)
 {
   if (command.hasParent())
   {
     printCommand(command.getParent());
-    serial->print(' ');
+    output->print(' ');
   }
 
   printFromPgm(command.getCommandPgm());
@@ -23,10 +38,10 @@ void SerialCommands::printCommand(const Command &command)
   for (uint16_t j = 0; j < count; ++j)
   {
     memcpy_P(&argc, &argcs[j], sizeof(impl::ArgConstraint));
-    serial->print(' ');
-    serial->print('<');
+    output->print(' ');
+    output->print('<');
     printFromPgm(argc.getNamePgm());
-    serial->print('>');
+    output->print('>');
   }
 }
 
@@ -37,28 +52,32 @@ void SerialCommands::printCommandDescription(const Command &command)
 
 void SerialCommands::listCommands(const Command *commands, uint16_t commandsCount)
 {
+  const uint8_t *order = sortedOrder(commands);
   for (uint16_t i = 0; i < commandsCount; ++i)
   {
-    printCommand(commands[i]);
-    serial->print(F(" - "));
-    printCommandDescription(commands[i]);
-    serial->println();
+    const Command &command = commands[order != nullptr ? order[i] : i];
+    printCommand(command);
+    output->print(F(" - "));
+    printCommandDescription(command);
+    output->println();
   }
 }
 
 void SerialCommands::listAllCommands(const Command *commands, uint16_t commandsCount)
 {
+  const uint8_t *order = sortedOrder(commands);
   const Command *subcmds;
   uint16_t subcmdCount;
   for (uint16_t i = 0; i < commandsCount; ++i)
   {
-    printCommand(commands[i]);
-    serial->print(F(" - "));
-    printCommandDescription(commands[i]);
-    serial->println();
+    const Command &command = commands[order != nullptr ? order[i] : i];
+    printCommand(command);
+    output->print(F(" - "));
+    printCommandDescription(command);
+    output->println();
 
     subcmds = nullptr;
-    commands[i].getSubCommands(&subcmds, &subcmdCount);
+    command.getSubCommands(&subcmds, &subcmdCount);
     if (subcmds != nullptr)
     {
       listAllCommands(subcmds, subcmdCount);
@@ -68,234 +87,825 @@ void SerialCommands::listAllCommands(const Command *commands, uint16_t commandsC
 
 void SerialCommands::readSerial()
 {
-  static uint16_t index = 0;
-  static uint64_t lastTime = millis();
+  sortCommands();
 
-  if (timeout != 0 && lastTime + timeout < millis())
+  if (timeout != 0 && millis() - lastTime > timeout &&
+      (lexState != LexState::Between || cmd != nullptr))
   {
-    index = 0;
+    resetLine();
   }
 
   while (serial->available())
   {
     lastTime = millis();
-    int ch = serial->read();
-    if (isTerm(ch))
+    processChar(serial->read());
+  }
+}
+
+void SerialCommands::processChar(char ch)
+{
+#if SERIAL_COMMANDS_FRAMES
+  if (lexState >= LexState::FrameLength)
+  {
+    processFrameByte(ch);
+    return;
+  }
+  if (lexState == LexState::Between && cmd == nullptr && (uint8_t)ch == CMD_FRAME_START)
+  {
+    lexState = LexState::FrameLength;
+    return;
+  }
+#endif
+
+  if (isTerm(ch))
+  {
+    endLine();
+    return;
+  }
+
+  switch (lexState)
+  {
+  case LexState::Between:
+    if (isDelim(ch))
+      return;
+    if (index >= bufferSize || !startToken())
     {
-      if (index > 0)
-      {
-        buffer[index] = '\0';
-        parseCommand(buffer);
-        index = 0;
-      }
+      serial->println(F("ERROR: Buffer overflow"));
+      skipLine(false);
+      return;
     }
-    else if (index < bufferSize)
+    if (isQuotation(ch))
     {
-      buffer[index] = ch;
-      index++;
+      quote = ch;
+      lexState = LexState::Quoted;
     }
     else
     {
-      serial->println(F("ERROR: Buffer overflow"));
-      index = 0;
+      lexState = LexState::Token;
+      addChar(ch);
     }
+    break;
+
+  case LexState::Token:
+    if (isDelim(ch))
+      endToken();
+    else
+      addChar(ch);
+    break;
+
+  case LexState::Quoted:
+    if (ch == quote)
+      endToken();
+    else
+      addChar(ch);
+    break;
+
+  default:
+    break;
   }
 }
 
-const Command *SerialCommands::findCommand(const char *const string, const Command *commands, uint16_t commandsCount)
+bool SerialCommands::startToken()
 {
-  uint16_t len = strlen(string);
-  uint16_t index;
-  uint16_t count = 0;
-  for (uint16_t i = 0; i < commandsCount; ++i)
+  number = 0;
+  tokenType = ArgType::Null;
+  if (cmd != nullptr && cmdArgIndex < argCount)
   {
-    PGM_P cmd = commands[i].getCommandPgm();
-    if (memcmp_P(string, cmd, len + 1) == 0)
-      return &commands[i];
-    if (memcmp_P(string, cmd, len) == 0)
-    {
-      ++count;
-      index = i;
-    }
+    // An argument is stored behind its type; keep room for a terminating null
+    tokenType = (ArgType)pgm_read_byte(&argcs[cmdArgIndex].type);
+    if (index + 2 > bufferSize)
+      return false;
+    buffer[index++] = (char)tokenType;
   }
-  if (count == 1)
-    return &commands[index];
-  return nullptr;
+  tokenStart = index;
+  return true;
 }
 
-bool SerialCommands::processArguments(const Command *cmd, char **string, Args &args, uint8_t &argIndex)
+void SerialCommands::addChar(char ch)
 {
-  uint8_t argCount;
-  const impl::ArgConstraint *argcs = cmd->getArgsPgm(&argCount);
-  impl::ArgConstraint argc;
-  for (uint8_t i = 0; i < argCount; ++i)
+  if (index >= bufferSize - 1)
   {
-    memcpy_P(&argc, &argcs[i], sizeof(impl::ArgConstraint));
-    char *token = getToken(string);
-    if (token == nullptr)
+    serial->println(F("ERROR: Buffer overflow"));
+    skipLine(false);
+    return;
+  }
+
+  if (tokenType == ArgType::Int && !((ch == '-' || ch == '+') && index == tokenStart))
+  {
+    // Reject a bad digit or an overflow as soon as it arrives
+    const uint8_t d = ch - '0';
+    const bool negative = index > tokenStart && buffer[tokenStart] == '-';
+    const uint32_t limit = negative ? 2147483648UL : 2147483647UL;
+    if (d > 9 || number > (limit - d) / 10)
     {
-      serial->println(F("ERROR: Not enough arguments"));
-      printCommand(*cmd);
-      serial->println();
-      return false;
+      serial->print(F("ERROR: Can't parse argument "));
+      serial->println(argIndex + 1);
+      skipLine(true);
+      return;
     }
-    if (!getArg(args[argIndex], token, argc))
+    number = number * 10 + d;
+  }
+
+  buffer[index++] = ch;
+}
+
+void SerialCommands::endToken()
+{
+  lexState = LexState::Between;
+  buffer[index] = '\0';
+  const char *token = buffer + tokenStart;
+
+  switch (tokenType)
+  {
+  case ArgType::Null:
+    processName(token);
+    index = tokenStart;
+    break;
+
+  case ArgType::Int:
+    // Every character was checked; a digit must end the token
+    if (index == tokenStart || buffer[index - 1] < '0' || buffer[index - 1] > '9')
     {
       serial->print(F("ERROR: Can't parse argument "));
       serial->println(argIndex + 1);
-      printCommand(*cmd);
-      serial->println();
-      return false;
+      skipLine(true);
+      return;
     }
-    if (!argc.isInRange(args[argIndex]))
+    processArg(Arg(buffer[tokenStart] == '-' ? (int32_t)(0UL - number) : (int32_t)number));
+    break;
+
+  case ArgType::Float:
+  {
+    float value;
+    if (!parse::strtof(token, &value))
     {
-      serial->print(F("ERROR: Argument out of range "));
-      serial->print(argIndex + 1);
-      impl::Range range = argc.getRange();
-      serial->print(F(" ("));
-      serial->print(range.minimum);
-      serial->print(F(" - "));
-      serial->print(range.maximum);
-      serial->println(')');
-      printCommand(*cmd);
-      serial->println();
-      return false;
+      serial->print(F("ERROR: Can't parse argument "));
+      serial->println(argIndex + 1);
+      skipLine(true);
+      return;
     }
-    argIndex++;
+    processArg(Arg(value));
+  }
+  break;
+
+  default:
+    processArg(Arg(token));
+    break;
   }
-  return true;
 }
 
-void SerialCommands::parseCommand(char *string)
+void SerialCommands::processName(const char *name)
 {
-  char *token;
-  uint8_t argIndex = 0;
-  Args args{};
-  const Command *cmd = nullptr;
   const Command *cmds = this->commands;
   uint16_t cmdsCount = commandsCount;
+  if (cmd != nullptr)
+  {
+    cmds = nullptr;
+    cmd->getSubCommands(&cmds, &cmdsCount);
+    if (cmds == nullptr)
+    {
+      serial->println(F("ERROR: Too many arguments"));
+      skipLine(true);
+      return;
+    }
+  }
+
+  const Command *found = findCommand(name, cmds, cmdsCount);
+  if (found == nullptr)
+  {
+    serial->print(F("ERROR: Command does not exist \""));
+    serial->print(name);
+    serial->println('"');
+    skipLine(false);
+    return;
+  }
+
+  cmd = found;
+  argcs = cmd->getArgsPgm(&argCount);
+  cmdArgIndex = 0;
+}
 
-  token = getToken(&string);
-  while (token != nullptr)
+void SerialCommands::processArg(Arg arg)
+{
+  impl::ArgConstraint argc;
+  memcpy_P(&argc, &argcs[cmdArgIndex], sizeof(impl::ArgConstraint));
+  if (!argc.isInRange(arg))
+  {
+    serial->print(F("ERROR: Argument out of range "));
+    serial->print(argIndex + 1);
+    impl::Range range = argc.getRange();
+    serial->print(F(" ("));
+    serial->print(range.minimum);
+    serial->print(F(" - "));
+    serial->print(range.maximum);
+    serial->println(')');
+    skipLine(true);
+    return;
+  }
+  if (argIndex >= MAX_ARGS)
   {
-    cmd = findCommand(token, cmds, cmdsCount);
-    if (cmd != nullptr)
+    serial->println(F("ERROR: Too many arguments"));
+    skipLine(true);
+    return;
+  }
+
+  // Strings stay as received; numbers replace their text with their value
+  if (arg.getType() == ArgType::String)
+  {
+    index++;
+  }
+  else
+  {
+    if (tokenStart + 4 > bufferSize)
     {
-      if (!processArguments(cmd, &string, args, argIndex))
-        return;
+      serial->println(F("ERROR: Buffer overflow"));
+      skipLine(false);
+      return;
+    }
+    if (arg.getType() == ArgType::Int)
+    {
+      const int32_t value = arg.getInt();
+      memcpy(buffer + tokenStart, &value, 4);
+    }
+    else
+    {
+      const float value = arg.getFloat();
+      memcpy(buffer + tokenStart, &value, 4);
+    }
+    index = tokenStart + 4;
+  }
+  argIndex++;
+  cmdArgIndex++;
+}
 
-      cmd->getSubCommands(&cmds, &cmdsCount);
-      token = getToken(&string);
-      if (cmds == nullptr)
-      {
-        if (token != nullptr)
-        {
-          serial->println(F("ERROR: Too many arguments"));
-          printCommand(*cmd);
-          serial->println();
-          return;
-        }
-        cmd->runCommand(*this, args);
-        return;
-      }
-      else if (token == nullptr)
-      {
-        cmd->runCommand(*this, args);
-        return;
-      }
+void SerialCommands::endLine()
+{
+  if (lexState == LexState::Token || lexState == LexState::Quoted)
+    endToken();
+
+  if (lexState != LexState::Discard && cmd != nullptr)
+  {
+    if (cmdArgIndex < argCount)
+    {
+      serial->println(F("ERROR: Not enough arguments"));
+      skipLine(true);
     }
     else
     {
-      serial->print(F("ERROR: Command does not exist \""));
-      serial->print(token);
-      serial->println('"');
-      return;
+      Args args;
+      loadArgs(args);
+      cmd->runCommand(*this, args);
     }
   }
+  resetLine();
 }
 
-char *SerialCommands::getToken(char **stringp)
+void SerialCommands::loadArgs(Args &args)
 {
-  char *begin, *end;
-  begin = *stringp;
-  if (begin == nullptr)
-    return nullptr;
+  uint16_t i = 0;
+  for (uint8_t n = 0; n < argIndex; ++n)
+  {
+    const ArgType type = (ArgType)buffer[i++];
+    if (type == ArgType::Int)
+    {
+      int32_t value;
+      memcpy(&value, buffer + i, 4);
+      args[n] = Arg(value);
+      i += 4;
+    }
+    else if (type == ArgType::Float)
+    {
+      float value;
+      memcpy(&value, buffer + i, 4);
+      args[n] = Arg(value);
+      i += 4;
+    }
+    else
+    {
+      args[n] = Arg(buffer + i);
+      i += strlen(buffer + i) + 1;
+    }
+  }
+}
 
-  while (isDelim(*begin))
-    begin++;
+void SerialCommands::resetLine()
+{
+  lexState = LexState::Between;
+  index = 0;
+  cmd = nullptr;
+  argCount = 0;
+  cmdArgIndex = 0;
+  argIndex = 0;
+}
 
-  if (isQuotation(*begin))
+void SerialCommands::skipLine(bool printSyntax)
+{
+  if (printSyntax)
   {
-    const char quote = *begin;
-    begin++;
-    end = begin;
-    while (*end != quote && *end != '\0')
-      end++;
+    printCommand(*cmd);
+    output->println();
+  }
+  lexState = LexState::Discard;
+}
 
-    if (*end == quote)
+SerialCommands::~SerialCommands()
+{
+  free(sortedTables);
+}
+
+void SerialCommands::sortCommands()
+{
+#if SERIAL_COMMANDS_SORTED_LOOKUP
+  if (sorted)
+    return;
+  sorted = true;
+
+  uint16_t tables = 0;
+  uint16_t entries = 0;
+  countTables(commands, commandsCount, &tables, &entries);
+  if (tables == 0 || tables > 255)
+    return;
+
+  // Without the memory every table is searched linearly
+  sortedTables = static_cast<SortedTable *>(malloc(tables * sizeof(SortedTable) + entries));
+  if (sortedTables == nullptr)
+    return;
+  uint8_t *order = reinterpret_cast<uint8_t *>(sortedTables + tables);
+  sortTables(commands, commandsCount, &order);
+#endif
+}
+
+void SerialCommands::countTables(const Command *commands, uint16_t commandsCount, uint16_t *tables, uint16_t *entries)
+{
+  // A single command needs no order; positions are stored in one byte
+  if (commandsCount > 1 && commandsCount <= 256)
+  {
+    ++*tables;
+    *entries += commandsCount;
+  }
+
+  const Command *subcmds;
+  uint16_t subcmdCount;
+  for (uint16_t i = 0; i < commandsCount; ++i)
+  {
+    subcmds = nullptr;
+    commands[i].getSubCommands(&subcmds, &subcmdCount);
+    if (subcmds != nullptr)
     {
-      *end = '\0';
-      end++;
+      countTables(subcmds, subcmdCount, tables, entries);
     }
   }
-  else
+}
+
+void SerialCommands::sortTables(const Command *commands, uint16_t commandsCount, uint8_t **order)
+{
+  // A table shared by several commands is sorted once
+  if (commandsCount > 1 && commandsCount <= 256 && sortedOrder(commands) == nullptr)
   {
-    end = begin;
-    while (!isDelim(*end) && *end != '\0')
-      end++;
+    uint8_t *positions = *order;
+    *order += commandsCount;
+
+    // Insertion sort of the positions: the table is left as declared
+    for (uint16_t i = 0; i < commandsCount; ++i)
+    {
+      PGM_P name = commands[i].getCommandPgm();
+      uint16_t j = i;
+      while (j > 0 && compareNamesPgm(commands[positions[j - 1]].getCommandPgm(), name) > 0)
+      {
+        positions[j] = positions[j - 1];
+        --j;
+      }
+      positions[j] = i;
+    }
+    sortedTables[sortedTableCount].commands = commands;
+    sortedTables[sortedTableCount].order = positions;
+    sortedTableCount++;
   }
 
-  while (isDelim(*end))
+  const Command *subcmds;
+  uint16_t subcmdCount;
+  for (uint16_t i = 0; i < commandsCount; ++i)
   {
-    *end = '\0';
-    end++;
+    subcmds = nullptr;
+    commands[i].getSubCommands(&subcmds, &subcmdCount);
+    if (subcmds != nullptr)
+    {
+      sortTables(subcmds, subcmdCount, order);
+    }
   }
+}
 
-  if (*end != '\0')
-    *stringp = end;
-  else
-    *stringp = nullptr;
-
-  return begin;
+const uint8_t *SerialCommands::sortedOrder(const Command *commands) const
+{
+  for (uint8_t i = 0; i < sortedTableCount; ++i)
+  {
+    if (sortedTables[i].commands == commands)
+      return sortedTables[i].order;
+  }
+  return nullptr;
 }
 
-bool SerialCommands::getArg(Arg &out, const char *string, const impl::ArgConstraint &arg)
+const Command *SerialCommands::findCommand(const char *const string, const Command *commands, uint16_t commandsCount)
 {
-  switch (arg.type)
+  uint16_t len = strlen(string);
+#if SERIAL_COMMANDS_SORTED_LOOKUP
+  const uint8_t *order = sortedOrder(commands);
+  if (order != nullptr)
   {
-  case ArgType::String:
-    out = Arg(string);
-    return true;
+    // First name not below the string; names starting with it follow from here
+    uint16_t low = 0;
+    uint16_t high = commandsCount;
+    while (low < high)
+    {
+      const uint16_t middle = low + (high - low) / 2;
+      if (strcmp_P(string, commands[order[middle]].getCommandPgm()) > 0)
+        low = middle + 1;
+      else
+        high = middle;
+    }
+    if (low == commandsCount)
+      return nullptr;
 
-  case ArgType::Int:
+    PGM_P cmd = commands[order[low]].getCommandPgm();
+    if (strncmp_P(string, cmd, len) != 0)
+      return nullptr;
+
+    // An exact match sorts first; a prefix must not start the next name too
+    if (pgm_read_byte(cmd + len) == '\0' ||
+        low + 1 == commandsCount ||
+        strncmp_P(string, commands[order[low + 1]].getCommandPgm(), len) != 0)
+      return &commands[order[low]];
+    return nullptr;
+  }
+#endif
+
+  uint16_t index;
+  uint16_t count = 0;
+  for (uint16_t i = 0; i < commandsCount; ++i)
   {
-    int32_t value;
-    if (parse::strtoi(string, &value))
+    PGM_P cmd = commands[i].getCommandPgm();
+    if (memcmp_P(string, cmd, len + 1) == 0)
+      return &commands[i];
+    if (memcmp_P(string, cmd, len) == 0)
     {
-      out = Arg(value);
-      return true;
+      ++count;
+      index = i;
     }
   }
-  break;
+  if (count == 1)
+    return &commands[index];
+  return nullptr;
+}
 
-  case ArgType::Float:
+#if SERIAL_COMMANDS_FRAMES
+void SerialCommands::processFrameByte(uint8_t b)
+{
+  switch (lexState)
   {
-    float value_f;
-    if (parse::strtof(string, &value_f))
+  case LexState::FrameLength:
+    if (b == 0)
     {
-      out = Arg(value_f);
-      return true;
+      lexState = LexState::Between;
+      return;
     }
+    frameLength = b;
+    frameCrc = frame::crc16(0xFFFF, b);
+    index = 0;
+    lexState = LexState::FrameBody;
+    break;
+
+  case LexState::FrameBody:
+    // A frame too long for the buffer is still received to its end, then refused
+    frameCrc = frame::crc16(frameCrc, b);
+    if (index < bufferSize)
+      buffer[index] = b;
+    if (++index == frameLength)
+      lexState = LexState::FrameCrcLow;
+    break;
+
+  case LexState::FrameCrcLow:
+    frameCrc ^= b;
+    lexState = LexState::FrameCrcHigh;
+    break;
+
+  default:
+    frameCrc ^= (uint16_t)b << 8;
+    processFrame();
+    resetLine();
+    break;
   }
-  break;
+}
 
+void SerialCommands::processFrame()
+{
+  if (frameCrc != 0)
+  {
+    sendResult(FrameStatus::BadCrc, 0);
+    return;
+  }
+  if (frameLength > bufferSize)
+  {
+    sendResult(FrameStatus::TooLong, 0);
+    return;
+  }
+
+  switch ((FrameType)buffer[0])
+  {
+  case FrameType::Call:
+    callFrame();
+    break;
+  case FrameType::Describe:
+    describeFrame();
+    break;
   default:
+    sendResult(FrameStatus::BadType, 0);
     break;
   }
-  return false;
 }
 
+void SerialCommands::callFrame()
+{
+  if (frameLength < 3)
+  {
+    sendResult(FrameStatus::BadArguments, 0);
+    return;
+  }
+
+  const uint16_t id = (uint8_t)buffer[1] | (uint16_t)(uint8_t)buffer[2] << 8;
+  frameRead = 3;
+  Args args;
+  const Command *command = commandById(id, nullptr, &args);
+  if (command == nullptr)
+  {
+    sendResult(frameStatus, frameArg);
+    return;
+  }
+  if (frameRead != frameLength)
+  {
+    sendResult(FrameStatus::BadArguments, 0);
+    return;
+  }
+
+  outputLength = 0;
+  output = &frameOutput;
+  command->runCommand(*this, args);
+  flushOutput();
+  output = serial;
+  sendResult(FrameStatus::Ok, 0);
+}
+
+void SerialCommands::describeFrame()
+{
+  if (frameLength != 3)
+  {
+    sendResult(FrameStatus::BadArguments, 0);
+    return;
+  }
+
+  const uint16_t id = (uint8_t)buffer[1] | (uint16_t)(uint8_t)buffer[2] << 8;
+  uint16_t parentId;
+  const Command *command = commandById(id, &parentId, nullptr);
+  if (command == nullptr)
+  {
+    sendResult(frameStatus, 0);
+    return;
+  }
+
+  // Type, id, parent id and argument count, then the arguments and two strings
+  uint8_t count;
+  const impl::ArgConstraint *argcs = command->getArgsPgm(&count);
+  impl::ArgConstraint argc;
+  uint16_t length = 6;
+  for (uint8_t i = 0; i < count; ++i)
+  {
+    memcpy_P(&argc, &argcs[i], sizeof(impl::ArgConstraint));
+    length += 9 + strlen_P(argc.getNamePgm()) + 1;
+  }
+  const uint16_t nameLength = strlen_P(command->getCommandPgm());
+  length += nameLength + 1;
+  uint16_t descriptionLength = strlen_P(command->getDescriptionPgm());
+  if (length + 1 > 255)
+  {
+    sendResult(FrameStatus::TooLong, 0);
+    return;
+  }
+  // A long description is cut to fit the frame
+  if (length + descriptionLength + 1 > 255)
+    descriptionLength = 255 - length - 1;
+  length += descriptionLength + 1;
+
+  beginFrame(FrameType::Description, length);
+  writeFrame(&id, 2);
+  writeFrame(&parentId, 2);
+  writeFrame(&count, 1);
+  for (uint8_t i = 0; i < count; ++i)
+  {
+    memcpy_P(&argc, &argcs[i], sizeof(impl::ArgConstraint));
+    const impl::Range range = argc.getRange();
+    writeFrame(&argc.type, 1);
+    writeFrame(&range.minimum, 4);
+    writeFrame(&range.maximum, 4);
+    writeFramePgm(argc.getNamePgm(), strlen_P(argc.getNamePgm()));
+  }
+  writeFramePgm(command->getCommandPgm(), nameLength);
+  writeFramePgm(command->getDescriptionPgm(), descriptionLength);
+  endFrame();
+}
+
+const Command *SerialCommands::commandById(uint16_t id, uint16_t *parentId, Args *args)
+{
+  const Command *cmds = commands;
+  uint16_t cmdsCount = commandsCount;
+  uint16_t base = 0;
+  uint16_t parent = 0xFFFF;
+
+  while (cmds != nullptr)
+  {
+    // Skip the siblings whose subtrees end before the id
+    uint16_t i = 0;
+    for (; i < cmdsCount; ++i)
+    {
+      const uint16_t size = subtreeSize(cmds[i]);
+      if (id < base + size)
+        break;
+      base += size;
+    }
+    if (i == cmdsCount)
+      break;
+
+    const Command *command = &cmds[i];
+    if (args != nullptr && !decodeArgs(command, *args))
+      return nullptr;
+    if (id == base)
+    {
+      if (parentId != nullptr)
+        *parentId = parent;
+      return command;
+    }
+
+    parent = base;
+    base++;
+    cmds = nullptr;
+    command->getSubCommands(&cmds, &cmdsCount);
+  }
+
+  frameStatus = FrameStatus::UnknownCommand;
+  return nullptr;
+}
+
+uint16_t SerialCommands::subtreeSize(const Command &command)
+{
+  uint16_t size = 1;
+  const Command *subcmds = nullptr;
+  uint16_t subcmdCount;
+  command.getSubCommands(&subcmds, &subcmdCount);
+  if (subcmds != nullptr)
+  {
+    for (uint16_t i = 0; i < subcmdCount; ++i)
+      size += subtreeSize(subcmds[i]);
+  }
+  return size;
+}
+
+bool SerialCommands::decodeArgs(const Command *command, Args &args)
+{
+  uint8_t count;
+  const impl::ArgConstraint *argcs = command->getArgsPgm(&count);
+  impl::ArgConstraint argc;
+  for (uint8_t i = 0; i < count; ++i)
+  {
+    memcpy_P(&argc, &argcs[i], sizeof(impl::ArgConstraint));
+    frameArg = argIndex + 1;
+    frameStatus = FrameStatus::BadArguments;
+    if (argIndex >= MAX_ARGS)
+      return false;
+
+    const uint8_t left = frameLength - frameRead;
+    const char *data = buffer + frameRead;
+    Arg arg;
+    switch (argc.type)
+    {
+    case ArgType::Int:
+    case ArgType::Float:
+    {
+      if (left < 4)
+        return false;
+      if (argc.type == ArgType::Int)
+      {
+        int32_t value;
+        memcpy(&value, data, 4);
+        arg = Arg(value);
+      }
+      else
+      {
+        float value;
+        memcpy(&value, data, 4);
+        arg = Arg(value);
+      }
+      frameRead += 4;
+      if (!argc.isInRange(arg))
+      {
+        frameStatus = FrameStatus::OutOfRange;
+        return false;
+      }
+    }
+    break;
+
+    case ArgType::String:
+    {
+      // Sent with its terminating null, so it is used in place
+      const char *end = (const char *)memchr(data, '\0', left);
+      if (end == nullptr)
+        return false;
+      arg = Arg(data);
+      frameRead += end - data + 1;
+    }
+    break;
+
+    default:
+      return false;
+    }
+    args[argIndex++] = arg;
+  }
+  frameStatus = FrameStatus::Ok;
+  frameArg = 0;
+  return true;
+}
+
+void SerialCommands::sendResult(FrameStatus status, uint8_t arg)
+{
+  beginFrame(FrameType::Result, 3);
+  writeFrame(&status, 1);
+  writeFrame(&arg, 1);
+  endFrame();
+}
+
+void SerialCommands::beginFrame(FrameType type, uint8_t length)
+{
+  serial->write((uint8_t)CMD_FRAME_START);
+  serial->write(length);
+  frameCrc = frame::crc16(0xFFFF, length);
+  writeFrame(&type, 1);
+}
+
+void SerialCommands::writeFrame(const void *data, uint8_t length)
+{
+  const uint8_t *bytes = (const uint8_t *)data;
+  for (uint8_t i = 0; i < length; ++i)
+  {
+    serial->write(bytes[i]);
+    frameCrc = frame::crc16(frameCrc, bytes[i]);
+  }
+}
+
+void SerialCommands::writeFramePgm(PGM_P str, uint8_t length)
+{
+  for (uint8_t i = 0; i < length; ++i)
+  {
+    const uint8_t c = pgm_read_byte(str + i);
+    writeFrame(&c, 1);
+  }
+  const uint8_t terminator = 0;
+  writeFrame(&terminator, 1);
+}
+
+void SerialCommands::endFrame()
+{
+  serial->write((uint8_t)(frameCrc & 0xFF));
+  serial->write((uint8_t)(frameCrc >> 8));
+}
+
+void SerialCommands::writeOutput(uint8_t b)
+{
+  // Output is collected behind the request in the buffer
+  uint16_t capacity = bufferSize - frameLength;
+  if (capacity > 254)
+    capacity = 254;
+  if (capacity == 0)
+  {
+    beginFrame(FrameType::Output, 2);
+    writeFrame(&b, 1);
+    endFrame();
+    return;
+  }
+
+  buffer[frameLength + outputLength++] = b;
+  if (outputLength == capacity)
+    flushOutput();
+}
+
+void SerialCommands::flushOutput()
+{
+  if (outputLength == 0)
+    return;
+  beginFrame(FrameType::Output, outputLength + 1);
+  writeFrame(buffer + frameLength, outputLength);
+  endFrame();
+  outputLength = 0;
+}
+#endif
+
 void SerialCommands::printFromPgm(PGM_P str)
 {
-  serial->print(reinterpret_cast<const __FlashStringHelper *>(str));
+  output->print(reinterpret_cast<const __FlashStringHelper *>(str));
 }
@@ -22,6 +22,7 @@ Repository     : https://github.com/naszly/Arduino-StaticSerialCommands
 
 #include <Arduino.h>
 #include "Command.h"
+#include "Frame.h"
 
 /**
  * @brief Macro to create a SerialCommands instance with a given serial port and command array.
@@ -50,12 +51,33 @@ Repository     : https://github.com/naszly/Arduino-StaticSerialCommands
  */
 #define CMD_TERM_2 '\r'
 
+/**
+ * @brief Look commands up by binary search.
+ *
+ * When 1 (default), the name order of every command table reachable from
+ * the registered commands is worked out once, before the first command is
+ * parsed or listed. The tables themselves are not changed: the order is kept
+ * as one byte per command on the heap, plus a few bytes per table. Each
+ * lookup then takes log2(n) name comparisons instead of two per command, and
+ * listings come out in alphabetical order. Tables of more than 256 commands,
+ * or all tables if the allocation fails, are searched linearly. Set it to 0
+ * to keep the declared order and search linearly.
+ */
+#ifndef SERIAL_COMMANDS_SORTED_LOOKUP
+#define SERIAL_COMMANDS_SORTED_LOOKUP 1
+#endif
+
 /**
  * @brief Main class for handling serial commands.
  *
  * This class provides functionality to parse and execute commands received
  * over a serial interface. It supports command hierarchies, argument validation,
  * and help text generation.
+ *
+ * Besides the buffer, an instance takes about 50 bytes of RAM on AVR, about
+ * 70 with SERIAL_COMMANDS_FRAMES. The arguments of a line are kept in the
+ * buffer; the Args given to a command (MAX_ARGS * sizeof(Arg) bytes) is on
+ * the stack only while the command runs.
  */
 class SerialCommands
 {
@@ -79,7 +101,7 @@ public:
    * @param timeout Timeout in milliseconds for command input (0 for no timeout).
    */
   SerialCommands(Stream &serial, const Command *commands, uint16_t commandsCount, char *buffer, uint16_t bufferSize, uint16_t timeout = 0)
-      : serial(&serial), buffer(buffer), bufferSize(bufferSize),
+      : serial(&serial), output(&serial), buffer(buffer), bufferSize(bufferSize),
         commands(commands), commandsCount(commandsCount),
         timeout(timeout) {}
 
@@ -91,14 +113,22 @@ public:
    * @param commandsCount Number of commands in the array.
    */
   SerialCommands(Stream &serial, const Command *commands, uint16_t commandsCount)
-      : serial(&serial),
+      : serial(&serial), output(&serial),
         commands(commands), commandsCount(commandsCount), timeout(0)
   {
     static char tmpBffer[64];
     this->buffer = tmpBffer;
-    bufferSize = sizeof(buffer);
+    bufferSize = sizeof(tmpBffer);
   }
 
+  /**
+   * @brief Destructor. Frees the name order of the command tables.
+   */
+  ~SerialCommands();
+
+  SerialCommands(const SerialCommands &) = delete;
+  SerialCommands &operator=(const SerialCommands &) = delete;
+
   /**
    * @brief Print a command's syntax.
    *
@@ -144,6 +174,7 @@ public:
    */
   void listCommands()
   {
+    sortCommands();
     listCommands(commands, commandsCount);
   }
 
@@ -154,6 +185,7 @@ public:
    */
   void listAllCommands()
   {
+    sortCommands();
     listAllCommands(commands, commandsCount);
   }
 
@@ -161,17 +193,24 @@ public:
    * @brief Read and process commands from the serial interface.
    *
    * This method should be called regularly to check for and process incoming commands.
+   * Each character is tokenized as it arrives: command names are looked up and
+   * arguments are parsed and range-checked as soon as their token ends, and the
+   * command runs when the terminator arrives. Errors are reported at once and
+   * the rest of the line is skipped.
    */
   void readSerial();
 
   /**
    * @brief Get the Stream object used for communication.
    *
+   * While a command called by a binary frame runs, this is a stream that
+   * sends what the command prints in Output frames.
+   *
    * @return Reference to the Stream object.
    */
   Stream &getSerial()
   {
-    return *serial;
+    return *output;
   }
 
   /**
@@ -238,12 +277,88 @@ public:
   }
 
 private:
+#if SERIAL_COMMANDS_FRAMES
+  /**
+   * @brief Stream given to commands called by binary frames.
+   *
+   * Reads come from the serial port; writes are collected into Output frames.
+   */
+  class FrameOutput : public Stream
+  {
+  public:
+    explicit FrameOutput(SerialCommands *owner) : owner(owner) {}
+    size_t write(uint8_t b) override
+    {
+      owner->writeOutput(b);
+      return 1;
+    }
+    int available() override { return owner->serial->available(); }
+    int read() override { return owner->serial->read(); }
+    int peek() override { return owner->serial->peek(); }
+
+  private:
+    SerialCommands *owner; ///< Commands instance sending the frames
+  };
+#endif
+
   Stream *const serial;         ///< Stream for communication
+  Stream *output;               ///< Stream commands and listings print to
   char *buffer;                 ///< Buffer for command processing
   uint16_t bufferSize;          ///< Size of the buffer
   const Command *commands;      ///< Array of registered commands
   const uint16_t commandsCount; ///< Number of registered commands
   const uint16_t timeout;       ///< Timeout for command input
+  bool sorted = false;          ///< Name order of the command tables has been worked out
+
+  /**
+   * @brief Name order of one command table.
+   */
+  struct SortedTable
+  {
+    const Command *commands; ///< The command table
+    uint8_t *order;          ///< Table positions in name order
+  };
+
+  SortedTable *sortedTables = nullptr; ///< Sorted tables, followed by their orders, in one allocation
+  uint8_t sortedTableCount = 0;        ///< Number of sorted tables
+
+  /**
+   * @brief Tokenizer states.
+   */
+  enum class LexState : uint8_t
+  {
+    Between,     ///< Skipping delimiters before the next token
+    Token,       ///< Inside an unquoted token
+    Quoted,      ///< Inside a quoted token
+    Discard,     ///< Skipping the rest of a line with an error
+    FrameLength, ///< Expecting the length of a binary frame
+    FrameBody,   ///< Receiving the type and body of a binary frame
+    FrameCrcLow, ///< Expecting the low byte of the frame CRC
+    FrameCrcHigh ///< Expecting the high byte of the frame CRC
+  };
+
+  LexState lexState = LexState::Between;       ///< Tokenizer state
+  char quote = '\0';                           ///< Quotation character that opened the token
+  ArgType tokenType = ArgType::Null;           ///< Expected token, Null for a command name
+  uint16_t index = 0;                          ///< Next free byte of the buffer
+  uint16_t tokenStart = 0;                     ///< Buffer position of the current token
+  uint32_t number = 0;                         ///< Magnitude of an integer token so far
+  uint32_t lastTime = 0;                       ///< Time the last character arrived
+  const Command *cmd = nullptr;                ///< Command matched so far, nullptr before the first name
+  const impl::ArgConstraint *argcs = nullptr;  ///< Argument constraints of cmd
+  uint8_t argCount = 0;                        ///< Number of arguments of cmd
+  uint8_t cmdArgIndex = 0;                     ///< Arguments of cmd received so far
+  uint8_t argIndex = 0;                        ///< Arguments of the line received so far
+
+#if SERIAL_COMMANDS_FRAMES
+  FrameOutput frameOutput{this};               ///< Output stream of framed calls
+  uint8_t frameLength = 0;                     ///< Size of type and body of the frame
+  uint16_t frameCrc = 0;                       ///< CRC of the frame being received or sent
+  uint8_t frameRead = 0;                       ///< Next body byte to decode
+  uint8_t outputLength = 0;                    ///< Output bytes waiting after the request in the buffer
+  FrameStatus frameStatus = FrameStatus::Ok;   ///< Outcome of the request being decoded
+  uint8_t frameArg = 0;                        ///< 1-based number of the failing argument, or 0
+#endif
 
   /**
    * @brief Default delimiter predicate.
@@ -263,9 +378,48 @@ private:
   CharPredicate isTerm = [](char c)
   { return c == CMD_TERM_1 || c == CMD_TERM_2; };
 
+  /**
+   * @brief Work out the name order of the registered command tables, once.
+   *
+   * Done on first use rather than in the constructor, as the command arrays
+   * may be initialized after this object when they live in another file.
+   */
+  void sortCommands();
+
+  /**
+   * @brief Count a command array and its subcommand arrays that can be sorted.
+   *
+   * @param commands Array of commands.
+   * @param commandsCount Number of commands in the array.
+   * @param tables Incremented by the number of tables.
+   * @param entries Incremented by the number of commands in them.
+   */
+  static void countTables(const Command *commands, uint16_t commandsCount, uint16_t *tables, uint16_t *entries);
+
+  /**
+   * @brief Store the name order of a command array and its subcommand arrays.
+   *
+   * @param commands Array of commands.
+   * @param commandsCount Number of commands in the array.
+   * @param order Next free byte for the orders, advanced past the ones stored.
+   */
+  void sortTables(const Command *commands, uint16_t commandsCount, uint8_t **order);
+
+  /**
+   * @brief Get the name order of a command array.
+   *
+   * @param commands Array of commands.
+   * @return Table positions in name order, or nullptr if the array is not sorted.
+   */
+  const uint8_t *sortedOrder(const Command *commands) const;
+
   /**
    * @brief Find a command by name in the command array.
    *
+   * An exact name match wins; otherwise the string must be the prefix of
+   * exactly one command name. With SERIAL_COMMANDS_SORTED_LOOKUP a sorted
+   * array is searched by binary search through its name order.
+   *
    * @param string The command name to find.
    * @param commands Array of commands to search.
    * @param commandsCount Number of commands in the array.
@@ -274,40 +428,176 @@ private:
   const Command *findCommand(const char *const string, const Command *commands, uint16_t commandsCount);
 
   /**
-   * @brief Parse and execute a command string.
+   * @brief Feed one received character to the tokenizer.
    *
-   * @param string The command string to parse.
+   * @param ch The character.
    */
-  void parseCommand(char *string);
+  void processChar(char ch);
 
   /**
-   * @brief Get the next token from a string.
+   * @brief Begin a token, expecting a name or the next argument of cmd.
    *
-   * @param stringp Pointer to string pointer (modified).
-   * @return Pointer to the token or nullptr if no more tokens.
+   * @return false if the buffer has no room for an argument.
    */
-  char *getToken(char **stringp);
+  bool startToken();
 
   /**
-   * @brief Parse an argument from a string according to a constraint.
+   * @brief Add a character to the current token.
    *
-   * @param out Output argument.
-   * @param string The string to parse.
-   * @param arg The argument constraint.
-   * @return true if parsing was successful, false otherwise.
+   * Integer arguments are validated character by character.
+   *
+   * @param ch The character.
+   */
+  void addChar(char ch);
+
+  /**
+   * @brief Finish the current token and process it.
+   */
+  void endToken();
+
+  /**
+   * @brief Look up a command or subcommand name.
+   *
+   * @param name The name token.
    */
-  bool getArg(Arg &out, const char *string, const impl::ArgConstraint &arg);
+  void processName(const char *name);
 
   /**
-   * @brief Process command arguments.
+   * @brief Check a parsed argument against its constraint and store it.
    *
-   * @param cmd The command to process arguments for.
-   * @param string Pointer to the command string (modified).
-   * @param args Output arguments.
-   * @param argIndex Current argument index (modified).
-   * @return true if all arguments were successfully processed, false otherwise.
+   * The argument is kept in the buffer behind a type byte until the command
+   * runs: a number as its 4 byte value, a string as received.
+   *
+   * @param arg The parsed argument.
+   */
+  void processArg(Arg arg);
+
+  /**
+   * @brief Run the matched command when the terminator arrives.
+   */
+  void endLine();
+
+  /**
+   * @brief Read the stored arguments of the line back from the buffer.
+   *
+   * @param args Arguments to fill.
+   */
+  void loadArgs(Args &args);
+
+  /**
+   * @brief Forget the line being received.
+   */
+  void resetLine();
+
+  /**
+   * @brief Skip the rest of the line after an error message.
+   *
+   * @param printSyntax Print the syntax of the matched command first.
+   */
+  void skipLine(bool printSyntax);
+
+#if SERIAL_COMMANDS_FRAMES
+  /**
+   * @brief Feed one byte of a binary frame.
+   *
+   * @param b The byte.
+   */
+  void processFrameByte(uint8_t b);
+
+  /**
+   * @brief Check and answer a complete binary frame.
+   */
+  void processFrame();
+
+  /**
+   * @brief Run the command of a Call frame.
+   */
+  void callFrame();
+
+  /**
+   * @brief Answer a Describe frame with the command's table entry.
+   */
+  void describeFrame();
+
+  /**
+   * @brief Find a command by its frame id.
+   *
+   * Walks from the root to the command, so the arguments of every command on
+   * the path can be decoded in order, like the text parser does.
+   *
+   * @param id The command id.
+   * @param parentId Output id of the parent command, 0xFFFF at the root; may be nullptr.
+   * @param args Output arguments of the commands on the path; nullptr to skip them.
+   * @return Pointer to the command, or nullptr with frameStatus set.
+   */
+  const Command *commandById(uint16_t id, uint16_t *parentId, Args *args);
+
+  /**
+   * @brief Count a command and all its subcommands.
+   *
+   * @param command The command.
+   * @return Number of ids the command takes.
+   */
+  uint16_t subtreeSize(const Command &command);
+
+  /**
+   * @brief Decode and check the arguments of a command from the frame body.
+   *
+   * @param command The command.
+   * @param args Arguments to fill.
+   * @return true if all arguments were valid, false with frameStatus set.
+   */
+  bool decodeArgs(const Command *command, Args &args);
+
+  /**
+   * @brief Send a Result frame.
+   *
+   * @param status The outcome.
+   * @param arg 1-based number of the failing argument, or 0.
+   */
+  void sendResult(FrameStatus status, uint8_t arg);
+
+  /**
+   * @brief Start sending a frame.
+   *
+   * @param type The frame type.
+   * @param length Size of type and body.
+   */
+  void beginFrame(FrameType type, uint8_t length);
+
+  /**
+   * @brief Send bytes of the frame body.
+   *
+   * @param data The bytes.
+   * @param length Number of bytes.
+   */
+  void writeFrame(const void *data, uint8_t length);
+
+  /**
+   * @brief Send a string from program memory and its terminating null.
+   *
+   * @param str The string.
+   * @param length Number of characters to send.
+   */
+  void writeFramePgm(PGM_P str, uint8_t length);
+
+  /**
+   * @brief Finish the frame with its CRC.
+   */
+  void endFrame();
+
+  /**
+   * @brief Collect a byte printed by a framed call.
+   *
+   * @param b The byte.
+   */
+  void writeOutput(uint8_t b);
+
+  /**
+   * @brief Send the collected output in an Output frame.
    */
-  bool processArguments(const Command *cmd, char **string, Args &args, uint8_t &argIndex);
+  void flushOutput();
+#endif
 
   /**
    * @brief Print a string from program memory.